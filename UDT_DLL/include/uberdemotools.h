@@ -2,7 +2,7 @@
 
 
 #define  UDT_VERSION_MAJOR     1
-#define  UDT_VERSION_MINOR     3
+#define  UDT_VERSION_MINOR     4
 #define  UDT_VERSION_REVISION  0
 
 #define  UDT_QUOTE(name)            #name
@@ -113,6 +113,8 @@ typedef double f64;
 typedef struct udtParserContext_s udtParserContext;
 typedef struct udtParserContextGroup_s udtParserContextGroup;
 typedef struct udtPatternSearchContext_s udtPatternSearchContext;
+typedef struct udtAnalysisDataFile_s udtAnalysisDataFile;
+typedef struct udtProbeContext_s udtProbeContext;
 
 #if defined(__cplusplus)
 
@@ -811,6 +813,7 @@ struct udtPerfStatsDataType
 		Throughput, /* Data throughput, in bytes/second. */
 		Duration,   /* Duration in micro-seconds. */
 		Percentage, /* Percentage multiplied by 10. */
+		Rate,       /* Count per second multiplied by 10. */
 		Count
 	};
 };
@@ -825,7 +828,19 @@ struct udtPerfStatsDataType
 	N(MemoryCommitted, "memory committed", Bytes) \
 	N(MemoryUsed, "memory used", Bytes) \
 	N(MemoryEfficiency, "memory usage efficiency", Percentage) \
-	N(ResizeCount, "buffer relocation count", Generic)
+	N(ResizeCount, "buffer relocation count", Generic) \
+	N(CutCount, "cuts written", Generic) \
+	N(CutThroughput, "cut throughput", Rate) \
+	N(MessageCount, "messages parsed", Generic) \
+	N(SnapshotCount, "snapshots parsed", Generic) \
+	N(CachedDemoCount, "demos read from cache", Generic) \
+	N(SkippedByteCount, "data skipped", Bytes) \
+	N(FileReadDuration, "file read time", Duration) \
+	N(MessageParseDuration, "message parse time", Duration) \
+	N(SnapshotParseDuration, "snapshot parse time", Duration) \
+	N(EntityParseDuration, "entity parse time", Duration) \
+	N(PlugInDuration, "plug-in time", Duration) \
+	N(OutputWriteDuration, "output write time", Duration)
 
 #define UDT_PERF_STATS_ITEM(Enum, Desc, Type) Enum,
 struct udtPerfStatsField
@@ -841,7 +856,6 @@ struct udtPerfStatsField
 #endif
 
 
-#define    UDT_MAX_MERGE_DEMO_COUNT             8
 #define    UDT_TEAM_STATS_MASK_BYTE_COUNT       8
 #define    UDT_PLAYER_STATS_MASK_BYTE_COUNT    32
 
@@ -876,6 +890,27 @@ extern "C"
 	{
 		enum Id
 		{
+			/* Linux: read demos with asynchronous read-ahead instead of memory-mapping them. */
+			/* Recommended for network file systems. Always the case on Windows. */
+			ReadAheadInput = UDT_BIT(0),
+			/* When parsing a demo from the start, also write a keyframe index file next to it. */
+			/* The index of "demo.dm_68" is "demo.dm_68.udtidx". */
+			/* Keyframes are DemoIndexIntervalMs of server time apart. */
+			WriteDemoIndex = UDT_BIT(1),
+			/* When cutting, start parsing at the closest keyframe of the demo's index file */
+			/* instead of at the game state, if there is an up-to-date index file. */
+			UseDemoIndex = UDT_BIT(2),
+			/* Decode up to 2 Huffman symbols per table look-up when reading multi-byte fields. */
+			/* The output is the same, only the speed differs. */
+			MultiSymbolHuffman = UDT_BIT(3),
+			/* Measure the time spent in each parsing stage when PerformanceStats isn't NULL. */
+			/* Fills in udtPerfStatsField::FileReadDuration and the fields after it, and PlugInPerformanceStats. */
+			/* The stages are nested: message parsing includes snapshot parsing, which includes entity parsing. */
+			/* Plug-in time is spread over the stages that call the plug-ins. */
+			/* With memory-mapped input, most of the I/O time shows up as parsing time (page faults). */
+			/* The message and snapshot counts are always available. */
+			/* Reads the clock several times per message, so leave it off when only the total duration matters. */
+			ProfileStages = UDT_BIT(4)
 		};
 	};
 #endif
@@ -912,8 +947,12 @@ extern "C"
 		/* The array size should be udtPerfStatsField::Count. */
 		u64* PerformanceStats;
 
-		/* Ignore this. */
-		void* Reserved1;
+		/* May be NULL. */
+		/* Only used with udtParseArgFlag::ProfileStages. */
+		/* The array size should be udtParserPlugIn::Count. */
+		/* Time spent in each plug-in's callbacks, in micro-seconds. */
+		/* Add the arrays of different batches element by element to merge them. */
+		u64* PlugInPerformanceStats;
 
 		/* Number of elements in the array pointed to by the PlugIns pointer. */
 		/* May be 0. */
@@ -934,12 +973,87 @@ extern "C"
 		/* Minimum duration, in milli-seconds, between 2 consecutive calls to ProgressCb. */
 		u32 MinProgressTimeMs;
 
-		/* Ignore this. */
-		s32 Reserved2;
+		/* Server time duration, in milli-seconds, between 2 consecutive keyframes. */
+		/* Only used with udtParseArgFlag::WriteDemoIndex. */
+		/* 0 means the default of 30 seconds. */
+		u32 DemoIndexIntervalMs;
+
+		/* May be NULL. */
+		/* Folder where the analysis results of each demo and plug-in get cached. */
+		/* Only used by udtParseDemoFiles, udtSaveDemoFilesAnalysisDataToJSON and udtSaveDemoFilesAnalysisDataToBinary. */
+		/* Demos whose results are all cached aren't parsed again. */
+		/* Entries are keyed by demo content hash, UDT version and plug-in ID. */
+		/* The folder must already exist. It's safe to delete its files at any time. */
+		/* Demos are never read from the cache with udtParseArgFlag::WriteDemoIndex. */
+		const char* CacheFolderPath;
+
+		/* Size, in bytes, of the blocks read in the background with udtParseArgFlag::ReadAheadInput (always the case on Windows). */
+		/* 0 means the default of 128 KB. Smaller values than the largest message size of 16 KB are raised to it. */
+		/* Only applied when a context reads its first demo: the context keeps its blocks for the next demos. */
+		u32 ReadAheadBlockSize;
+
+		/* The amount of blocks: while the parser works on a block, the next (ReadAheadBlockCount - 1) blocks are being read. */
+		/* 0 means the default of 2. Smaller values are raised to 2. */
+		/* Only applied when a context reads its first demo: the context keeps its blocks for the next demos. */
+		u32 ReadAheadBlockCount;
 	}
 	udtParseArg;
 	UDT_ENFORCE_API_STRUCT_SIZE(udtParseArg)
 
+#if defined(__cplusplus)
+	struct udtMultiParseArgFlag
+	{
+		enum Id
+		{
+			/* Threads pull the next demo from a shared queue instead of being assigned */
+			/* a fixed list of demos up-front based on file sizes. */
+			/* Better load balancing when parse costs vary a lot between demos. */
+			DynamicScheduling = UDT_BIT(0),
+			/* Only used by udtParseDemoFiles when there is a single demo file. */
+			/* Parses the demo's game state segments on separate threads */
+			/* and merges the plug-in data back in order. */
+			SplitByGameState = UDT_BIT(1)
+		};
+	};
+
+	struct udtThreadPolicyFlag
+	{
+		enum Id
+		{
+			/* Pin each worker thread to its own processor core. */
+			PinThreadsToCores = UDT_BIT(0),
+			/* Start with a single thread and keep adding threads during the first seconds of the job */
+			/* for as long as the measured throughput per thread stays high enough. */
+			/* Implies udtMultiParseArgFlag::DynamicScheduling. */
+			AutoTune = UDT_BIT(1)
+		};
+	};
+#endif
+
+	typedef struct udtThreadPolicy_s
+	{
+		/* Minimum amount of input data, in bytes, for each thread. */
+		/* 0 means the default value of 6 MB is used. */
+		u64 MinByteCountPerThread;
+
+		/* The maximum amount of threads that should be used to process the demos. */
+		/* 0 means the processor core count is used. */
+		/* This value is never larger than the processor core count. */
+		u32 MaxThreadCount;
+
+		/* Minimum amount of demo files for each thread. */
+		/* 0 means the default value of 1 is used. */
+		u32 MinFileCountPerThread;
+
+		/* See udtThreadPolicyFlag::Id. */
+		u32 Flags;
+
+		/* Ignore this. */
+		s32 Reserved1;
+	}
+	udtThreadPolicy;
+	UDT_ENFORCE_API_STRUCT_SIZE(udtThreadPolicy)
+
 	typedef struct udtMultiParseArg_s
 	{
 		/* Pointer to an array of file paths. */
@@ -952,7 +1066,18 @@ extern "C"
 		u32 FileCount;
 
 		/* The maximum amount of threads that should be used to process the demos. */
+		/* This value is never larger than the processor core count. */
 		u32 MaxThreadCount;
+
+		/* May be NULL. */
+		/* When not NULL, MaxThreadCount is ignored. */
+		const udtThreadPolicy* ThreadPolicy;
+
+		/* See udtMultiParseArgFlag::Id. */
+		u32 Flags;
+
+		/* Ignore this. */
+		s32 Reserved1;
 	}
 	udtMultiParseArg;
 	UDT_ENFORCE_API_STRUCT_SIZE(udtMultiParseArg)
@@ -1014,7 +1139,13 @@ extern "C"
 	{
 		enum Id
 		{
-			MergeCutSections = UDT_BIT(0) /* Enable/disable merging cut sections from different patterns. */
+			MergeCutSections = UDT_BIT(0), /* Enable/disable merging cut sections from different patterns. */
+			/* Cut while searching instead of parsing the demo again to apply the cuts. */
+			/* Recent messages and parser states are kept in memory so cuts can start before their match. */
+			/* Only used when cutting and only when all patterns support it (chat, frag sequences, mid-airs, */
+			/* multi-frag rails and flick rails) and, with multiple patterns, MergeCutSections is set. */
+			/* Cuts that can't be written this way get written by a second parse. */
+			SinglePass = UDT_BIT(1)
 		};
 	};
 
@@ -1156,6 +1287,28 @@ extern "C"
 	udtCutByTimeArg;
 	UDT_ENFORCE_API_STRUCT_SIZE(udtCutByTimeArg)
 
+	typedef struct udtMultiCutByTimeArg_s
+	{
+		/* Pointer to an array of cut times. */
+		/* udtCut::GameStateIndex is the game state each cut applies to. */
+		/* The cuts of a demo can overlap and don't need to be sorted. */
+		/* May not be NULL. */
+		const udtCut* Cuts;
+
+		/* Pointer to an array of indices into udtMultiParseArg::FilePaths, one per cut. */
+		/* Must be sorted in ascending order. */
+		/* May not be NULL. */
+		const u32* DemoInputIndices;
+
+		/* Number of elements in the arrays pointed by Cuts and DemoInputIndices. */
+		u32 CutCount;
+
+		/* Ignore this. */
+		s32 Reserved1;
+	}
+	udtMultiCutByTimeArg;
+	UDT_ENFORCE_API_STRUCT_SIZE(udtMultiCutByTimeArg)
+
 	typedef struct udtChatPatternRule_s
 	{
 		/* May not be NULL. */
@@ -2179,17 +2332,187 @@ extern "C"
 	udtTimeShiftArg;
 	UDT_ENFORCE_API_STRUCT_SIZE(udtTimeShiftArg)
 
+#if defined(__cplusplus)
+	struct udtJSONArgFlag
+	{
+		enum Id
+		{
+			/* No new lines, indentation or spaces between tokens. */
+			/* Much smaller files for when no human will ever read them. */
+			Compact = UDT_BIT(0),
+			/* Newline-delimited JSON: instead of writing one file per demo, */
+			/* all demos are written to a single file with one compact JSON object per line. */
+			/* Each object has a "filePath" field with the demo's path. */
+			/* Every processing thread writes to its own file (see udtJSONArg::OutputFilePath). */
+			/* Implies udtJSONArgFlag::Compact. */
+			NDJSON = UDT_BIT(1)
+		};
+	};
+#endif
+
 	typedef struct udtJSONArg_s
 	{
 		/* Output the data to stdout when non-zero. */
 		u32 ConsoleOutput;
 
+		/* See udtJSONArgFlag::Id. */
+		u32 Flags;
+
+		/* Only used with udtJSONArgFlag::NDJSON when ConsoleOutput is 0. */
+		/* When more than one thread is used, the thread index is appended to the file name: */
+		/* "data.ndjson" becomes "data_0.ndjson", "data_1.ndjson", etc. */
+		const char* OutputFilePath;
+
 		/* Ignore this. */
-		s32 Reserved1;
+		const void* Reserved1;
 	}
 	udtJSONArg;
 	UDT_ENFORCE_API_STRUCT_SIZE(udtJSONArg)
 
+	typedef struct udtBinaryExportArg_s
+	{
+		/* Path of the file to create. */
+		/* The data of all the demos of the call goes into this single file. */
+		const char* OutputFilePath;
+
+		/* Ignore this. */
+		const void* Reserved1;
+	}
+	udtBinaryExportArg;
+	UDT_ENFORCE_API_STRUCT_SIZE(udtBinaryExportArg)
+
+	typedef struct udtProbeArg_s
+	{
+		/* The amount of snapshots to read after the first game state. */
+		/* Zero stops right after the first game state. */
+		/* More snapshots give more reliable mod, game type and game play values. */
+		u32 MaxSnapshotCount;
+
+		/* Ignore this. */
+		u32 Reserved1;
+	}
+	udtProbeArg;
+	UDT_ENFORCE_API_STRUCT_SIZE(udtProbeArg)
+
+	typedef struct udtDemoProbePlayer_s
+	{
+		/* String offset. The player's name without color codes. */
+		u32 Name;
+
+		/* String length. */
+		u32 NameLength;
+
+		/* The client number. */
+		/* Range: [0;63]. */
+		s32 Index;
+
+		/* Index of the team the player was in. */
+		/* Negative if not available. */
+		s32 Team;
+	}
+	udtDemoProbePlayer;
+	UDT_ENFORCE_API_STRUCT_SIZE(udtDemoProbePlayer)
+
+	typedef struct udtDemoProbeInfo_s
+	{
+		/* String offset. The map's name. */
+		u32 MapName;
+
+		/* String length. */
+		u32 MapNameLength;
+
+		/* String offset. The mod's version, if available. */
+		u32 ModVersion;
+
+		/* String length. */
+		u32 ModVersionLength;
+
+		/* String offset. The server's name, without color codes. */
+		u32 ServerName;
+
+		/* String length. */
+		u32 ServerNameLength;
+
+		/* String offset. Name of the player who recorded the demo without color codes. */
+		u32 DemoTakerName;
+
+		/* String length. */
+		u32 DemoTakerNameLength;
+
+		/* The index of the first player in udtProbeResults::Players. */
+		u32 FirstPlayerIndex;
+
+		/* The player count. */
+		u32 PlayerCount;
+
+		/* Of type udtProtocol::Id. */
+		/* udtProtocol::Invalid if the demo couldn't be probed. */
+		u32 Protocol;
+
+		/* Of type udtMod::Id. */
+		u32 Mod;
+
+		/* Of type udtGameType::Id. */
+		u32 GameType;
+
+		/* Of type udtGamePlay::Id. */
+		u32 GamePlay;
+
+		/* Index the player who recorded the demo. */
+		/* Range: [0;63]. */
+		s32 DemoTakerPlayerIndex;
+
+		/* Time of the first snapshot read, in milli-seconds. */
+		/* S32_MIN if no snapshot was read. */
+		s32 FirstSnapshotTimeMs;
+
+		/* Time of the last snapshot read, in milli-seconds. */
+		/* S32_MIN if no snapshot was read. */
+		s32 LastSnapshotTimeMs;
+
+		/* The amount of snapshots read. */
+		u32 SnapshotCount;
+
+		/* Match start date, in seconds since the Unix epoch. */
+		/* Zero if not available. */
+		u32 StartDateEpoch;
+
+		/* Ignore this. */
+		u32 Reserved1;
+	}
+	udtDemoProbeInfo;
+	UDT_ENFORCE_API_STRUCT_SIZE(udtDemoProbeInfo)
+
+	typedef struct udtProbeResults_s
+	{
+		/* Pointer to the array of demo descriptors. */
+		/* Indexed by the input index: the array has the same length as udtMultiParseArg::FilePaths. */
+		const udtDemoProbeInfo* Demos;
+
+		/* Pointer to the array of player descriptors. */
+		const udtDemoProbePlayer* Players;
+
+		/* Pointer to a buffer containing all UTF-8 strings. */
+		const u8* StringBuffer;
+
+		/* Ignore this. */
+		const void* Reserved1;
+
+		/* Length of the Demos array. */
+		u32 DemoCount;
+
+		/* Length of the Players array. */
+		u32 PlayerCount;
+
+		/* The byte count of the StringBuffer. */
+		u32 StringBufferSize;
+
+		/* Ignore this. */
+		u32 Reserved2;
+	}
+	udtProbeResults;
+	UDT_ENFORCE_API_STRUCT_SIZE(udtProbeResults)
+
 #pragma pack(pop)
 
 	/*
@@ -2301,7 +2624,7 @@ extern "C"
 	UDT_API(s32) udtCutDemoFileByTime(udtParserContext* context, const udtParseArg* info, const udtCutByTimeArg* cutInfo, const char* demoFilePath);
 
 	/* Creates a new demo that is basically the first demo passed with extra entity data from the other demos. */
-	/* The maximum amount of demos merged (i.e. the maximum value of fileCount) is UDT_MAX_MERGE_DEMO_COUNT. */
+	/* There is no limit on the amount of demos merged, but each one needs its own parser and about 6 MB of memory. */
 	UDT_API(s32) udtMergeDemoFiles(const udtParseArg* info, const char** filePaths, u32 fileCount);
 
 	/* For a given plug-in id, gets the complete buffer descriptor table for all demos in the context. */
@@ -2340,6 +2663,10 @@ extern "C"
 	/* Creates, for each demo, sub-demos around every occurrence of a matching pattern. */
 	UDT_API(s32) udtCutDemoFilesByPattern(const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtPatternSearchArg* patternInfo);
 
+	/* Creates sub-demos for all the cuts of all the demos. */
+	/* Every demo is read once and the cuts that overlap share the decoded data, only the output messages are encoded for each cut. */
+	UDT_API(s32) udtCutDemoFilesByTime(const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtMultiCutByTimeArg* cutInfo);
+
 	/* Creates a list of matches for the requested patterns in the newly created search context. */
 	UDT_API(s32) udtFindPatternsInDemoFiles(udtPatternSearchContext** context, const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtPatternSearchArg* patternInfo);
 
@@ -2358,6 +2685,44 @@ extern "C"
 	/* Creates, for each demo, a .JSON file with the data from all the selected plug-ins. */
 	UDT_API(s32) udtSaveDemoFilesAnalysisDataToJSON(const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtJSONArg* jsonInfo);
 
+	/* Creates a single binary file with the data from all the selected plug-ins for all the demos. */
+	/* The item arrays of the udtParseData*Buffers structs are stored as they are, so reading the file back doesn't copy or convert anything. */
+	/* The file is only valid for the exact same library version and architecture. */
+	UDT_API(s32) udtSaveDemoFilesAnalysisDataToBinary(const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtBinaryExportArg* binaryInfo);
+
+	/* Reads the first game state of every demo and, optionally, a few snapshots after it. */
+	/* Much faster than udtParseDemoFiles with udtParserPlugIn::GameState since the rest of the demo isn't read. */
+	/* Creates the probe context holding the results. */
+	UDT_API(s32) udtProbeDemoFiles(udtProbeContext** context, const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtProbeArg* probeInfo);
+
+	/* Gets the probe results from the given probe context. */
+	/* The pointers stay valid until the context is destroyed. */
+	UDT_API(s32) udtGetProbeResults(udtProbeContext* context, udtProbeResults* results);
+
+	/* Releases all the resources associated to the probe context. */
+	UDT_API(s32) udtDestroyProbeContext(udtProbeContext* context);
+
+	/* Opens a file created by udtSaveDemoFilesAnalysisDataToBinary. */
+	/* Like a context group, the file stores the data of one or more contexts. */
+	UDT_API(s32) udtLoadAnalysisDataFile(udtAnalysisDataFile** file, const char* filePath);
+
+	/* Gets the amount of contexts stored in the file. */
+	UDT_API(s32) udtGetContextCountFromAnalysisDataFile(udtAnalysisDataFile* file, u32* count);
+
+	/* Gets the demo count for which plug-in data is stored in a context of the file. */
+	UDT_API(s32) udtGetDemoCountFromAnalysisDataFile(udtAnalysisDataFile* file, u32 contextIdx, u32* count);
+
+	/* Gets the input index and the file path of the specified demo. */
+	/* The file path is null-terminated and stays valid until the file is destroyed. */
+	UDT_API(s32) udtGetDemoInfoFromAnalysisDataFile(udtAnalysisDataFile* file, u32 contextIdx, u32 demoIdx, u32* demoInputIdx, const char** demoFilePath);
+
+	/* For a given plug-in id, gets the complete buffer descriptor table for all demos in a context of the file. */
+	/* Same as udtGetContextPlugInBuffers, the pointers stay valid until the file is destroyed. */
+	UDT_API(s32) udtGetAnalysisDataFilePlugInBuffers(udtAnalysisDataFile* file, u32 contextIdx, u32 plugInId, void* buffersStruct);
+
+	/* Releases all the resources associated to the file. */
+	UDT_API(s32) udtDestroyAnalysisDataFile(udtAnalysisDataFile* file);
+
 	/*
 	Custom parsing constants and data structures.
 	*/
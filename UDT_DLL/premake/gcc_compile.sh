@@ -42,8 +42,11 @@ make UDT_merger config=$UDT_CONFIG
 make UDT_json config=$UDT_CONFIG
 make UDT_captures config=$UDT_CONFIG
 make UDT_converter config=$UDT_CONFIG
+make UDT_huffman_bench config=$UDT_CONFIG
+make UDT_bench config=$UDT_CONFIG
 make UDT_viewer config=$UDT_CONFIG
 make viewer_data_gen config=$UDT_CONFIG
+make viewer_heat_maps config=$UDT_CONFIG
 make tut_players config=$UDT_CONFIG
 make tut_multi_rail config=$UDT_CONFIG
 
@@ -250,6 +250,22 @@ solution "UDT"
 		files { path_src_apps.."/shared.cpp" }
 		ApplyProjectSettings()
 		
+	project "UDT_huffman_bench"
+	
+		kind "ConsoleApp"
+		defines { "UDT_CREATE_DLL" }
+		files { path_src_apps.."/app_huffman_bench.cpp" }
+		files { path_src_apps.."/shared.cpp" }
+		ApplyProjectSettings()
+		
+	project "UDT_bench"
+	
+		kind "ConsoleApp"
+		defines { "UDT_CREATE_DLL" }
+		files { path_src_apps.."/app_bench.cpp" }
+		files { path_src_apps.."/shared.cpp" }
+		ApplyProjectSettings()
+		
 	-- This project exists only to test the API in C89 mode to ensure nothing got messed up for C programmers.
 	project "UDT_c89"
 	
@@ -327,3 +343,15 @@ solution "UDT"
 		files { path_src_apps.."/shared.cpp" }
 		includedirs { path_src_core.."/viewer" }
 		ApplyProjectSettings()
+		
+	project "viewer_heat_maps"
+	
+		kind "ConsoleApp"
+		defines { "UDT_CREATE_DLL" }
+		files { path_src_core.."/viewer_heat_maps/*.cpp" }
+		files { path_src_core.."/viewer/demo.cpp", path_src_core.."/viewer/demo.hpp" }
+		files { path_src_core.."/viewer/log.cpp", path_src_core.."/viewer/log.hpp" }
+		files { path_src_core.."/viewer_data_gen/stb.cpp" }
+		files { path_src_apps.."/shared.cpp" }
+		includedirs { path_src_core.."/viewer", path_src_core.."/viewer_data_gen" }
+		ApplyProjectSettings()
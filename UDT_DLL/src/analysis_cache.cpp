@@ -0,0 +1,389 @@
+#include "analysis_cache.hpp"
+#include "analysis_data_file.hpp"
+#include "file_stream.hpp"
+#include "scoped_stack_allocator.hpp"
+#include "path.hpp"
+#include "utils.hpp"
+
+
+/*
+Entry file layout:
+- udtAnalysisCacheHeader
+- udtAnalysisCacheColumn array: the plug-in's columns, in the order of UDT_ANALYSIS_DATA_COLUMN_LIST
+- column data: the items the demo added to each array of the plug-in's buffers struct
+- string data: the strings the demo added to the plug-in's string buffer
+
+Items are stored as they were in memory: their indices and string offsets are relative to
+the array sizes and string buffer size the plug-in had when the demo started.
+Those sizes are stored too so that udtBaseParserPlugIn::AppendDemo can fix everything up.
+All data is 8-byte aligned and stored in the native byte order.
+*/
+
+
+#define UDT_ANALYSIS_CACHE_MAGIC        0x43414455 // "UDAC"
+#define UDT_ANALYSIS_CACHE_VERSION      1
+#define UDT_ANALYSIS_CACHE_ALIGNMENT    8
+
+
+struct udtAnalysisCacheHeader
+{
+	u32 Magic;
+	u32 Version;
+	u32 VersionMajor; // UDT's.
+	u32 VersionMinor; // UDT's.
+	u32 VersionRevision; // UDT's.
+	u32 PlugInId;
+	u32 Protocol;
+	u32 ColumnCount;
+	u64 DemoFileHash;
+	u64 DemoFileSize;
+	u32 StringBufferBase;
+	u32 StringBufferSize;
+};
+
+struct udtAnalysisCacheColumn
+{
+	u32 ColumnId; // udtAnalysisDataColumn::Id
+	u32 ElementSize; // Must match the reader's element type.
+	u32 ElementCount;
+	u32 BaseElementCount;
+};
+
+
+static u32 AlignOffset(u32 offset)
+{
+	return (offset + (UDT_ANALYSIS_CACHE_ALIGNMENT - 1)) & ~(u32)(UDT_ANALYSIS_CACHE_ALIGNMENT - 1);
+}
+
+static u32 GetColumnCount(u32 plugInId)
+{
+	u32 columnCount = 0;
+#define UDT_ANALYSIS_DATA_COLUMN_ITEM(PlugIn, Field, CountField, CountScale, Type) \
+	if(plugInId == (u32)udtParserPlugIn::PlugIn) \
+	{ \
+		++columnCount; \
+	}
+	UDT_ANALYSIS_DATA_COLUMN_LIST(UDT_ANALYSIS_DATA_COLUMN_ITEM)
+#undef UDT_ANALYSIS_DATA_COLUMN_ITEM
+
+	return columnCount;
+}
+
+static void GetPlugInStrings(const u8*& stringBuffer, u32& stringBufferSize, u32 plugInId, const udtAnalysisDataBuffers& buffers)
+{
+	stringBuffer = NULL;
+	stringBufferSize = 0;
+#define UDT_ANALYSIS_DATA_RANGES_ITEM(PlugIn, RangesField) \
+	if(plugInId == (u32)udtParserPlugIn::PlugIn) \
+	{ \
+		stringBuffer = buffers.PlugIn.StringBuffer; \
+		stringBufferSize = buffers.PlugIn.StringBufferSize; \
+	}
+	UDT_ANALYSIS_DATA_RANGES_LIST(UDT_ANALYSIS_DATA_RANGES_ITEM)
+#undef UDT_ANALYSIS_DATA_RANGES_ITEM
+}
+
+static void SetPlugInStrings(udtAnalysisDataBuffers& buffers, u32 plugInId, const u8* stringBuffer, u32 stringBufferSize)
+{
+#define UDT_ANALYSIS_DATA_RANGES_ITEM(PlugIn, RangesField) \
+	if(plugInId == (u32)udtParserPlugIn::PlugIn) \
+	{ \
+		buffers.PlugIn.StringBuffer = stringBuffer; \
+		buffers.PlugIn.StringBufferSize = stringBufferSize; \
+	}
+	UDT_ANALYSIS_DATA_RANGES_LIST(UDT_ANALYSIS_DATA_RANGES_ITEM)
+#undef UDT_ANALYSIS_DATA_RANGES_ITEM
+}
+
+static bool WritePadded(udtFileStream& file, u32& fileOffset, const void* data, u32 byteCount)
+{
+	static const u8 zeroes[UDT_ANALYSIS_CACHE_ALIGNMENT] = { 0 };
+
+	const u32 offset = AlignOffset(fileOffset);
+	if(offset > fileOffset && file.Write(zeroes, offset - fileOffset, 1) != 1)
+	{
+		return false;
+	}
+
+	if(byteCount > 0 && file.Write(data, byteCount, 1) != 1)
+	{
+		return false;
+	}
+
+	fileOffset = offset + byteCount;
+
+	return true;
+}
+
+
+udtAnalysisCache::udtAnalysisCache(udtParserContext& context)
+	: _context(context)
+	, _folderPath(NULL)
+	, _demoFileHash(0)
+	, _demoFileSize(0)
+	, _protocol(udtProtocol::Invalid)
+{
+	memset(_bases, 0, sizeof(_bases));
+}
+
+udtAnalysisCache::~udtAnalysisCache()
+{
+}
+
+bool udtAnalysisCache::Init(const char* cacheFolderPath, const char* demoFilePath, udtProtocol::Id protocol)
+{
+	if(_context.PlugIns.IsEmpty())
+	{
+		return false;
+	}
+
+	for(u32 i = 0, count = _context.PlugIns.GetSize(); i < count; ++i)
+	{
+		if((u32)_context.PlugIns[i].Id >= (u32)udtParserPlugIn::Count)
+		{
+			return false;
+		}
+	}
+
+	u64 hash = 0;
+	u64 fileSize = 0;
+	if(!HashFile(hash, fileSize, demoFilePath, _context.PlugInTempAllocator))
+	{
+		return false;
+	}
+
+	_folderPath = cacheFolderPath;
+	_demoFileHash = hash;
+	_demoFileSize = fileSize;
+	_protocol = protocol;
+
+	return true;
+}
+
+bool udtAnalysisCache::GetEntryFilePath(udtString& filePath, udtVMLinearAllocator& allocator, u32 plugInId) const
+{
+	char fileName[64];
+	sprintf(fileName, "%08x%08x_%x_%u_%u.udtcache",
+			(u32)(_demoFileHash >> 32), (u32)_demoFileHash, (u32)_demoFileSize, (u32)_protocol, plugInId);
+
+	return udtPath::Combine(filePath, allocator, udtString::NewConstRef(_folderPath), fileName);
+}
+
+bool udtAnalysisCache::Read()
+{
+	const u32 plugInCount = _context.PlugIns.GetSize();
+	udtVMLinearAllocator& allocator = _context.PlugInTempAllocator;
+	udtVMScopedStackAllocator allocatorScope(allocator);
+
+	// Load and validate everything first: we add all of the demo or nothing.
+	uptr entryOffsets[udtParserPlugIn::Count];
+	for(u32 p = 0; p < plugInCount; ++p)
+	{
+		const u32 plugInId = (u32)_context.PlugIns[p].Id;
+		udtString filePath;
+		if(!GetEntryFilePath(filePath, allocator, plugInId))
+		{
+			return false;
+		}
+
+		udtFileStream file;
+		if(!file.Open(filePath.GetPtr(), udtFileOpenMode::Read))
+		{
+			return false;
+		}
+
+		const u64 fileSize = file.Length();
+		if(fileSize < (u64)sizeof(udtAnalysisCacheHeader) || fileSize > (u64)UDT_U32_MAX)
+		{
+			return false;
+		}
+
+		const uptr entryOffset = allocator.Allocate((uptr)fileSize);
+		u8* const entry = allocator.GetAddressAt(entryOffset);
+		if(file.Read(entry, (u32)fileSize, 1) != 1)
+		{
+			return false;
+		}
+
+		const udtAnalysisCacheHeader& header = *(const udtAnalysisCacheHeader*)entry;
+		const u32 columnCount = GetColumnCount(plugInId);
+		if(header.Magic != UDT_ANALYSIS_CACHE_MAGIC ||
+		   header.Version != UDT_ANALYSIS_CACHE_VERSION ||
+		   header.VersionMajor != UDT_VERSION_MAJOR ||
+		   header.VersionMinor != UDT_VERSION_MINOR ||
+		   header.VersionRevision != UDT_VERSION_REVISION ||
+		   header.PlugInId != plugInId ||
+		   header.Protocol != (u32)_protocol ||
+		   header.ColumnCount != columnCount ||
+		   header.DemoFileHash != _demoFileHash ||
+		   header.DemoFileSize != _demoFileSize ||
+		   fileSize < (u64)sizeof(udtAnalysisCacheHeader) + (u64)columnCount * (u64)sizeof(udtAnalysisCacheColumn))
+		{
+			return false;
+		}
+
+		// The columns must be the plug-in's, in order, and the sizes must add up exactly.
+		const udtAnalysisCacheColumn* const columns = (const udtAnalysisCacheColumn*)(entry + sizeof(udtAnalysisCacheHeader));
+		u64 offset = (u64)sizeof(udtAnalysisCacheHeader) + (u64)columnCount * (u64)sizeof(udtAnalysisCacheColumn);
+		u32 c = 0;
+#define UDT_ANALYSIS_DATA_COLUMN_ITEM(PlugIn, Field, CountField, CountScale, Type) \
+		if(plugInId == (u32)udtParserPlugIn::PlugIn) \
+		{ \
+			const udtAnalysisCacheColumn& column = columns[c++]; \
+			if(column.ColumnId != (u32)udtAnalysisDataColumn::PlugIn##Field || \
+			   column.ElementSize != (u32)sizeof(Type) || \
+			   column.ElementCount % CountScale != 0 || \
+			   column.BaseElementCount % CountScale != 0) \
+			{ \
+				return false; \
+			} \
+			offset = (u64)AlignOffset((u32)offset) + (u64)column.ElementCount * (u64)sizeof(Type); \
+			if(offset > fileSize) \
+			{ \
+				return false; \
+			} \
+		}
+		UDT_ANALYSIS_DATA_COLUMN_LIST(UDT_ANALYSIS_DATA_COLUMN_ITEM)
+#undef UDT_ANALYSIS_DATA_COLUMN_ITEM
+
+		if((u64)AlignOffset((u32)offset) + (u64)header.StringBufferSize != fileSize)
+		{
+			return false;
+		}
+
+		entryOffsets[p] = entryOffset;
+	}
+
+	for(u32 p = 0; p < plugInCount; ++p)
+	{
+		const u32 plugInId = (u32)_context.PlugIns[p].Id;
+		const u8* const entry = allocator.GetAddressAt(entryOffsets[p]);
+		const udtAnalysisCacheHeader& header = *(const udtAnalysisCacheHeader*)entry;
+		const udtAnalysisCacheColumn* const columns = (const udtAnalysisCacheColumn*)(entry + sizeof(udtAnalysisCacheHeader));
+
+		udtAnalysisDataBuffers buffers;
+		udtAnalysisDataBuffers bases;
+		memset(&buffers, 0, sizeof(buffers));
+		memset(&bases, 0, sizeof(bases));
+
+		u32 offset = (u32)sizeof(udtAnalysisCacheHeader) + header.ColumnCount * (u32)sizeof(udtAnalysisCacheColumn);
+		u32 c = 0;
+#define UDT_ANALYSIS_DATA_COLUMN_ITEM(PlugIn, Field, CountField, CountScale, Type) \
+		if(plugInId == (u32)udtParserPlugIn::PlugIn) \
+		{ \
+			const udtAnalysisCacheColumn& column = columns[c++]; \
+			offset = AlignOffset(offset); \
+			buffers.PlugIn.Field = (const Type*)(entry + offset); \
+			buffers.PlugIn.CountField = column.ElementCount / CountScale; \
+			bases.PlugIn.CountField = column.BaseElementCount / CountScale; \
+			offset += column.ElementCount * (u32)sizeof(Type); \
+		}
+		UDT_ANALYSIS_DATA_COLUMN_LIST(UDT_ANALYSIS_DATA_COLUMN_ITEM)
+#undef UDT_ANALYSIS_DATA_COLUMN_ITEM
+
+		SetPlugInStrings(buffers, plugInId, entry + AlignOffset(offset), header.StringBufferSize);
+		SetPlugInStrings(bases, plugInId, NULL, header.StringBufferBase);
+		_context.PlugIns[p].PlugIn->AppendDemo(&buffers, &bases);
+	}
+
+	return true;
+}
+
+void udtAnalysisCache::StartDemo()
+{
+	_context.UpdatePlugInBufferStructs();
+	for(u32 p = 0, count = _context.PlugIns.GetSize(); p < count; ++p)
+	{
+		const u32 plugInId = (u32)_context.PlugIns[p].Id;
+		_context.PlugIns[p].PlugIn->CopyBuffersStruct(&_bases[plugInId]);
+	}
+}
+
+bool udtAnalysisCache::Write()
+{
+	_context.UpdatePlugInBufferStructs();
+
+	bool success = true;
+	for(u32 p = 0, count = _context.PlugIns.GetSize(); p < count; ++p)
+	{
+		success &= WriteEntry((u32)_context.PlugIns[p].Id);
+	}
+
+	return success;
+}
+
+bool udtAnalysisCache::WriteEntry(u32 plugInId)
+{
+	udtAnalysisDataBuffers buffers;
+	memset(&buffers, 0, sizeof(buffers));
+	_context.CopyBuffersStruct(plugInId, &buffers);
+	const udtAnalysisDataBuffers& bases = _bases[plugInId];
+
+	udtAnalysisCacheColumn columns[udtAnalysisDataColumn::Count];
+	const u8* columnData[udtAnalysisDataColumn::Count];
+	u32 columnCount = 0;
+#define UDT_ANALYSIS_DATA_COLUMN_ITEM(PlugIn, Field, CountField, CountScale, Type) \
+	if(plugInId == (u32)udtParserPlugIn::PlugIn) \
+	{ \
+		udtAnalysisCacheColumn& column = columns[columnCount]; \
+		column.ColumnId = (u32)udtAnalysisDataColumn::PlugIn##Field; \
+		column.ElementSize = (u32)sizeof(Type); \
+		column.BaseElementCount = bases.PlugIn.CountField * CountScale; \
+		column.ElementCount = buffers.PlugIn.CountField * CountScale - column.BaseElementCount; \
+		columnData[columnCount++] = (const u8*)(buffers.PlugIn.Field + column.BaseElementCount); \
+	}
+	UDT_ANALYSIS_DATA_COLUMN_LIST(UDT_ANALYSIS_DATA_COLUMN_ITEM)
+#undef UDT_ANALYSIS_DATA_COLUMN_ITEM
+
+	const u8* stringBuffer;
+	u32 stringBufferSize;
+	const u8* baseStringBuffer;
+	u32 baseStringBufferSize;
+	GetPlugInStrings(stringBuffer, stringBufferSize, plugInId, buffers);
+	GetPlugInStrings(baseStringBuffer, baseStringBufferSize, plugInId, bases);
+
+	udtAnalysisCacheHeader header;
+	header.Magic = UDT_ANALYSIS_CACHE_MAGIC;
+	header.Version = UDT_ANALYSIS_CACHE_VERSION;
+	header.VersionMajor = UDT_VERSION_MAJOR;
+	header.VersionMinor = UDT_VERSION_MINOR;
+	header.VersionRevision = UDT_VERSION_REVISION;
+	header.PlugInId = plugInId;
+	header.Protocol = (u32)_protocol;
+	header.ColumnCount = columnCount;
+	header.DemoFileHash = _demoFileHash;
+	header.DemoFileSize = _demoFileSize;
+	header.StringBufferBase = baseStringBufferSize;
+	header.StringBufferSize = stringBufferSize - baseStringBufferSize;
+
+	udtVMLinearAllocator& allocator = _context.PlugInTempAllocator;
+	udtVMScopedStackAllocator allocatorScope(allocator);
+	udtString filePath;
+	if(!GetEntryFilePath(filePath, allocator, plugInId))
+	{
+		return false;
+	}
+
+	udtFileStream file;
+	if(!file.Open(filePath.GetPtr(), udtFileOpenMode::Write))
+	{
+		return false;
+	}
+
+	if(file.Write(&header, (u32)sizeof(header), 1) != 1 ||
+	   (columnCount > 0 && file.Write(columns, (u32)sizeof(udtAnalysisCacheColumn), columnCount) != columnCount))
+	{
+		return false;
+	}
+
+	u32 fileOffset = (u32)sizeof(header) + columnCount * (u32)sizeof(udtAnalysisCacheColumn);
+	for(u32 c = 0; c < columnCount; ++c)
+	{
+		if(!WritePadded(file, fileOffset, columnData[c], columns[c].ElementCount * columns[c].ElementSize))
+		{
+			return false;
+		}
+	}
+
+	return WritePadded(file, fileOffset, stringBuffer + baseStringBufferSize, header.StringBufferSize);
+}
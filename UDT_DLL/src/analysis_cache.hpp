@@ -0,0 +1,33 @@
+#pragma once
+
+
+#include "parser_context.hpp"
+
+
+// On-disk cache of the analysis plug-ins' output, see udtParseArg::CacheFolderPath.
+// There is one file per demo and plug-in, keyed by demo content hash, protocol, UDT version and plug-in ID.
+// Only works with contexts that have analysis plug-ins exclusively.
+struct udtAnalysisCache
+{
+public:
+	udtAnalysisCache(udtParserContext& context);
+	~udtAnalysisCache();
+
+	bool Init(const char* cacheFolderPath, const char* demoFilePath, udtProtocol::Id protocol); // Hashes the demo file.
+	bool Read(); // Adds the demo to the plug-ins when all of them have a valid entry. Adds nothing otherwise.
+	void StartDemo(); // Call right before parsing the demo.
+	bool Write(); // Call once the demo was parsed successfully and without errors.
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtAnalysisCache);
+
+	bool GetEntryFilePath(udtString& filePath, udtVMLinearAllocator& allocator, u32 plugInId) const;
+	bool WriteEntry(u32 plugInId);
+
+	udtParserContext& _context;
+	udtAnalysisDataBuffers _bases[udtParserPlugIn::Count]; // Where the demo's data starts in each plug-in.
+	const char* _folderPath;
+	u64 _demoFileHash;
+	u64 _demoFileSize;
+	udtProtocol::Id _protocol;
+};
@@ -0,0 +1,601 @@
+#include "analysis_data_file.hpp"
+#include "file_stream.hpp"
+#include "utils.hpp"
+
+
+/*
+File layout:
+- udtAnalysisDataFileHeader
+- udtAnalysisDataFileContext array
+- udtAnalysisDataFileDemo array
+- udtAnalysisDataFilePlugIn array
+- udtAnalysisDataFileColumn array
+- column data: the buffer ranges of each plug-in and the arrays of its buffers struct
+- string table: the string buffers of all plug-ins and the demo file paths
+
+There is one context for each parser context that did the work (i.e. one per thread),
+exactly like with udtParseDemoFiles.
+Columns are the arrays of the udtParseData*Buffers structs stored as they are in memory:
+all offsets and indices stay valid and the buffers structs can point straight into the file.
+The string buffers of all plug-ins of a context are stored back to back in the string table
+and each plug-in only remembers where its own starts.
+All data is 8-byte aligned and stored in the native byte order.
+*/
+
+
+#define UDT_ANALYSIS_DATA_FILE_MAGIC      0x46444155 // "UADF"
+#define UDT_ANALYSIS_DATA_FILE_VERSION    1
+#define UDT_ANALYSIS_DATA_FILE_ALIGNMENT  8
+
+
+struct udtAnalysisDataFileHeader
+{
+	u32 Magic;
+	u32 Version;
+	u32 ContextCount;
+	u32 DemoCount;
+	u32 PlugInCount;
+	u32 ColumnCount;
+	u32 StringTableOffset;
+	u32 StringTableByteCount;
+};
+
+struct udtAnalysisDataFileContext
+{
+	u32 FirstDemoIndex;
+	u32 DemoCount;
+	u32 FirstPlugInIndex;
+	u32 PlugInCount;
+};
+
+struct udtAnalysisDataFileDemo
+{
+	u32 InputIndex;
+	u32 FilePathOffset; // Into the string table.
+	u32 FilePathLength; // Not including the terminating null byte.
+	u32 Reserved;
+};
+
+struct udtAnalysisDataFilePlugIn
+{
+	u32 PlugInId;
+	u32 RangesOffset; // The context's demo count is the range count.
+	u32 StringBufferOffset; // Into the string table.
+	u32 StringBufferSize;
+	u32 FirstColumnIndex;
+	u32 ColumnCount;
+};
+
+struct udtAnalysisDataFileColumn
+{
+	u32 ColumnId; // udtAnalysisDataColumn::Id
+	u32 ElementSize; // Must match the reader's element type.
+	u32 ElementCount;
+	u32 Offset;
+};
+
+struct udtAnalysisDataFileChunk
+{
+	const void* Data;
+	u32 ByteCount;
+	u32 Offset;
+};
+
+
+static u32 AlignOffset(u32 offset)
+{
+	return (offset + (UDT_ANALYSIS_DATA_FILE_ALIGNMENT - 1)) & ~(u32)(UDT_ANALYSIS_DATA_FILE_ALIGNMENT - 1);
+}
+
+static void AddChunk(udtVMArray<udtAnalysisDataFileChunk>& chunks, const void* data, u32 byteCount)
+{
+	udtAnalysisDataFileChunk chunk;
+	chunk.Data = data;
+	chunk.ByteCount = byteCount;
+	chunk.Offset = 0;
+	chunks.Add(chunk);
+}
+
+static void AddColumn(udtVMArray<udtAnalysisDataFileColumn>& columns, udtVMArray<udtAnalysisDataFileChunk>& chunks, udtAnalysisDataColumn::Id columnId, const void* data, u32 elementSize, u32 elementCount)
+{
+	udtAnalysisDataFileColumn column;
+	column.ColumnId = (u32)columnId;
+	column.ElementSize = elementSize;
+	column.ElementCount = elementCount;
+	column.Offset = chunks.GetSize(); // Fixed up once the layout is known.
+	columns.Add(column);
+	AddChunk(chunks, data, elementSize * elementCount);
+}
+
+static void AddPlugInColumns(udtVMArray<udtAnalysisDataFileColumn>& columns, udtVMArray<udtAnalysisDataFileChunk>& chunks, udtParserPlugIn::Id plugInId, const udtAnalysisDataBuffers& buffers)
+{
+#define UDT_ANALYSIS_DATA_COLUMN_ITEM(PlugIn, Field, CountField, CountScale, Type) \
+	if(plugInId == udtParserPlugIn::PlugIn) \
+	{ \
+		AddColumn(columns, chunks, udtAnalysisDataColumn::PlugIn##Field, buffers.PlugIn.Field, (u32)sizeof(Type), buffers.PlugIn.CountField * CountScale); \
+	}
+	UDT_ANALYSIS_DATA_COLUMN_LIST(UDT_ANALYSIS_DATA_COLUMN_ITEM)
+#undef UDT_ANALYSIS_DATA_COLUMN_ITEM
+}
+
+static void GetPlugInStringBuffer(const u8*& stringBuffer, u32& stringBufferSize, udtParserPlugIn::Id plugInId, const udtAnalysisDataBuffers& buffers)
+{
+	stringBuffer = NULL;
+	stringBufferSize = 0;
+#define UDT_ANALYSIS_DATA_RANGES_ITEM(PlugIn, RangesField) \
+	if(plugInId == udtParserPlugIn::PlugIn) \
+	{ \
+		stringBuffer = buffers.PlugIn.StringBuffer; \
+		stringBufferSize = buffers.PlugIn.StringBufferSize; \
+	}
+	UDT_ANALYSIS_DATA_RANGES_LIST(UDT_ANALYSIS_DATA_RANGES_ITEM)
+#undef UDT_ANALYSIS_DATA_RANGES_ITEM
+}
+
+static bool WriteChunk(udtFileStream& file, u32& fileOffset, const void* data, u32 byteCount, u32 offset)
+{
+	static const u8 zeroes[UDT_ANALYSIS_DATA_FILE_ALIGNMENT] = { 0 };
+
+	assert(offset >= fileOffset && offset - fileOffset < UDT_ANALYSIS_DATA_FILE_ALIGNMENT);
+	if(offset > fileOffset && file.Write(zeroes, offset - fileOffset, 1) != 1)
+	{
+		return false;
+	}
+
+	if(byteCount > 0 && file.Write(data, byteCount, 1) != 1)
+	{
+		return false;
+	}
+
+	fileOffset = offset + byteCount;
+
+	return true;
+}
+
+bool ExportPlugInsDataToBinary(udtParserContext* contexts, u32 contextCount, const char** demoFilePaths, const char* filePath)
+{
+	udtVMArray<udtAnalysisDataFileContext> fileContexts("ExportPlugInsDataToBinary::ContextsArray");
+	udtVMArray<udtAnalysisDataFileDemo> fileDemos("ExportPlugInsDataToBinary::DemosArray");
+	udtVMArray<udtAnalysisDataFilePlugIn> filePlugIns("ExportPlugInsDataToBinary::PlugInsArray");
+	udtVMArray<udtAnalysisDataFileColumn> fileColumns("ExportPlugInsDataToBinary::ColumnsArray");
+	udtVMArray<udtAnalysisDataFileChunk> dataChunks("ExportPlugInsDataToBinary::DataChunksArray");
+	udtVMArray<udtAnalysisDataFileChunk> stringChunks("ExportPlugInsDataToBinary::StringChunksArray");
+	udtVMArray<udtParseDataBufferRange> paddedRanges("ExportPlugInsDataToBinary::PaddedRangesArray");
+	udtVMArray<u32> rangeChunkIndices("ExportPlugInsDataToBinary::RangeChunkIndicesArray");
+
+	// Demos that failed before their analysis finished have no range.
+	// We give them empty ranges so that every plug-in has one range per demo.
+	// The ranges are copied first to keep the addresses stable.
+	u32 paddedRangeCount = 0;
+	for(u32 c = 0; c < contextCount; ++c)
+	{
+		udtParserContext& context = contexts[c];
+		const u32 demoCount = udt_min(context.GetDemoCount(), context.InputIndices.GetSize());
+		for(u32 p = 0, plugInCount = context.PlugIns.GetSize(); p < plugInCount; ++p)
+		{
+			if((u32)context.PlugIns[p].Id < (u32)udtParserPlugIn::Count)
+			{
+				paddedRangeCount += demoCount;
+			}
+		}
+	}
+	paddedRanges.Resize(paddedRangeCount);
+
+	u32 stringTableByteCount = 0;
+	u32 nextRangeIndex = 0;
+	for(u32 c = 0; c < contextCount; ++c)
+	{
+		udtParserContext& context = contexts[c];
+		const u32 demoCount = udt_min(context.GetDemoCount(), context.InputIndices.GetSize());
+
+		udtAnalysisDataFileContext fileContext;
+		fileContext.FirstDemoIndex = fileDemos.GetSize();
+		fileContext.DemoCount = demoCount;
+		fileContext.FirstPlugInIndex = filePlugIns.GetSize();
+		fileContext.PlugInCount = 0;
+
+		for(u32 d = 0; d < demoCount; ++d)
+		{
+			const char* const demoFilePath = demoFilePaths[context.InputIndices[d]];
+			const u32 pathLength = (u32)strlen(demoFilePath);
+
+			udtAnalysisDataFileDemo demo;
+			demo.InputIndex = context.InputIndices[d];
+			demo.FilePathOffset = stringTableByteCount;
+			demo.FilePathLength = pathLength;
+			demo.Reserved = 0;
+			fileDemos.Add(demo);
+
+			AddChunk(stringChunks, demoFilePath, pathLength + 1);
+			stringTableByteCount += pathLength + 1;
+		}
+
+		for(u32 p = 0, plugInCount = context.PlugIns.GetSize(); p < plugInCount; ++p)
+		{
+			const udtParserPlugIn::Id plugInId = context.PlugIns[p].Id;
+			if((u32)plugInId >= (u32)udtParserPlugIn::Count)
+			{
+				continue;
+			}
+
+			udtAnalysisDataBuffers buffers;
+			memset(&buffers, 0, sizeof(buffers));
+			context.CopyBuffersStruct((u32)plugInId, &buffers);
+
+			const udtBaseParserPlugIn* const plugIn = context.PlugIns[p].PlugIn;
+			const u32 validRangeCount = udt_min(plugIn->GetBufferRangeCount(), demoCount);
+			const u32 itemCount = plugIn->GetItemCount();
+			const udtParseDataBufferRange* ranges = NULL;
+#define UDT_ANALYSIS_DATA_RANGES_ITEM(PlugIn, RangesField) \
+			if(plugInId == udtParserPlugIn::PlugIn) \
+			{ \
+				ranges = buffers.PlugIn.RangesField; \
+			}
+			UDT_ANALYSIS_DATA_RANGES_LIST(UDT_ANALYSIS_DATA_RANGES_ITEM)
+#undef UDT_ANALYSIS_DATA_RANGES_ITEM
+
+			udtParseDataBufferRange* const fileRanges = paddedRanges.GetStartAddress() + nextRangeIndex;
+			if(validRangeCount > 0)
+			{
+				memcpy(fileRanges, ranges, (size_t)validRangeCount * sizeof(udtParseDataBufferRange));
+			}
+			for(u32 r = validRangeCount; r < demoCount; ++r)
+			{
+				fileRanges[r].FirstIndex = itemCount;
+				fileRanges[r].Count = 0;
+			}
+			nextRangeIndex += demoCount;
+
+			const u8* stringBuffer;
+			u32 stringBufferSize;
+			GetPlugInStringBuffer(stringBuffer, stringBufferSize, plugInId, buffers);
+
+			udtAnalysisDataFilePlugIn filePlugIn;
+			filePlugIn.PlugInId = (u32)plugInId;
+			filePlugIn.RangesOffset = 0;
+			filePlugIn.StringBufferOffset = stringTableByteCount;
+			filePlugIn.StringBufferSize = stringBufferSize;
+			filePlugIn.FirstColumnIndex = fileColumns.GetSize();
+
+			rangeChunkIndices.Add(dataChunks.GetSize());
+			AddChunk(dataChunks, fileRanges, demoCount * (u32)sizeof(udtParseDataBufferRange));
+			AddPlugInColumns(fileColumns, dataChunks, plugInId, buffers);
+			filePlugIn.ColumnCount = fileColumns.GetSize() - filePlugIn.FirstColumnIndex;
+			filePlugIns.Add(filePlugIn);
+
+			AddChunk(stringChunks, stringBuffer, stringBufferSize);
+			stringTableByteCount += stringBufferSize;
+			++fileContext.PlugInCount;
+		}
+
+		fileContexts.Add(fileContext);
+	}
+
+	// Compute the layout.
+	u32 offset =
+		(u32)sizeof(udtAnalysisDataFileHeader) +
+		fileContexts.GetSize() * (u32)sizeof(udtAnalysisDataFileContext) +
+		fileDemos.GetSize() * (u32)sizeof(udtAnalysisDataFileDemo) +
+		filePlugIns.GetSize() * (u32)sizeof(udtAnalysisDataFilePlugIn) +
+		fileColumns.GetSize() * (u32)sizeof(udtAnalysisDataFileColumn);
+	for(u32 i = 0, count = dataChunks.GetSize(); i < count; ++i)
+	{
+		udtAnalysisDataFileChunk& chunk = dataChunks[i];
+		offset = AlignOffset(offset);
+		chunk.Offset = offset;
+		offset += chunk.ByteCount;
+	}
+
+	for(u32 i = 0, count = filePlugIns.GetSize(); i < count; ++i)
+	{
+		filePlugIns[i].RangesOffset = dataChunks[rangeChunkIndices[i]].Offset;
+	}
+
+	for(u32 i = 0, count = fileColumns.GetSize(); i < count; ++i)
+	{
+		udtAnalysisDataFileColumn& column = fileColumns[i];
+		column.Offset = dataChunks[column.Offset].Offset;
+	}
+
+	udtAnalysisDataFileHeader header;
+	header.Magic = UDT_ANALYSIS_DATA_FILE_MAGIC;
+	header.Version = UDT_ANALYSIS_DATA_FILE_VERSION;
+	header.ContextCount = fileContexts.GetSize();
+	header.DemoCount = fileDemos.GetSize();
+	header.PlugInCount = filePlugIns.GetSize();
+	header.ColumnCount = fileColumns.GetSize();
+	header.StringTableOffset = AlignOffset(offset);
+	header.StringTableByteCount = stringTableByteCount;
+
+	udtFileStream file;
+	if(!file.Open(filePath, udtFileOpenMode::Write))
+	{
+		return false;
+	}
+
+	if(file.Write(&header, (u32)sizeof(header), 1) != 1 ||
+	   (!fileContexts.IsEmpty() && file.Write(fileContexts.GetStartAddress(), (u32)sizeof(udtAnalysisDataFileContext), fileContexts.GetSize()) != fileContexts.GetSize()) ||
+	   (!fileDemos.IsEmpty() && file.Write(fileDemos.GetStartAddress(), (u32)sizeof(udtAnalysisDataFileDemo), fileDemos.GetSize()) != fileDemos.GetSize()) ||
+	   (!filePlugIns.IsEmpty() && file.Write(filePlugIns.GetStartAddress(), (u32)sizeof(udtAnalysisDataFilePlugIn), filePlugIns.GetSize()) != filePlugIns.GetSize()) ||
+	   (!fileColumns.IsEmpty() && file.Write(fileColumns.GetStartAddress(), (u32)sizeof(udtAnalysisDataFileColumn), fileColumns.GetSize()) != fileColumns.GetSize()))
+	{
+		return false;
+	}
+
+	u32 fileOffset = (u32)file.Offset();
+	for(u32 i = 0, count = dataChunks.GetSize(); i < count; ++i)
+	{
+		const udtAnalysisDataFileChunk& chunk = dataChunks[i];
+		if(!WriteChunk(file, fileOffset, chunk.Data, chunk.ByteCount, chunk.Offset))
+		{
+			return false;
+		}
+	}
+
+	u32 stringOffset = header.StringTableOffset;
+	for(u32 i = 0, count = stringChunks.GetSize(); i < count; ++i)
+	{
+		const udtAnalysisDataFileChunk& chunk = stringChunks[i];
+		if(!WriteChunk(file, fileOffset, chunk.Data, chunk.ByteCount, stringOffset))
+		{
+			return false;
+		}
+		stringOffset += chunk.ByteCount;
+	}
+
+	return true;
+}
+
+
+udtAnalysisDataFile_s::udtAnalysisDataFile_s()
+{
+	_data = NULL;
+	_contexts = NULL;
+	_demos = NULL;
+	_plugIns = NULL;
+	_columns = NULL;
+	_stringTable = NULL;
+	_byteCount = 0;
+	_contextCount = 0;
+}
+
+udtAnalysisDataFile_s::~udtAnalysisDataFile_s()
+{
+}
+
+bool udtAnalysisDataFile_s::Load(const char* filePath)
+{
+	_data = NULL;
+	_byteCount = 0;
+	_contextCount = 0;
+	_fileData.Clear();
+
+#if defined(UDT_LINUX)
+	if(!_mappedFile.Open(filePath))
+	{
+		return false;
+	}
+
+	_byteCount = (u32)_mappedFile.Length();
+	_data = _mappedFile.ReadInPlace(_byteCount, 0);
+#else
+	udtFileStream file;
+	if(!file.Open(filePath, udtFileOpenMode::Read))
+	{
+		return false;
+	}
+
+	const u64 byteCount = file.Length();
+	if(byteCount > (u64)UDT_U32_MAX)
+	{
+		return false;
+	}
+
+	_byteCount = (u32)byteCount;
+	_fileData.Resize(_byteCount);
+	if(_byteCount > 0 && file.Read(_fileData.GetStartAddress(), _byteCount, 1) != 1)
+	{
+		return false;
+	}
+
+	_data = _fileData.GetStartAddress();
+#endif
+
+	if(_data == NULL || !Validate())
+	{
+		_data = NULL;
+		_byteCount = 0;
+		_contextCount = 0;
+		return false;
+	}
+
+	return true;
+}
+
+static bool IsValidFileRange(u64 offset, u64 byteCount, u64 fileByteCount)
+{
+	return offset + byteCount <= fileByteCount;
+}
+
+static bool IsValidColumn(u32 plugInId, const udtAnalysisDataFileColumn& column)
+{
+#define UDT_ANALYSIS_DATA_COLUMN_ITEM(PlugIn, Field, CountField, CountScale, Type) \
+	if(column.ColumnId == (u32)udtAnalysisDataColumn::PlugIn##Field) \
+	{ \
+		return \
+			plugInId == (u32)udtParserPlugIn::PlugIn && \
+			column.ElementSize == (u32)sizeof(Type) && \
+			column.ElementCount % CountScale == 0; \
+	}
+	UDT_ANALYSIS_DATA_COLUMN_LIST(UDT_ANALYSIS_DATA_COLUMN_ITEM)
+#undef UDT_ANALYSIS_DATA_COLUMN_ITEM
+
+	return false;
+}
+
+bool udtAnalysisDataFile_s::Validate()
+{
+	if(_byteCount < (u32)sizeof(udtAnalysisDataFileHeader))
+	{
+		return false;
+	}
+
+	const udtAnalysisDataFileHeader& header = *(const udtAnalysisDataFileHeader*)_data;
+	const u64 directoryByteCount =
+		(u64)sizeof(udtAnalysisDataFileHeader) +
+		(u64)header.ContextCount * (u64)sizeof(udtAnalysisDataFileContext) +
+		(u64)header.DemoCount * (u64)sizeof(udtAnalysisDataFileDemo) +
+		(u64)header.PlugInCount * (u64)sizeof(udtAnalysisDataFilePlugIn) +
+		(u64)header.ColumnCount * (u64)sizeof(udtAnalysisDataFileColumn);
+	if(header.Magic != UDT_ANALYSIS_DATA_FILE_MAGIC ||
+	   header.Version != UDT_ANALYSIS_DATA_FILE_VERSION ||
+	   !IsValidFileRange(0, directoryByteCount, _byteCount) ||
+	   !IsValidFileRange(header.StringTableOffset, header.StringTableByteCount, _byteCount))
+	{
+		return false;
+	}
+
+	const u8* data = _data + sizeof(udtAnalysisDataFileHeader);
+	_contexts = (const udtAnalysisDataFileContext*)data;
+	data += header.ContextCount * sizeof(udtAnalysisDataFileContext);
+	_demos = (const udtAnalysisDataFileDemo*)data;
+	data += header.DemoCount * sizeof(udtAnalysisDataFileDemo);
+	_plugIns = (const udtAnalysisDataFilePlugIn*)data;
+	data += header.PlugInCount * sizeof(udtAnalysisDataFilePlugIn);
+	_columns = (const udtAnalysisDataFileColumn*)data;
+	_stringTable = _data + header.StringTableOffset;
+
+	for(u32 i = 0; i < header.DemoCount; ++i)
+	{
+		const udtAnalysisDataFileDemo& demo = _demos[i];
+		if((u64)demo.FilePathOffset + (u64)demo.FilePathLength >= (u64)header.StringTableByteCount ||
+		   _stringTable[demo.FilePathOffset + demo.FilePathLength] != '\0')
+		{
+			return false;
+		}
+	}
+
+	for(u32 i = 0; i < header.ContextCount; ++i)
+	{
+		const udtAnalysisDataFileContext& context = _contexts[i];
+		if((u64)context.FirstDemoIndex + (u64)context.DemoCount > (u64)header.DemoCount ||
+		   (u64)context.FirstPlugInIndex + (u64)context.PlugInCount > (u64)header.PlugInCount)
+		{
+			return false;
+		}
+
+		for(u32 p = context.FirstPlugInIndex, plugInEnd = context.FirstPlugInIndex + context.PlugInCount; p < plugInEnd; ++p)
+		{
+			const udtAnalysisDataFilePlugIn& plugIn = _plugIns[p];
+			if(plugIn.PlugInId >= (u32)udtParserPlugIn::Count ||
+			   plugIn.RangesOffset % UDT_ANALYSIS_DATA_FILE_ALIGNMENT != 0 ||
+			   !IsValidFileRange(plugIn.RangesOffset, (u64)context.DemoCount * (u64)sizeof(udtParseDataBufferRange), _byteCount) ||
+			   !IsValidFileRange(plugIn.StringBufferOffset, plugIn.StringBufferSize, header.StringTableByteCount) ||
+			   (u64)plugIn.FirstColumnIndex + (u64)plugIn.ColumnCount > (u64)header.ColumnCount)
+			{
+				return false;
+			}
+
+			for(u32 c = plugIn.FirstColumnIndex, columnEnd = plugIn.FirstColumnIndex + plugIn.ColumnCount; c < columnEnd; ++c)
+			{
+				const udtAnalysisDataFileColumn& column = _columns[c];
+				if(!IsValidColumn(plugIn.PlugInId, column) ||
+				   column.Offset % UDT_ANALYSIS_DATA_FILE_ALIGNMENT != 0 ||
+				   !IsValidFileRange(column.Offset, (u64)column.ElementSize * (u64)column.ElementCount, _byteCount))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	_contextCount = header.ContextCount;
+
+	return true;
+}
+
+bool udtAnalysisDataFile_s::GetDemoCount(u32 contextIdx, u32& demoCount) const
+{
+	if(contextIdx >= _contextCount)
+	{
+		return false;
+	}
+
+	demoCount = _contexts[contextIdx].DemoCount;
+
+	return true;
+}
+
+bool udtAnalysisDataFile_s::GetDemoInfo(u32 contextIdx, u32 demoIdx, u32& demoInputIdx, const char*& demoFilePath) const
+{
+	if(contextIdx >= _contextCount ||
+	   demoIdx >= _contexts[contextIdx].DemoCount)
+	{
+		return false;
+	}
+
+	const udtAnalysisDataFileDemo& demo = _demos[_contexts[contextIdx].FirstDemoIndex + demoIdx];
+	demoInputIdx = demo.InputIndex;
+	demoFilePath = (const char*)(_stringTable + demo.FilePathOffset);
+
+	return true;
+}
+
+bool udtAnalysisDataFile_s::GetPlugInBuffers(u32 contextIdx, u32 plugInId, void* buffersStruct) const
+{
+	if(contextIdx >= _contextCount)
+	{
+		return false;
+	}
+
+	const udtAnalysisDataFileContext& context = _contexts[contextIdx];
+	const udtAnalysisDataFilePlugIn* plugIn = NULL;
+	for(u32 p = context.FirstPlugInIndex, plugInEnd = context.FirstPlugInIndex + context.PlugInCount; p < plugInEnd; ++p)
+	{
+		if(_plugIns[p].PlugInId == plugInId)
+		{
+			plugIn = &_plugIns[p];
+			break;
+		}
+	}
+
+	if(plugIn == NULL)
+	{
+		return false;
+	}
+
+	udtAnalysisDataBuffers buffers;
+	memset(&buffers, 0, sizeof(buffers));
+
+	const udtParseDataBufferRange* const ranges = (const udtParseDataBufferRange*)(_data + plugIn->RangesOffset);
+	const u8* const stringBuffer = _stringTable + plugIn->StringBufferOffset;
+	size_t buffersByteCount = 0;
+#define UDT_ANALYSIS_DATA_RANGES_ITEM(PlugIn, RangesField) \
+	if(plugInId == (u32)udtParserPlugIn::PlugIn) \
+	{ \
+		buffers.PlugIn.RangesField = ranges; \
+		buffers.PlugIn.StringBuffer = stringBuffer; \
+		buffers.PlugIn.StringBufferSize = plugIn->StringBufferSize; \
+		buffersByteCount = sizeof(buffers.PlugIn); \
+	}
+	UDT_ANALYSIS_DATA_RANGES_LIST(UDT_ANALYSIS_DATA_RANGES_ITEM)
+#undef UDT_ANALYSIS_DATA_RANGES_ITEM
+
+	for(u32 c = plugIn->FirstColumnIndex, columnEnd = plugIn->FirstColumnIndex + plugIn->ColumnCount; c < columnEnd; ++c)
+	{
+		const udtAnalysisDataFileColumn& column = _columns[c];
+		const u8* const columnData = _data + column.Offset;
+#define UDT_ANALYSIS_DATA_COLUMN_ITEM(PlugIn, Field, CountField, CountScale, Type) \
+		if(column.ColumnId == (u32)udtAnalysisDataColumn::PlugIn##Field) \
+		{ \
+			buffers.PlugIn.Field = (const Type*)columnData; \
+			buffers.PlugIn.CountField = column.ElementCount / CountScale; \
+		}
+		UDT_ANALYSIS_DATA_COLUMN_LIST(UDT_ANALYSIS_DATA_COLUMN_ITEM)
+#undef UDT_ANALYSIS_DATA_COLUMN_ITEM
+	}
+
+	memcpy(buffersStruct, &buffers, buffersByteCount);
+
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+
+#include "parser_context.hpp"
+#include "array.hpp"
+#include "mapped_file_stream.hpp"
+
+
+// N(PlugIn, ArrayField, CountField, CountScale, ElementType)
+#define UDT_ANALYSIS_DATA_COLUMN_LIST(N) \
+	N(Chat,             ChatMessages,            ChatMessageCount,   1, udtParseDataChat) \
+	N(GameState,        GameStates,              GameStateCount,     1, udtParseDataGameState) \
+	N(GameState,        Matches,                 MatchCount,         1, udtMatchInfo) \
+	N(GameState,        KeyValuePairs,           KeyValuePairCount,  1, udtGameStateKeyValuePair) \
+	N(GameState,        Players,                 PlayerCount,        1, udtGameStatePlayerInfo) \
+	N(Obituaries,       Obituaries,              ObituaryCount,      1, udtParseDataObituary) \
+	N(Stats,            MatchStats,              MatchCount,         1, udtParseDataStats) \
+	N(Stats,            TimeOutStartAndEndTimes, TimeOutRangeCount,  2, s32) \
+	N(Stats,            TeamFlags,               TeamFlagCount,      1, u8) \
+	N(Stats,            PlayerFlags,             PlayerFlagCount,    1, u8) \
+	N(Stats,            TeamFields,              TeamFieldCount,     1, s32) \
+	N(Stats,            PlayerFields,            PlayerFieldCount,   1, s32) \
+	N(Stats,            PlayerStats,             PlayerStatsCount,   1, udtPlayerStats) \
+	N(RawCommands,      Commands,                CommandCount,       1, udtParseDataRawCommand) \
+	N(RawConfigStrings, ConfigStrings,           ConfigStringCount,  1, udtParseDataRawConfigString) \
+	N(Captures,         Captures,                CaptureCount,       1, udtParseDataCapture) \
+	N(Scores,           Scores,                  ScoreCount,         1, udtParseDataScore)
+
+// N(PlugIn, RangesField)
+#define UDT_ANALYSIS_DATA_RANGES_LIST(N) \
+	N(Chat,             ChatMessageRanges) \
+	N(GameState,        GameStateRanges) \
+	N(Obituaries,       ObituaryRanges) \
+	N(Stats,            MatchStatsRanges) \
+	N(RawCommands,      CommandRanges) \
+	N(RawConfigStrings, ConfigStringRanges) \
+	N(Captures,         CaptureRanges) \
+	N(Scores,           ScoreRanges)
+
+#define UDT_ANALYSIS_DATA_COLUMN_ITEM(PlugIn, Field, CountField, CountScale, Type) PlugIn##Field,
+struct udtAnalysisDataColumn
+{
+	enum Id
+	{
+		UDT_ANALYSIS_DATA_COLUMN_LIST(UDT_ANALYSIS_DATA_COLUMN_ITEM)
+		Count
+	};
+};
+#undef UDT_ANALYSIS_DATA_COLUMN_ITEM
+
+
+// Writes the data of all the selected plug-ins of all contexts to a single file.
+// demoFilePaths is indexed by the input indices stored in the contexts.
+extern bool ExportPlugInsDataToBinary(udtParserContext* contexts, u32 contextCount, const char** demoFilePaths, const char* filePath);
+
+struct udtAnalysisDataFileContext;
+struct udtAnalysisDataFileDemo;
+struct udtAnalysisDataFilePlugIn;
+struct udtAnalysisDataFileColumn;
+
+// Read-only view of a file written by ExportPlugInsDataToBinary.
+// The buffer structs point directly into the file's data.
+struct udtAnalysisDataFile_s
+{
+public:
+	udtAnalysisDataFile_s();
+	~udtAnalysisDataFile_s();
+
+	bool Load(const char* filePath); // Validates the whole file once so that the getters don't have to.
+	u32  GetContextCount() const { return _contextCount; }
+	bool GetDemoCount(u32 contextIdx, u32& demoCount) const;
+	bool GetDemoInfo(u32 contextIdx, u32 demoIdx, u32& demoInputIdx, const char*& demoFilePath) const;
+	bool GetPlugInBuffers(u32 contextIdx, u32 plugInId, void* buffersStruct) const;
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtAnalysisDataFile_s);
+
+	bool Validate();
+
+#if defined(UDT_LINUX)
+	udtMappedFileStream _mappedFile;
+#endif
+	udtVMArray<u8> _fileData { "AnalysisDataFile::FileDataArray" }; // Only used when the file isn't memory-mapped.
+	const u8* _data;
+	const udtAnalysisDataFileContext* _contexts;
+	const udtAnalysisDataFileDemo* _demos;
+	const udtAnalysisDataFilePlugIn* _plugIns;
+	const udtAnalysisDataFileColumn* _columns;
+	const u8* _stringTable;
+	u32 _byteCount;
+	u32 _contextCount;
+};
@@ -70,6 +70,8 @@ void udtGeneralAnalyzer::InitAllocators(udtVMLinearAllocator& tempAllocator, u32
 
 void udtGeneralAnalyzer::ResetForNextDemo()
 {
+	// The strings must outlive game states and matches since the mod version is only read once.
+	_stringAllocator.Clear();
 	_modVersion = udtString::NewNull();
 	_mapName = udtString::NewNull();
 	_gameStateIndex = -1;
@@ -141,8 +143,10 @@ void udtGeneralAnalyzer::ProcessGamestateMessage(const udtGamestateCallbackArg&
 		}
 		else
 		{
-			ProcessQ3ServerInfoConfigStringOnce(parser._inConfigStrings[CS_SERVERINFO].GetPtr());
-			ProcessModNameAndVersionOnce();
+			// Demo segments always use the demo's first game state, see ParseDemoFileSegment.
+			const char* const serverInfo = parser.ContinuesDemo ? parser.FirstServerInfo.GetPtr() : parser._inConfigStrings[CS_SERVERINFO].GetPtr();
+			ProcessQ3ServerInfoConfigStringOnce(serverInfo);
+			ProcessModNameAndVersionOnce(serverInfo);
 		}
 	}
 	else
@@ -367,11 +371,6 @@ void udtGeneralAnalyzer::ProcessCommandMessage(const udtCommandCallbackArg& /*ar
 	}
 }
 
-void udtGeneralAnalyzer::ClearStringAllocator()
-{
-	_stringAllocator.Clear();
-}
-
 void udtGeneralAnalyzer::SetIntermissionEndTime()
 {
 	_intermissionEndTime = _parser->_inServerTime;
@@ -976,10 +975,9 @@ void udtGeneralAnalyzer::ProcessQLPauseEndConfigString(const char* configString)
 	}
 }
 
-void udtGeneralAnalyzer::ProcessModNameAndVersionOnce()
+void udtGeneralAnalyzer::ProcessModNameAndVersionOnce(const char* serverInfo)
 {
 	udtVMScopedStackAllocator scopedTempAllocator(*_tempAllocator);
-	const char* const serverInfo = _parser->_inConfigStrings[CS_SERVERINFO].GetPtr();
 
 	u32 charIndex = 0;
 	udtString varValue;
@@ -18,7 +18,6 @@ public:
 	void ProcessGamestateMessage(const udtGamestateCallbackArg& arg, udtBaseParser& parser);
 	void ProcessCommandMessage(const udtCommandCallbackArg& arg, udtBaseParser& parser);
 
-	void ClearStringAllocator();
 	void SetIntermissionEndTime();
 	void ResetForNextMatch();
 	bool HasMatchJustStarted() const;
@@ -83,7 +82,7 @@ private:
 
 	// Functions with the "Once" suffix only need to be called from ProcessGamestateMessage.
 	void UpdateGameState(udtGameState::Id gameState);
-	void ProcessModNameAndVersionOnce();
+	void ProcessModNameAndVersionOnce(const char* serverInfo);
 	void ProcessMapNameOnce();
 	void ProcessQ3ServerInfoConfigStringOnce(const char* configString);
 	void ProcessCPMAGameInfoConfigString(const char* configString);
@@ -110,7 +109,7 @@ private:
 	udtVMLinearAllocator _stringAllocator { "GeneralAnalyzer::Strings" };
 	udtBaseParser* _parser;
 	udtVMLinearAllocator* _tempAllocator;
-	udtString _modVersion; // Allocated by _stringAllocator.
+	udtString _modVersion; // Allocated by _stringAllocator, only read from the first game state.
 	udtString _mapName;    // Allocated by _stringAllocator.
 	s32 _gameStateIndex;
 	s32 _matchStartTime;
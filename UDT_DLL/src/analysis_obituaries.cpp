@@ -47,6 +47,7 @@ void udtObituariesAnalyzer::ProcessSnapshotMessage(const udtSnapshotCallbackArg&
 		info.ServerTimeMs = arg.Snapshot->serverTime;
 		info.TargetIdx = eventInfo.TargetIndex;
 		info.AttackerIdx = eventInfo.AttackerIndex;
+		info.Reserved1 = 0;
 		WriteStringToApiStruct(info.TargetName, targetName);
 		WriteStringToApiStruct(info.AttackerName, attackerName);
 		WriteStringToApiStruct(info.MeanOfDeathName, modName);
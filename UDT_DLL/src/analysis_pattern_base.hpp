@@ -22,6 +22,10 @@ public:
 	virtual void ProcessSnapshotMessage(const udtSnapshotCallbackArg& /*arg*/, udtBaseParser& /*parser*/) {}
 	virtual void ProcessCommandMessage(const udtCommandCallbackArg& /*arg*/, udtBaseParser& /*parser*/) {}
 
+	// For single-pass cutting, see udtPatternSearchArgMask::SinglePass.
+	virtual bool AddsCutSectionsLive() const { return false; } // Sections are added to CutSections as soon as they're found, not when finishing.
+	virtual s32  GetPendingMatchTimeMs() const { return UDT_S32_MAX; } // Server time of the first match of the section being built, if any.
+
 	udtVMArray<udtCutSection> CutSections { "PatternSearchAnalyzerBase::CutSectionsArray" };
 
 protected:
@@ -105,7 +105,7 @@ void udtChatPatternAnalyzer::ProcessCommandMessage(const udtCommandCallbackArg&
 	cutSection.StartTimeMs = startTimeMs;
 	cutSection.EndTimeMs = endTimeMs;
 	cutSection.PatternTypes = UDT_BIT((u32)udtPatternType::Chat);
-	_cutSections.Add(cutSection);
+	CutSections.Add(cutSection);
 }
 
 void udtChatPatternAnalyzer::StartAnalysis()
@@ -115,5 +115,11 @@ void udtChatPatternAnalyzer::StartAnalysis()
 
 void udtChatPatternAnalyzer::FinishAnalysis()
 {
+	_cutSections.Clear();
+	for(u32 i = 0, count = CutSections.GetSize(); i < count; ++i)
+	{
+		_cutSections.Add(CutSections[i]);
+	}
+
 	MergeRanges(CutSections, _cutSections);
 }
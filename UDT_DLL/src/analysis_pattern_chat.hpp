@@ -17,9 +17,10 @@ public:
 	void StartAnalysis() override;
 	void FinishAnalysis() override;
 	void ProcessCommandMessage(const udtCommandCallbackArg& info, udtBaseParser& parser) override;
+	bool AddsCutSectionsLive() const override { return true; }
 
 private:
 	UDT_NO_COPY_SEMANTICS(udtChatPatternAnalyzer);
 
-	udtVMArray<udtCutSection> _cutSections { "CutByChatAnalyzer::CutSections" }; // Local copy, write back to the final array as merged.
+	udtVMArray<udtCutSection> _cutSections { "CutByChatAnalyzer::CutSections" }; // Copy of the sections found, merged back into the final array.
 };
@@ -13,6 +13,7 @@ public:
 	void StartAnalysis() override;
 	void ProcessGamestateMessage(const udtGamestateCallbackArg& arg, udtBaseParser& parser) override;
 	void ProcessSnapshotMessage(const udtSnapshotCallbackArg& arg, udtBaseParser& parser) override;
+	bool AddsCutSectionsLive() const override { return true; }
 
 private:
 	UDT_NO_COPY_SEMANTICS(udtFlickRailPatternAnalyzer);
@@ -68,6 +68,8 @@ udtFragRunPatternAnalyzer::~udtFragRunPatternAnalyzer()
 
 void udtFragRunPatternAnalyzer::ProcessGamestateMessage(const udtGamestateCallbackArg& arg, udtBaseParser& parser)
 {
+	// A sequence never spans multiple game states.
+	AddCurrentSectionIfValid();
 	_analyzer.ProcessGamestateMessage(arg, parser);
 }
 
@@ -80,11 +82,6 @@ void udtFragRunPatternAnalyzer::ProcessSnapshotMessage(const udtSnapshotCallback
 {
 	_analyzer.ProcessSnapshotMessage(arg, parser);
 	const u32 obituaryCount = _analyzer.Obituaries.GetSize();
-	if(obituaryCount == 0)
-	{
-		return;
-	}
-
 	const udtFragRunPatternArg& extraInfo = GetExtraInfo<udtFragRunPatternArg>();
 	const s32 maxIntervalMs = extraInfo.TimeBetweenFragsSec * 1000;
 	const s32 playerIndex = PlugIn->GetTrackedPlayerIndex();
@@ -151,6 +148,17 @@ void udtFragRunPatternAnalyzer::ProcessSnapshotMessage(const udtSnapshotCallback
 	}
 
 	_analyzer.Obituaries.Clear();
+
+	// No later frag can extend the sequence, so we add it now instead of at the next frag.
+	if(!_frags.IsEmpty() && arg.ServerTime > _frags[_frags.GetSize() - 1].ServerTimeMs + maxIntervalMs)
+	{
+		AddCurrentSectionIfValid();
+	}
+}
+
+s32 udtFragRunPatternAnalyzer::GetPendingMatchTimeMs() const
+{
+	return _frags.IsEmpty() ? UDT_S32_MAX : _frags[0].ServerTimeMs;
 }
 
 void udtFragRunPatternAnalyzer::InitAllocators(u32 demoCount)
@@ -17,6 +17,8 @@ public:
 	void ProcessGamestateMessage(const udtGamestateCallbackArg& arg, udtBaseParser& parser) override;
 	void ProcessCommandMessage(const udtCommandCallbackArg& arg, udtBaseParser& parser) override;
 	void ProcessSnapshotMessage(const udtSnapshotCallbackArg& arg, udtBaseParser& parser) override;
+	bool AddsCutSectionsLive() const override { return true; }
+	s32  GetPendingMatchTimeMs() const override;
 
 private:
 	UDT_NO_COPY_SEMANTICS(udtFragRunPatternAnalyzer);
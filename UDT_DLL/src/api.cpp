@@ -15,6 +15,10 @@
 #include "system.hpp"
 #include "custom_context.hpp"
 #include "pattern_search_context.hpp"
+#include "probe_context.hpp"
+#include "plug_in_probe.hpp"
+#include "demo_index.hpp"
+#include "analysis_data_file.hpp"
 
 // For malloc and free.
 #include <stdlib.h>
@@ -549,6 +553,20 @@ UDT_API(s32) udtGetStatsConstants(u32* playerMaskByteCount, u32* teamMaskByteCou
 	return (s32)udtErrorCode::None;
 }
 
+static void AddParserProfilePerfStats(u64* destPerfStats, const u64* sourcePerfStats)
+{
+	destPerfStats[udtPerfStatsField::MessageCount] += sourcePerfStats[udtPerfStatsField::MessageCount];
+	destPerfStats[udtPerfStatsField::SnapshotCount] += sourcePerfStats[udtPerfStatsField::SnapshotCount];
+	destPerfStats[udtPerfStatsField::CachedDemoCount] += sourcePerfStats[udtPerfStatsField::CachedDemoCount];
+	destPerfStats[udtPerfStatsField::SkippedByteCount] += sourcePerfStats[udtPerfStatsField::SkippedByteCount];
+	destPerfStats[udtPerfStatsField::FileReadDuration] += sourcePerfStats[udtPerfStatsField::FileReadDuration];
+	destPerfStats[udtPerfStatsField::MessageParseDuration] += sourcePerfStats[udtPerfStatsField::MessageParseDuration];
+	destPerfStats[udtPerfStatsField::SnapshotParseDuration] += sourcePerfStats[udtPerfStatsField::SnapshotParseDuration];
+	destPerfStats[udtPerfStatsField::EntityParseDuration] += sourcePerfStats[udtPerfStatsField::EntityParseDuration];
+	destPerfStats[udtPerfStatsField::PlugInDuration] += sourcePerfStats[udtPerfStatsField::PlugInDuration];
+	destPerfStats[udtPerfStatsField::OutputWriteDuration] += sourcePerfStats[udtPerfStatsField::OutputWriteDuration];
+}
+
 UDT_API(s32) udtMergeBatchPerfStats(u64* destPerfStats, const u64* sourcePerfStats)
 {
 	if(destPerfStats == NULL || sourcePerfStats == NULL)
@@ -573,6 +591,10 @@ UDT_API(s32) udtMergeBatchPerfStats(u64* destPerfStats, const u64* sourcePerfSta
 	}
 
 	destPerfStats[udtPerfStatsField::ResizeCount] += sourcePerfStats[udtPerfStatsField::ResizeCount];
+	destPerfStats[udtPerfStatsField::CutCount] += sourcePerfStats[udtPerfStatsField::CutCount];
+	destPerfStats[udtPerfStatsField::CutThroughput] = (destPerfStats[udtPerfStatsField::Duration] > 0) ?
+		((10000000 * destPerfStats[udtPerfStatsField::CutCount]) / destPerfStats[udtPerfStatsField::Duration]) : 0;
+	AddParserProfilePerfStats(destPerfStats, sourcePerfStats);
 
 	return (s32)udtErrorCode::None;
 }
@@ -592,10 +614,14 @@ UDT_API(s32) udtAddThreadPerfStats(u64* destPerfStats, const u64* sourcePerfStat
 	destPerfStats[udtPerfStatsField::MemoryCommitted] += sourcePerfStats[udtPerfStatsField::MemoryCommitted];
 	destPerfStats[udtPerfStatsField::MemoryUsed] += sourcePerfStats[udtPerfStatsField::MemoryUsed];
 	destPerfStats[udtPerfStatsField::ResizeCount] += sourcePerfStats[udtPerfStatsField::ResizeCount];
+	destPerfStats[udtPerfStatsField::CutCount] += sourcePerfStats[udtPerfStatsField::CutCount];
 	destPerfStats[udtPerfStatsField::DataThroughput] = (destPerfStats[udtPerfStatsField::Duration] > 0) ?
 		((1000000 * destPerfStats[udtPerfStatsField::DataProcessed]) / destPerfStats[udtPerfStatsField::Duration]) : 0;
+	destPerfStats[udtPerfStatsField::CutThroughput] = (destPerfStats[udtPerfStatsField::Duration] > 0) ?
+		((10000000 * destPerfStats[udtPerfStatsField::CutCount]) / destPerfStats[udtPerfStatsField::Duration]) : 0;
 	destPerfStats[udtPerfStatsField::MemoryEfficiency] = (destPerfStats[udtPerfStatsField::MemoryCommitted] > 0) ?
 		((1000 * destPerfStats[udtPerfStatsField::MemoryUsed]) / destPerfStats[udtPerfStatsField::MemoryCommitted]) : 0;
+	AddParserProfilePerfStats(destPerfStats, sourcePerfStats);
 
 	return (s32)udtErrorCode::None;
 }
@@ -622,6 +648,7 @@ UDT_API(s32) udtInitLibrary()
 {
 	udtThreadLocalAllocators::Init();
 	BuildLookUpTables();
+	BuildHuffmanTables();
 
 	return (s32)udtErrorCode::None;
 }
@@ -838,7 +865,27 @@ UDT_API(s32) udtCutDemoFileByTime(udtParserContext* context, const udtParseArg*
 		return (s32)udtErrorCode::OperationFailed;
 	}
 
-	if(info->FileOffset > 0 && file.Seek((s32)info->FileOffset, udtSeekOrigin::Start) != 0)
+	// Start from the last keyframe before the first cut if the demo was indexed.
+	udtDemoIndex demoIndex;
+	s32 keyframeIndex = -1;
+	if((info->Flags & (u32)udtParseArgFlag::UseDemoIndex) != 0 &&
+	   demoIndex.Load(demoFilePath, protocol))
+	{
+		s32 startTimeMs = UDT_S32_MAX;
+		for(u32 i = 0; i < cutInfo->CutCount; ++i)
+		{
+			const udtCut& cut = cutInfo->Cuts[i];
+			if(cut.StartTimeMs < cut.EndTimeMs)
+			{
+				startTimeMs = udt_min(startTimeMs, cut.StartTimeMs);
+			}
+		}
+
+		keyframeIndex = demoIndex.FindStartKeyframe(info->GameStateIndex, startTimeMs, info->FileOffset);
+	}
+
+	const u32 fileOffset = keyframeIndex >= 0 ? demoIndex.Keyframes[keyframeIndex].FileOffset : info->FileOffset;
+	if(fileOffset > 0 && file.Seek((s32)fileOffset, udtSeekOrigin::Start) != 0)
 	{
 		return (s32)udtErrorCode::OperationFailed;
 	}
@@ -848,6 +895,11 @@ UDT_API(s32) udtCutDemoFileByTime(udtParserContext* context, const udtParseArg*
 		return (s32)udtErrorCode::OperationFailed;
 	}
 
+	if(keyframeIndex >= 0 && !demoIndex.RestoreKeyframe(context->Parser, (u32)keyframeIndex))
+	{
+		return (s32)udtErrorCode::OperationFailed;
+	}
+
 	CallbackCutDemoFileStreamCreationInfo streamInfo;
 	streamInfo.OutputFolderPath = info->OutputFolderPath;
 
@@ -887,8 +939,6 @@ UDT_API(s32) udtMergeDemoFiles(const udtParseArg* info, const char** filePaths,
 		return (s32)udtErrorCode::InvalidArgument;
 	}
 
-	fileCount = udt_min(fileCount, (u32)UDT_MAX_MERGE_DEMO_COUNT);
-
 	for(u32 i = 0; i < fileCount; ++i)
 	{
 		if(filePaths[i] == NULL)
@@ -1023,7 +1073,7 @@ static s32 RunJobWithLocalContextGroup(udtParsingJobType::Id jobType, const udtP
 	jobTimer.Start();
 
 	udtDemoThreadAllocator threadAllocator;
-	const bool threadJob = threadAllocator.Process(extraInfo->FilePaths, extraInfo->FileCount, extraInfo->MaxThreadCount);
+	const bool threadJob = threadAllocator.Process(*extraInfo);
 	if(!threadJob)
 	{
 		return udtParseMultipleDemosSingleThread(jobType, NULL, info, extraInfo, jobSpecificArg);
@@ -1055,6 +1105,34 @@ UDT_API(s32) udtDestroyContextGroup(udtParserContextGroup* contextGroup)
 	return (s32)udtErrorCode::None;
 }
 
+static s32 ParseDemoFileByGameStates(udtTimer& jobTimer, udtParserContextGroup** contextGroup, const udtParseArg* info, const udtMultiParseArg* extraInfo)
+{
+	if(!CreateContextGroup(contextGroup, 1))
+	{
+		return (s32)udtErrorCode::OperationFailed;
+	}
+
+	udtParserContext* const outputContext = (*contextGroup)->Contexts;
+	udtDemoSegmentAllocator segmentAllocator;
+	if(!segmentAllocator.Process(*outputContext, *info, *extraInfo))
+	{
+		return udtParseMultipleDemosSingleThread(udtParsingJobType::General, outputContext, info, extraInfo, NULL);
+	}
+
+	// The extra contexts only live until their plug-in data has been appended to the output context.
+	udtParserContextGroup* segmentGroup = NULL;
+	if(!CreateContextGroup(&segmentGroup, segmentAllocator.Segments.GetSize() - 1))
+	{
+		return (s32)udtErrorCode::OperationFailed;
+	}
+
+	udtMultiThreadedParsing parser;
+	const bool success = parser.ProcessSegments(jobTimer, outputContext, segmentGroup->Contexts, segmentAllocator, info, extraInfo);
+	DestroyContextGroup(segmentGroup);
+
+	return GetErrorCode(success, info->CancelOperation);
+}
+
 UDT_API(s32) udtParseDemoFiles(udtParserContextGroup** contextGroup, const udtParseArg* info, const udtMultiParseArg* extraInfo)
 {
 	if(contextGroup == NULL || info == NULL || extraInfo == NULL ||
@@ -1066,8 +1144,13 @@ UDT_API(s32) udtParseDemoFiles(udtParserContextGroup** contextGroup, const udtPa
 	udtTimer jobTimer;
 	jobTimer.Start();
 
+	if(extraInfo->FileCount == 1 && (extraInfo->Flags & (u32)udtMultiParseArgFlag::SplitByGameState) != 0)
+	{
+		return ParseDemoFileByGameStates(jobTimer, contextGroup, info, extraInfo);
+	}
+
 	udtDemoThreadAllocator threadAllocator;
-	const bool threadJob = threadAllocator.Process(extraInfo->FilePaths, extraInfo->FileCount, extraInfo->MaxThreadCount);
+	const bool threadJob = threadAllocator.Process(*extraInfo);
 	const u32 threadCount = threadJob ? threadAllocator.Threads.GetSize() : 1;
 	if(!CreateContextGroup(contextGroup, threadCount))
 	{
@@ -1097,6 +1180,17 @@ UDT_API(s32) udtCutDemoFilesByPattern(const udtParseArg* info, const udtMultiPar
 	return RunJobWithLocalContextGroup(udtParsingJobType::CutByPattern, info, extraInfo, patternInfo);
 }
 
+UDT_API(s32) udtCutDemoFilesByTime(const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtMultiCutByTimeArg* cutInfo)
+{
+	if(info == NULL || extraInfo == NULL || cutInfo == NULL ||
+	   !IsValid(*extraInfo) || !IsValid(*cutInfo, extraInfo->FileCount) || !HasValidOutputOption(*info))
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	return RunJobWithLocalContextGroup(udtParsingJobType::CutByTime, info, extraInfo, cutInfo);
+}
+
 UDT_API(s32) udtFindPatternsInDemoFiles(udtPatternSearchContext** contextPtr, const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtPatternSearchArg* patternInfo)
 {
 	if(contextPtr == NULL || info == NULL || extraInfo == NULL || patternInfo == NULL ||
@@ -1170,6 +1264,68 @@ UDT_API(s32) udtTimeShiftDemoFiles(const udtParseArg* info, const udtMultiParseA
 	return RunJobWithLocalContextGroup(udtParsingJobType::TimeShift, info, extraInfo, timeShiftArg);
 }
 
+// Unlike RunJobWithLocalContextGroup, always creates the contexts (one per thread)
+// so that the caller can set them up before and read them after the job.
+static bool CreateJobContextGroup(udtParserContextGroup** contextGroup, udtDemoThreadAllocator& threadAllocator, bool& threadJob, const udtMultiParseArg* extraInfo)
+{
+	threadJob = threadAllocator.Process(*extraInfo);
+	const u32 threadCount = threadJob ? threadAllocator.Threads.GetSize() : 1;
+
+	return CreateContextGroup(contextGroup, threadCount);
+}
+
+static s32 RunJobWithContextGroup(udtTimer& jobTimer, udtParserContextGroup* contextGroup, udtDemoThreadAllocator& threadAllocator, bool threadJob, udtParsingJobType::Id jobType, const udtParseArg* info, const udtMultiParseArg* extraInfo, const void* jobSpecificArg)
+{
+	if(threadJob)
+	{
+		udtMultiThreadedParsing parser;
+		const bool success = parser.Process(jobTimer, contextGroup->Contexts, threadAllocator, info, extraInfo, jobType, jobSpecificArg);
+		return GetErrorCode(success, info->CancelOperation);
+	}
+
+	return udtParseMultipleDemosSingleThread(jobType, contextGroup->Contexts, info, extraInfo, jobSpecificArg);
+}
+
+static bool OpenNDJSONFiles(udtParserContextGroup* contextGroup, const char* filePath)
+{
+	udtParserContext* const contexts = contextGroup->Contexts;
+	const u32 contextCount = contextGroup->ContextCount;
+	if(contextCount == 1)
+	{
+		return contexts[0].JSONWriterContext.BatchFile.Open(filePath, udtFileOpenMode::Write);
+	}
+
+	// The thread index goes before the extension, if any.
+	const udtString path = udtString::NewConstRef(filePath);
+	u32 dotIndex = 0;
+	u32 separatorIndex = 0;
+	if(!udtString::FindLastCharacterMatch(dotIndex, path, '.') ||
+	   (udtString::FindLastCharacterListMatch(separatorIndex, path, udtString::NewConstRef("/\\")) && separatorIndex > dotIndex))
+	{
+		dotIndex = path.GetLength();
+	}
+
+	const udtString pathStart = udtString::NewSubstringRef(path, 0, dotIndex);
+	const udtString pathEnd = udtString::NewSubstringRef(path, dotIndex);
+	for(u32 i = 0; i < contextCount; ++i)
+	{
+		udtVMLinearAllocator& tempAllocator = contexts[i].PlugInTempAllocator;
+		udtVMScopedStackAllocator allocatorScope(tempAllocator);
+
+		char indexString[16];
+		sprintf(indexString, "_%u", i);
+		const udtString index = udtString::NewConstRef(indexString);
+		const udtString* strings[] = { &pathStart, &index, &pathEnd };
+		const udtString threadFilePath = udtString::NewFromConcatenatingMultiple(tempAllocator, strings, (u32)UDT_COUNT_OF(strings));
+		if(!contexts[i].JSONWriterContext.BatchFile.Open(threadFilePath.GetPtr(), udtFileOpenMode::Write))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 UDT_API(s32) udtSaveDemoFilesAnalysisDataToJSON(const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtJSONArg* jsonInfo)
 {
 	if(info == NULL || extraInfo == NULL || jsonInfo == NULL ||
@@ -1178,7 +1334,281 @@ UDT_API(s32) udtSaveDemoFilesAnalysisDataToJSON(const udtParseArg* info, const u
 		return (s32)udtErrorCode::InvalidArgument;
 	}
 
-	return RunJobWithLocalContextGroup(udtParsingJobType::ExportToJSON, info, extraInfo, jsonInfo);
+	if((jsonInfo->Flags & (u32)udtJSONArgFlag::NDJSON) == 0 ||
+	   jsonInfo->ConsoleOutput != 0)
+	{
+		return RunJobWithLocalContextGroup(udtParsingJobType::ExportToJSON, info, extraInfo, jsonInfo);
+	}
+
+	if(jsonInfo->OutputFilePath == NULL)
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	udtTimer jobTimer;
+	jobTimer.Start();
+
+	// Each context writes all of its demos to its own file.
+	udtDemoThreadAllocator threadAllocator;
+	bool threadJob = false;
+	udtParserContextGroup* contextGroup;
+	if(!CreateJobContextGroup(&contextGroup, threadAllocator, threadJob, extraInfo))
+	{
+		return (s32)udtErrorCode::OperationFailed;
+	}
+
+	s32 result = (s32)udtErrorCode::OperationFailed;
+	if(OpenNDJSONFiles(contextGroup, jsonInfo->OutputFilePath))
+	{
+		result = RunJobWithContextGroup(jobTimer, contextGroup, threadAllocator, threadJob, udtParsingJobType::ExportToJSON, info, extraInfo, jsonInfo);
+	}
+
+	// Closes the files.
+	DestroyContextGroup(contextGroup);
+
+	return result;
+}
+
+UDT_API(s32) udtSaveDemoFilesAnalysisDataToBinary(const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtBinaryExportArg* binaryInfo)
+{
+	if(info == NULL || extraInfo == NULL || binaryInfo == NULL || binaryInfo->OutputFilePath == NULL ||
+	   !IsValid(*extraInfo) || !HasValidPlugInOptions(*info))
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	udtTimer jobTimer;
+	jobTimer.Start();
+
+	// The file is written once all the contexts are done.
+	udtDemoThreadAllocator threadAllocator;
+	bool threadJob = false;
+	udtParserContextGroup* contextGroup;
+	if(!CreateJobContextGroup(&contextGroup, threadAllocator, threadJob, extraInfo))
+	{
+		return (s32)udtErrorCode::OperationFailed;
+	}
+
+	s32 result = RunJobWithContextGroup(jobTimer, contextGroup, threadAllocator, threadJob, udtParsingJobType::ExportToBinary, info, extraInfo, binaryInfo);
+	if(result == (s32)udtErrorCode::None &&
+	   !ExportPlugInsDataToBinary(contextGroup->Contexts, contextGroup->ContextCount, extraInfo->FilePaths, binaryInfo->OutputFilePath))
+	{
+		result = (s32)udtErrorCode::OperationFailed;
+	}
+
+	DestroyContextGroup(contextGroup);
+
+	return result;
+}
+
+static void CopyProbeResults(udtProbeContext* probeContext, udtParserContextGroup* contextGroup)
+{
+	for(u32 i = 0, count = contextGroup->ContextCount; i < count; ++i)
+	{
+		udtBaseParserPlugIn* plugInBase = NULL;
+		contextGroup->Contexts[i].GetPlugInById(plugInBase, udtPrivateParserPlugIn::Probe);
+		if(plugInBase == NULL)
+		{
+			continue;
+		}
+
+		const udtParserPlugInProbe& plugIn = *(const udtParserPlugInProbe*)plugInBase;
+		const u32 stringOffset = AppendStringBuffer(probeContext->StringAllocator, plugIn.StringAllocator.GetStartAddress(), (u32)plugIn.StringAllocator.GetCurrentByteCount());
+		const u32 firstPlayerIndex = probeContext->Players.GetSize();
+
+		const u32 playerCount = plugIn.Players.GetSize();
+		udtDemoProbePlayer* const players = probeContext->Players.Append(plugIn.Players.GetStartAddress(), playerCount);
+		for(u32 j = 0; j < playerCount; ++j)
+		{
+			RebaseApiStringOffset(players[j].Name, stringOffset);
+		}
+
+		for(u32 j = 0, demoCount = plugIn.Demos.GetSize(); j < demoCount; ++j)
+		{
+			udtDemoProbeInfo& demo = probeContext->Demos[plugIn.InputIndices[j]];
+			demo = plugIn.Demos[j];
+			RebaseApiStringOffset(demo.MapName, stringOffset);
+			RebaseApiStringOffset(demo.ModVersion, stringOffset);
+			RebaseApiStringOffset(demo.ServerName, stringOffset);
+			RebaseApiStringOffset(demo.DemoTakerName, stringOffset);
+			demo.FirstPlayerIndex += firstPlayerIndex;
+		}
+	}
+}
+
+UDT_API(s32) udtProbeDemoFiles(udtProbeContext** contextPtr, const udtParseArg* info, const udtMultiParseArg* extraInfo, const udtProbeArg* probeInfo)
+{
+	if(contextPtr == NULL || info == NULL || extraInfo == NULL || probeInfo == NULL ||
+	   !IsValid(*extraInfo))
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	udtProbeContext* const context = (udtProbeContext*)malloc(sizeof(udtProbeContext));
+	if(context == NULL)
+	{
+		return (s32)udtErrorCode::OperationFailed;
+	}
+	new (context) udtProbeContext(probeInfo);
+
+	// Demos that can't be probed keep the "not available" values.
+	context->Demos.Resize(extraInfo->FileCount);
+	for(u32 i = 0; i < extraInfo->FileCount; ++i)
+	{
+		udtParserPlugInProbe::ClearDemoInfo(context->Demos[i]);
+	}
+
+	udtTimer jobTimer;
+	jobTimer.Start();
+
+	// The strings are copied from the contexts once all of them are done.
+	udtDemoThreadAllocator threadAllocator;
+	bool threadJob = false;
+	udtParserContextGroup* contextGroup;
+	if(!CreateJobContextGroup(&contextGroup, threadAllocator, threadJob, extraInfo))
+	{
+		context->~udtProbeContext_s();
+		free(context);
+		return (s32)udtErrorCode::OperationFailed;
+	}
+
+	const s32 result = RunJobWithContextGroup(jobTimer, contextGroup, threadAllocator, threadJob, udtParsingJobType::Probe, info, extraInfo, context);
+	CopyProbeResults(context, contextGroup);
+	DestroyContextGroup(contextGroup);
+
+	if(result == (s32)udtErrorCode::None || 
+	   result == (s32)udtErrorCode::OperationCanceled)
+	{
+		*contextPtr = context;
+	}
+	else
+	{
+		context->~udtProbeContext_s();
+		free(context);
+	}
+
+	return result;
+}
+
+UDT_API(s32) udtGetProbeResults(udtProbeContext* context, udtProbeResults* results)
+{
+	if(context == NULL || results == NULL)
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	results->Demos = context->Demos.GetStartAddress();
+	results->Players = context->Players.GetStartAddress();
+	results->StringBuffer = context->StringAllocator.GetStartAddress();
+	results->Reserved1 = NULL;
+	results->DemoCount = context->Demos.GetSize();
+	results->PlayerCount = context->Players.GetSize();
+	results->StringBufferSize = (u32)context->StringAllocator.GetCurrentByteCount();
+	results->Reserved2 = 0;
+
+	return (s32)udtErrorCode::None;
+}
+
+UDT_API(s32) udtDestroyProbeContext(udtProbeContext* context)
+{
+	if(context == NULL)
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	context->~udtProbeContext_s();
+	free(context);
+
+	return (s32)udtErrorCode::None;
+}
+
+UDT_API(s32) udtLoadAnalysisDataFile(udtAnalysisDataFile** filePtr, const char* filePath)
+{
+	if(filePtr == NULL || filePath == NULL)
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	udtAnalysisDataFile* const file = (udtAnalysisDataFile*)malloc(sizeof(udtAnalysisDataFile));
+	if(file == NULL)
+	{
+		return (s32)udtErrorCode::OperationFailed;
+	}
+	new (file) udtAnalysisDataFile;
+
+	if(!file->Load(filePath))
+	{
+		file->~udtAnalysisDataFile_s();
+		free(file);
+		return (s32)udtErrorCode::OperationFailed;
+	}
+
+	*filePtr = file;
+
+	return (s32)udtErrorCode::None;
+}
+
+UDT_API(s32) udtGetContextCountFromAnalysisDataFile(udtAnalysisDataFile* file, u32* count)
+{
+	if(file == NULL || count == NULL)
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	*count = file->GetContextCount();
+
+	return (s32)udtErrorCode::None;
+}
+
+UDT_API(s32) udtGetDemoCountFromAnalysisDataFile(udtAnalysisDataFile* file, u32 contextIdx, u32* count)
+{
+	if(file == NULL || count == NULL || 
+	   !file->GetDemoCount(contextIdx, *count))
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	return (s32)udtErrorCode::None;
+}
+
+UDT_API(s32) udtGetDemoInfoFromAnalysisDataFile(udtAnalysisDataFile* file, u32 contextIdx, u32 demoIdx, u32* demoInputIdx, const char** demoFilePath)
+{
+	if(file == NULL || demoInputIdx == NULL || demoFilePath == NULL ||
+	   !file->GetDemoInfo(contextIdx, demoIdx, *demoInputIdx, *demoFilePath))
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	return (s32)udtErrorCode::None;
+}
+
+UDT_API(s32) udtGetAnalysisDataFilePlugInBuffers(udtAnalysisDataFile* file, u32 contextIdx, u32 plugInId, void* buffersStruct)
+{
+	if(file == NULL || plugInId >= (u32)udtParserPlugIn::Count || buffersStruct == NULL ||
+	   contextIdx >= file->GetContextCount())
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	if(!file->GetPlugInBuffers(contextIdx, plugInId, buffersStruct))
+	{
+		return (s32)udtErrorCode::OperationFailed;
+	}
+
+	return (s32)udtErrorCode::None;
+}
+
+UDT_API(s32) udtDestroyAnalysisDataFile(udtAnalysisDataFile* file)
+{
+	if(file == NULL)
+	{
+		return (s32)udtErrorCode::InvalidArgument;
+	}
+
+	file->~udtAnalysisDataFile_s();
+	free(file);
+
+	return (s32)udtErrorCode::None;
 }
 
 UDT_API(s32) udtGetContextCountFromGroup(udtParserContextGroup* contextGroup, u32* count)
@@ -11,6 +11,26 @@ static bool IsValid(const udtCutByTimeArg& arg)
 	return arg.CutCount > 0 && arg.Cuts != NULL;
 }
 
+static bool IsValid(const udtMultiCutByTimeArg& arg, u32 fileCount)
+{
+	if(arg.CutCount == 0 || arg.Cuts == NULL || arg.DemoInputIndices == NULL)
+	{
+		return false;
+	}
+
+	for(u32 i = 0; i < arg.CutCount; ++i)
+	{
+		const u32 demoIndex = arg.DemoInputIndices[i];
+		if(demoIndex >= fileCount ||
+		   (i > 0 && demoIndex < arg.DemoInputIndices[i - 1]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 static bool IsValid(const udtChatPatternArg& arg)
 {
 	if(arg.Rules == NULL || arg.RuleCount == 0)
@@ -137,5 +157,5 @@ static bool HasValidPlugInOptions(const udtParseArg& arg)
 		}
 	}
 
-	return true;
+	return arg.CacheFolderPath == NULL || IsValidDirectory(arg.CacheFolderPath);
 }
@@ -14,12 +14,31 @@
 #include "memory_stream.hpp"
 #include "json_export.hpp"
 #include "pattern_search_context.hpp"
+#include "demo_index.hpp"
+#include "analysis_cache.hpp"
+#include "plug_in_probe.hpp"
+#include "probe_context.hpp"
+
+#include <stdlib.h>
 
 
 bool InitContextWithPlugIns(udtParserContext& context, const udtParseArg& info, u32 demoCount, udtParsingJobType::Id jobType, const void* jobSpecificInfo)
 {
+	context.ReadAheadInput = (info.Flags & (u32)udtParseArgFlag::ReadAheadInput) != 0;
+	context.ReadAheadBlockSize = info.ReadAheadBlockSize;
+	context.ReadAheadBlockCount = info.ReadAheadBlockCount;
+	context.Parser.MultiSymbolHuffman = (info.Flags & (u32)udtParseArgFlag::MultiSymbolHuffman) != 0;
+	context.Parser.Profiler.Enabled = (info.Flags & (u32)udtParseArgFlag::ProfileStages) != 0 && info.PerformanceStats != NULL;
+	context.Parser.Profiler.Clear();
+
+	// The demo index writer needs the full snapshots.
+	context.Parser.SkipUnneededSnapshots =
+		(jobType == udtParsingJobType::General || jobType == udtParsingJobType::ExportToJSON || jobType == udtParsingJobType::ExportToBinary) &&
+		(info.Flags & (u32)udtParseArgFlag::WriteDemoIndex) == 0;
+
 	if(jobType == udtParsingJobType::General ||
-	   jobType == udtParsingJobType::ExportToJSON)
+	   jobType == udtParsingJobType::ExportToJSON ||
+	   jobType == udtParsingJobType::ExportToBinary)
 	{
 		for(u32 i = 0; i < info.PlugInCount; ++i)
 		{
@@ -33,7 +52,8 @@ bool InitContextWithPlugIns(udtParserContext& context, const udtParseArg& info,
 		return context.Init(demoCount, info.PlugIns, info.PlugInCount);
 	}
 
-	if(jobType == udtParsingJobType::Conversion)
+	if(jobType == udtParsingJobType::Conversion ||
+	   jobType == udtParsingJobType::CutByTime)
 	{
 		if(jobSpecificInfo == NULL)
 		{
@@ -66,6 +86,33 @@ bool InitContextWithPlugIns(udtParserContext& context, const udtParseArg& info,
 		return true;
 	}
 
+	if(jobType == udtParsingJobType::Probe)
+	{
+		if(jobSpecificInfo == NULL)
+		{
+			return false;
+		}
+
+		const u32 plugInId = udtPrivateParserPlugIn::Probe;
+		if(!context.Init(demoCount, &plugInId, 1))
+		{
+			return false;
+		}
+
+		udtBaseParserPlugIn* plugInBase = NULL;
+		context.GetPlugInById(plugInBase, plugInId);
+		if(plugInBase == NULL)
+		{
+			return false;
+		}
+
+		const udtProbeContext* const probeContext = (const udtProbeContext*)jobSpecificInfo;
+		udtParserPlugInProbe& plugIn = *(udtParserPlugInProbe*)plugInBase;
+		plugIn.SetProbeInfo(*probeContext->ProbeInfo);
+
+		return true;
+	}
+
 	if(jobType == udtParsingJobType::CutByPattern ||
 	   jobType == udtParsingJobType::FindPatterns)
 	{
@@ -130,11 +177,23 @@ static bool ParseDemoFile(udtProtocol::Id protocol, udtParserContext* context, c
 	}
 
 	context->Parser.SetFilePath(demoFilePath);
-	if(!RunParser(context->Parser, file, info->CancelOperation))
+
+	const bool writeIndex = (info->Flags & (u32)udtParseArgFlag::WriteDemoIndex) != 0;
+	if(writeIndex)
+	{
+		context->DemoIndexWriter.Init(protocol, info->DemoIndexIntervalMs);
+	}
+
+	if(!RunParser(context->Parser, file, info->CancelOperation, writeIndex ? &context->DemoIndexWriter : NULL))
 	{
 		return false;
 	}
 
+	if(writeIndex && !context->DemoIndexWriter.WriteFile(demoFilePath))
+	{
+		context->Context.LogWarning("Failed to write the index file of demo %s", demoFilePath);
+	}
+
 	return true;
 }
 
@@ -146,10 +205,46 @@ static bool ParseDemoFile(udtParserContext* context, const udtParseArg* info, co
 		return false;
 	}
 
-	return ParseDemoFile(protocol, context, info, demoFilePath, clearPlugInData);
+	// Index files can only be written by parsing.
+	if(info->CacheFolderPath == NULL || clearPlugInData || (info->Flags & (u32)udtParseArgFlag::WriteDemoIndex) != 0)
+	{
+		return ParseDemoFile(protocol, context, info, demoFilePath, clearPlugInData);
+	}
+
+	context->ResetForNextDemo(true);
+	if(!context->Context.SetCallbacks(info->MessageCb, info->ProgressCb, info->ProgressContext))
+	{
+		return false;
+	}
+
+	udtAnalysisCache cache(*context);
+	if(!cache.Init(info->CacheFolderPath, demoFilePath, protocol))
+	{
+		return ParseDemoFile(protocol, context, info, demoFilePath, clearPlugInData);
+	}
+
+	if(cache.Read())
+	{
+		++context->Parser.Profiler.CachedDemoCount;
+		return true;
+	}
+
+	cache.StartDemo();
+	if(!ParseDemoFile(protocol, context, info, demoFilePath, clearPlugInData))
+	{
+		return false;
+	}
+
+	// Plug-ins can be left in an inconsistent state when parsing stops early.
+	if(context->Context.GetErrorCount() == 0 && !cache.Write())
+	{
+		context->Context.LogWarning("Failed to write the analysis cache entries of demo %s", demoFilePath);
+	}
+
+	return true;
 }
 
-static bool CutByPattern(udtParserContext* context, const udtParseArg* info, const char* demoFilePath)
+bool ParseDemoFileSegment(udtParserContext* context, const udtParseArg* info, const char* demoFilePath, u32 startFileOffset, u32 endFileOffset, const udtString& firstServerInfo)
 {
 	const udtProtocol::Id protocol = (udtProtocol::Id)udtGetProtocolByFilePath(demoFilePath);
 	if(protocol == udtProtocol::Invalid)
@@ -157,7 +252,103 @@ static bool CutByPattern(udtParserContext* context, const udtParseArg* info, con
 		return false;
 	}
 
-	if(!ParseDemoFile(protocol, context, info, demoFilePath, false))
+	context->ResetForNextDemo(true);
+	if(!context->Context.SetCallbacks(info->MessageCb, info->ProgressCb, info->ProgressContext))
+	{
+		return false;
+	}
+
+	UDT_INIT_DEMO_FILE_READER_AT(file, demoFilePath, context, startFileOffset);
+
+	// The game state indices the plug-ins output are relative to the segment's first game state.
+	if(!context->Parser.Init(&context->Context, protocol, protocol))
+	{
+		return false;
+	}
+
+	context->Parser.SetFilePath(demoFilePath);
+	context->Parser.ContinuesDemo = startFileOffset != 0;
+	context->Parser.FirstServerInfo = firstServerInfo;
+
+	udtParserRunner runner;
+	if(!runner.Init(context->Parser, file, info->CancelOperation, endFileOffset))
+	{
+		return false;
+	}
+
+	while(runner.ParseNextMessage())
+	{
+	}
+
+	runner.FinishParsing();
+
+	return runner.WasSuccess();
+}
+
+// Writes the cuts while searching, sections is only filled with those left to cut.
+static bool SearchAndCutByPattern(udtProtocol::Id protocol, udtParserContext* context, const udtParseArg* info, const char* demoFilePath, udtPatternSearchPlugIn& plugIn, udtVMArray<udtCutSection>& sections)
+{
+	context->ResetForNextDemo(true);
+	if(!context->Context.SetCallbacks(info->MessageCb, info->ProgressCb, info->ProgressContext))
+	{
+		return false;
+	}
+
+	UDT_INIT_DEMO_FILE_READER(file, demoFilePath, context);
+
+	if(!context->Parser.Init(&context->Context, protocol, protocol))
+	{
+		return false;
+	}
+
+	context->Parser.SetFilePath(demoFilePath);
+
+	udtPatternCutter& cutter = context->PatternCutter;
+	if(!cutter.StartDemo(context->Parser, plugIn, info->OutputFolderPath))
+	{
+		return false;
+	}
+
+	udtParserRunner runner;
+	if(!runner.Init(context->Parser, file, info->CancelOperation))
+	{
+		return false;
+	}
+
+	const bool writeIndex = (info->Flags & (u32)udtParseArgFlag::WriteDemoIndex) != 0;
+	if(writeIndex)
+	{
+		context->DemoIndexWriter.Init(protocol, info->DemoIndexIntervalMs);
+		runner.SetIndexWriter(&context->DemoIndexWriter);
+	}
+
+	while(runner.ParseNextMessage())
+	{
+		cutter.ProcessMessage(
+			context->Parser, runner.GetMessage(), runner.GetServerMessageSequence(), 
+			runner.GetMessageFileOffset(), runner.GetNextFileOffset());
+	}
+
+	runner.FinishParsing();
+	if(!runner.WasSuccess())
+	{
+		return false;
+	}
+
+	cutter.FinishDemo(context->Parser, sections);
+
+	if(writeIndex && !context->DemoIndexWriter.WriteFile(demoFilePath))
+	{
+		context->Context.LogWarning("Failed to write the index file of demo %s", demoFilePath);
+	}
+
+	return true;
+}
+
+static bool CutByPattern(udtParserContext* context, const udtParseArg* info, const char* demoFilePath)
+{
+	const udtProtocol::Id protocol = (udtProtocol::Id)udtGetProtocolByFilePath(demoFilePath);
+	if(protocol == udtProtocol::Invalid)
 	{
 		return false;
 	}
@@ -166,7 +357,29 @@ static bool CutByPattern(udtParserContext* context, const udtParseArg* info, con
 	context->GetPlugInById(plugInBase, udtPrivateParserPlugIn::FindPatterns);
 	udtPatternSearchPlugIn& plugIn = *(udtPatternSearchPlugIn*)plugInBase;
 
-	if(plugIn.CutSections.IsEmpty())
+	// Save the cut sections in a temporary array.
+	udtVMArray<udtCutSection> sections("CutByPattern::SectionsArray");
+	if(plugIn.CanCutInSinglePass())
+	{
+		if(!SearchAndCutByPattern(protocol, context, info, demoFilePath, plugIn, sections))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if(!ParseDemoFile(protocol, context, info, demoFilePath, false))
+		{
+			return false;
+		}
+
+		for(u32 i = 0, count = plugIn.CutSections.GetSize(); i < count; ++i)
+		{
+			sections.Add(plugIn.CutSections[i]);
+		}
+	}
+
+	if(sections.IsEmpty())
 	{
 		return true;
 	}
@@ -177,23 +390,42 @@ static bool CutByPattern(udtParserContext* context, const udtParseArg* info, con
 		return false;
 	}
 
-	const s32 gsIndex = plugIn.CutSections[0].GameStateIndex;
-	const u32 fileOffset = context->Parser._inGameStateFileOffsets[gsIndex];
-	UDT_INIT_DEMO_FILE_READER_AT(file, demoFilePath, context, fileOffset);
+	const s32 gsIndex = sections[0].GameStateIndex;
+	const u32 gsFileOffset = context->Parser._inGameStateFileOffsets[gsIndex];
 
-	// Save the cut sections in a temporary array.
-	udtVMArray<udtCutSection> sections("CutByPattern::SectionsArray");
-	for(u32 i = 0, count = plugIn.CutSections.GetSize(); i < count; ++i)
+	// Start from the last keyframe before the first cut if the demo was indexed.
+	udtDemoIndex demoIndex;
+	s32 keyframeIndex = -1;
+	if((info->Flags & (u32)udtParseArgFlag::UseDemoIndex) != 0 &&
+	   demoIndex.Load(demoFilePath, protocol))
 	{
-		sections.Add(plugIn.CutSections[i]);
+		s32 startTimeMs = UDT_S32_MAX;
+		for(u32 i = 0, count = sections.GetSize(); i < count; ++i)
+		{
+			const udtCutSection& section = sections[i];
+			if(section.GameStateIndex == gsIndex)
+			{
+				startTimeMs = udt_min(startTimeMs, section.StartTimeMs);
+			}
+		}
+
+		keyframeIndex = demoIndex.FindStartKeyframe(gsIndex, startTimeMs, gsFileOffset);
 	}
-	
+
+	const u32 fileOffset = keyframeIndex >= 0 ? demoIndex.Keyframes[keyframeIndex].FileOffset : gsFileOffset;
+	UDT_INIT_DEMO_FILE_READER_AT(file, demoFilePath, context, fileOffset);
+
 	// This will clear the plug-in's section list.
 	if(!context->Parser.Init(&context->Context, protocol, protocol, gsIndex, false))
 	{
 		return false;
 	}
 
+	if(keyframeIndex >= 0 && !demoIndex.RestoreKeyframe(context->Parser, (u32)keyframeIndex))
+	{
+		return false;
+	}
+
 	context->Parser.SetFilePath(demoFilePath);
 
 	CallbackCutDemoFileStreamCreationInfo cutCbInfo;
@@ -216,6 +448,111 @@ static bool CutByPattern(udtParserContext* context, const udtParseArg* info, con
 	return result;
 }
 
+static bool CutByTime(udtParserContext* context, u32 inputDemoIndex, const udtParseArg* info, const char* demoFilePath, const udtMultiCutByTimeArg* cutInfo)
+{
+	const udtProtocol::Id protocol = (udtProtocol::Id)udtGetProtocolByFilePath(demoFilePath);
+	if(protocol == udtProtocol::Invalid)
+	{
+		return false;
+	}
+
+	// The cuts are sorted by demo input index.
+	u32 firstCutIndex = 0;
+	u32 cutCount = cutInfo->CutCount;
+	while(cutCount > 0)
+	{
+		const u32 halfCount = cutCount / 2;
+		if(cutInfo->DemoInputIndices[firstCutIndex + halfCount] < inputDemoIndex)
+		{
+			firstCutIndex += halfCount + 1;
+			cutCount -= halfCount + 1;
+		}
+		else
+		{
+			cutCount = halfCount;
+		}
+	}
+
+	u32 endCutIndex = firstCutIndex;
+	s32 gsIndex = UDT_S32_MAX;
+	while(endCutIndex < cutInfo->CutCount && cutInfo->DemoInputIndices[endCutIndex] == inputDemoIndex)
+	{
+		gsIndex = udt_min(gsIndex, cutInfo->Cuts[endCutIndex].GameStateIndex);
+		++endCutIndex;
+	}
+
+	if(endCutIndex == firstCutIndex)
+	{
+		return true;
+	}
+
+	context->ResetForNextDemo(true);
+	if(!context->Context.SetCallbacks(info->MessageCb, info->ProgressCb, info->ProgressContext))
+	{
+		return false;
+	}
+
+	// Start from the last keyframe before the first cut if the demo was indexed.
+	// Otherwise, all the cuts are applied in a single pass from the start of the file.
+	udtDemoIndex demoIndex;
+	s32 keyframeIndex = -1;
+	if((info->Flags & (u32)udtParseArgFlag::UseDemoIndex) != 0 &&
+	   demoIndex.Load(demoFilePath, protocol))
+	{
+		s32 startTimeMs = UDT_S32_MAX;
+		for(u32 i = firstCutIndex; i < endCutIndex; ++i)
+		{
+			const udtCut& cut = cutInfo->Cuts[i];
+			if(cut.GameStateIndex == gsIndex)
+			{
+				startTimeMs = udt_min(startTimeMs, cut.StartTimeMs);
+			}
+		}
+
+		keyframeIndex = demoIndex.FindStartKeyframe(gsIndex, startTimeMs, 0);
+	}
+
+	const u32 fileOffset = keyframeIndex >= 0 ? demoIndex.Keyframes[keyframeIndex].FileOffset : 0;
+	UDT_INIT_DEMO_FILE_READER_AT(file, demoFilePath, context, fileOffset);
+
+	if(!context->Parser.Init(&context->Context, protocol, protocol, keyframeIndex >= 0 ? gsIndex : 0, false))
+	{
+		return false;
+	}
+
+	if(keyframeIndex >= 0 && !demoIndex.RestoreKeyframe(context->Parser, (u32)keyframeIndex))
+	{
+		return false;
+	}
+
+	context->Parser.SetFilePath(demoFilePath);
+
+	CallbackCutDemoFileStreamCreationInfo cutCbInfo;
+	cutCbInfo.OutputFolderPath = info->OutputFolderPath;
+
+	for(u32 i = firstCutIndex; i < endCutIndex; ++i)
+	{
+		const udtCut& cut = cutInfo->Cuts[i];
+		if(cut.StartTimeMs >= cut.EndTimeMs)
+		{
+			continue;
+		}
+
+		if(cut.FilePath != NULL)
+		{
+			context->Parser.AddCut(cut.GameStateIndex, cut.StartTimeMs, cut.EndTimeMs, cut.FilePath);
+		}
+		else
+		{
+			context->Parser.AddCut(cut.GameStateIndex, cut.StartTimeMs, cut.EndTimeMs, &CallbackCutDemoFileNameCreation, NULL, &cutCbInfo);
+		}
+	}
+
+	context->Context.LogInfo("Processing demo for applying timed cut(s): %s", demoFilePath);
+
+	return RunParser(context->Parser, file, info->CancelOperation);
+}
+
 static bool FindPatterns(udtParserContext* context, u32 demoIndex, const udtParseArg* info, const char* demoFilePath, udtPatternSearchContext* searchContext)
 {
 	const udtProtocol::Id protocol = (udtProtocol::Id)udtGetProtocolByFilePath(demoFilePath);
@@ -254,6 +591,37 @@ static bool FindPatterns(udtParserContext* context, u32 demoIndex, const udtPars
 	return true;
 }
 
+static bool ProbeDemoFile(udtParserContext* context, u32 inputDemoIndex, const udtParseArg* info, const char* demoFilePath)
+{
+	const udtProtocol::Id protocol = (udtProtocol::Id)udtGetProtocolByFilePath(demoFilePath);
+	if(protocol == udtProtocol::Invalid)
+	{
+		return false;
+	}
+
+	context->ResetForNextDemo(true);
+	if(!context->Context.SetCallbacks(info->MessageCb, info->ProgressCb, info->ProgressContext))
+	{
+		return false;
+	}
+
+	UDT_INIT_DEMO_FILE_READER(file, demoFilePath, context);
+
+	udtBaseParserPlugIn* plugIn = NULL;
+	context->GetPlugInById(plugIn, udtPrivateParserPlugIn::Probe);
+	((udtParserPlugInProbe*)plugIn)->SetInputIndex(inputDemoIndex);
+
+	if(!context->Parser.Init(&context->Context, protocol, protocol))
+	{
+		return false;
+	}
+
+	context->Parser.SetFilePath(demoFilePath);
+
+	// The parser stops once the plug-in is done.
+	return RunParser(context->Parser, file, info->CancelOperation);
+}
+
 static bool ConvertDemoFile(udtParserContext* context, const udtParseArg* info, const char* demoFilePath, const udtProtocolConversionArg* conversionInfo)
 {
 	const udtProtocol::Id protocol = (udtProtocol::Id)udtGetProtocolByFilePath(demoFilePath);
@@ -471,6 +839,12 @@ static bool ExportToJSON(udtParserContext* context, u32 demoIndex, const udtPars
 
 	udtVMScopedStackAllocator allocatorScope(tempAllocator);
 
+	if((jsonInfo->Flags & (u32)udtJSONArgFlag::NDJSON) != 0)
+	{
+		context->UpdatePlugInBufferStructs();
+		return ExportPlugInsDataToNDJSON(context, demoIndex, demoFilePath, jsonInfo->ConsoleOutput != 0);
+	}
+
 	const char* outputFilePath = NULL;
 	if(jsonInfo->ConsoleOutput == 0)
 	{
@@ -480,7 +854,8 @@ static bool ExportToJSON(udtParserContext* context, u32 demoIndex, const udtPars
 	}
 	
 	context->UpdatePlugInBufferStructs();
-	if(!ExportPlugInsDataToJSON(context, demoIndex, outputFilePath))
+	const bool compact = (jsonInfo->Flags & (u32)udtJSONArgFlag::Compact) != 0;
+	if(!ExportPlugInsDataToJSON(context, demoIndex, outputFilePath, compact))
 	{
 		return false;
 	}
@@ -510,6 +885,15 @@ bool ProcessSingleDemoFile(udtParsingJobType::Id jobType, udtParserContext* cont
 		case udtParsingJobType::FindPatterns:
 			return FindPatterns(context, inputDemoIndex, info, demoFilePath, (udtPatternSearchContext*)jobSpecificInfo);
 
+		case udtParsingJobType::CutByTime:
+			return CutByTime(context, inputDemoIndex, info, demoFilePath, (const udtMultiCutByTimeArg*)jobSpecificInfo);
+
+		case udtParsingJobType::ExportToBinary:
+			return ParseDemoFile(context, info, demoFilePath, false);
+
+		case udtParsingJobType::Probe:
+			return ProbeDemoFile(context, inputDemoIndex, info, demoFilePath);
+
 		default:
 			return false;
 	}
@@ -543,7 +927,7 @@ s32 udtParseMultipleDemosSingleThread(udtParsingJobType::Id jobType, udtParserCo
 	jobTimer.Start();
 	if(info->PerformanceStats != NULL)
 	{
-		PerfStatsInit(info->PerformanceStats);
+		PerfStatsInit(info->PerformanceStats, info->PlugInPerformanceStats);
 	}
 
 	bool customContext = false;
@@ -597,6 +981,7 @@ s32 udtParseMultipleDemosSingleThread(udtParsingJobType::Id jobType, udtParserCo
 	newInfo.ProgressContext = &progressContext;
 
 	u64 actualProcessedByteCount = 0;
+	const u32 firstCutCount = context->Parser.GetWrittenCutCount();
 	for(u32 i = 0; i < extraInfo->FileCount; ++i)
 	{
 		if(info->CancelOperation != NULL && *info->CancelOperation != 0)
@@ -624,7 +1009,9 @@ s32 udtParseMultipleDemosSingleThread(udtParsingJobType::Id jobType, udtParserCo
 
 	if(info->PerformanceStats != NULL)
 	{
-		PerfStatsAddCurrentThread(info->PerformanceStats, actualProcessedByteCount);
+		const u32 cutCount = context->Parser.GetWrittenCutCount() - firstCutCount;
+		PerfStatsAddCurrentThread(info->PerformanceStats, actualProcessedByteCount, (u64)cutCount);
+		PerfStatsAddParserProfile(info->PerformanceStats, info->PlugInPerformanceStats, *context);
 		PerfStatsFinalize(info->PerformanceStats, 1, jobTimer.GetElapsedUs());
 	}
 
@@ -674,6 +1061,9 @@ static void CreateMergedDemoName(udtString& outputFilePath, udtVMLinearAllocator
 	outputFilePath = udtString::NewFromConcatenatingMultiple(allocator, outputFilePathParts, (u32)UDT_COUNT_OF(outputFilePathParts));
 }
 
+// Merges any number of demos into the first one's stream.
+// Each input only keeps its parser and the last 2 snapshots converted, so memory grows linearly with the input count.
+// The other inputs are kept in a min-heap ordered by server time and only those lagging behind the first demo are read.
 struct DemoMerger
 {
 	struct DemoData
@@ -682,37 +1072,69 @@ struct DemoMerger
 		udtParserRunner Runner;
 		udtVMMemoryStream WriteBuffer;
 		udtReadOnlyMemoryStream ReadBuffer;
-		udtdConverter ConverterToQuake;
+		udtdConverter ConverterToQuake; // Too big for the stack.
 		udtParserContext* Context;
 		udtParserPlugInQuakeToUDT* ConverterToUDT;
 	};
 
 	DemoMerger()
 	{
-		for(u32 i = 0; i < UDT_MAX_MERGE_DEMO_COUNT; ++i)
-		{
-			_demos[i].Context = NULL;
-			_demos[i].ConverterToUDT = NULL;
-		}
-
+		_demos = NULL;
+		_heap = NULL;
 		_fileCount = 0;
+		_heapSize = 0;
 	}
 
 	~DemoMerger()
 	{
-		for(u32 i = 0; i < UDT_MAX_MERGE_DEMO_COUNT; ++i)
+		if(_demos != NULL)
 		{
-			if(_demos[i].Context != NULL)
+			for(u32 i = 0; i < _fileCount; ++i)
 			{
-				udtDestroyContext(_demos[i].Context);
+				DemoData* const demo = _demos[i];
+				if(demo == NULL)
+				{
+					continue;
+				}
+
+				if(demo->Context != NULL)
+				{
+					udtDestroyContext(demo->Context);
+				}
+				demo->~DemoData();
+				free(demo);
 			}
+			free(_demos);
 		}
+
+		free(_heap);
 	}
 
 	bool MergeDemos(const udtParseArg* info, const char** filePaths, u32 fileCount, udtProtocol::Id protocol)
 	{
+		_demos = (DemoData**)calloc((size_t)fileCount, sizeof(DemoData*));
+		_heap = (u32*)malloc((size_t)fileCount * sizeof(u32));
+		if(_demos == NULL || _heap == NULL)
+		{
+			return false;
+		}
 		_fileCount = fileCount;
 
+		// @NOTE: We don't use the standard operator new approach to avoid C++ exceptions.
+		for(u32 i = 0; i < fileCount; ++i)
+		{
+			DemoData* const demo = (DemoData*)malloc(sizeof(DemoData));
+			if(demo == NULL)
+			{
+				return false;
+			}
+
+			new (demo) DemoData;
+			demo->Context = NULL;
+			demo->ConverterToUDT = NULL;
+			_demos[i] = demo;
+		}
+
 		udtVMLinearAllocator tempAllocator("DemoMerger::MergeDemos::Temp");
 
 		udtString outputFilePath;
@@ -726,7 +1148,7 @@ struct DemoMerger
 
 		for(u32 i = 0; i < fileCount; ++i)
 		{
-			DemoData& demo = _demos[i];
+			DemoData& demo = *_demos[i];
 
 			demo.Context = udtCreateContext();
 			if(demo.Context == NULL)
@@ -778,7 +1200,14 @@ struct DemoMerger
 			demo.ConverterToQuake.ResetForNextDemo(demo.ReadBuffer, i == 0 ? &output : NULL, protocol);
 		}
 
-		DemoData& firstDemo = _demos[0];
+		// They all start at the same time, so the index order is a valid heap.
+		_heapSize = 0;
+		for(u32 i = 1; i < fileCount; ++i)
+		{
+			_heap[_heapSize++] = i;
+		}
+
+		DemoData& firstDemo = *_demos[0];
 		s32 firstTime = UDT_S32_MIN;
 		udtdMessageType::Id messageType = udtdMessageType::Invalid;
 		udtdConverter::SnapshotInfo snapshotInfo;
@@ -831,25 +1260,29 @@ struct DemoMerger
 			return;
 		}
 
-		for(u32 i = 1; i < _fileCount; ++i)
+		while(_heapSize > 0 && GetDemoTime(_heap[0]) < firstTime)
 		{
-			SynchronizeDemo(_demos[i], firstTime);
+			if(SynchronizeDemo(*_demos[_heap[0]], firstTime))
+			{
+				SiftDown(0);
+			}
+			else
+			{
+				// The demo ended before reaching that time, so it can't be merged from again.
+				_heap[0] = _heap[--_heapSize];
+				SiftDown(0);
+			}
 		}
 	}
 
-	void SynchronizeDemo(DemoData& demo, s32 firstTime)
+	bool SynchronizeDemo(DemoData& demo, s32 firstTime)
 	{
-		if(demo.ConverterToQuake.GetServerTimeOld() >= firstTime)
-		{
-			return;
-		}
-
 		udtdMessageType::Id messageType = udtdMessageType::Invalid;
 		for(;;)
 		{
 			if(!demo.Runner.ParseNextMessage())
 			{
-				break;
+				return false;
 			}
 
 			const u64 writeBufferSize = demo.WriteBuffer.Length();
@@ -860,7 +1293,7 @@ struct DemoMerger
 
 			if(!demo.ReadBuffer.Open(demo.WriteBuffer.GetBuffer(), (u32)demo.WriteBuffer.Length()))
 			{
-				break;
+				return false;
 			}
 			
 			// udtParserRunner::ParseNextMessage() may read more than just a snapshot.
@@ -877,18 +1310,19 @@ struct DemoMerger
 			demo.WriteBuffer.Clear();
 			if(stop)
 			{
-				break;
+				return true;
 			}
 		}
 	}
 
 	void MergeDemoEntities()
 	{
-		DemoData& firstDemo = _demos[0];
+		// The demos are merged in input order because the first one to provide an entity wins.
+		DemoData& firstDemo = *_demos[0];
 		const s32 firstTime = firstDemo.ConverterToQuake.GetServerTime();
 		for(u32 i = 1; i < _fileCount; ++i)
 		{
-			DemoData& demo = _demos[i];
+			DemoData& demo = *_demos[i];
 
 			const s32 time = demo.ConverterToQuake.GetServerTimeOld();
 			if(time == firstTime)
@@ -898,16 +1332,55 @@ struct DemoMerger
 		}
 	}
 
-	DemoData _demos[UDT_MAX_MERGE_DEMO_COUNT];
+	s32 GetDemoTime(u32 demoIndex) const
+	{
+		return _demos[demoIndex]->ConverterToQuake.GetServerTimeOld();
+	}
+
+	bool IsHeapLess(u32 a, u32 b) const
+	{
+		const s32 timeA = GetDemoTime(_heap[a]);
+		const s32 timeB = GetDemoTime(_heap[b]);
+
+		return timeA < timeB || (timeA == timeB && _heap[a] < _heap[b]);
+	}
+
+	void SiftDown(u32 index)
+	{
+		for(;;)
+		{
+			const u32 left = 2 * index + 1;
+			const u32 right = left + 1;
+			u32 smallest = index;
+			if(left < _heapSize && IsHeapLess(left, smallest))
+			{
+				smallest = left;
+			}
+			if(right < _heapSize && IsHeapLess(right, smallest))
+			{
+				smallest = right;
+			}
+			if(smallest == index)
+			{
+				break;
+			}
+
+			const u32 temp = _heap[index];
+			_heap[index] = _heap[smallest];
+			_heap[smallest] = temp;
+			index = smallest;
+		}
+	}
+
+	DemoData** _demos;
+	u32* _heap; // Indices into _demos of the demos that can still be read, ordered by server time.
 	u32 _fileCount;
+	u32 _heapSize;
 };
 
 bool MergeDemosNoInputCheck(const udtParseArg* info, const char** filePaths, u32 fileCount, udtProtocol::Id protocol)
 {
-	udtVMLinearAllocator allocator("MergeDemosNoInputCheck::Temp");
-	udtVMScopedStackAllocator allocatorScope(allocator);
-	const uptr mergerOffset = allocatorScope.NewObject<DemoMerger>();
-	DemoMerger* const merger = (DemoMerger*)allocator.GetAddressAt(mergerOffset);
+	DemoMerger merger;
 
-	return merger->MergeDemos(info, filePaths, fileCount, protocol);
+	return merger.MergeDemos(info, filePaths, fileCount, protocol);
 }
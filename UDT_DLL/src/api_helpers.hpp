@@ -15,11 +15,15 @@ struct udtParsingJobType
 		TimeShift,    // Shift non-first-person living player entities back in time to act as an anti-lag.
 		ExportToJSON, // Write a .JSON file with the data from the selected plug-ins.
 		FindPatterns, // Generate and keep the list of cuts.
+		CutByTime,    // Apply all the cuts of a demo in a single pass.
+		ExportToBinary, // Parse the demo and keep the data of the selected plug-ins for a single binary file written at the end.
+		Probe,        // Read the first game state and a few snapshots, then stop.
 		Count
 	};
 };
 
 struct udtTimer;
+struct udtString;
 
 struct SingleThreadProgressContext
 {
@@ -34,6 +38,7 @@ struct SingleThreadProgressContext
 
 extern void SingleThreadProgressCallback(f32 jobProgress, void* userData);
 extern bool InitContextWithPlugIns(udtParserContext& context, const udtParseArg& info, u32 demoCount, udtParsingJobType::Id jobType, const void* jobSpecificInfo = NULL);
+extern bool ParseDemoFileSegment(udtParserContext* context, const udtParseArg* info, const char* demoFilePath, u32 startFileOffset, u32 endFileOffset, const udtString& firstServerInfo); // Parses until the end if endFileOffset is 0.
 extern bool ProcessSingleDemoFile(udtParsingJobType::Id jobType, udtParserContext* context, u32 contextDemoIndex, u32 inputDemoIndex, const udtParseArg* info, const char* demoFilePath, const void* jobSpecificInfo);
 extern bool MergeDemosNoInputCheck(const udtParseArg* info, const char** filePaths, u32 fileCount, udtProtocol::Id protocol);
 extern s32  udtParseMultipleDemosSingleThread(udtParsingJobType::Id jobType, udtParserContext* context, const udtParseArg* info, const udtMultiParseArg* extraInfo, const void* jobSpecificInfo);
@@ -0,0 +1,722 @@
+#include "shared.hpp"
+#include "file_stream.hpp"
+#include "file_system.hpp"
+#include "path.hpp"
+#include "timer.hpp"
+#include "utils.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+
+#define    UDT_BENCH_DEFAULT_RUN_COUNT      5
+#define    UDT_BENCH_DEFAULT_CORPUS_PATH    "demo_files"
+
+
+void PrintHelp()
+{
+	printf("Runs every job type of the library on demos grouped by protocol and reports their speed.\n");
+	printf("\n");
+	printf("UDT_bench [-r] [-n=runcount] [-t=maxthreads] [-c=csvfile] -o=outputfolder [inputfile|inputfolder]\n");
+	printf("\n");
+	printf("-r    enable recursive demo file search   (default: off)\n");
+	printf("-n=N  run every job N times               (default: %d)\n", UDT_BENCH_DEFAULT_RUN_COUNT);
+	printf("-t=N  maximum number of threads per job   (default: 1)\n");
+	printf("-c=P  also write the results to CSV file P\n");
+	printf("-o=P  output folder for the demos and files written by the jobs\n");
+	printf("\n");
+	printf("Without an input path, the '%s' folder of the current directory is searched recursively.\n", UDT_BENCH_DEFAULT_CORPUS_PATH);
+	printf("Demos that can't be parsed are left out.\n");
+	printf("The demo merging job merges each demo with itself and doesn't report message and snapshot counts.\n");
+}
+
+struct BenchJobType
+{
+	enum Id
+	{
+		Parse,        // All plug-ins.
+		PlugIn,       // A single plug-in.
+		FindPatterns,
+		CutByPattern,
+		CutByPatternSinglePass,
+		CutByTime,    // Cuts the first game state of every demo.
+		Convert,
+		TimeShift,
+		Merge,
+		ExportJSON,
+		Probe,        // The first game state and the first snapshot.
+		Count
+	};
+};
+
+struct BenchJob
+{
+	const char* Name;
+	BenchJobType::Id Type;
+	u32 PlugInId;
+};
+
+struct BenchDemo
+{
+	udtString FilePath;
+	u64 ByteCount;
+	s32 StartTimeMs; // First snapshot of the first game state.
+	s32 EndTimeMs;   // Last snapshot of the first game state.
+	udtProtocol::Id Protocol;
+};
+
+struct BenchConfig
+{
+	const char* OutputFolderPath;
+	const char* CSVFilePath;
+	u32 RunCount;
+	u32 MaxThreadCount;
+};
+
+struct BenchRun
+{
+	u64 DurationUs;
+	u64 MessageCount;
+	u64 SnapshotCount;
+};
+
+struct BenchStats
+{
+	f64 Min;
+	f64 Median;
+	f64 Max;
+};
+
+static bool KeepOnlyDemoFiles(const char* name, u64 /*size*/, void* /*userData*/)
+{
+	return udtPath::HasValidDemoFileExtension(name);
+}
+
+static udtProtocol::Id GetConversionOutputProtocol(udtProtocol::Id protocol)
+{
+	switch(protocol)
+	{
+		case udtProtocol::Dm3:
+		case udtProtocol::Dm48:
+			return udtProtocol::Dm68;
+
+		case udtProtocol::Dm73:
+		case udtProtocol::Dm90:
+			return udtProtocol::Dm91;
+
+		default:
+			return udtProtocol::Invalid;
+	}
+}
+
+static bool IsJobSupported(BenchJobType::Id jobType, udtProtocol::Id protocol)
+{
+	switch(jobType)
+	{
+		case BenchJobType::CutByPattern:
+		case BenchJobType::CutByPatternSinglePass:
+		case BenchJobType::CutByTime:
+		case BenchJobType::TimeShift:
+		case BenchJobType::Merge:
+			return udtIsProtocolWriteSupported((u32)protocol) != 0;
+
+		case BenchJobType::Convert:
+			return GetConversionOutputProtocol(protocol) != udtProtocol::Invalid;
+
+		default:
+			return true;
+	}
+}
+
+static void CreateJobList(udtVMArray<BenchJob>& jobs)
+{
+	const char** plugInNames = NULL;
+	u32 plugInCount = 0;
+	udtGetStringArray((u32)udtStringArray::PlugInNames, &plugInNames, &plugInCount);
+
+	BenchJob job;
+	job.PlugInId = 0;
+
+	job.Name = "parse";
+	job.Type = BenchJobType::Parse;
+	jobs.Add(job);
+
+	for(u32 i = 0; i < plugInCount; ++i)
+	{
+		job.Name = plugInNames[i];
+		job.Type = BenchJobType::PlugIn;
+		job.PlugInId = i;
+		jobs.Add(job);
+	}
+	job.PlugInId = 0;
+
+	struct JobInfo
+	{
+		const char* Name;
+		BenchJobType::Id Type;
+	};
+
+	const JobInfo otherJobs[] =
+	{
+		{ "pattern search", BenchJobType::FindPatterns },
+		{ "cut by pattern", BenchJobType::CutByPattern },
+		{ "cut by pattern (single pass)", BenchJobType::CutByPatternSinglePass },
+		{ "cut by time", BenchJobType::CutByTime },
+		{ "convert", BenchJobType::Convert },
+		{ "time shift", BenchJobType::TimeShift },
+		{ "merge", BenchJobType::Merge },
+		{ "JSON export", BenchJobType::ExportJSON },
+		{ "probe", BenchJobType::Probe }
+	};
+
+	for(u32 i = 0; i < (u32)UDT_COUNT_OF(otherJobs); ++i)
+	{
+		job.Name = otherJobs[i].Name;
+		job.Type = otherJobs[i].Type;
+		jobs.Add(job);
+	}
+}
+
+// Parses all demos once per plug-in to drop the invalid ones and grab the time range of their first game state.
+// Some corrupted demos only fail with specific plug-ins, so each plug-in gets a pass of its own.
+// This also gets the files in the OS's cache before the timed runs.
+static bool LoadDemos(udtVMArray<BenchDemo>& demos, const udtFileInfo* files, u32 fileCount, u32 maxThreadCount)
+{
+	udtVMArray<const char*> filePaths("Bench::LoadFilePathsArray");
+	udtVMArray<s32> errorCodes("Bench::LoadErrorCodesArray");
+	udtVMArray<BenchDemo> allDemos("Bench::AllDemosArray");
+	udtVMArray<bool> validDemos("Bench::ValidDemosArray");
+	filePaths.Resize(fileCount);
+	errorCodes.Resize(fileCount);
+	allDemos.Resize(fileCount);
+	validDemos.Resize(fileCount);
+	for(u32 i = 0; i < fileCount; ++i)
+	{
+		filePaths[i] = files[i].Path.GetPtr();
+		allDemos[i].FilePath = files[i].Path;
+		allDemos[i].ByteCount = files[i].Size;
+		allDemos[i].StartTimeMs = 0;
+		allDemos[i].EndTimeMs = 0;
+		allDemos[i].Protocol = (udtProtocol::Id)udtGetProtocolByFilePath(filePaths[i]);
+		validDemos[i] = allDemos[i].Protocol != udtProtocol::Invalid;
+	}
+
+	for(u32 plugInId = 0; plugInId < (u32)udtParserPlugIn::Count; ++plugInId)
+	{
+		for(u32 i = 0; i < fileCount; ++i)
+		{
+			errorCodes[i] = (s32)udtErrorCode::Unprocessed;
+		}
+
+		udtParseArg info;
+		memset(&info, 0, sizeof(info));
+		info.PlugIns = &plugInId;
+		info.PlugInCount = 1;
+
+		udtMultiParseArg threadInfo;
+		memset(&threadInfo, 0, sizeof(threadInfo));
+		threadInfo.FilePaths = filePaths.GetStartAddress();
+		threadInfo.OutputErrorCodes = errorCodes.GetStartAddress();
+		threadInfo.FileCount = fileCount;
+		threadInfo.MaxThreadCount = maxThreadCount;
+
+		udtParserContextGroup* contextGroup = NULL;
+		const s32 result = udtParseDemoFiles(&contextGroup, &info, &threadInfo);
+		if(result != (s32)udtErrorCode::None)
+		{
+			fprintf(stderr, "udtParseDemoFiles failed with error: %s\n", udtGetErrorCodeString(result));
+			udtDestroyContextGroup(contextGroup);
+			return false;
+		}
+
+		for(u32 i = 0; i < fileCount; ++i)
+		{
+			if(errorCodes[i] != (s32)udtErrorCode::None)
+			{
+				validDemos[i] = false;
+			}
+		}
+
+		if(plugInId == (u32)udtParserPlugIn::GameState)
+		{
+			u32 contextCount = 0;
+			udtGetContextCountFromGroup(contextGroup, &contextCount);
+			for(u32 contextIdx = 0; contextIdx < contextCount; ++contextIdx)
+			{
+				udtParserContext* context = NULL;
+				u32 demoCount = 0;
+				udtGetContextFromGroup(contextGroup, contextIdx, &context);
+				udtGetDemoCountFromContext(context, &demoCount);
+
+				udtParseDataGameStateBuffers buffers;
+				if(udtGetContextPlugInBuffers(context, plugInId, &buffers) != (s32)udtErrorCode::None)
+				{
+					continue;
+				}
+
+				for(u32 demoIdx = 0; demoIdx < demoCount; ++demoIdx)
+				{
+					u32 demoInputIdx = 0;
+					udtGetDemoInputIndex(context, demoIdx, &demoInputIdx);
+
+					const udtParseDataBufferRange range = buffers.GameStateRanges[demoIdx];
+					if(demoInputIdx < fileCount && range.Count > 0)
+					{
+						const udtParseDataGameState& gameState = buffers.GameStates[range.FirstIndex];
+						allDemos[demoInputIdx].StartTimeMs = gameState.FirstSnapshotTimeMs;
+						allDemos[demoInputIdx].EndTimeMs = gameState.LastSnapshotTimeMs;
+					}
+				}
+			}
+		}
+
+		udtDestroyContextGroup(contextGroup);
+	}
+
+	for(u32 i = 0; i < fileCount; ++i)
+	{
+		const BenchDemo& demo = allDemos[i];
+		if(!validDemos[i] || demo.EndTimeMs <= demo.StartTimeMs)
+		{
+			fprintf(stderr, "Skipping demo file %s\n", demo.FilePath.GetPtr());
+			continue;
+		}
+
+		demos.Add(demo);
+	}
+
+	return !demos.IsEmpty();
+}
+
+static s32 RunJobOnce(const BenchJob& job, const BenchConfig& config, const BenchDemo* demos, u32 demoCount, u64* perfStats)
+{
+	udtVMArray<const char*> filePaths("Bench::FilePathsArray");
+	udtVMArray<s32> errorCodes("Bench::ErrorCodesArray");
+	filePaths.Resize(demoCount);
+	errorCodes.Resize(demoCount);
+	for(u32 i = 0; i < demoCount; ++i)
+	{
+		filePaths[i] = demos[i].FilePath.GetPtr();
+		errorCodes[i] = (s32)udtErrorCode::Unprocessed;
+	}
+
+	u32 plugInIds[udtParserPlugIn::Count];
+	for(u32 i = 0; i < (u32)udtParserPlugIn::Count; ++i)
+	{
+		plugInIds[i] = i;
+	}
+
+	udtParseArg info;
+	memset(&info, 0, sizeof(info));
+	info.OutputFolderPath = config.OutputFolderPath;
+	info.PerformanceStats = perfStats;
+
+	udtMultiParseArg threadInfo;
+	memset(&threadInfo, 0, sizeof(threadInfo));
+	threadInfo.FilePaths = filePaths.GetStartAddress();
+	threadInfo.OutputErrorCodes = errorCodes.GetStartAddress();
+	threadInfo.FileCount = demoCount;
+	threadInfo.MaxThreadCount = config.MaxThreadCount;
+
+	udtFragRunPatternArg fragRunInfo;
+	memset(&fragRunInfo, 0, sizeof(fragRunInfo));
+	fragRunInfo.MinFragCount = 2;
+	fragRunInfo.TimeBetweenFragsSec = 5;
+	fragRunInfo.AllowedMeansOfDeaths = (u32)~0;
+
+	udtPatternInfo patternInfo;
+	memset(&patternInfo, 0, sizeof(patternInfo));
+	patternInfo.Type = (u32)udtPatternType::FragSequences;
+	patternInfo.TypeSpecificInfo = &fragRunInfo;
+
+	udtPatternSearchArg patternArg;
+	memset(&patternArg, 0, sizeof(patternArg));
+	patternArg.Patterns = &patternInfo;
+	patternArg.PatternCount = 1;
+	patternArg.StartOffsetSec = 5;
+	patternArg.EndOffsetSec = 5;
+	patternArg.PlayerIndex = (s32)udtPlayerIndex::DemoTaker;
+
+	s32 result = (s32)udtErrorCode::None;
+	switch(job.Type)
+	{
+		case BenchJobType::Parse:
+		case BenchJobType::PlugIn:
+		{
+			const u32 plugInId = job.PlugInId;
+			info.PlugIns = job.Type == BenchJobType::Parse ? plugInIds : &plugInId;
+			info.PlugInCount = job.Type == BenchJobType::Parse ? (u32)udtParserPlugIn::Count : 1;
+			udtParserContextGroup* contextGroup = NULL;
+			result = udtParseDemoFiles(&contextGroup, &info, &threadInfo);
+			udtDestroyContextGroup(contextGroup);
+			break;
+		}
+
+		case BenchJobType::FindPatterns:
+		{
+			udtPatternSearchContext* searchContext = NULL;
+			result = udtFindPatternsInDemoFiles(&searchContext, &info, &threadInfo, &patternArg);
+			udtDestroySearchContext(searchContext);
+			break;
+		}
+
+		case BenchJobType::CutByPattern:
+			result = udtCutDemoFilesByPattern(&info, &threadInfo, &patternArg);
+			break;
+
+		case BenchJobType::CutByPatternSinglePass:
+			patternArg.Flags |= (u32)udtPatternSearchArgMask::SinglePass;
+			result = udtCutDemoFilesByPattern(&info, &threadInfo, &patternArg);
+			break;
+
+		case BenchJobType::CutByTime:
+		{
+			udtVMArray<udtCut> cuts("Bench::CutsArray");
+			udtVMArray<u32> demoInputIndices("Bench::DemoInputIndicesArray");
+			cuts.Resize(demoCount);
+			demoInputIndices.Resize(demoCount);
+			for(u32 i = 0; i < demoCount; ++i)
+			{
+				udtCut& cut = cuts[i];
+				memset(&cut, 0, sizeof(cut));
+				cut.StartTimeMs = demos[i].StartTimeMs;
+				cut.EndTimeMs = demos[i].EndTimeMs;
+				cut.GameStateIndex = 0;
+				demoInputIndices[i] = i;
+			}
+
+			udtMultiCutByTimeArg cutInfo;
+			memset(&cutInfo, 0, sizeof(cutInfo));
+			cutInfo.Cuts = cuts.GetStartAddress();
+			cutInfo.DemoInputIndices = demoInputIndices.GetStartAddress();
+			cutInfo.CutCount = demoCount;
+			result = udtCutDemoFilesByTime(&info, &threadInfo, &cutInfo);
+			break;
+		}
+
+		case BenchJobType::Convert:
+		{
+			udtProtocolConversionArg conversionArg;
+			memset(&conversionArg, 0, sizeof(conversionArg));
+			conversionArg.OutputProtocol = (u32)GetConversionOutputProtocol(demos[0].Protocol);
+			result = udtConvertDemoFiles(&info, &threadInfo, &conversionArg);
+			break;
+		}
+
+		case BenchJobType::TimeShift:
+		{
+			udtTimeShiftArg timeShiftArg;
+			memset(&timeShiftArg, 0, sizeof(timeShiftArg));
+			timeShiftArg.SnapshotCount = 2;
+			result = udtTimeShiftDemoFiles(&info, &threadInfo, &timeShiftArg);
+			break;
+		}
+
+		case BenchJobType::Merge:
+		{
+			// The merger doesn't fill in the performance stats.
+			memset(perfStats, 0, sizeof(u64) * (size_t)udtPerfStatsField::Count);
+			for(u32 i = 0; i < demoCount; ++i)
+			{
+				const char* mergePaths[2] = { filePaths[i], filePaths[i] };
+				errorCodes[i] = udtMergeDemoFiles(&info, mergePaths, 2);
+			}
+			break;
+		}
+
+		case BenchJobType::ExportJSON:
+		{
+			info.PlugIns = plugInIds;
+			info.PlugInCount = (u32)udtParserPlugIn::Count;
+			udtJSONArg jsonInfo;
+			memset(&jsonInfo, 0, sizeof(jsonInfo));
+			result = udtSaveDemoFilesAnalysisDataToJSON(&info, &threadInfo, &jsonInfo);
+			break;
+		}
+
+		case BenchJobType::Probe:
+		{
+			udtProbeArg probeInfo;
+			memset(&probeInfo, 0, sizeof(probeInfo));
+			probeInfo.MaxSnapshotCount = 1;
+			udtProbeContext* probeContext = NULL;
+			result = udtProbeDemoFiles(&probeContext, &info, &threadInfo, &probeInfo);
+			udtDestroyProbeContext(probeContext);
+			break;
+		}
+
+		default:
+			result = (s32)udtErrorCode::InvalidArgument;
+			break;
+	}
+
+	if(result != (s32)udtErrorCode::None)
+	{
+		return result;
+	}
+
+	for(u32 i = 0; i < demoCount; ++i)
+	{
+		if(errorCodes[i] != (s32)udtErrorCode::None)
+		{
+			fprintf(stderr, "Job '%s' failed on demo file %s\n", job.Name, filePaths[i]);
+			return errorCodes[i];
+		}
+	}
+
+	return (s32)udtErrorCode::None;
+}
+
+static void ComputeStats(BenchStats& stats, const BenchRun* runs, u32 runCount, u64 amount)
+{
+	// Runs must be sorted by ascending duration.
+	stats.Max = (f64)amount * 1000000.0 / (f64)runs[0].DurationUs;
+	stats.Median = (f64)amount * 1000000.0 / (f64)runs[runCount / 2].DurationUs;
+	stats.Min = (f64)amount * 1000000.0 / (f64)runs[runCount - 1].DurationUs;
+}
+
+static bool WriteCSVLine(udtFileStream& file, const char* line)
+{
+	return file.Write(line, (u32)strlen(line), 1) == 1;
+}
+
+static bool RunBenchmark(const BenchDemo* allDemos, u32 allDemoCount, const BenchConfig& config)
+{
+	udtFileStream csvFile;
+	if(config.CSVFilePath != NULL)
+	{
+		if(!csvFile.Open(config.CSVFilePath, udtFileOpenMode::Write) ||
+		   !WriteCSVLine(csvFile, "version,job,protocol,threads,runs,demos,bytes,messages,snapshots,"
+		                          "min_mb_s,median_mb_s,max_mb_s,min_messages_s,median_messages_s,max_messages_s,"
+		                          "min_snapshots_s,median_snapshots_s,max_snapshots_s\n"))
+		{
+			fprintf(stderr, "Failed to write to CSV file %s\n", config.CSVFilePath);
+			return false;
+		}
+	}
+
+	udtVMArray<BenchJob> jobs("Bench::JobsArray");
+	CreateJobList(jobs);
+
+	// The demo list is grouped by protocol so that each group can be handed to the library as is.
+	udtVMArray<BenchDemo> demos("Bench::DemosArray");
+	u32 groupFirstIndices[udtProtocol::Count + 1];
+	for(u32 p = 0; p < (u32)udtProtocol::Count; ++p)
+	{
+		groupFirstIndices[p] = demos.GetSize();
+		for(u32 i = 0; i < allDemoCount; ++i)
+		{
+			if((u32)allDemos[i].Protocol == p)
+			{
+				demos.Add(allDemos[i]);
+			}
+		}
+	}
+	groupFirstIndices[udtProtocol::Count] = demos.GetSize();
+
+	printf("UDT library version %s, %u demo(s), %u run(s) per job, %u thread(s) max.\n", udtGetVersionString(), demos.GetSize(), config.RunCount, config.MaxThreadCount);
+	printf("%-18s %-6s %5s %8s | %8s %8s %8s | %8s %8s %8s | %8s %8s %8s\n",
+		   "job", "proto", "demos", "MB", "min MB/s", "med MB/s", "max MB/s", "min kM/s", "med kM/s", "max kM/s", "min kS/s", "med kS/s", "max kS/s");
+
+	udtVMArray<BenchRun> runs("Bench::RunsArray");
+	u64 perfStats[udtPerfStatsField::Count];
+	char line[1024];
+	bool success = true;
+	udtTimer timer;
+	for(u32 j = 0, jobCount = jobs.GetSize(); j < jobCount; ++j)
+	{
+		const BenchJob& job = jobs[j];
+		for(u32 p = 0; p < (u32)udtProtocol::Count; ++p)
+		{
+			const u32 firstDemoIdx = groupFirstIndices[p];
+			const u32 demoCount = groupFirstIndices[p + 1] - firstDemoIdx;
+			if(demoCount == 0 || !IsJobSupported(job.Type, (udtProtocol::Id)p))
+			{
+				continue;
+			}
+
+			u64 byteCount = 0;
+			for(u32 i = 0; i < demoCount; ++i)
+			{
+				byteCount += demos[firstDemoIdx + i].ByteCount;
+			}
+
+			runs.Clear();
+			s32 result = (s32)udtErrorCode::None;
+			for(u32 r = 0; r < config.RunCount; ++r)
+			{
+				timer.Restart();
+				result = RunJobOnce(job, config, demos.GetStartAddress() + firstDemoIdx, demoCount, perfStats);
+				timer.Stop();
+				if(result != (s32)udtErrorCode::None)
+				{
+					break;
+				}
+
+				BenchRun run;
+				run.DurationUs = udt_max(timer.GetElapsedUs(), (u64)1);
+				run.MessageCount = perfStats[udtPerfStatsField::MessageCount];
+				run.SnapshotCount = perfStats[udtPerfStatsField::SnapshotCount];
+				runs.Add(run);
+			}
+
+			const char* const protocolName = udtGetFileExtensionByProtocol(p) + 1;
+			if(result != (s32)udtErrorCode::None)
+			{
+				fprintf(stderr, "Job '%s' failed on protocol %s with error: %s\n", job.Name, protocolName, udtGetErrorCodeString(result));
+				success = false;
+				continue;
+			}
+
+			std::sort(runs.GetStartAddress(), runs.GetEndAddress(), [](const BenchRun& a, const BenchRun& b) { return a.DurationUs < b.DurationUs; });
+			const u64 messageCount = runs[0].MessageCount;
+			const u64 snapshotCount = runs[0].SnapshotCount;
+			BenchStats byteStats;
+			BenchStats messageStats;
+			BenchStats snapshotStats;
+			ComputeStats(byteStats, runs.GetStartAddress(), config.RunCount, byteCount);
+			ComputeStats(messageStats, runs.GetStartAddress(), config.RunCount, messageCount);
+			ComputeStats(snapshotStats, runs.GetStartAddress(), config.RunCount, snapshotCount);
+
+			const f64 mb = 1024.0 * 1024.0;
+			printf("%-18s %-6s %5u %8.1f | %8.1f %8.1f %8.1f | ",
+				   job.Name, protocolName, demoCount, (f64)byteCount / mb,
+				   byteStats.Min / mb, byteStats.Median / mb, byteStats.Max / mb);
+			if(messageCount > 0)
+			{
+				printf("%8.1f %8.1f %8.1f | %8.1f %8.1f %8.1f\n",
+					   messageStats.Min / 1000.0, messageStats.Median / 1000.0, messageStats.Max / 1000.0,
+					   snapshotStats.Min / 1000.0, snapshotStats.Median / 1000.0, snapshotStats.Max / 1000.0);
+			}
+			else
+			{
+				printf("%8s %8s %8s | %8s %8s %8s\n", "-", "-", "-", "-", "-", "-");
+			}
+
+			if(config.CSVFilePath != NULL)
+			{
+				sprintf(line, "%s,%s,%s,%u,%u,%u,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+						udtGetVersionString(), job.Name, protocolName, config.MaxThreadCount, config.RunCount, demoCount,
+						(unsigned long long)byteCount, (unsigned long long)messageCount, (unsigned long long)snapshotCount,
+						byteStats.Min / mb, byteStats.Median / mb, byteStats.Max / mb,
+						messageStats.Min, messageStats.Median, messageStats.Max,
+						snapshotStats.Min, snapshotStats.Median, snapshotStats.Max);
+				if(!WriteCSVLine(csvFile, line))
+				{
+					fprintf(stderr, "Failed to write to CSV file %s\n", config.CSVFilePath);
+					return false;
+				}
+			}
+		}
+	}
+
+	return success;
+}
+
+int udt_main(int argc, char** argv)
+{
+	if(argc < 2)
+	{
+		PrintHelp();
+		return 0;
+	}
+
+	// The input path is optional and always comes last.
+	const char* inputPath = UDT_BENCH_DEFAULT_CORPUS_PATH;
+	int optionEnd = argc;
+	bool recursive = false;
+	if(argv[argc - 1][0] != '-')
+	{
+		inputPath = argv[argc - 1];
+		optionEnd = argc - 1;
+	}
+	else
+	{
+		// The default corpus has one sub-folder per protocol.
+		recursive = true;
+	}
+
+	BenchConfig config;
+	config.OutputFolderPath = NULL;
+	config.CSVFilePath = NULL;
+	config.RunCount = UDT_BENCH_DEFAULT_RUN_COUNT;
+	config.MaxThreadCount = 1;
+	for(int i = 1; i < optionEnd; ++i)
+	{
+		s32 localRunCount = 0;
+		s32 localMaxThreadCount = 0;
+
+		const udtString arg = udtString::NewConstRef(argv[i]);
+		if(udtString::Equals(arg, "-r"))
+		{
+			recursive = true;
+		}
+		else if(udtString::StartsWith(arg, "-n=") &&
+				arg.GetLength() >= 4 &&
+				StringParseInt(localRunCount, arg.GetPtr() + 3) &&
+				localRunCount >= 1 &&
+				localRunCount <= 1000)
+		{
+			config.RunCount = (u32)localRunCount;
+		}
+		else if(udtString::StartsWith(arg, "-t=") &&
+				arg.GetLength() >= 4 &&
+				StringParseInt(localMaxThreadCount, arg.GetPtr() + 3) &&
+				localMaxThreadCount >= 1 &&
+				localMaxThreadCount <= 16)
+		{
+			config.MaxThreadCount = (u32)localMaxThreadCount;
+		}
+		else if(udtString::StartsWith(arg, "-c=") &&
+				arg.GetLength() >= 4)
+		{
+			config.CSVFilePath = argv[i] + 3;
+		}
+		else if(udtString::StartsWith(arg, "-o=") &&
+				arg.GetLength() >= 4 &&
+				IsValidDirectory(argv[i] + 3))
+		{
+			config.OutputFolderPath = argv[i] + 3;
+		}
+	}
+
+	if(config.OutputFolderPath == NULL)
+	{
+		fprintf(stderr, "Invalid or unspecified output folder path.\n");
+		return 1;
+	}
+
+	udtFileListQuery query;
+	if(udtFileStream::Exists(inputPath) && udtPath::HasValidDemoFileExtension(inputPath))
+	{
+		udtFileStream file;
+		udtFileInfo fileInfo;
+		fileInfo.Name = udtString::NewNull();
+		fileInfo.Path = udtString::NewConstRef(inputPath);
+		fileInfo.Size = file.Open(inputPath, udtFileOpenMode::Read) ? file.Length() : 0;
+		query.Files.Add(fileInfo);
+	}
+	else if(IsValidDirectory(inputPath))
+	{
+		query.FileFilter = &KeepOnlyDemoFiles;
+		query.FolderPath = udtString::NewConstRef(inputPath);
+		query.Recursive = recursive;
+		GetDirectoryFileList(query);
+	}
+	else
+	{
+		fprintf(stderr, "Invalid file/folder path.\n");
+		return 1;
+	}
+
+	udtVMArray<BenchDemo> demos("Bench::LoadedDemosArray");
+	if(query.Files.IsEmpty() ||
+	   !LoadDemos(demos, query.Files.GetStartAddress(), query.Files.GetSize(), config.MaxThreadCount))
+	{
+		fprintf(stderr, "No valid demo file found.\n");
+		return 1;
+	}
+
+	return RunBenchmark(demos.GetStartAddress(), demos.GetSize(), config) ? 0 : 1;
+}
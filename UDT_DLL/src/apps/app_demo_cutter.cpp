@@ -21,7 +21,7 @@ void PrintHelp()
 	printf("Cuts demos by time, chat or matches.\n");
 	printf("\n");
 	printf("UDT_cutter t [-o=outputfolder] [-q] [-g=gamestateindex] -s=starttime -e=endtime inputfile\n");
-	printf("UDT_cutter c [-o=outputfolder] [-q] [-t=maxthreads] [-r] -c=configpath inputfile|inputfolder\n");
+	printf("UDT_cutter c [-o=outputfolder] [-q] [-t=maxthreads] [-r] [-p] -c=configpath inputfile|inputfolder\n");
 	printf("UDT_cutter m [-o=outputfolder] [-q] [-t=maxthreads] [-r] [-s=startoffset] [-e=endoffset] inputfile|inputfolder\n");
 	printf("UDT_cutter g -c=configpath\n");
 	printf("\n");
@@ -31,6 +31,7 @@ void PrintHelp()
 	printf("g     generate a cut by chat example config\n");
 	printf("-q    quiet mode: no logging to stdout    (default: off)\n");
 	printf("-r    enable recursive demo file search   (default: off)\n");
+	printf("-p    cut by chat in a single pass        (default: off)\n");
 	printf("-o=p  set the output folder path to p     (default: input folder)\n");
 	printf("-g=N  set the game state index to N       (default: 0)\n");
 	printf("-t=N  set the maximum thread count to N   (default: 1)\n");
@@ -78,6 +79,7 @@ struct CutByChatConfig
 	int MaxThreadCount = 1;
 	int StartOffsetSec = 10;
 	int EndOffsetSec = 10;
+	bool SinglePass = false;
 };
 
 
@@ -299,6 +301,7 @@ static bool CutByChatBatch(udtParseArg& parseArg, const udtFileInfo* files, cons
 	patternArg.EndOffsetSec = (u32)config.EndOffsetSec;
 	patternArg.PatternCount = 1;
 	patternArg.Patterns = &patternInfo;
+	if(config.SinglePass) patternArg.Flags |= (u32)udtPatternSearchArgMask::SinglePass;
 
 	const s32 result = udtCutDemoFilesByPattern(&parseArg, &threadInfo, &patternArg);
 
@@ -502,6 +505,7 @@ struct ProgramOptions
 	s32 StartTimeSec = UDT_S32_MIN; // -s=
 	s32 EndTimeSec = UDT_S32_MIN; // -e=
 	bool Recursive = false;	 // -r
+	bool SinglePass = false; // -p
 };
 
 static bool LoadChatConfig(CutByChatConfig& config, const ProgramOptions& options)
@@ -514,6 +518,7 @@ static bool LoadChatConfig(CutByChatConfig& config, const ProgramOptions& option
 
 	config.CustomOutputFolder = options.OutputFolderPath;
 	config.MaxThreadCount = (int)options.MaxThreadCount;
+	config.SinglePass = options.SinglePass;
 	if(options.StartTimeSec > 0) config.StartOffsetSec = (int)options.StartTimeSec;
 	if(options.EndTimeSec > 0) config.EndOffsetSec = (int)options.EndTimeSec;
 
@@ -570,6 +575,10 @@ int udt_main(int argc, char** argv)
 		{
 			options.Recursive = true;
 		}
+		else if(udtString::Equals(arg, "-p"))
+		{
+			options.SinglePass = true;
+		}
 		else if(udtString::StartsWith(arg, "-c=") &&
 				arg.GetLength() >= 4)
 		{
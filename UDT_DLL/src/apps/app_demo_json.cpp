@@ -10,17 +10,23 @@
 
 
 #define    UDT_JSON_BATCH_SIZE    256
+#define    UDT_JSON_BINARY_FILE_NAME_FORMAT    "udt_analysis_data_%03u.udtad"
+#define    UDT_JSON_NDJSON_FILE_NAME_FORMAT    "udt_analysis_data_%03u.ndjson"
 
 
 void PrintHelp()
 {
 	printf("For each input demo, outputs JSON data with analysis results to one file per demo or optionally to the terminal.\n");
 	printf("\n");
-	printf("UDT_json [-c] [-r] [-q] [-t=maxthreads] [-a=analyzers] [-o=outputfolder] inputfile|inputfolder\n");
+	printf("UDT_json [-c] [-b] [-n] [-m] [-r] [-q] [-t=maxthreads] [-a=analyzers] [-o=outputfolder] [-k=cachefolder] inputfile|inputfolder\n");
 	printf("\n");
 	printf("-q    quiet mode: no logging to stdout        (default: off)\n");
 	printf("-o=p  set the output folder path to p         (default: the input's folder)\n");
+	printf("-k=p  cache the analysis results in folder p  (default: no caching)\n");
 	printf("-c    output to the console/terminal          (default: off)\n");
+	printf("-b    output one binary file per batch        (default: off)\n");
+	printf("-n    output one NDJSON file per batch        (default: off)\n");
+	printf("-m    minified JSON output: no white space    (default: off)\n");
 	printf("-r    enable recursive demo file search       (default: off)\n");
 	printf("-t=N  set the maximum number of threads to N  (default: 1)\n");
 	printf("-a=   select analyzers                        (default: all enabled)\n");
@@ -34,6 +40,15 @@ void PrintHelp()
 	printf("still be active, so make sure you only read the stdout output from your programs and scripts.\n");
 	printf("\n");
 	printf("Example for selecting analyzers: -a=sd will select stats and deaths.\n");
+	printf("\n");
+	printf("The binary output option -b writes the data of up to %d demos to each file instead of using JSON.\n", UDT_JSON_BATCH_SIZE);
+	printf("The files are named " UDT_JSON_BINARY_FILE_NAME_FORMAT " and can be read back with udtLoadAnalysisDataFile.\n", 0);
+	printf("\n");
+	printf("The NDJSON output option -n writes the data of up to %d demos to each file with one line of JSON per demo.\n", UDT_JSON_BATCH_SIZE);
+	printf("The files are named " UDT_JSON_NDJSON_FILE_NAME_FORMAT ", with the thread index appended when using more than 1 thread.\n", 0);
+	printf("When combined with -c, the lines are written to the terminal instead.\n");
+	printf("\n");
+	printf("With the cache option -k, demos whose results are all in the cache folder aren't parsed again.\n");
 }
 
 static bool KeepOnlyDemoFiles(const char* name, u64 /*size*/, void* /*userData*/)
@@ -65,7 +80,7 @@ static void CallbackConsoleMessageNoStdOut(s32 logLevel, const char* message)
 	fprintf(stderr, "%s%s\n", logLevel == 2 ? "Error: " : "Fatal: ", message);
 }
 
-static bool ProcessBatch(udtParseArg& parseArg, const udtFileInfo* files, u32 fileCount, bool consoleOutput, u32 maxThreadCount)
+static bool ProcessBatch(udtParseArg& parseArg, const udtFileInfo* files, u32 fileCount, bool consoleOutput, u32 jsonFlags, u32 maxThreadCount, const char* batchFilePath)
 {
 	udtVMArray<const char*> filePaths("ProcessMultipleDemos::FilePathsArray");
 	udtVMArray<s32> errorCodes("ProcessMultipleDemos::ErrorCodesArray");
@@ -88,11 +103,27 @@ static bool ProcessBatch(udtParseArg& parseArg, const udtFileInfo* files, u32 fi
 	threadInfo.FileCount = fileCount;
 	threadInfo.MaxThreadCount = maxThreadCount;
 
-	udtJSONArg jsonInfo;
-	memset(&jsonInfo, 0, sizeof(jsonInfo));
-	jsonInfo.ConsoleOutput = consoleOutput ? 1 : 0;
+	// The batch file is binary unless newline-delimited JSON was requested.
+	const bool binaryOutput = batchFilePath != NULL && (jsonFlags & (u32)udtJSONArgFlag::NDJSON) == 0;
+	s32 result;
+	if(binaryOutput)
+	{
+		udtBinaryExportArg binaryInfo;
+		memset(&binaryInfo, 0, sizeof(binaryInfo));
+		binaryInfo.OutputFilePath = batchFilePath;
+
+		result = udtSaveDemoFilesAnalysisDataToBinary(&parseArg, &threadInfo, &binaryInfo);
+	}
+	else
+	{
+		udtJSONArg jsonInfo;
+		memset(&jsonInfo, 0, sizeof(jsonInfo));
+		jsonInfo.ConsoleOutput = consoleOutput ? 1 : 0;
+		jsonInfo.Flags = jsonFlags;
+		jsonInfo.OutputFilePath = batchFilePath;
 
-	const s32 result = udtSaveDemoFilesAnalysisDataToJSON(&parseArg, &threadInfo, &jsonInfo);
+		result = udtSaveDemoFilesAnalysisDataToJSON(&parseArg, &threadInfo, &jsonInfo);
+	}
 
 	udtVMLinearAllocator tempAllocator("ProcessMultipleDemos::Temp");
 	for(u32 i = 0; i < fileCount; ++i)
@@ -112,26 +143,42 @@ static bool ProcessBatch(udtParseArg& parseArg, const udtFileInfo* files, u32 fi
 		return true;
 	}
 
-	fprintf(stderr, "udtSaveDemoFilesAnalysisDataToJSON failed with error: %s\n", udtGetErrorCodeString(result));
+	fprintf(stderr, "%s failed with error: %s\n", 
+			binaryOutput ? "udtSaveDemoFilesAnalysisDataToBinary" : "udtSaveDemoFilesAnalysisDataToJSON",
+			udtGetErrorCodeString(result));
 
 	return false;
 }
 
-static bool ProcessMultipleDemos(const udtFileInfo* files, u32 fileCount, const char* customOutputFolder, bool consoleOutput, u32 maxThreadCount, const u32* plugInIds, u32 plugInCount)
+static bool ProcessMultipleDemos(const udtFileInfo* files, u32 fileCount, const char* customOutputFolder, bool consoleOutput, u32 jsonFlags, u32 maxThreadCount, const u32* plugInIds, u32 plugInCount, const char* batchFolder, const char* cacheFolder)
 {
 	CmdLineParseArg cmdLineParseArg;
 	udtParseArg& parseArg = cmdLineParseArg.ParseArg;
 	parseArg.PlugIns = plugInIds;
 	parseArg.PlugInCount = plugInCount;
 	parseArg.OutputFolderPath = customOutputFolder;
+	parseArg.CacheFolderPath = cacheFolder;
 
+	udtVMLinearAllocator filePathAllocator("ProcessMultipleDemos::FilePath");
 	BatchRunner runner(parseArg, files, fileCount, UDT_JSON_BATCH_SIZE);
 	const u32 batchCount = runner.GetBatchCount();
 	for(u32 i = 0; i < batchCount; ++i)
 	{
+		const char* batchFilePath = NULL;
+		if(batchFolder != NULL)
+		{
+			const bool ndjson = (jsonFlags & (u32)udtJSONArgFlag::NDJSON) != 0;
+			char batchFileName[64];
+			sprintf(batchFileName, ndjson ? UDT_JSON_NDJSON_FILE_NAME_FORMAT : UDT_JSON_BINARY_FILE_NAME_FORMAT, i);
+			udtString filePath;
+			filePathAllocator.Clear();
+			udtPath::Combine(filePath, filePathAllocator, udtString::NewConstRef(batchFolder), batchFileName);
+			batchFilePath = filePath.GetPtr();
+		}
+
 		runner.PrepareNextBatch();
 		const BatchRunner::BatchInfo& info = runner.GetBatchInfo(i);
-		if(!ProcessBatch(parseArg, files + info.FirstFileIndex, info.FileCount, consoleOutput, maxThreadCount))
+		if(!ProcessBatch(parseArg, files + info.FirstFileIndex, info.FileCount, consoleOutput, jsonFlags, maxThreadCount, batchFilePath))
 		{
 			return false;
 		}
@@ -161,11 +208,14 @@ int udt_main(int argc, char** argv)
 	}
 
 	const char* customOutputPath = NULL;
+	const char* cacheFolderPath = NULL;
 	u32 maxThreadCount = 1;
 	u32 analyzerCount = (u32)udtParserPlugIn::Count;
 	u32 analyzers[udtParserPlugIn::Count];
 	bool recursive = false;
 	bool consoleOutput = false;
+	bool binaryOutput = false;
+	u32 jsonFlags = 0;
 
 	for(u32 i = 0; i < (u32)udtParserPlugIn::Count; ++i)
 	{
@@ -185,12 +235,30 @@ int udt_main(int argc, char** argv)
 		{
 			consoleOutput = true;
 		}
+		else if(udtString::Equals(arg, "-b"))
+		{
+			binaryOutput = true;
+		}
+		else if(udtString::Equals(arg, "-n"))
+		{
+			jsonFlags |= (u32)udtJSONArgFlag::NDJSON;
+		}
+		else if(udtString::Equals(arg, "-m"))
+		{
+			jsonFlags |= (u32)udtJSONArgFlag::Compact;
+		}
 		else if(udtString::StartsWith(arg, "-o=") && 
 				arg.GetLength() >= 4 &&
 				IsValidDirectory(argv[i] + 3))
 		{
 			customOutputPath = argv[i] + 3;
 		}
+		else if(udtString::StartsWith(arg, "-k=") && 
+				arg.GetLength() >= 4 &&
+				IsValidDirectory(argv[i] + 3))
+		{
+			cacheFolderPath = argv[i] + 3;
+		}
 		else if(udtString::StartsWith(arg, "-t=") && 
 				arg.GetLength() >= 4 &&
 				StringParseInt(localMaxThreads, arg.GetPtr() + 3) &&
@@ -222,6 +290,34 @@ int udt_main(int argc, char** argv)
 		}
 	}
 
+	// Binary output takes precedence over NDJSON output.
+	if(binaryOutput)
+	{
+		jsonFlags &= ~(u32)udtJSONArgFlag::NDJSON;
+		consoleOutput = false;
+	}
+
+	// The terminal output option only works in file mode.
+	if(!fileMode)
+	{
+		consoleOutput = false;
+	}
+
+	// The batch files go to the output folder or next to the input.
+	// NDJSON lines written to the terminal don't need any.
+	const char* batchFolder = NULL;
+	udtVMLinearAllocator folderAllocator("Main::Folder");
+	if(binaryOutput || ((jsonFlags & (u32)udtJSONArgFlag::NDJSON) != 0 && !consoleOutput))
+	{
+		batchFolder = customOutputPath != NULL ? customOutputPath : inputPath;
+		if(customOutputPath == NULL && fileMode)
+		{
+			udtString folderPath;
+			udtPath::GetFolderPath(folderPath, folderAllocator, udtString::NewConstRef(inputPath));
+			batchFolder = udtString::IsNullOrEmpty(folderPath) ? "." : folderPath.GetPtr();
+		}
+	}
+
 	if(fileMode)
 	{
 		udtFileInfo fileInfo;
@@ -229,7 +325,7 @@ int udt_main(int argc, char** argv)
 		fileInfo.Path = udtString::NewConstRef(inputPath);
 		fileInfo.Size = 0;
 
-		return ProcessMultipleDemos(&fileInfo, 1, customOutputPath, consoleOutput, maxThreadCount, analyzers, analyzerCount) ? 0 : 1;
+		return ProcessMultipleDemos(&fileInfo, 1, customOutputPath, consoleOutput, jsonFlags, maxThreadCount, analyzers, analyzerCount, batchFolder, cacheFolderPath) ? 0 : 1;
 	}
 
 	udtFileListQuery query;
@@ -243,7 +339,7 @@ int udt_main(int argc, char** argv)
 		return 1;
 	}
 
-	if(!ProcessMultipleDemos(query.Files.GetStartAddress(), query.Files.GetSize(), customOutputPath, false, maxThreadCount, analyzers, analyzerCount))
+	if(!ProcessMultipleDemos(query.Files.GetStartAddress(), query.Files.GetSize(), customOutputPath, false, jsonFlags, maxThreadCount, analyzers, analyzerCount, batchFolder, cacheFolderPath))
 	{
 		return 1;
 	}
@@ -0,0 +1,231 @@
+#include "shared.hpp"
+#include "parser_context.hpp"
+#include "parser_runner.hpp"
+#include "memory_stream.hpp"
+#include "file_stream.hpp"
+#include "file_system.hpp"
+#include "path.hpp"
+#include "timer.hpp"
+#include "utils.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+
+#define    UDT_HUFFMAN_BENCH_DEFAULT_RUN_COUNT    5
+
+
+void PrintHelp()
+{
+	printf("Parses demos from memory with the single-symbol and the multi-symbol Huffman decoders and compares their speed.\n");
+	printf("\n");
+	printf("UDT_huffman_bench [-r] [-n=runcount] inputfile|inputfolder\n");
+	printf("\n");
+	printf("-r    enable recursive demo file search  (default: off)\n");
+	printf("-n=N  parse all demos N times per mode   (default: %d)\n", UDT_HUFFMAN_BENCH_DEFAULT_RUN_COUNT);
+}
+
+struct DemoData
+{
+	udtString FilePath;
+	uptr DataOffset;
+	u32 ByteCount;
+	udtProtocol::Id Protocol;
+};
+
+static bool KeepOnlyDemoFiles(const char* name, u64 /*size*/, void* /*userData*/)
+{
+	return udtPath::HasValidDemoFileExtension(name);
+}
+
+static bool ParseDemoFromMemory(udtParserContext& context, const DemoData& demo, const u8* data, bool multiSymbol)
+{
+	udtReadOnlyMemoryStream stream;
+	if(!stream.Open(data, demo.ByteCount))
+	{
+		return false;
+	}
+
+	context.ResetForNextDemo(false);
+	context.Parser.MultiSymbolHuffman = multiSymbol;
+	if(!context.Parser.Init(&context.Context, demo.Protocol, demo.Protocol, 0, false))
+	{
+		return false;
+	}
+
+	context.Parser.SetFilePath(demo.FilePath.GetPtr());
+
+	return RunParser(context.Parser, stream, NULL);
+}
+
+static bool RunBenchmark(const udtFileInfo* files, u32 fileCount, u32 runCount)
+{
+	udtVMLinearAllocator dataAllocator("HuffmanBench::Data");
+	udtVMArray<DemoData> demos("HuffmanBench::DemosArray");
+	u64 totalByteCount = 0;
+	for(u32 i = 0; i < fileCount; ++i)
+	{
+		const char* const filePath = files[i].Path.GetPtr();
+		const udtProtocol::Id protocol = (udtProtocol::Id)udtGetProtocolByFilePath(filePath);
+		if(protocol < udtProtocol::Dm66)
+		{
+			// The older protocols don't use Huffman compression.
+			continue;
+		}
+
+		udtFileStream file;
+		if(!file.Open(filePath, udtFileOpenMode::Read))
+		{
+			fprintf(stderr, "Failed to open demo file %s\n", filePath);
+			continue;
+		}
+
+		DemoData demo;
+		demo.FilePath = files[i].Path;
+		demo.ByteCount = (u32)file.Length();
+		demo.DataOffset = file.ReadAll(dataAllocator);
+		demo.Protocol = protocol;
+		if(demo.DataOffset == uptr(~0))
+		{
+			fprintf(stderr, "Failed to read demo file %s\n", filePath);
+			continue;
+		}
+
+		demos.Add(demo);
+		totalByteCount += (u64)demo.ByteCount;
+	}
+
+	if(demos.IsEmpty())
+	{
+		fprintf(stderr, "No demo file with Huffman-compressed messages found.\n");
+		return false;
+	}
+
+	udtParserContext* const context = udtCreateContext();
+	if(context == NULL)
+	{
+		return false;
+	}
+
+	context->Context.SetCallbacks(NULL, NULL, NULL);
+
+	// Runs of both modes are interleaved so that they're equally affected by the machine's state.
+	udtVMArray<u64> singleSymbolDurationsUs("HuffmanBench::SingleSymbolDurationsArray");
+	udtVMArray<u64> multiSymbolDurationsUs("HuffmanBench::MultiSymbolDurationsArray");
+	udtVMArray<u64>* const durationsUs[2] = { &singleSymbolDurationsUs, &multiSymbolDurationsUs };
+	bool success = true;
+	udtTimer timer;
+	for(u32 run = 0; run < runCount && success; ++run)
+	{
+		for(u32 mode = 0; mode < 2 && success; ++mode)
+		{
+			timer.Restart();
+			for(u32 i = 0, count = demos.GetSize(); i < count; ++i)
+			{
+				const DemoData& demo = demos[i];
+				if(!ParseDemoFromMemory(*context, demo, dataAllocator.GetAddressAt(demo.DataOffset), mode == 1))
+				{
+					fprintf(stderr, "Failed to parse demo file %s\n", demo.FilePath.GetPtr());
+					success = false;
+					break;
+				}
+			}
+			timer.Stop();
+			durationsUs[mode]->Add(udt_max(timer.GetElapsedUs(), (u64)1));
+		}
+	}
+
+	udtDestroyContext(context);
+
+	if(!success)
+	{
+		return false;
+	}
+
+	printf("%u demo(s), %.1f MB, %u run(s) per mode\n", demos.GetSize(), (f64)totalByteCount / (1024.0 * 1024.0), runCount);
+	printf("%-14s %12s %12s %12s\n", "Huffman", "min MB/s", "median MB/s", "max MB/s");
+
+	f64 medianThroughputs[2];
+	const char* const modeNames[2] = { "single-symbol", "multi-symbol" };
+	for(u32 mode = 0; mode < 2; ++mode)
+	{
+		u64* const durations = durationsUs[mode]->GetStartAddress();
+		std::sort(durations, durations + runCount);
+		const f64 mb = (f64)totalByteCount / (1024.0 * 1024.0);
+		const f64 maxThroughput = mb * 1000000.0 / (f64)durations[0];
+		const f64 medianThroughput = mb * 1000000.0 / (f64)durations[runCount / 2];
+		const f64 minThroughput = mb * 1000000.0 / (f64)durations[runCount - 1];
+		medianThroughputs[mode] = medianThroughput;
+		printf("%-14s %12.1f %12.1f %12.1f\n", modeNames[mode], minThroughput, medianThroughput, maxThroughput);
+	}
+
+	printf("Median speed-up: %.3fx\n", medianThroughputs[1] / medianThroughputs[0]);
+
+	return true;
+}
+
+int udt_main(int argc, char** argv)
+{
+	if(argc < 2)
+	{
+		PrintHelp();
+		return 0;
+	}
+
+	bool fileMode = false;
+	const char* const inputPath = argv[argc - 1];
+	if(udtFileStream::Exists(inputPath) && udtPath::HasValidDemoFileExtension(inputPath))
+	{
+		fileMode = true;
+	}
+	else if(!IsValidDirectory(inputPath))
+	{
+		fprintf(stderr, "Invalid file/folder path.\n");
+		return 1;
+	}
+
+	bool recursive = false;
+	u32 runCount = UDT_HUFFMAN_BENCH_DEFAULT_RUN_COUNT;
+	for(int i = 1; i < argc - 1; ++i)
+	{
+		s32 localRunCount = 0;
+
+		const udtString arg = udtString::NewConstRef(argv[i]);
+		if(udtString::Equals(arg, "-r"))
+		{
+			recursive = true;
+		}
+		else if(udtString::StartsWith(arg, "-n=") &&
+				arg.GetLength() >= 4 &&
+				StringParseInt(localRunCount, arg.GetPtr() + 3) &&
+				localRunCount >= 1 &&
+				localRunCount <= 1000)
+		{
+			runCount = (u32)localRunCount;
+		}
+	}
+
+	if(fileMode)
+	{
+		udtFileInfo fileInfo;
+		fileInfo.Name = udtString::NewNull();
+		fileInfo.Path = udtString::NewConstRef(inputPath);
+		fileInfo.Size = 0;
+
+		return RunBenchmark(&fileInfo, 1, runCount) ? 0 : 1;
+	}
+
+	udtFileListQuery query;
+	query.FileFilter = &KeepOnlyDemoFiles;
+	query.FolderPath = udtString::NewConstRef(inputPath);
+	query.Recursive = recursive;
+	GetDirectoryFileList(query);
+	if(query.Files.IsEmpty())
+	{
+		fprintf(stderr, "No demo file found.\n");
+		return 1;
+	}
+
+	return RunBenchmark(query.Files.GetStartAddress(), query.Files.GetSize(), runCount) ? 0 : 1;
+}
@@ -100,6 +100,22 @@ struct udtVMArray
 		return GetStartAddress() + oldSize;
 	}
 
+	T* Append(const udtVMArray<T>& other) // Returns the address of the first item added.
+	{
+		return Append(other.GetStartAddress(), other.GetSize());
+	}
+
+	T* Append(const T* items, u32 itemsToAdd) // Returns the address of the first item added.
+	{
+		T* const firstNewItem = Extend(itemsToAdd);
+		if(itemsToAdd > 0)
+		{
+			memcpy(firstNewItem, items, (size_t)itemsToAdd * sizeof(T));
+		}
+
+		return firstNewItem;
+	}
+
 	T* ExtendAndMemset(u32 itemsToAdd, u8 value)
 	{
 		const u32 oldSize = GetSize();
@@ -110,7 +126,7 @@ struct udtVMArray
 		return firstNewItem;
 	}
 
-	void ExtendAndSet(u32 itemsToAdd, T value)
+	T* ExtendAndSet(u32 itemsToAdd, T value)
 	{
 		const u32 oldSize = GetSize();
 		const u32 newSize = oldSize + itemsToAdd;
@@ -178,6 +194,12 @@ struct udtVMArray
 		_allocator.SetName(name);
 	}
 
+	// Call before adding items. The items don't get relocated while the reserved address space is enough.
+	void Init(uptr reservedByteCount)
+	{
+		_allocator.Init(reservedByteCount);
+	}
+
 private:
 	UDT_NO_COPY_SEMANTICS(udtVMArray);
 
@@ -22,6 +22,7 @@ udtContext::udtContext()
 	: _messageCallback(NULL)
 	, _progressCallback(NULL)
 	, _progressContext(NULL)
+	, _errorCount(0)
 {
 }
 
@@ -41,6 +42,7 @@ bool udtContext::SetCallbacks(udtMessageCallback messageCb, udtProgressCallback
 
 void udtContext::Reset()
 {
+	_errorCount = 0;
 }
 
 void udtContext::Destroy()
@@ -81,6 +83,7 @@ void udtContext::LogWarning(UDT_PRINTF_FORMAT_ARG const char* format, ...) const
 
 void udtContext::LogError(UDT_PRINTF_FORMAT_ARG const char* format, ...) const
 {
+	++_errorCount;
 	if(!_messageCallback)
 	{
 		return;
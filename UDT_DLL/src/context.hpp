@@ -24,6 +24,7 @@ public:
 	void LogError(UDT_PRINTF_FORMAT_ARG const char* format, ...) const UDT_PRINTF_POST_FUNCTION(2, 3);
 	void LogErrorAndCrash(UDT_PRINTF_FORMAT_ARG const char* format, ...) const UDT_PRINTF_POST_FUNCTION(2, 3);
 	void NotifyProgress(f32 progress) const;
+	u32  GetErrorCount() const { return _errorCount; } // Since the last reset.
 
 	udtProtocolConverter* GetProtocolConverter(udtProtocol::Id outProtocol, udtProtocol::Id inProtocol);
 
@@ -36,6 +37,7 @@ private:
 	udtMessageCallback  _messageCallback;  // Can be NULL.
 	udtProgressCallback _progressCallback; // Can be NULL.
 	void*               _progressContext;  // Can be NULL.
+	mutable u32         _errorCount;
 
 	udtProtocolConverter3to68    _converter3to68;
 	udtProtocolConverter48to68   _converter48to68;
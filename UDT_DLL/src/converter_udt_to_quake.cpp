@@ -411,6 +411,7 @@ void udtdConverter::WriteOutputMessageToFile(bool increaseMessageSequence)
 		++_outMessageSequence;
 	}
 
+	_outMsg.ClearUnusedBits();
 	const s32 messageLength = _outMsg.Buffer.cursize;
 	_output->Write(&_outMessageSequence, 4, 1);
 	_output->Write(&messageLength, 4, 1);
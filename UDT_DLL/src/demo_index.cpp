@@ -0,0 +1,694 @@
+#include "demo_index.hpp"
+#include "file_stream.hpp"
+#include "utils.hpp"
+#include "thread_local_allocators.hpp"
+
+
+/*
+File layout:
+- udtDemoIndexHeader
+- udtDemoIndexKeyframe array
+- data: baselines and config strings of each game state and the parser state of each keyframe
+
+Entity states, snapshots and entity event times are XORed with a reference
+(the baseline or the previous entity state with the same number, the previous
+snapshot, ...) and the result is stored with zero runs packed.
+Most of the bytes end up being zeros, so keyframes stay small.
+For the same reason, keyframes only store the config strings that changed
+since the game state's first snapshot.
+*/
+
+
+#define UDT_DEMO_INDEX_MAGIC      0x58444955 // "UIDX"
+#define UDT_DEMO_INDEX_VERSION    2
+
+// Entity state numbers are stored with this flag when the state is equal to its reference.
+#define UDT_DEMO_INDEX_UNCHANGED_ENTITY    0x8000
+
+
+struct udtDemoIndexHeader
+{
+	u32 Magic;
+	u32 Version;
+	u64 DemoFileLength;
+	u64 DemoFileHash;
+	u32 Protocol;
+	u32 IntervalMs;
+	u32 KeyframeCount;
+	u32 DataByteCount;
+};
+
+struct udtDemoIndexReader
+{
+	const u8* Data;
+	u32 ByteCount;
+	u32 Offset;
+
+	bool Read(void* buffer, u32 byteCount)
+	{
+		if(Offset + byteCount > ByteCount)
+		{
+			return false;
+		}
+
+		memcpy(buffer, Data + Offset, (size_t)byteCount);
+		Offset += byteCount;
+
+		return true;
+	}
+
+	template<typename T>
+	bool Read(T& value)
+	{
+		return Read(&value, (u32)sizeof(T));
+	}
+};
+
+
+static bool GetIndexFilePath(char* indexFilePath, const char* demoFilePath)
+{
+	const size_t length = strlen(demoFilePath);
+	if(length + sizeof(UDT_DEMO_INDEX_FILE_EXTENSION) > UDT_MAX_PATH_LENGTH)
+	{
+		return false;
+	}
+
+	memcpy(indexFilePath, demoFilePath, length);
+	memcpy(indexFilePath + length, UDT_DEMO_INDEX_FILE_EXTENSION, sizeof(UDT_DEMO_INDEX_FILE_EXTENSION));
+
+	return true;
+}
+
+static void WriteData(udtVMArray<u8>& data, const void* buffer, u32 byteCount)
+{
+	memcpy(data.Extend(byteCount), buffer, (size_t)byteCount);
+}
+
+template<typename T>
+static void WriteData(udtVMArray<u8>& data, const T& value)
+{
+	WriteData(data, &value, (u32)sizeof(T));
+}
+
+// Token byte: high bit set for a run of (token & 0x7F) + 1 zero bytes,
+// cleared for token + 1 literal bytes that follow.
+static void WriteDeltaBlock(udtVMArray<u8>& data, const u8* block, const u8* reference, u32 byteCount)
+{
+	u8 literals[128];
+	u32 literalCount = 0;
+	u32 zeroCount = 0;
+	for(u32 i = 0; i < byteCount; ++i)
+	{
+		const u8 byte = reference != NULL ? (block[i] ^ reference[i]) : block[i];
+		if(byte == 0)
+		{
+			if(literalCount > 0)
+			{
+				data.Add((u8)(literalCount - 1));
+				WriteData(data, literals, literalCount);
+				literalCount = 0;
+			}
+
+			if(++zeroCount == 128)
+			{
+				data.Add(0xFF);
+				zeroCount = 0;
+			}
+		}
+		else
+		{
+			if(zeroCount > 0)
+			{
+				data.Add((u8)(0x80 | (zeroCount - 1)));
+				zeroCount = 0;
+			}
+
+			literals[literalCount++] = byte;
+			if(literalCount == 128)
+			{
+				data.Add(0x7F);
+				WriteData(data, literals, literalCount);
+				literalCount = 0;
+			}
+		}
+	}
+
+	if(literalCount > 0)
+	{
+		data.Add((u8)(literalCount - 1));
+		WriteData(data, literals, literalCount);
+	}
+	else if(zeroCount > 0)
+	{
+		data.Add((u8)(0x80 | (zeroCount - 1)));
+	}
+}
+
+static bool ReadDeltaBlock(udtDemoIndexReader& reader, u8* block, const u8* reference, u32 byteCount)
+{
+	u32 i = 0;
+	while(i < byteCount)
+	{
+		u8 token;
+		if(!reader.Read(token))
+		{
+			return false;
+		}
+
+		const u32 runLength = (u32)(token & 0x7F) + 1;
+		if(i + runLength > byteCount)
+		{
+			return false;
+		}
+
+		if((token & 0x80) != 0)
+		{
+			memset(block + i, 0, (size_t)runLength);
+		}
+		else if(!reader.Read(block + i, runLength))
+		{
+			return false;
+		}
+
+		if(reference != NULL)
+		{
+			for(u32 j = i; j < i + runLength; ++j)
+			{
+				block[j] ^= reference[j];
+			}
+		}
+
+		i += runLength;
+	}
+
+	return true;
+}
+
+static bool ReadConfigStrings(udtDemoIndexReader& reader, udtBaseParser& parser)
+{
+	u32 configStringCount = 0;
+	if(!reader.Read(configStringCount))
+	{
+		return false;
+	}
+
+	for(u32 i = 0; i < configStringCount; ++i)
+	{
+		u32 index = 0;
+		u32 length = 0;
+		if(!reader.Read(index) ||
+		   !reader.Read(length) ||
+		   index >= (u32)UDT_COUNT_OF(parser._inConfigStrings) ||
+		   reader.Offset + length > reader.ByteCount)
+		{
+			return false;
+		}
+
+		parser._inConfigStrings[index] = udtString::NewClone(parser._configStringAllocator, (const char*)reader.Data + reader.Offset, length);
+		reader.Offset += length;
+	}
+
+	return true;
+}
+
+static void GetNullEventTimes(s32* eventTimes)
+{
+	for(u32 i = 0; i < (u32)MAX_GENTITIES; ++i)
+	{
+		eventTimes[i] = UDT_S32_MIN;
+	}
+}
+
+
+static s32 FindKeyframeInArray(const udtVMArray<udtDemoIndexKeyframe>& keyframes, s32 gameStateIndex, s32 serverTimeMs)
+{
+	// The parser only starts a cut after reading a snapshot, so the keyframe must come strictly before.
+	s32 result = -1;
+	for(u32 i = 0, count = keyframes.GetSize(); i < count; ++i)
+	{
+		const udtDemoIndexKeyframe& keyframe = keyframes[i];
+		if(keyframe.GameStateIndex == gameStateIndex && keyframe.ServerTimeMs < serverTimeMs)
+		{
+			result = (s32)i;
+		}
+	}
+
+	return result;
+}
+
+static bool RestoreKeyframeFromData(udtBaseParser& parser, const udtVMArray<udtDemoIndexKeyframe>& keyframes, const udtVMArray<u8>& data, u32 keyframeIndex)
+{
+	if(keyframeIndex >= keyframes.GetSize())
+	{
+		return false;
+	}
+
+	const udtDemoIndexKeyframe& keyframe = keyframes[keyframeIndex];
+	if(parser._inGameStateIndex != keyframe.GameStateIndex - 1)
+	{
+		return false;
+	}
+
+	parser.ResetForGamestateMessage();
+
+	udtDemoIndexReader reader;
+	reader.Data = data.GetStartAddress();
+	reader.ByteCount = data.GetSize();
+	reader.Offset = keyframe.GameStateDataOffset;
+	if(!ReadDeltaBlock(reader, parser._inEntityBaselines, NULL, (u32)(MAX_GENTITIES * parser._inProtocolSizeOfEntityState)) ||
+	   !ReadConfigStrings(reader, parser))
+	{
+		return false;
+	}
+
+	reader.Offset = keyframe.DataOffset;
+	u32 bigConfigStringLength = 0;
+	if(!reader.Read(parser._inServerMessageSequence) ||
+	   !reader.Read(parser._inServerCommandSequence) ||
+	   !reader.Read(parser._inReliableSequenceAcknowledge) ||
+	   !reader.Read(parser._inClientNum) ||
+	   !reader.Read(parser._inChecksumFeed) ||
+	   !reader.Read(parser._inParseEntitiesNum) ||
+	   !reader.Read(parser._inServerTime) ||
+	   !reader.Read(parser._inLastSnapshotMessageNumber) ||
+	   !reader.Read(bigConfigStringLength) ||
+	   bigConfigStringLength >= (u32)sizeof(parser._inBigConfigString) ||
+	   !reader.Read(parser._inBigConfigString, bigConfigStringLength))
+	{
+		return false;
+	}
+	parser._inBigConfigString[bigConfigStringLength] = '\0';
+
+	s32 nullEventTimes[MAX_GENTITIES];
+	GetNullEventTimes(nullEventTimes);
+	if(!ReadDeltaBlock(reader, (u8*)parser._inEntityEventTimesMs, (const u8*)nullEventTimes, (u32)sizeof(nullEventTimes)))
+	{
+		return false;
+	}
+
+	if(!ReadConfigStrings(reader, parser))
+	{
+		return false;
+	}
+
+	const u32 snapshotSize = (u32)parser._inProtocolSizeOfClientSnapshot;
+	for(s32 i = 0; i < PACKET_BACKUP; ++i)
+	{
+		const u8* const reference = i > 0 ? (const u8*)parser.GetClientSnapshot(i - 1) : NULL;
+		if(!ReadDeltaBlock(reader, (u8*)parser.GetClientSnapshot(i), reference, snapshotSize))
+		{
+			return false;
+		}
+	}
+
+	s32 firstEntity = 0;
+	s32 entityCount = 0;
+	if(!reader.Read(firstEntity) ||
+	   !reader.Read(entityCount) ||
+	   entityCount < 0 ||
+	   entityCount > ID_MAX_PARSE_ENTITIES)
+	{
+		return false;
+	}
+
+	const u32 entityStateSize = (u32)parser._inProtocolSizeOfEntityState;
+	const idEntityStateBase* references[MAX_GENTITIES];
+	for(s32 i = 0; i < MAX_GENTITIES; ++i)
+	{
+		references[i] = parser.GetBaseline(i);
+	}
+
+	for(s32 i = 0; i < entityCount; ++i)
+	{
+		u16 numberAndFlag = 0;
+		if(!reader.Read(numberAndFlag))
+		{
+			return false;
+		}
+
+		const u16 number = numberAndFlag & (MAX_GENTITIES - 1);
+		idEntityStateBase* const entity = parser.GetEntity((firstEntity + i) & (ID_MAX_PARSE_ENTITIES - 1));
+		const idEntityStateBase* const reference = references[number];
+		references[number] = entity;
+		if((numberAndFlag & UDT_DEMO_INDEX_UNCHANGED_ENTITY) != 0)
+		{
+			memcpy(entity, reference, (size_t)entityStateSize);
+		}
+		else if(!ReadDeltaBlock(reader, (u8*)entity, (const u8*)reference, entityStateSize))
+		{
+			return false;
+		}
+	}
+
+	parser._inGameStateIndex = keyframe.GameStateIndex;
+	parser._inGameStateFileOffsets.Add(keyframe.GameStateFileOffset);
+
+	return true;
+}
+
+
+udtDemoIndexWriter::udtDemoIndexWriter()
+{
+	_protocol = udtProtocol::Invalid;
+	_intervalMs = UDT_DEMO_INDEX_DEFAULT_INTERVAL_MS;
+	_gameStateDataOffset = 0;
+	_gameStateIndex = -1;
+	_nextKeyframeTimeMs = UDT_S32_MIN;
+}
+
+void udtDemoIndexWriter::Init(udtProtocol::Id protocol, u32 intervalMs)
+{
+	_keyframes.Clear();
+	_data.Clear();
+	_protocol = protocol;
+	_intervalMs = intervalMs != 0 ? intervalMs : UDT_DEMO_INDEX_DEFAULT_INTERVAL_MS;
+	_gameStateDataOffset = 0;
+	_gameStateIndex = -1;
+	_nextKeyframeTimeMs = UDT_S32_MIN;
+}
+
+void udtDemoIndexWriter::ProcessMessage(const udtBaseParser& parser, u32 nextFileOffset)
+{
+	// Wait for the first snapshot of the game state.
+	if(parser._inGameStateIndex < 0 || parser._inServerTime == UDT_S32_MIN)
+	{
+		return;
+	}
+
+	if(parser._inGameStateIndex != _gameStateIndex)
+	{
+		AddGameState(parser);
+		return;
+	}
+
+	if(parser._inServerTime >= _nextKeyframeTimeMs)
+	{
+		AddKeyframe(parser, nextFileOffset);
+		_nextKeyframeTimeMs = parser._inServerTime + (s32)_intervalMs;
+	}
+}
+
+void udtDemoIndexWriter::AddGameState(const udtBaseParser& parser)
+{
+	_gameStateIndex = parser._inGameStateIndex;
+	_nextKeyframeTimeMs = parser._inServerTime + (s32)_intervalMs;
+	_gameStateDataOffset = _data.GetSize();
+
+	// The baselines never change within a game state.
+	WriteDeltaBlock(_data, parser._inEntityBaselines, NULL, (u32)(MAX_GENTITIES * parser._inProtocolSizeOfEntityState));
+
+	_stringAllocator.Clear();
+	_configStrings.Resize((u32)UDT_COUNT_OF(parser._inConfigStrings));
+	u32 configStringCount = 0;
+	for(u32 i = 0; i < (u32)UDT_COUNT_OF(parser._inConfigStrings); ++i)
+	{
+		const udtString& cs = parser._inConfigStrings[i];
+		_configStrings[i] = cs.GetPtr() != NULL ? udtString::NewCloneFromRef(_stringAllocator, cs) : udtString::NewNull();
+		if(cs.GetPtr() != NULL)
+		{
+			++configStringCount;
+		}
+	}
+
+	WriteData(_data, configStringCount);
+	for(u32 i = 0; i < (u32)UDT_COUNT_OF(parser._inConfigStrings); ++i)
+	{
+		const udtString& cs = parser._inConfigStrings[i];
+		if(cs.GetPtr() != NULL)
+		{
+			const u32 length = cs.GetLength();
+			WriteData(_data, i);
+			WriteData(_data, length);
+			WriteData(_data, cs.GetPtr(), length);
+		}
+	}
+}
+
+void udtDemoIndexWriter::AddKeyframe(const udtBaseParser& parser, u32 nextFileOffset)
+{
+	udtDemoIndexKeyframe keyframe;
+	keyframe.GameStateIndex = parser._inGameStateIndex;
+	keyframe.ServerTimeMs = parser._inServerTime;
+	keyframe.FileOffset = nextFileOffset;
+	keyframe.GameStateFileOffset = parser._inGameStateFileOffsets[parser._inGameStateIndex];
+	keyframe.DataOffset = _data.GetSize();
+	keyframe.GameStateDataOffset = _gameStateDataOffset;
+	_keyframes.Add(keyframe);
+
+	WriteData(_data, parser._inServerMessageSequence);
+	WriteData(_data, parser._inServerCommandSequence);
+	WriteData(_data, parser._inReliableSequenceAcknowledge);
+	WriteData(_data, parser._inClientNum);
+	WriteData(_data, parser._inChecksumFeed);
+	WriteData(_data, parser._inParseEntitiesNum);
+	WriteData(_data, parser._inServerTime);
+	WriteData(_data, parser._inLastSnapshotMessageNumber);
+
+	// Big config strings can span multiple messages.
+	const u32 bigConfigStringLength = (u32)strlen(parser._inBigConfigString);
+	WriteData(_data, bigConfigStringLength);
+	WriteData(_data, parser._inBigConfigString, bigConfigStringLength);
+
+	s32 nullEventTimes[MAX_GENTITIES];
+	GetNullEventTimes(nullEventTimes);
+	WriteDeltaBlock(_data, (const u8*)parser._inEntityEventTimesMs, (const u8*)nullEventTimes, (u32)sizeof(nullEventTimes));
+
+	// Config strings are never reset to NULL within a game state.
+	u32 configStringCount = 0;
+	for(u32 i = 0; i < (u32)UDT_COUNT_OF(parser._inConfigStrings); ++i)
+	{
+		const udtString& cs = parser._inConfigStrings[i];
+		if(cs.GetPtr() != NULL && !udtString::Equals(cs, _configStrings[i]))
+		{
+			++configStringCount;
+		}
+	}
+
+	WriteData(_data, configStringCount);
+	for(u32 i = 0; i < (u32)UDT_COUNT_OF(parser._inConfigStrings); ++i)
+	{
+		const udtString& cs = parser._inConfigStrings[i];
+		if(cs.GetPtr() != NULL && !udtString::Equals(cs, _configStrings[i]))
+		{
+			const u32 length = cs.GetLength();
+			WriteData(_data, i);
+			WriteData(_data, length);
+			WriteData(_data, cs.GetPtr(), length);
+		}
+	}
+
+	// Consecutive snapshots in the ring are very similar.
+	const u32 snapshotSize = (u32)parser._inProtocolSizeOfClientSnapshot;
+	for(s32 i = 0; i < PACKET_BACKUP; ++i)
+	{
+		const u8* const reference = i > 0 ? (const u8*)parser.GetClientSnapshot(i - 1) : NULL;
+		WriteDeltaBlock(_data, (const u8*)parser.GetClientSnapshot(i), reference, snapshotSize);
+	}
+
+	// We only need the entities of the snapshots we can still delta from.
+	s32 firstEntity = parser._inParseEntitiesNum;
+	for(s32 i = 0; i < PACKET_BACKUP; ++i)
+	{
+		const idClientSnapshotBase* const snapshot = parser.GetClientSnapshot(i);
+		if(snapshot->valid && snapshot->parseEntitiesNum < firstEntity)
+		{
+			firstEntity = snapshot->parseEntitiesNum;
+		}
+	}
+	firstEntity = udt_max(firstEntity, parser._inParseEntitiesNum - ID_MAX_PARSE_ENTITIES);
+	const s32 entityCount = parser._inParseEntitiesNum - firstEntity;
+	WriteData(_data, firstEntity);
+	WriteData(_data, entityCount);
+
+	// The reference of an entity state is the previous one with the same number or the baseline.
+	const u32 entityStateSize = (u32)parser._inProtocolSizeOfEntityState;
+	const idEntityStateBase* references[MAX_GENTITIES];
+	for(s32 i = 0; i < MAX_GENTITIES; ++i)
+	{
+		references[i] = parser.GetBaseline(i);
+	}
+
+	for(s32 i = 0; i < entityCount; ++i)
+	{
+		// Masking the number only affects which reference is used, the state itself is stored losslessly.
+		const idEntityStateBase* const entity = parser.GetEntity((firstEntity + i) & (ID_MAX_PARSE_ENTITIES - 1));
+		const u16 number = (u16)(entity->number & (MAX_GENTITIES - 1));
+		const idEntityStateBase* const reference = references[number];
+		references[number] = entity;
+		if(memcmp(entity, reference, (size_t)entityStateSize) == 0)
+		{
+			WriteData(_data, (u16)(number | UDT_DEMO_INDEX_UNCHANGED_ENTITY));
+			continue;
+		}
+
+		WriteData(_data, number);
+		WriteDeltaBlock(_data, (const u8*)entity, (const u8*)reference, entityStateSize);
+	}
+}
+
+bool udtDemoIndexWriter::WriteFile(const char* demoFilePath)
+{
+	char indexFilePath[UDT_MAX_PATH_LENGTH];
+	if(!GetIndexFilePath(indexFilePath, demoFilePath))
+	{
+		return false;
+	}
+
+	u64 demoFileHash = 0;
+	u64 demoFileLength = 0;
+	if(!HashFile(demoFileHash, demoFileLength, demoFilePath, udtThreadLocalAllocators::GetTempAllocator()))
+	{
+		return false;
+	}
+
+	udtFileStream file;
+	if(!file.Open(indexFilePath, udtFileOpenMode::Write))
+	{
+		return false;
+	}
+
+	udtDemoIndexHeader header;
+	header.Magic = UDT_DEMO_INDEX_MAGIC;
+	header.Version = UDT_DEMO_INDEX_VERSION;
+	header.DemoFileLength = demoFileLength;
+	header.DemoFileHash = demoFileHash;
+	header.Protocol = (u32)_protocol;
+	header.IntervalMs = _intervalMs;
+	header.KeyframeCount = _keyframes.GetSize();
+	header.DataByteCount = _data.GetSize();
+
+	return
+		file.Write(&header, (u32)sizeof(header), 1) == 1 &&
+		(_keyframes.IsEmpty() || file.Write(_keyframes.GetStartAddress(), (u32)sizeof(udtDemoIndexKeyframe), _keyframes.GetSize()) == _keyframes.GetSize()) &&
+		(_data.IsEmpty() || file.Write(_data.GetStartAddress(), _data.GetSize(), 1) == 1);
+}
+
+s32 udtDemoIndexWriter::FindKeyframe(s32 gameStateIndex, s32 serverTimeMs) const
+{
+	return FindKeyframeInArray(_keyframes, gameStateIndex, serverTimeMs);
+}
+
+bool udtDemoIndexWriter::RestoreKeyframe(udtBaseParser& parser, u32 keyframeIndex) const
+{
+	return RestoreKeyframeFromData(parser, _keyframes, _data, keyframeIndex);
+}
+
+void udtDemoIndexWriter::DiscardKeyframes(u32 keyframeCount)
+{
+	const u32 oldKeyframeCount = _keyframes.GetSize();
+	keyframeCount = udt_min(keyframeCount, oldKeyframeCount);
+	if(keyframeCount == 0)
+	{
+		return;
+	}
+
+	// We keep the game state data of the first keyframe left (or of the current game state)
+	// and everything from the first keyframe left on.
+	const bool keyframesLeft = keyframeCount < oldKeyframeCount;
+	const u32 gameStateStart = keyframesLeft ? _keyframes[keyframeCount].GameStateDataOffset : _gameStateDataOffset;
+	const u32 keptStart = keyframesLeft ? _keyframes[keyframeCount].DataOffset : _data.GetSize();
+	u32 gameStateEnd = keptStart;
+	for(u32 i = 0; i < keyframeCount; ++i)
+	{
+		if(_keyframes[i].GameStateDataOffset == gameStateStart)
+		{
+			gameStateEnd = _keyframes[i].DataOffset;
+			break;
+		}
+	}
+
+	const u32 gameStateByteCount = gameStateEnd - gameStateStart;
+	const u32 keptByteCount = _data.GetSize() - keptStart;
+	u8* const data = _data.GetStartAddress();
+	memmove(data, data + gameStateStart, (size_t)gameStateByteCount);
+	memmove(data + gameStateByteCount, data + keptStart, (size_t)keptByteCount);
+	_data.Resize(gameStateByteCount + keptByteCount);
+
+	const u32 keptShift = keptStart - gameStateByteCount;
+	for(u32 i = keyframeCount; i < oldKeyframeCount; ++i)
+	{
+		udtDemoIndexKeyframe& keyframe = _keyframes[i];
+		keyframe.DataOffset -= keptShift;
+		keyframe.GameStateDataOffset -= keyframe.GameStateDataOffset >= keptStart ? keptShift : gameStateStart;
+		_keyframes[i - keyframeCount] = keyframe;
+	}
+	_keyframes.Resize(oldKeyframeCount - keyframeCount);
+	_gameStateDataOffset -= _gameStateDataOffset >= keptStart ? keptShift : gameStateStart;
+}
+
+
+udtDemoIndex::udtDemoIndex()
+{
+}
+
+bool udtDemoIndex::Load(const char* demoFilePath, udtProtocol::Id protocol)
+{
+	Keyframes.Clear();
+	_data.Clear();
+
+	char indexFilePath[UDT_MAX_PATH_LENGTH];
+	if(!GetIndexFilePath(indexFilePath, demoFilePath) ||
+	   !udtFileStream::Exists(indexFilePath))
+	{
+		return false;
+	}
+
+	udtFileStream file;
+	if(!file.Open(indexFilePath, udtFileOpenMode::Read))
+	{
+		return false;
+	}
+
+	udtDemoIndexHeader header;
+	if(file.Read(&header, (u32)sizeof(header), 1) != 1 ||
+	   header.Magic != UDT_DEMO_INDEX_MAGIC ||
+	   header.Version != UDT_DEMO_INDEX_VERSION ||
+	   header.Protocol != (u32)protocol ||
+	   (u64)sizeof(header) + (u64)header.KeyframeCount * (u64)sizeof(udtDemoIndexKeyframe) + (u64)header.DataByteCount != file.Length())
+	{
+		return false;
+	}
+
+	// The demo could have been replaced by another one of the same length.
+	u64 demoFileHash = 0;
+	u64 demoFileLength = 0;
+	if(!HashFile(demoFileHash, demoFileLength, demoFilePath, udtThreadLocalAllocators::GetTempAllocator()) ||
+	   header.DemoFileLength != demoFileLength ||
+	   header.DemoFileHash != demoFileHash)
+	{
+		return false;
+	}
+
+	Keyframes.Resize(header.KeyframeCount);
+	_data.Resize(header.DataByteCount);
+	if((header.KeyframeCount > 0 && file.Read(Keyframes.GetStartAddress(), (u32)sizeof(udtDemoIndexKeyframe), header.KeyframeCount) != header.KeyframeCount) ||
+	   (header.DataByteCount > 0 && file.Read(_data.GetStartAddress(), header.DataByteCount, 1) != 1))
+	{
+		Keyframes.Clear();
+		_data.Clear();
+		return false;
+	}
+
+	return true;
+}
+
+s32 udtDemoIndex::FindKeyframe(s32 gameStateIndex, s32 serverTimeMs) const
+{
+	return FindKeyframeInArray(Keyframes, gameStateIndex, serverTimeMs);
+}
+
+s32 udtDemoIndex::FindStartKeyframe(s32 gameStateIndex, s32 startTimeMs, u32 minFileOffset) const
+{
+	const s32 keyframeIndex = FindKeyframeInArray(Keyframes, gameStateIndex, startTimeMs);
+	if(keyframeIndex < 0 || Keyframes[keyframeIndex].FileOffset < minFileOffset)
+	{
+		return -1;
+	}
+
+	return keyframeIndex;
+}
+
+bool udtDemoIndex::RestoreKeyframe(udtBaseParser& parser, u32 keyframeIndex) const
+{
+	return RestoreKeyframeFromData(parser, Keyframes, _data, keyframeIndex);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+
+#include "parser.hpp"
+#include "array.hpp"
+
+
+// The index of "demo.dm_68" is stored in "demo.dm_68.udtidx".
+#define UDT_DEMO_INDEX_FILE_EXTENSION         ".udtidx"
+#define UDT_DEMO_INDEX_DEFAULT_INTERVAL_MS    30000
+
+
+struct udtDemoIndexKeyframe
+{
+	s32 GameStateIndex;
+	s32 ServerTimeMs; // Server time of the last snapshot read before the keyframe.
+	u32 FileOffset; // Offset of the first message to read after restoring the keyframe.
+	u32 GameStateFileOffset;
+	u32 DataOffset; // Parser state.
+	u32 GameStateDataOffset; // Baselines and config strings shared by all keyframes of a game state.
+};
+
+// Records the full parser state every N seconds of server time so that
+// the parser can start from the closest keyframe instead of the game state.
+struct udtDemoIndexWriter
+{
+public:
+	udtDemoIndexWriter();
+
+	void Init(udtProtocol::Id protocol, u32 intervalMs); // Once for each demo. 0 means the default interval.
+	void ProcessMessage(const udtBaseParser& parser, u32 nextFileOffset); // After each message.
+	bool WriteFile(const char* demoFilePath); // Writes next to the demo file, along with the demo's length and hash.
+
+	// For keeping the recent keyframes in memory only, without writing a file.
+	u32  GetKeyframeCount() const { return _keyframes.GetSize(); }
+	const udtDemoIndexKeyframe& GetKeyframe(u32 keyframeIndex) const { return _keyframes[keyframeIndex]; }
+	s32  FindKeyframe(s32 gameStateIndex, s32 serverTimeMs) const; // See udtDemoIndex::FindKeyframe.
+	bool RestoreKeyframe(udtBaseParser& parser, u32 keyframeIndex) const; // See udtDemoIndex::RestoreKeyframe.
+	void DiscardKeyframes(u32 keyframeCount); // Removes the oldest keyframes and the data only they needed.
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtDemoIndexWriter);
+
+	void AddGameState(const udtBaseParser& parser);
+	void AddKeyframe(const udtBaseParser& parser, u32 nextFileOffset);
+
+	udtVMArray<udtDemoIndexKeyframe> _keyframes { "DemoIndexWriter::KeyframesArray" };
+	udtVMArray<u8> _data { "DemoIndexWriter::DataArray" };
+	udtVMArray<udtString> _configStrings { "DemoIndexWriter::ConfigStringsArray" }; // Keyframes only store the ones that changed since.
+	udtVMLinearAllocator _stringAllocator { "DemoIndexWriter::Strings" };
+	udtProtocol::Id _protocol;
+	u32 _intervalMs;
+	u32 _gameStateDataOffset;
+	s32 _gameStateIndex;
+	s32 _nextKeyframeTimeMs;
+};
+
+struct udtDemoIndex
+{
+public:
+	udtDemoIndex();
+
+	bool Load(const char* demoFilePath, udtProtocol::Id protocol); // Fails if there is no index or if the demo's length or hash changed.
+	s32  FindKeyframe(s32 gameStateIndex, s32 serverTimeMs) const; // The last keyframe before the given time or -1 if none.
+	s32  FindStartKeyframe(s32 gameStateIndex, s32 startTimeMs, u32 minFileOffset) const; // Same, but -1 if the parser would have to start before minFileOffset.
+	bool RestoreKeyframe(udtBaseParser& parser, u32 keyframeIndex) const; // After udtBaseParser::Init was called with the keyframe's game state index.
+
+	udtVMArray<udtDemoIndexKeyframe> Keyframes { "DemoIndex::KeyframesArray" };
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtDemoIndex);
+
+	udtVMArray<u8> _data { "DemoIndex::DataArray" };
+};
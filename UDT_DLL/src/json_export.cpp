@@ -723,25 +723,8 @@ static void WriteScores(udtJSONExporter& writer, const udtParseDataScoreBuffers&
 	writer.EndArray();
 }
 
-bool ExportPlugInsDataToJSON(udtParserContext* context, u32 demoIndex, const char* jsonPath)
+static void WritePlugInsData(udtJSONExporter& jsonWriter, udtParserContext* context, u32 demoIndex)
 {
-	udtFileStream jsonFile;
-	if(jsonPath != NULL)
-	{
-		if(!jsonFile.Open(jsonPath, udtFileOpenMode::Write))
-		{
-			context->Context.LogError("Failed to open file '%s' for writing", jsonPath);
-			return false;
-		}
-	}
-
-	context->JSONWriterContext.ResetForNextDemo();
-	udtJSONWriter& writer = context->JSONWriterContext.Writer;
-	udtVMLinearAllocator& tempAllocator = context->Parser._tempAllocator;
-	udtJSONExporter jsonWriter(writer, tempAllocator);
-
-	writer.StartFile();
-
 	{
 		udtParseDataGameStateBuffers gameStateBuffers;
 		if(udtGetContextPlugInBuffers(context, (u32)udtParserPlugIn::GameState, &gameStateBuffers) == (s32)udtErrorCode::None)
@@ -810,16 +793,45 @@ bool ExportPlugInsDataToJSON(udtParserContext* context, u32 demoIndex, const cha
 			WriteScores(jsonWriter, scoreBuffers, demoIndex);
 		}
 	}
+}
 
-	writer.EndFile();
+bool ExportPlugInsDataToJSON(udtParserContext* context, u32 demoIndex, const char* jsonPath, bool compact)
+{
+	udtFileStream jsonFile;
+	if(jsonPath != NULL)
+	{
+		if(!jsonFile.Open(jsonPath, udtFileOpenMode::Write))
+		{
+			context->Context.LogError("Failed to open file '%s' for writing", jsonPath);
+			return false;
+		}
+	}
+
+	// When writing to a file, the writer's buffer gets flushed straight to it
+	// instead of going through the memory stream first.
+	context->JSONWriterContext.ResetForNextDemo();
+	udtJSONWriter& writer = context->JSONWriterContext.Writer;
+	if(jsonPath != NULL)
+	{
+		writer.SetOutputStream(&jsonFile);
+	}
+	writer.SetCompactMode(compact);
+	udtVMLinearAllocator& tempAllocator = context->Parser._tempAllocator;
+	udtJSONExporter jsonWriter(writer, tempAllocator);
+
+	writer.StartFile();
+
+	WritePlugInsData(jsonWriter, context, demoIndex);
+
+	const bool success = writer.EndFile();
 
-	udtVMMemoryStream& memoryStream = context->JSONWriterContext.MemoryStream;
 	if(jsonPath == NULL)
 	{
-		return fwrite(memoryStream.GetBuffer(), (size_t)memoryStream.Length(), 1, stdout) == 1;
+		udtVMMemoryStream& memoryStream = context->JSONWriterContext.MemoryStream;
+		return success && fwrite(memoryStream.GetBuffer(), (size_t)memoryStream.Length(), 1, stdout) == 1;
 	}
 
-	if(jsonFile.Write(memoryStream.GetBuffer(), (u32)memoryStream.Length(), 1) != 1)
+	if(!success)
 	{
 		context->Context.LogError("Failed to write to JSON file '%s'", jsonPath);
 		return false;
@@ -829,3 +841,33 @@ bool ExportPlugInsDataToJSON(udtParserContext* context, u32 demoIndex, const cha
 
 	return true;
 }
+
+bool ExportPlugInsDataToNDJSON(udtParserContext* context, u32 demoIndex, const char* demoFilePath, bool consoleOutput)
+{
+	// One line per demo, written to this context's batch file or to stdout.
+	udtJSONWriterContext& writerContext = context->JSONWriterContext;
+	writerContext.ResetForNextDemo();
+	udtStream& output = consoleOutput ? (udtStream&)writerContext.MemoryStream : (udtStream&)writerContext.BatchFile;
+	udtJSONWriter& writer = writerContext.Writer;
+	writer.SetOutputStream(&output);
+	writer.SetCompactMode(true);
+	udtVMLinearAllocator& tempAllocator = context->Parser._tempAllocator;
+	udtJSONExporter jsonWriter(writer, tempAllocator);
+
+	writer.StartFile();
+	jsonWriter.WriteStringValue("file path", demoFilePath);
+	WritePlugInsData(jsonWriter, context, demoIndex);
+	if(!writer.EndFile() || output.Write("\n", 1, 1) != 1)
+	{
+		context->Context.LogError("Failed to write the JSON data of demo '%s'", demoFilePath);
+		return false;
+	}
+
+	if(consoleOutput)
+	{
+		udtVMMemoryStream& memoryStream = writerContext.MemoryStream;
+		return fwrite(memoryStream.GetBuffer(), (size_t)memoryStream.Length(), 1, stdout) == 1;
+	}
+
+	return true;
+}
@@ -4,4 +4,7 @@
 #include "parser_context.hpp"
 
 
-extern bool ExportPlugInsDataToJSON(udtParserContext* context, u32 demoIndex, const char* jsonPath);
+extern bool ExportPlugInsDataToJSON(udtParserContext* context, u32 demoIndex, const char* jsonPath, bool compact);
+
+// Writes a single line of compact JSON to the context's batch file or to stdout.
+extern bool ExportPlugInsDataToNDJSON(udtParserContext* context, u32 demoIndex, const char* demoFilePath, bool consoleOutput);
@@ -1,176 +1,43 @@
 #include "json_writer.hpp"
+#include "utils.hpp"
 
 
-static bool UTF8_NextCodePoint(u32& codePoint, u32& byteCount, const char* input)
+// How each byte is handled when writing a string value.
+// 0:          copied as is
+// 2, 3, 4:    first byte of a UTF-8 sequence of that length, copied as is
+// 'u':        written as \u00XX
+// 'x':        the null terminator or an invalid UTF-8 byte, ends the string
+// Otherwise:  written as a backslash followed by the table value
+static const u8 EscapeTable[256] =
 {
-	if(*input == '\0')
-	{
-		return false;
-	}
-
-	const u8 byte0 = (u8)input[0];
-	if(byte0 <= 127)
-	{
-		codePoint = (u32)byte0;
-		byteCount = 1;
-		return true;
-	}
-
-	// Starts with 110?
-	if((byte0 >> 5) == 6)
-	{
-		const u8 byte1 = (u8)input[1];
-		codePoint = ((u32)byte1 & 63) | (((u32)byte0 & 31) << 6);
-		byteCount = 2;
-		return true;
-	}
-
-	// Starts with 1110?
-	if((byte0 >> 4) == 14)
-	{
-		const u8 byte1 = (u8)input[1];
-		const u8 byte2 = (u8)input[2];
-		codePoint = ((u32)byte2 & 63) | (((u32)byte1 & 63) << 6) | (((u32)byte0 & 15) << 12);
-		byteCount = 3;
-		return true;
-	}
-	
-	// Starts with 11110?
-	if((byte0 >> 3) == 30)
-	{
-		const u8 byte1 = (u8)input[1];
-		const u8 byte2 = (u8)input[2];
-		const u8 byte3 = (u8)input[3];
-		codePoint = ((u32)byte3 & 63) | (((u32)byte2 & 63) << 6) | (((u32)byte1 & 63) << 12) | (((u32)byte0 & 7) << 18);
-		byteCount = 4;
-		return true;
-	}
-	
-	return false;
-}
-
-struct ShortEscape
-{
-	u32 CodePoint;
-	char OutputChar;
+	'x', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u', // 0x00
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // 0x10
+	0,   0,   '"', 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   '/', // 0x20
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   // 0x30
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   // 0x40
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   '\\', 0,   0,   0,   // 0x50
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   // 0x60
+	0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   // 0x70
+	'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', // 0x80
+	'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', // 0x90
+	'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', // 0xA0
+	'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', // 0xB0
+	2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   // 0xC0
+	2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   // 0xD0
+	3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   // 0xE0
+	4,   4,   4,   4,   4,   4,   4,   4,   'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x'  // 0xF0
 };
 
-#define ENTRY(HexValue, Char) { 0x##HexValue, Char }
-static const ShortEscape ShortEscapeCodePoints[] =
-{
-	ENTRY(0022, '"'),
-	ENTRY(005C, '\\'),
-	ENTRY(002F, '/'),
-	ENTRY(0008, 'b'),
-	ENTRY(000C, 'f'),
-	ENTRY(000A, 'n'),
-	ENTRY(000D, 'r'),
-	ENTRY(0009, 't')
-};
-#undef ENTRY
-
 static const char HexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
 
-static bool UTF8_NeedsEscaping(u32& newLength, u32 codePoint)
-{
-	for(u32 i = 0; i < (u32)UDT_COUNT_OF(ShortEscapeCodePoints); ++i)
-	{
-		if(codePoint == ShortEscapeCodePoints[i].CodePoint)
-		{
-			newLength = 2; // Of form: "\A".
-			return true;
-		}
-	}
-
-	// Range: 0x0000 - 0x001F
-	if(codePoint <= 0x001F)
-	{
-		newLength = 6; // Of form: "\uABCD".
-		return true;
-	}
-
-	return false;
-}
-
-static void UTF8_WriteCodePoint(u32& newLength, char* output, u32 codePoint, const char* input)
-{
-	for(u32 i = 0; i < (u32)UDT_COUNT_OF(ShortEscapeCodePoints); ++i)
-	{
-		if(codePoint == ShortEscapeCodePoints[i].CodePoint)
-		{
-			newLength = 2;
-			output[0] = '\\';
-			output[1] = ShortEscapeCodePoints[i].OutputChar;
-			return;
-		}
-	}
-
-	// Range: 0x0000 - 0x001F
-	if(codePoint <= 0x001F)
-	{
-		newLength = 6;
-		output[0] = '\\';
-		output[1] = 'u';
-		output[2] = HexDigits[(codePoint >> 12) & 15];
-		output[3] = HexDigits[(codePoint >> 8) & 15];
-		output[4] = HexDigits[(codePoint >> 4) & 15];
-		output[5] = HexDigits[codePoint & 15];
-		return;
-	}
-
-	for(u32 i = 0; i < newLength; ++i)
-	{
-		output[i] = input[i];
-	}
-}
-
-static u32 UTF8_LengthForJSON(const char* input)
-{
-	const char* s = input;
-	u32 codePoint = 0;
-	u32 byteCount = 0;
-	u32 newLength = 0;
-	while(UTF8_NextCodePoint(codePoint, byteCount, s))
-	{
-		s += byteCount;
-		UTF8_NeedsEscaping(byteCount, codePoint);
-		newLength += byteCount;
-	}
-
-	return newLength;
-}
-
-static void UTF8_CleanForJSON(char* output, const char* input)
-{
-	const char* in = input;
-	char* out = output;
-	u32 codePoint = 0;
-	u32 inputByteCount = 0;
-	while(UTF8_NextCodePoint(codePoint, inputByteCount, in))
-	{
-		u32 outputByteCount = inputByteCount;
-		UTF8_WriteCodePoint(outputByteCount, out, codePoint, in);
-		in += inputByteCount;
-		out += outputByteCount;
-	}
-	*out = '\0';
-}
-
-static char* UTF8_CloneForJSON(udtVMLinearAllocator& allocator, const char* input)
-{
-	const u32 newLength = UTF8_LengthForJSON(input);
-	char* const output = (char*)allocator.AllocateAndGetAddress((uptr)newLength + 1);
-	UTF8_CleanForJSON(output, input);
-
-	return output;
-}
-
 
 udtJSONWriter::udtJSONWriter()
 {
 	_stream = NULL;
-	memset(_itemIndices, 0, sizeof(_itemIndices));
 	_level = 0;
+	_bufferByteCount = 0;
+	_compact = false;
+	_writeFailed = false;
 }
 
 udtJSONWriter::~udtJSONWriter()
@@ -182,48 +49,49 @@ void udtJSONWriter::SetOutputStream(udtStream* stream)
 	_stream = stream;
 }
 
+void udtJSONWriter::SetCompactMode(bool compact)
+{
+	_compact = compact;
+}
+
 void udtJSONWriter::StartFile()
 {
-	memset(_itemIndices, 0, sizeof(_itemIndices));
+	_itemIndices.Clear();
+	_itemIndices.Add(0);
 	_level = 0;
+	_bufferByteCount = 0;
+	_writeFailed = false;
 
 	Write("{");
-	++_level;
+	PushLevel();
 }
 
-void udtJSONWriter::EndFile()
+bool udtJSONWriter::EndFile()
 {
-	Write("\r\n}");
+	if(!_compact)
+	{
+		Write("\r\n");
+	}
+	Write("}");
+	Flush();
+
+	return !_writeFailed;
 }
 
 void udtJSONWriter::StartObject()
 {
-	if(_itemIndices[_level] > 0)
-	{
-		Write(",");
-	}
-
-	WriteNewLine();
+	StartItem();
 	Write("{");
-	++_level;
-	_itemIndices[_level] = 0;
+	PushLevel();
 }
 
 void udtJSONWriter::StartObject(const char* name)
 {
-	if(_itemIndices[_level] > 0)
-	{
-		Write(",");
-	}
-
-	WriteNewLine();
-	Write("\"");
-	Write(name);
-	Write("\":");
+	StartItem();
+	WriteName(name);
 	WriteNewLine();
 	Write("{");
-	++_level;
-	_itemIndices[_level] = 0;
+	PushLevel();
 }
 
 void udtJSONWriter::EndObject()
@@ -236,32 +104,18 @@ void udtJSONWriter::EndObject()
 
 void udtJSONWriter::StartArray()
 {
-	if(_itemIndices[_level] > 0)
-	{
-		Write(",");
-	}
-
-	WriteNewLine();
+	StartItem();
 	Write("[");
-	++_level;
-	_itemIndices[_level] = 0;
+	PushLevel();
 }
 
 void udtJSONWriter::StartArray(const char* name)
 {
-	if(_itemIndices[_level] > 0)
-	{
-		Write(",");
-	}
-
-	WriteNewLine();
-	Write("\"");
-	Write(name);
-	Write("\":");
+	StartItem();
+	WriteName(name);
 	WriteNewLine();
 	Write("[");
-	++_level;
-	_itemIndices[_level] = 0;
+	PushLevel();
 }
 
 void udtJSONWriter::EndArray()
@@ -272,46 +126,98 @@ void udtJSONWriter::EndArray()
 	++_itemIndices[_level];
 }
 
-void udtJSONWriter::WriteNewLine()
+void udtJSONWriter::WriteIntValue(const char* name, s32 number)
 {
-	Write("\r\n");
-	for(u32 i = 0; i < _level; ++i)
+	StartItem();
+	WriteName(name);
+	if(!_compact)
 	{
-		Write("\t");
+		Write(" ");
 	}
-}
 
-void udtJSONWriter::Write(const char* string)
-{
-	_stream->Write(string, (u32)strlen(string), 1);
+	// Written backwards from the end of the buffer.
+	char digits[16];
+	char* d = digits + sizeof(digits);
+	u32 value = number < 0 ? (u32)0 - (u32)number : (u32)number;
+	do
+	{
+		*--d = (char)('0' + (value % 10));
+		value /= 10;
+	}
+	while(value != 0);
+	if(number < 0)
+	{
+		*--d = '-';
+	}
+	Write(d, (u32)(digits + sizeof(digits) - d));
+
+	++_itemIndices[_level];
 }
 
-void udtJSONWriter::CleanAndWrite(const char* string)
+void udtJSONWriter::WriteBoolValue(const char* name, bool value)
 {
-	char* cleanCopy = UTF8_CloneForJSON(_stringAllocator, string);
-	Write(cleanCopy);
-	_stringAllocator.Clear();
+	StartItem();
+	WriteName(name);
+	if(!_compact)
+	{
+		Write(" ");
+	}
+	if(value)
+	{
+		Write("true");
+	}
+	else
+	{
+		Write("false");
+	}
+	++_itemIndices[_level];
 }
 
-void udtJSONWriter::WriteIntValue(const char* name, s32 number)
+void udtJSONWriter::WriteStringValue(const char* name, const char* string)
 {
-	char numberString[64];
-	sprintf(numberString, "%d", number);
+	if(string == NULL)
+	{
+		return;
+	}
 
+	// String values are separated by a comma and a space in indented mode.
 	if(_itemIndices[_level] > 0)
 	{
-		Write(",");
+		if(_compact)
+		{
+			Write(",");
+		}
+		else
+		{
+			Write(", ");
+		}
 	}
-
 	WriteNewLine();
+	WriteName(name);
+	if(!_compact)
+	{
+		Write(" ");
+	}
+	Write("\"");
+	WriteEscaped(string);
 	Write("\"");
-	Write(name);
-	Write("\": ");
-	Write(numberString);
 	++_itemIndices[_level];
 }
 
-void udtJSONWriter::WriteBoolValue(const char* name, bool value)
+void udtJSONWriter::PushLevel()
+{
+	++_level;
+	if(_level == _itemIndices.GetSize())
+	{
+		_itemIndices.Add(0);
+	}
+	else
+	{
+		_itemIndices[_level] = 0;
+	}
+}
+
+void udtJSONWriter::StartItem()
 {
 	if(_itemIndices[_level] > 0)
 	{
@@ -319,31 +225,135 @@ void udtJSONWriter::WriteBoolValue(const char* name, bool value)
 	}
 
 	WriteNewLine();
+}
+
+void udtJSONWriter::WriteName(const char* name)
+{
 	Write("\"");
-	Write(name);
-	Write("\": ");
-	Write(value ? "true" : "false");
-	++_itemIndices[_level];
+	Write(name, (u32)strlen(name));
+	Write("\":");
 }
 
-void udtJSONWriter::WriteStringValue(const char* name, const char* string)
+void udtJSONWriter::WriteNewLine()
 {
-	if(string == NULL)
+	if(_compact)
 	{
 		return;
 	}
 
-	if(_itemIndices[_level] > 0)
+	static const char tabs[16] = { '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t', '\t' };
+	Write("\r\n");
+	for(u32 i = 0; i < _level; i += (u32)sizeof(tabs))
 	{
-		Write(", ");
+		Write(tabs, udt_min(_level - i, (u32)sizeof(tabs)));
 	}
+}
 
-	WriteNewLine();
-	Write("\"");
-	Write(name);
-	Write("\": \"");
-	CleanAndWrite(string);
-	//Write(string);
-	Write("\"");
-	++_itemIndices[_level];
+void udtJSONWriter::Write(const char* string, u32 byteCount)
+{
+	if(_bufferByteCount + byteCount > (u32)UDT_JSON_WRITER_BUFFER_SIZE)
+	{
+		Flush();
+		if(byteCount > (u32)UDT_JSON_WRITER_BUFFER_SIZE)
+		{
+			if(_stream->Write(string, byteCount, 1) != 1)
+			{
+				_writeFailed = true;
+			}
+			return;
+		}
+	}
+
+	memcpy(_buffer + _bufferByteCount, string, (size_t)byteCount);
+	_bufferByteCount += byteCount;
+}
+
+void udtJSONWriter::WriteEscaped(const char* string)
+{
+	const u8* s = (const u8*)string;
+	for(;;)
+	{
+		// Copy the longest run of bytes that don't need escaping in one go.
+		const u8* const runStart = s;
+		while(EscapeTable[*s] == 0)
+		{
+			++s;
+		}
+		if(s > runStart)
+		{
+			Write((const char*)runStart, (u32)(s - runStart));
+		}
+
+		const u8 action = EscapeTable[*s];
+		if(action == 'x')
+		{
+			return;
+		}
+
+		if(action > 4)
+		{
+			WriteEscapedCodePoint((u32)*s);
+			++s;
+			continue;
+		}
+
+		// The trailing bytes of a UTF-8 sequence aren't validated.
+		// Overlong encodings of characters that need escaping still get escaped.
+		const u32 byteCount = (u32)action;
+		for(u32 i = 1; i < byteCount; ++i)
+		{
+			if(s[i] == 0)
+			{
+				Write((const char*)s, i);
+				return;
+			}
+		}
+
+		u32 codePoint;
+		switch(byteCount)
+		{
+			case 2: codePoint = ((u32)s[1] & 63) | (((u32)s[0] & 31) << 6); break;
+			case 3: codePoint = ((u32)s[2] & 63) | (((u32)s[1] & 63) << 6) | (((u32)s[0] & 15) << 12); break;
+			default: codePoint = ((u32)s[3] & 63) | (((u32)s[2] & 63) << 6) | (((u32)s[1] & 63) << 12) | (((u32)s[0] & 7) << 18); break;
+		}
+
+		if(codePoint < 128 && EscapeTable[codePoint] != 0)
+		{
+			WriteEscapedCodePoint(codePoint);
+		}
+		else
+		{
+			Write((const char*)s, byteCount);
+		}
+		s += byteCount;
+	}
+}
+
+void udtJSONWriter::WriteEscapedCodePoint(u32 codePoint)
+{
+	const u8 action = EscapeTable[codePoint];
+	if(action == 'u' || action == 'x')
+	{
+		const char escaped[6] = { '\\', 'u', '0', '0', HexDigits[codePoint >> 4], HexDigits[codePoint & 15] };
+		Write(escaped, (u32)sizeof(escaped));
+	}
+	else
+	{
+		const char escaped[2] = { '\\', (char)action };
+		Write(escaped, (u32)sizeof(escaped));
+	}
+}
+
+void udtJSONWriter::Flush()
+{
+	if(_bufferByteCount == 0)
+	{
+		return;
+	}
+
+	if(_stream->Write(_buffer, _bufferByteCount, 1) != 1)
+	{
+		_writeFailed = true;
+	}
+	_bufferByteCount = 0;
 }
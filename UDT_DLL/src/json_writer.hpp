@@ -2,8 +2,13 @@
 
 
 #include "stream.hpp"
+#include "array.hpp"
 
 
+#define UDT_JSON_WRITER_BUFFER_SIZE    (1 << 16)
+
+
+// Don't ever allocate an instance of this on the stack.
 struct udtJSONWriter
 {
 public:
@@ -11,9 +16,10 @@ public:
 	~udtJSONWriter();
 
 	void SetOutputStream(udtStream* stream);
-	
+	void SetCompactMode(bool compact); // No white space at all when enabled.
+
 	void StartFile();
-	void EndFile();
+	bool EndFile(); // Flushes the output. Returns false if any write to the stream failed.
 	void StartObject();
 	void StartObject(const char* name);
 	void EndObject();
@@ -28,12 +34,26 @@ public:
 private:
 	UDT_NO_COPY_SEMANTICS(udtJSONWriter);
 
+	template<u32 N>
+	void Write(const char (&string)[N])
+	{
+		Write(string, N - 1);
+	}
+
+	void PushLevel(); // Grows the item counter array when needed.
+	void StartItem(); // Comma and new line.
+	void WriteName(const char* name); // Quoted name and colon.
 	void WriteNewLine();
-	void Write(const char* string);
-	void CleanAndWrite(const char* string);
+	void Write(const char* string, u32 byteCount);
+	void WriteEscaped(const char* string);
+	void WriteEscapedCodePoint(u32 codePoint); // Only for code points that need escaping.
+	void Flush();
 
-	udtVMLinearAllocator _stringAllocator { "JSONWriter::Strings" };
 	udtStream* _stream;
-	u32 _itemIndices[16];
+	udtVMArray<u32> _itemIndices { "JSONWriter::ItemIndicesArray" }; // One item counter per nesting level.
 	u32 _level;
+	u32 _bufferByteCount;
+	bool _compact;
+	bool _writeFailed;
+	char _buffer[UDT_JSON_WRITER_BUFFER_SIZE];
 };
@@ -12,9 +12,10 @@ udtJSONWriterContext::~udtJSONWriterContext()
 
 void udtJSONWriterContext::ResetForNextDemo()
 {
+	// The output stream can be changed by the user after this call.
+	Writer.SetOutputStream(&MemoryStream);
 	if(!_initialized)
 	{
-		Writer.SetOutputStream(&MemoryStream);
 		_initialized = true;
 	}
 	else
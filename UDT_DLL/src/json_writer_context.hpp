@@ -3,6 +3,7 @@
 
 #include "json_writer.hpp"
 #include "memory_stream.hpp"
+#include "file_stream.hpp"
 
 
 struct udtJSONWriterContext
@@ -19,6 +20,7 @@ private:
 public:
 	udtVMMemoryStream MemoryStream;
 	udtJSONWriter Writer;
+	udtFileStream BatchFile; // Only used for newline-delimited JSON output.
 
 private:
 	bool _initialized;
@@ -0,0 +1,161 @@
+#include "mapped_file_stream.hpp"
+
+
+#if defined(UDT_LINUX)
+
+
+#include "assert_or_fatal.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+
+udtMappedFileStream::udtMappedFileStream()
+{
+	_data = NULL;
+	_fileByteCount = 0;
+	_fileOffset = 0;
+	_file = -1;
+}
+
+udtMappedFileStream::~udtMappedFileStream()
+{
+	Close();
+}
+
+bool udtMappedFileStream::Open(const char* filePath, u32 offset)
+{
+	Close();
+
+	const int file = open(filePath, O_RDONLY);
+	if(file == -1)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if(fstat(file, &info) != 0 || (u64)info.st_size > (u64)UDT_U32_MAX || (u64)offset > (u64)info.st_size)
+	{
+		close(file);
+		return false;
+	}
+
+	_file = (s32)file;
+	_fileByteCount = (u32)info.st_size;
+	_fileOffset = offset;
+	if(_fileByteCount == 0)
+	{
+		// mmap doesn't accept empty mappings.
+		return true;
+	}
+
+	void* const data = mmap(NULL, (size_t)_fileByteCount, PROT_READ, MAP_PRIVATE, file, 0);
+	if(data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	// Tell the kernel to read ahead aggressively and drop pages behind us.
+	madvise(data, (size_t)_fileByteCount, MADV_SEQUENTIAL);
+	_data = (const u8*)data;
+
+	return true;
+}
+
+u32 udtMappedFileStream::Read(void* dstBuff, u32 elementSize, u32 count)
+{
+	const u32 fileSize = _fileByteCount;
+	const u32 fileOffset = _fileOffset;
+	u32 byteCount = elementSize * count;
+	if(byteCount == 0 || fileOffset >= fileSize)
+	{
+		return 0;
+	}
+
+	if(fileOffset + byteCount > fileSize)
+	{
+		byteCount = fileSize - fileOffset;
+	}
+
+	memcpy(dstBuff, _data + fileOffset, (size_t)byteCount);
+	_fileOffset += byteCount;
+
+	return byteCount / elementSize;
+}
+
+u32 udtMappedFileStream::Write(const void* /*srcBuff*/, u32 /*elementSize*/, u32 /*count*/)
+{
+	UDT_ASSERT_OR_FATAL_ALWAYS("Calling Write on a udtMappedFileStream is invalid!");
+	return 0;
+}
+
+s32 udtMappedFileStream::Seek(s32 offset, udtSeekOrigin::Id origin)
+{
+	s64 newOffset = (s64)offset;
+	switch(origin)
+	{
+		case udtSeekOrigin::Current: newOffset += (s64)_fileOffset; break;
+		case udtSeekOrigin::End: newOffset += (s64)_fileByteCount; break;
+		default: break;
+	}
+
+	if(newOffset < 0 || newOffset > (s64)_fileByteCount)
+	{
+		return -1;
+	}
+
+	_fileOffset = (u32)newOffset;
+
+	return 0;
+}
+
+s32 udtMappedFileStream::Offset()
+{
+	return (s32)_fileOffset;
+}
+
+u64 udtMappedFileStream::Length()
+{
+	return (u64)_fileByteCount;
+}
+
+s32 udtMappedFileStream::Close()
+{
+	if(_data != NULL)
+	{
+		munmap((void*)_data, (size_t)_fileByteCount);
+		_data = NULL;
+	}
+
+	if(_file != -1)
+	{
+		close((int)_file);
+		_file = -1;
+	}
+
+	_fileByteCount = 0;
+	_fileOffset = 0;
+
+	return 0;
+}
+
+const u8* udtMappedFileStream::ReadInPlace(u32 byteCount, u32 paddingByteCount)
+{
+	// The padding bytes must also be in the mapping because readers are allowed to look past the end.
+	const u32 fileOffset = _fileOffset;
+	if(_data == NULL || (u64)fileOffset + (u64)byteCount + (u64)paddingByteCount > (u64)_fileByteCount)
+	{
+		return NULL;
+	}
+
+	_fileOffset += byteCount;
+
+	return _data + fileOffset;
+}
+
+
+#endif
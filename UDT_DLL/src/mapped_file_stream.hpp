@@ -0,0 +1,33 @@
+#pragma once
+
+
+#include "stream.hpp"
+
+
+// Read-only file stream backed by a memory mapping of the whole file.
+// Supports zero-copy reads through ReadInPlace.
+// Only implemented for Linux.
+struct udtMappedFileStream : udtStream
+{
+public:
+	udtMappedFileStream();
+	~udtMappedFileStream();
+
+	bool Open(const char* filePath, u32 offset = 0);
+
+	u32       Read(void* dstBuff, u32 elementSize, u32 count) override;
+	u32       Write(const void* srcBuff, u32 elementSize, u32 count) override;
+	s32       Seek(s32 offset, udtSeekOrigin::Id origin) override;
+	s32       Offset() override;
+	u64       Length() override;
+	s32       Close() override;
+	const u8* ReadInPlace(u32 byteCount, u32 paddingByteCount) override;
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtMappedFileStream);
+
+	const u8* _data;       // If invalid: NULL.
+	u32 _fileByteCount;
+	u32 _fileOffset;
+	s32 _file;             // If invalid: -1.
+};
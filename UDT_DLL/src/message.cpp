@@ -133,6 +133,13 @@ static const u16 HuffmanDecoderTable[2048] =
 	2322, 2504, 512, 2581, 2350, 1288, 512, 1568, 2323, 2597, 512, 1281, 1858, 1923, 512, 1543
 };
 
+// Decodes up to 2 symbols from the next 12 bits of input.
+// Bits  0- 7: first symbol
+// Bits  8-15: second symbol
+// Bits 16-19: bit count of the first symbol
+// Bits 20-24: bit count of both symbols or 0 when the second code doesn't fit in the 12 bits
+static u32 HuffmanPairDecoderTable[4096];
+
 static const u16 HuffmanEncoderTable[256] =
 {
 	34, 437, 1159, 1735, 2584, 280, 263, 1014, 341, 839, 1687, 183, 311, 726, 920, 2761,
@@ -186,6 +193,28 @@ static UDT_FORCE_INLINE void HuffmanOffsetTransmit(u8* fout, s32* offset, s32 ch
 }
 
 
+void BuildHuffmanTables()
+{
+	for(u32 window = 0; window < 4096; ++window)
+	{
+		const u32 first = (u32)HuffmanDecoderTable[window & 0x7FF];
+		const u32 firstBitCount = first >> 8;
+		const u32 second = (u32)HuffmanDecoderTable[(window >> firstBitCount) & 0x7FF];
+		const u32 secondBitCount = second >> 8;
+		u32 entry = (first & 0xFF) | (firstBitCount << 16);
+
+		// Codes are prefix-free, so the second symbol is only valid
+		// when all of its bits are within the window.
+		if(firstBitCount + secondBitCount <= 12)
+		{
+			entry |= ((second & 0xFF) << 8) | ((firstBitCount + secondBitCount) << 20);
+		}
+
+		HuffmanPairDecoderTable[window] = entry;
+	}
+}
+
+
 // if (s32)f == f and (s32)f + (1<<(FLOAT_INT_BITS-1)) < (1 << FLOAT_INT_BITS)
 // the float value will be sent with FLOAT_INT_BITS, otherwise all 32 bits will be sent
 #define	FLOAT_INT_BITS	13
@@ -207,7 +236,7 @@ static UDT_FORCE_INLINE void HuffmanOffsetTransmit(u8* fout, s32* offset, s32 ch
 #define ESF(field, bits) { (s16)OFFSET_OF(idEntityState3, field), bits }
 
 // Each field's index is the corresponding index into the field bit mask.
-const idNetField EntityStateFields3[]
+static constexpr idNetField EntityStateFields3[]
 {
 	ESF(eType, 8),
 	ESF(eFlags, 16),
@@ -263,7 +292,7 @@ const idNetField EntityStateFields3[]
 
 #undef ESF
 
-const s32 EntityStateFieldCount3 = sizeof(EntityStateFields3) / sizeof(EntityStateFields3[0]);
+static const s32 EntityStateFieldCount3 = sizeof(EntityStateFields3) / sizeof(EntityStateFields3[0]);
 static_assert(EntityStateFieldCount3 == 50, "dm3 network entity states have 50 fields!");
 
 //
@@ -273,7 +302,7 @@ static_assert(EntityStateFieldCount3 == 50, "dm3 network entity states have 50 f
 #define ESF(field, bits) { (s16)OFFSET_OF(idEntityState48, field), bits }
 
 // Each field's index is the corresponding index into the field bit mask.
-const idNetField EntityStateFields48[]
+static constexpr idNetField EntityStateFields48[]
 {
 	ESF(eType, 8),
 	ESF(eFlags, 19), // Changed from 16 to 19...
@@ -330,7 +359,7 @@ const idNetField EntityStateFields48[]
 
 #undef ESF
 
-const s32 EntityStateFieldCount48 = sizeof(EntityStateFields48) / sizeof(EntityStateFields48[0]);
+static const s32 EntityStateFieldCount48 = sizeof(EntityStateFields48) / sizeof(EntityStateFields48[0]);
 static_assert(EntityStateFieldCount48 == 51, "dm_48 network entity states have 51 fields!");
 
 //
@@ -339,7 +368,7 @@ static_assert(EntityStateFieldCount48 == 51, "dm_48 network entity states have 5
 
 #define ESF(field, bits) { (s16)OFFSET_OF(idEntityState68, field), bits }
 
-const idNetField EntityStateFields68[] =
+static constexpr idNetField EntityStateFields68[] =
 {
 	ESF(pos.trTime, 32),
 	ESF(pos.trBase[0], 0),
@@ -396,7 +425,7 @@ const idNetField EntityStateFields68[] =
 
 #undef ESF
 
-const s32 EntityStateFieldCount68 = sizeof(EntityStateFields68) / sizeof(EntityStateFields68[0]);
+static const s32 EntityStateFieldCount68 = sizeof(EntityStateFields68) / sizeof(EntityStateFields68[0]);
 
 //
 // 73
@@ -404,7 +433,7 @@ const s32 EntityStateFieldCount68 = sizeof(EntityStateFields68) / sizeof(EntityS
 
 #define ESF(field, bits) { (s16)OFFSET_OF(idEntityState73, field), bits }
 
-const idNetField EntityStateFields73[] =
+static constexpr idNetField EntityStateFields73[] =
 {
 	ESF(pos.trTime, 32),
 	ESF(pos.trBase[0], 0),
@@ -463,7 +492,7 @@ const idNetField EntityStateFields73[] =
 
 #undef ESF
 
-const s32 EntityStateFieldCount73 = sizeof(EntityStateFields73) / sizeof(EntityStateFields73[0]);
+static const s32 EntityStateFieldCount73 = sizeof(EntityStateFields73) / sizeof(EntityStateFields73[0]);
 
 //
 // 90
@@ -471,7 +500,7 @@ const s32 EntityStateFieldCount73 = sizeof(EntityStateFields73) / sizeof(EntityS
 
 #define ESF(field, bits) { (s16)OFFSET_OF(idEntityState90, field), bits }
 
-const idNetField EntityStateFields90[] =
+static constexpr idNetField EntityStateFields90[] =
 {
 	ESF(pos.trTime, 32),
 	ESF(pos.trBase[0], 0),
@@ -532,7 +561,7 @@ const idNetField EntityStateFields90[] =
 
 #undef ESF
 
-const s32 EntityStateFieldCount90 = sizeof(EntityStateFields90) / sizeof(EntityStateFields90[0]);
+static const s32 EntityStateFieldCount90 = sizeof(EntityStateFields90) / sizeof(EntityStateFields90[0]);
 
 //
 // 91
@@ -540,7 +569,7 @@ const s32 EntityStateFieldCount90 = sizeof(EntityStateFields90) / sizeof(EntityS
 
 #define ESF(field, bits) { (s16)OFFSET_OF(idEntityState91, field), bits }
 
-const idNetField EntityStateFields91[] =
+static constexpr idNetField EntityStateFields91[] =
 {
 	ESF(pos.trTime, 32),
 	ESF(pos.trBase[0], 0),
@@ -604,7 +633,7 @@ const idNetField EntityStateFields91[] =
 
 #undef ESF
 
-const s32 EntityStateFieldCount91 = sizeof(EntityStateFields91) / sizeof(EntityStateFields91[0]);
+static const s32 EntityStateFieldCount91 = sizeof(EntityStateFields91) / sizeof(EntityStateFields91[0]);
 
 //
 // 3
@@ -612,7 +641,7 @@ const s32 EntityStateFieldCount91 = sizeof(EntityStateFields91) / sizeof(EntityS
 
 #define PSF(field, bits) { (s16)OFFSET_OF(idPlayerState3, field), bits }
 
-static const idNetField PlayerStateFields3[] =
+static constexpr idNetField PlayerStateFields3[] =
 {
 	PSF(commandTime, 32),
 	PSF(pm_type, 8),
@@ -671,7 +700,7 @@ static const s32 PlayerStateFieldCount3 = sizeof(PlayerStateFields3) / sizeof(Pl
 
 #define PSF(field, bits) { (s16)OFFSET_OF(idPlayerState48, field), bits }
 
-static const idNetField PlayerStateFields48[] =
+static constexpr idNetField PlayerStateFields48[] =
 {
 	PSF(commandTime, 32),
 	PSF(pm_type, 8),
@@ -733,7 +762,7 @@ static const s32 PlayerStateFieldCount48 = sizeof(PlayerStateFields48) / sizeof(
 
 #define PSF(field, bits) { (s16)OFFSET_OF(idPlayerState68, field), bits }
 
-static const idNetField PlayerStateFields68[] =
+static constexpr idNetField PlayerStateFields68[] =
 {
 	PSF(commandTime, 32),
 	PSF(origin[0], 0),
@@ -795,7 +824,7 @@ static const s32 PlayerStateFieldCount68 = sizeof(PlayerStateFields68) / sizeof(
 
 #define PSF(field, bits) { (s16)OFFSET_OF(idPlayerState73, field), bits }
 
-static const idNetField PlayerStateFields73[] =
+static constexpr idNetField PlayerStateFields73[] =
 {
 	PSF(commandTime, 32),
 	PSF(origin[0], 0),
@@ -857,7 +886,7 @@ static const s32 PlayerStateFieldCount73 = sizeof(PlayerStateFields73) / sizeof(
 
 #define PSF(field, bits) { (s16)OFFSET_OF(idPlayerState90, field), bits }
 
-static const idNetField PlayerStateFields90[] =
+static constexpr idNetField PlayerStateFields90[] =
 {
 	PSF(commandTime, 32),
 	PSF(origin[0], 0),
@@ -921,7 +950,7 @@ static const s32 PlayerStateFieldCount90 = sizeof(PlayerStateFields90) / sizeof(
 
 #define PSF(field, bits) { (s16)OFFSET_OF(idPlayerState91, field), bits }
 
-static const idNetField PlayerStateFields91[] =
+static constexpr idNetField PlayerStateFields91[] =
 {
 	PSF(commandTime, 32),
 	PSF(origin[0], 0),
@@ -997,7 +1026,11 @@ udtMessage::udtMessage()
 	_entityStateFieldCount = EntityStateFieldCount68;
 	_playerStateFields = PlayerStateFields68;
 	_playerStateFieldCount = PlayerStateFieldCount68;
+	_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityT<EntityStateFields68, EntityStateFieldCount68>;
+	_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerT<PlayerStateFields68, PlayerStateFieldCount68>;
+	_protocolHuffman = true;
 	_fileName = udtString::NewNull();
+	_multiSymbolHuffman = false;
 }
 
 void udtMessage::InitContext(udtContext* context)
@@ -1018,6 +1051,9 @@ void udtMessage::InitProtocol(udtProtocol::Id protocol)
 			_entityStateFieldCount = EntityStateFieldCount91;
 			_playerStateFields = PlayerStateFields91;
 			_playerStateFieldCount = PlayerStateFieldCount91;
+			_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityT<EntityStateFields91, EntityStateFieldCount91>;
+			_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerT<PlayerStateFields91, PlayerStateFieldCount91>;
+			_protocolHuffman = true;
 			break;
 
 		case udtProtocol::Dm90:
@@ -1027,6 +1063,9 @@ void udtMessage::InitProtocol(udtProtocol::Id protocol)
 			_entityStateFieldCount = EntityStateFieldCount90;
 			_playerStateFields = PlayerStateFields90;
 			_playerStateFieldCount = PlayerStateFieldCount90;
+			_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityT<EntityStateFields90, EntityStateFieldCount90>;
+			_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerT<PlayerStateFields90, PlayerStateFieldCount90>;
+			_protocolHuffman = true;
 			break;
 
 		case udtProtocol::Dm73:
@@ -1036,6 +1075,9 @@ void udtMessage::InitProtocol(udtProtocol::Id protocol)
 			_entityStateFieldCount = EntityStateFieldCount73;
 			_playerStateFields = PlayerStateFields73;
 			_playerStateFieldCount = PlayerStateFieldCount73;
+			_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityT<EntityStateFields73, EntityStateFieldCount73>;
+			_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerT<PlayerStateFields73, PlayerStateFieldCount73>;
+			_protocolHuffman = true;
 			break;
 
 		case udtProtocol::Dm3:
@@ -1045,6 +1087,9 @@ void udtMessage::InitProtocol(udtProtocol::Id protocol)
 			_entityStateFieldCount = EntityStateFieldCount3;
 			_playerStateFields = PlayerStateFields3;
 			_playerStateFieldCount = PlayerStateFieldCount3;
+			_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityDM3T<EntityStateFields3, EntityStateFieldCount3>;
+			_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerDM3T<PlayerStateFields3, PlayerStateFieldCount3>;
+			_protocolHuffman = false;
 			break;
 
 		case udtProtocol::Dm48:
@@ -1054,6 +1099,9 @@ void udtMessage::InitProtocol(udtProtocol::Id protocol)
 			_entityStateFieldCount = EntityStateFieldCount48;
 			_playerStateFields = PlayerStateFields48;
 			_playerStateFieldCount = PlayerStateFieldCount48;
+			_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityDM3T<EntityStateFields48, EntityStateFieldCount48>;
+			_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerDM3T<PlayerStateFields48, PlayerStateFieldCount48>;
+			_protocolHuffman = false;
 			break;
 
 		case udtProtocol::Dm66:
@@ -1063,6 +1111,9 @@ void udtMessage::InitProtocol(udtProtocol::Id protocol)
 			_entityStateFieldCount = EntityStateFieldCount68;
 			_playerStateFields = PlayerStateFields68;
 			_playerStateFieldCount = PlayerStateFieldCount68;
+			_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityT<EntityStateFields68, EntityStateFieldCount68>;
+			_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerT<PlayerStateFields68, PlayerStateFieldCount68>;
+			_protocolHuffman = true;
 			break;
 
 		case udtProtocol::Dm67:
@@ -1072,6 +1123,9 @@ void udtMessage::InitProtocol(udtProtocol::Id protocol)
 			_entityStateFieldCount = EntityStateFieldCount68;
 			_playerStateFields = PlayerStateFields68;
 			_playerStateFieldCount = PlayerStateFieldCount68;
+			_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityT<EntityStateFields68, EntityStateFieldCount68>;
+			_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerT<PlayerStateFields68, PlayerStateFieldCount68>;
+			_protocolHuffman = true;
 			break;
 
 		case udtProtocol::Dm68:
@@ -1082,6 +1136,9 @@ void udtMessage::InitProtocol(udtProtocol::Id protocol)
 			_entityStateFieldCount = EntityStateFieldCount68;
 			_playerStateFields = PlayerStateFields68;
 			_playerStateFieldCount = PlayerStateFieldCount68;
+			_protocolReadDeltaEntity = &udtMessage::ReadDeltaEntityT<EntityStateFields68, EntityStateFieldCount68>;
+			_protocolReadDeltaPlayer = &udtMessage::ReadDeltaPlayerT<PlayerStateFields68, PlayerStateFieldCount68>;
+			_protocolHuffman = true;
 			break;
 	}
 }
@@ -1106,6 +1163,12 @@ void udtMessage::SetHuffman(bool huffman)
 	SetValid(Buffer.valid);
 }
 
+void udtMessage::SetMultiSymbolHuffman(bool multiSymbol)
+{
+	_multiSymbolHuffman = multiSymbol;
+	SetValid(Buffer.valid);
+}
+
 void udtMessage::GoToNextByte()
 {
 	if((Buffer.bit & 7) != 0)
@@ -1115,6 +1178,16 @@ void udtMessage::GoToNextByte()
 	}
 }
 
+void udtMessage::ClearUnusedBits()
+{
+	// The Huffman writer reports 1 more byte than it touched when it ends on a byte boundary.
+	const s32 usedBits = Buffer.bit - ((Buffer.cursize - 1) << 3);
+	if(Buffer.cursize > 0 && usedBits < 8)
+	{
+		Buffer.data[Buffer.cursize - 1] &= (u8)((1 << usedBits) - 1);
+	}
+}
+
 // negative bit values include signs
 void udtMessage::RealWriteBits(s32 value, s32 signedBits)
 {
@@ -1307,6 +1380,75 @@ s32 udtMessage::RealReadBits(s32 signedBits)
 	return value;
 }
 
+s32 udtMessage::RealReadBitsMultiSymbolHuffman(s32 signedBits)
+{
+	// Same overflow rules as RealReadBits.
+	// The 12-bit look-ups read at most 1 more bit past the last symbol than the 11-bit ones.
+	const bool signedValue = signedBits < 0;
+	s32 bits = signedValue ? -signedBits : signedBits;
+	if(Buffer.bit + bits > (Buffer.cursize + 4) * 8)
+	{
+		Context->LogError("udtMessage::RealReadBitsMultiSymbolHuffman: Overflowed! (in file: %s)", GetFileNamePtr());
+		SetValid(false);
+		return -1;
+	}
+
+	const u8* const bufferData = Buffer.data;
+	u32 value = 0;
+	u32 valueShift = 0;
+	s32 bitIndex = Buffer.bit;
+	const s32 nbits = bits & 7;
+	if(nbits)
+	{
+		const s16 allBits = *(const s16*)(bufferData + (bitIndex >> 3)) >> (bitIndex & 7);
+		value = (u32)(allBits & ((1 << nbits) - 1));
+		valueShift = (u32)nbits;
+		bitIndex += nbits;
+	}
+
+	s32 symbolsLeft = bits >> 3;
+	while(symbolsLeft >= 2)
+	{
+		const u32 window = ((*(const u32*)(bufferData + (bitIndex >> 3))) >> ((u32)bitIndex & 7)) & 0xFFF;
+		const u32 entry = HuffmanPairDecoderTable[window];
+		const s32 pairBitCount = (s32)((entry >> 20) & 31);
+		if(pairBitCount != 0)
+		{
+			value |= (entry & 0xFFFF) << valueShift;
+			valueShift += 16;
+			bitIndex += pairBitCount;
+			symbolsLeft -= 2;
+		}
+		else
+		{
+			value |= (entry & 0xFF) << valueShift;
+			valueShift += 8;
+			bitIndex += (s32)((entry >> 16) & 15);
+			symbolsLeft -= 1;
+		}
+	}
+
+	if(symbolsLeft)
+	{
+		const u16 code = ((*(const u32*)(bufferData + (bitIndex >> 3))) >> ((u32)bitIndex & 7)) & 0x7FF;
+		const u16 entry = HuffmanDecoderTable[code];
+		value |= (u32)(entry & 0xFF) << valueShift;
+		bitIndex += s32(entry >> 8);
+	}
+
+	Buffer.bit = bitIndex;
+	Buffer.readcount = (bitIndex >> 3) + 1;
+
+	if(signedValue)
+	{
+		const s32 bitCount = 32 - bits;
+
+		return ((s32)value << bitCount) >> bitCount;
+	}
+
+	return (s32)value;
+}
+
 s32 udtMessage::RealReadBitNoHuffman()
 {
 	// @NOTE: We leave overflow checking to RealReadBits.
@@ -2106,19 +2248,389 @@ bool udtMessage::RealReadDeltaEntity(bool& addedOrChanged, const idEntityStateBa
 	return ValidState();
 }
 
+//
+// Delta readers specialized for each protocol.
+// The field tables are walked at compile time so that all field offsets and bit counts are constants.
+// Protocols 66 and up always use Huffman compression, protocols 3 and 48 never do.
+//
+
+template<bool Huffman>
+UDT_FORCE_INLINE s32 udtMessage::InlineReadBit()
+{
+	if(!Buffer.valid)
+	{
+		return -1;
+	}
+
+	return Huffman ? RealReadBitHuffman() : RealReadBitNoHuffman();
+}
+
+template<bool Huffman>
+UDT_FORCE_INLINE s32 udtMessage::InlineReadBits(s32 bits)
+{
+	if(!Buffer.valid)
+	{
+		return -1;
+	}
+
+	if(Huffman && _multiSymbolHuffman)
+	{
+		return RealReadBitsMultiSymbolHuffman(bits);
+	}
+
+	return RealReadBits(bits);
+}
+
+template<bool Huffman>
+UDT_FORCE_INLINE s32 udtMessage::InlineReadField(s32 bits)
+{
+	if(bits != 0)
+	{
+		return InlineReadBits<Huffman>(bits);
+	}
+
+	if(InlineReadBit<Huffman>())
+	{
+		return InlineReadBits<Huffman>(32);
+	}
+
+	// Sneaking around the strict aliasing rules.
+	union FloatAndInt
+	{
+		FloatAndInt(f32 f) : AsFloat(f) {}
+
+		f32 AsFloat;
+		s32 AsInt;
+	};
+
+	const s32 intValue = InlineReadBits<Huffman>(FLOAT_INT_BITS) - FLOAT_INT_BIAS;
+	const FloatAndInt realValue((f32)intValue);
+
+	return realValue.AsInt;
+}
+
+template<const idNetField* Fields, s32 Index, s32 Count, bool Huffman>
+struct udtNetFieldsReader
+{
+	typedef udtNetFieldsReader<Fields, Index + 1, Count, Huffman> Next;
+
+	// Protocols 66 and up: the first changedCount fields have a "changed" bit and entities also have a "zero" bit.
+	static UDT_FORCE_INLINE void ReadDeltaFields(udtMessage& msg, const u8* from, u8* to, s32 changedCount, bool hasZeroBit)
+	{
+		const s32* const fromF = (const s32*)(from + Fields[Index].offset);
+		s32* const toF = (s32*)(to + Fields[Index].offset);
+		if(Index >= changedCount || msg.InlineReadBit<Huffman>() == 0)
+		{
+			*toF = *fromF;
+		}
+		else if(hasZeroBit && msg.InlineReadBit<Huffman>() == 0)
+		{
+			*toF = 0;
+		}
+		else
+		{
+			*toF = msg.InlineReadField<Huffman>(Fields[Index].bits);
+		}
+
+		Next::ReadDeltaFields(msg, from, to, changedCount, hasZeroBit);
+	}
+
+	// Protocols 3 and 48: the changed entity fields are flagged in a bit mask.
+	static UDT_FORCE_INLINE void ReadMaskedFields(udtMessage& msg, const u8* from, u8* to, const u8* bitMask)
+	{
+		const s32* const fromF = (const s32*)(from + Fields[Index].offset);
+		s32* const toF = (s32*)(to + Fields[Index].offset);
+		if((bitMask[Index >> 3] & (1 << (Index & 7))) == 0)
+		{
+			*toF = *fromF;
+		}
+		else
+		{
+			*toF = msg.InlineReadField<Huffman>(Fields[Index].bits);
+		}
+
+		Next::ReadMaskedFields(msg, from, to, bitMask);
+	}
+
+	// Protocols 3 and 48: every player field has a "changed" bit, unchanged fields are left as is.
+	static UDT_FORCE_INLINE void ReadFlaggedFields(udtMessage& msg, u8* to)
+	{
+		if(msg.InlineReadBit<Huffman>())
+		{
+			*(s32*)(to + Fields[Index].offset) = msg.InlineReadField<Huffman>(Fields[Index].bits);
+		}
+
+		Next::ReadFlaggedFields(msg, to);
+	}
+};
+
+template<const idNetField* Fields, s32 Count, bool Huffman>
+struct udtNetFieldsReader<Fields, Count, Count, Huffman>
+{
+	static UDT_FORCE_INLINE void ReadDeltaFields(udtMessage&, const u8*, u8*, s32, bool) {}
+	static UDT_FORCE_INLINE void ReadMaskedFields(udtMessage&, const u8*, u8*, const u8*) {}
+	static UDT_FORCE_INLINE void ReadFlaggedFields(udtMessage&, u8*) {}
+};
+
+template<const idNetField* Fields, s32 FieldCount>
+bool udtMessage::ReadDeltaEntityT(bool& addedOrChanged, const idEntityStateBase* from, idEntityStateBase* to, s32 number)
+{
+	if(number < 0 || number >= MAX_GENTITIES)
+	{
+		Context->LogError("udtMessage::ReadDeltaEntity: Bad delta entity number: %d (max is %d) (in file: %s)", number, MAX_GENTITIES - 1, GetFileNamePtr());
+		SetValid(false);
+		return false;
+	}
+
+	// check for a remove
+	if(InlineReadBit<true>() == 1)
+	{
+		Com_Memset(to, 0, _protocolSizeOfEntityState);
+		to->number = MAX_GENTITIES - 1;
+		addedOrChanged = false;
+		return ValidState();
+	}
+
+	// check for no delta
+	if(InlineReadBit<true>() == 0)
+	{
+		Com_Memcpy(to, from, _protocolSizeOfEntityState);
+		to->number = number;
+		addedOrChanged = false;
+		return ValidState();
+	}
+
+	addedOrChanged = true;
+	const s32 fieldCount = InlineReadBits<true>(8);
+	if(fieldCount > FieldCount || fieldCount < 0)
+	{
+		Context->LogError("udtMessage::ReadDeltaEntity: Invalid entityState field count: %d (max is %d) (in file: %s)", fieldCount, FieldCount, GetFileNamePtr());
+		SetValid(false);
+		return false;
+	}
+
+	to->number = number;
+	udtNetFieldsReader<Fields, 0, FieldCount, true>::ReadDeltaFields(*this, (const u8*)from, (u8*)to, fieldCount, true);
+
+	return ValidState();
+}
+
+template<const idNetField* Fields, s32 FieldCount>
+bool udtMessage::ReadDeltaEntityDM3T(bool& addedOrChanged, const idEntityStateBase* from, idEntityStateBase* to, s32 number)
+{
+	if(number < 0 || number >= MAX_GENTITIES)
+	{
+		Context->LogError("udtMessage::ReadDeltaEntity: Bad delta entity number: %d (max is %d) (in file: %s)", number, MAX_GENTITIES - 1, GetFileNamePtr());
+		SetValid(false);
+		return false;
+	}
+
+	// check for a remove
+	if(InlineReadBit<false>() == 1)
+	{
+		Com_Memset(to, 0, _protocolSizeOfEntityState);
+		to->number = MAX_GENTITIES - 1;
+		addedOrChanged = false;
+		return ValidState();
+	}
+
+	// check for no delta
+	if(InlineReadBit<false>() == 0)
+	{
+		Com_Memcpy(to, from, _protocolSizeOfEntityState);
+		to->number = number;
+		addedOrChanged = false;
+		return ValidState();
+	}
+
+	addedOrChanged = true;
+	to->number = number;
+
+	u8 bitMask[7]; // 50-51 bits used only.
+	const s32 maskIndex = InlineReadBits<false>(5);
+	if(maskIndex == 0x1F)
+	{
+		for(s32 i = 0; i < 6; ++i)
+		{
+			bitMask[i] = (u8)InlineReadBits<false>(8);
+		}
+		bitMask[6] = (u8)InlineReadBits<false>(FieldCount - 48);
+	}
+	else
+	{
+		for(s32 i = 0; i < 7; ++i)
+		{
+			bitMask[i] = KnownBitMasks[maskIndex & 0x1F][i];
+		}
+	}
+
+	udtNetFieldsReader<Fields, 0, FieldCount, false>::ReadMaskedFields(*this, (const u8*)from, (u8*)to, bitMask);
+
+	return ValidState();
+}
+
+template<const idNetField* Fields, s32 FieldCount>
+bool udtMessage::ReadDeltaPlayerT(const idPlayerStateBase* from, idPlayerStateBase* to)
+{
+	idLargestPlayerState dummy;
+	if(!from)
+	{
+		from = &dummy;
+		memset(&dummy, 0, sizeof(dummy));
+	}
+	memcpy(to, from, _protocolSizeOfPlayerState);
+
+	const s32 lc = InlineReadBits<true>(8);
+	if(lc > FieldCount || lc < 0)
+	{
+		Context->LogError("udtMessage::ReadDeltaPlayer: Invalid playerState field count: %d (max is %d) (in file: %s)", lc, FieldCount, GetFileNamePtr());
+		SetValid(false);
+		return false;
+	}
+
+	udtNetFieldsReader<Fields, 0, FieldCount, true>::ReadDeltaFields(*this, (const u8*)from, (u8*)to, lc, false);
+
+	// read the arrays
+	if(InlineReadBit<true>())
+	{
+		// parse stats
+		if(InlineReadBit<true>())
+		{
+			const s32 bits = InlineReadBits<true>(ID_MAX_PS_STATS);
+			for(s32 i = 0; i < ID_MAX_PS_STATS; i++)
+			{
+				if(bits & (1 << i))
+				{
+					to->stats[i] = InlineReadBits<true>(-16);
+				}
+			}
+		}
+
+		// parse persistant stats
+		if(InlineReadBit<true>())
+		{
+			const s32 bits = InlineReadBits<true>(ID_MAX_PS_PERSISTANT);
+			for(s32 i = 0; i < ID_MAX_PS_PERSISTANT; i++)
+			{
+				if(bits & (1 << i))
+				{
+					to->persistant[i] = InlineReadBits<true>(16);
+				}
+			}
+		}
+
+		// parse ammo
+		if(InlineReadBit<true>())
+		{
+			const s32 bits = InlineReadBits<true>(ID_MAX_PS_WEAPONS);
+			for(s32 i = 0; i < ID_MAX_PS_WEAPONS; i++)
+			{
+				if(bits & (1 << i))
+				{
+					to->ammo[i] = InlineReadBits<true>(16);
+				}
+			}
+		}
+
+		// parse powerups
+		if(InlineReadBit<true>())
+		{
+			const s32 bits = InlineReadBits<true>(ID_MAX_PS_POWERUPS);
+			for(s32 i = 0; i < ID_MAX_PS_POWERUPS; i++)
+			{
+				if(bits & (1 << i))
+				{
+					to->powerups[i] = InlineReadBits<true>(32);
+				}
+			}
+		}
+	}
+
+	return ValidState();
+}
+
+template<const idNetField* Fields, s32 FieldCount>
+bool udtMessage::ReadDeltaPlayerDM3T(const idPlayerStateBase* from, idPlayerStateBase* to)
+{
+	idLargestPlayerState dummy;
+	if(!from)
+	{
+		from = &dummy;
+		memset(&dummy, 0, sizeof(dummy));
+	}
+	memcpy(to, from, _protocolSizeOfPlayerState);
+
+	udtNetFieldsReader<Fields, 0, FieldCount, false>::ReadFlaggedFields(*this, (u8*)to);
+
+	// Stats array.
+	if(InlineReadBit<false>())
+	{
+		const s32 mask = InlineReadBits<false>(16);
+		for(s32 i = 0; i < ID_MAX_PS_STATS; ++i)
+		{
+			if((mask & (1 << i)) != 0)
+			{
+				to->stats[i] = InlineReadBits<false>(-16);
+			}
+		}
+	}
+
+	// Persistent array.
+	if(InlineReadBit<false>())
+	{
+		const s32 mask = InlineReadBits<false>(16);
+		for(s32 i = 0; i < ID_MAX_PS_PERSISTANT; ++i)
+		{
+			if((mask & (1 << i)) != 0)
+			{
+				to->persistant[i] = InlineReadBits<false>(16);
+			}
+		}
+	}
+
+	// Ammo array.
+	if(InlineReadBit<false>())
+	{
+		const s32 mask = InlineReadBits<false>(16);
+		for(s32 i = 0; i < ID_MAX_PS_WEAPONS; ++i)
+		{
+			if((mask & (1 << i)) != 0)
+			{
+				to->ammo[i] = InlineReadBits<false>(16);
+			}
+		}
+	}
+
+	// Power-ups array.
+	if(InlineReadBit<false>())
+	{
+		const s32 mask = InlineReadBits<false>(16);
+		for(s32 i = 0; i < ID_MAX_PS_POWERUPS; ++i)
+		{
+			if((mask & (1 << i)) != 0)
+			{
+				to->powerups[i] = InlineReadBits<false>(32);
+			}
+		}
+	}
+
+	return ValidState();
+}
+
 void udtMessage::SetValid(bool valid)
 {
 	Buffer.valid = valid;
 	if(valid)
 	{
-		_readBits = &udtMessage::RealReadBits;
+		_readBits = (!Buffer.oob && _multiSymbolHuffman) ? &udtMessage::RealReadBitsMultiSymbolHuffman : &udtMessage::RealReadBits;
 		_readBit = Buffer.oob ? &udtMessage::RealReadBitNoHuffman : &udtMessage::RealReadBitHuffman;
 		_readFloat = &udtMessage::RealReadFloat;
 		_readString = &udtMessage::RealReadString;
 		_readData = &udtMessage::RealReadData;
 		_peekByte = &udtMessage::RealPeekByte;
-		_readDeltaEntity = &udtMessage::RealReadDeltaEntity;
-		_readDeltaPlayer = &udtMessage::RealReadDeltaPlayer;
+		const bool specialized = Buffer.oob != _protocolHuffman;
+		_readDeltaEntity = specialized ? _protocolReadDeltaEntity : &udtMessage::RealReadDeltaEntity;
+		_readDeltaPlayer = specialized ? _protocolReadDeltaPlayer : &udtMessage::RealReadDeltaPlayer;
 		_writeBits = &udtMessage::RealWriteBits;
 		_writeFloat = &udtMessage::RealWriteFloat;
 		_writeString = &udtMessage::RealWriteString;
@@ -5,6 +5,11 @@
 #include "context.hpp"
 
 
+// Upper bound on how many bytes past the end of the message data the read functions can touch:
+// 4 bytes of tolerated overflow + 8 bytes for the widest unaligned load.
+#define UDT_MESSAGE_READ_PADDING 16
+
+
 struct idMessage
 {
 	u8*  data;
@@ -22,6 +27,8 @@ struct idNetField
 	s16 bits; // 0 = floating-point number (f32)
 };
 
+extern void BuildHuffmanTables(); // Once, before any message is read.
+
 struct udtMessage
 {
 public:
@@ -33,7 +40,9 @@ public:
 	void  WriteData (const void* data, s32 length);
 	void  Bitstream();
 	void  SetHuffman(bool huffman);
+	void  SetMultiSymbolHuffman(bool multiSymbol); // Decode up to 2 Huffman symbols per table look-up.
 	void  GoToNextByte();
+	void  ClearUnusedBits(); // Call before writing the data out so that the last byte doesn't hold bits of earlier messages.
 	bool  ValidState() const { return Buffer.valid; }
 	void  SetFileName(const udtString& fileName) { _fileName = fileName; }
 
@@ -82,6 +91,7 @@ private:
 	bool  DummyWriteDeltaEntity(const idEntityStateBase*, const idEntityStateBase*, bool) { return false; }
 
 	s32   RealReadBits(s32 bits);
+	s32   RealReadBitsMultiSymbolHuffman(s32 bits);
 	s32   RealReadBitNoHuffman();
 	s32   RealReadBitHuffman();
 	s32   RealReadFloat();
@@ -91,6 +101,16 @@ private:
 	bool  RealReadDeltaEntity(bool& addedOrChanged, const idEntityStateBase* from, idEntityStateBase* to, s32 number);
 	bool  RealReadDeltaPlayer(const idPlayerStateBase* from, idPlayerStateBase* to);
 
+	// Specialized for each protocol's field tables. Selected once in InitProtocol.
+	template<const idNetField* Fields, s32 FieldCount> bool ReadDeltaEntityT(bool& addedOrChanged, const idEntityStateBase* from, idEntityStateBase* to, s32 number);
+	template<const idNetField* Fields, s32 FieldCount> bool ReadDeltaEntityDM3T(bool& addedOrChanged, const idEntityStateBase* from, idEntityStateBase* to, s32 number);
+	template<const idNetField* Fields, s32 FieldCount> bool ReadDeltaPlayerT(const idPlayerStateBase* from, idPlayerStateBase* to);
+	template<const idNetField* Fields, s32 FieldCount> bool ReadDeltaPlayerDM3T(const idPlayerStateBase* from, idPlayerStateBase* to);
+	template<bool Huffman> s32 InlineReadBit();
+	template<bool Huffman> s32 InlineReadBits(s32 bits);
+	template<bool Huffman> s32 InlineReadField(s32 bits);
+	template<const idNetField*, s32, s32, bool> friend struct udtNetFieldsReader;
+
 	void  RealWriteBits(s32 value, s32 bits);
 	void  RealWriteFloat(s32 c);
 	void  RealWriteString(const char* s, s32 length, s32 bufferLength, char* buffer);
@@ -142,4 +162,8 @@ private:
 	WriteStringFunc      _writeString;
 	WriteDeltaPlayerFunc _writeDeltaPlayer;
 	WriteDeltaEntityFunc _writeDeltaEntity;
+	ReadDeltaEntityFunc  _protocolReadDeltaEntity;
+	ReadDeltaPlayerFunc  _protocolReadDeltaPlayer;
+	bool                 _protocolHuffman; // The specialized delta readers are only used when the message has the protocol's compression mode.
+	bool                 _multiSymbolHuffman;
 };
@@ -6,13 +6,15 @@
 #include "system.hpp"
 #include "timer.hpp"
 #include "api_helpers.hpp"
+#include "parser_runner.hpp"
 
 #include <stdlib.h>
 #include <assert.h>
 
 
-#define    UDT_MIN_BYTE_SIZE_PER_THREAD    ((u64)(6 * (1<<20)))
-#define    UDT_MAX_THREAD_COUNT            (16)
+#define    UDT_DEFAULT_MIN_BYTE_SIZE_PER_THREAD    ((u64)(6 * (1<<20)))
+#define    UDT_AUTO_TUNE_PERIOD_MS                 (500)
+#define    UDT_AUTO_TUNE_MIN_EFFICIENCY            (0.75)
 
 
 struct FileInfo
@@ -39,19 +41,69 @@ static int SortByThreadIndexAscending(const void* aPtr, const void* bPtr)
 	return (int)(a - b);
 }
 
+struct ThreadLimits
+{
+	u64 MinByteCountPerThread;
+	u32 MaxThreadCount;
+	u32 MinFileCountPerThread;
+	u32 ProcessorCoreCount;
+};
+
+static void GetThreadLimits(ThreadLimits& limits, const udtMultiParseArg& info)
+{
+	u32 processorCoreCount = 1;
+	GetProcessorCoreCount(processorCoreCount);
+
+	limits.ProcessorCoreCount = processorCoreCount;
+	limits.MaxThreadCount = info.MaxThreadCount;
+	limits.MinByteCountPerThread = UDT_DEFAULT_MIN_BYTE_SIZE_PER_THREAD;
+	limits.MinFileCountPerThread = 1;
+
+	const udtThreadPolicy* const policy = info.ThreadPolicy;
+	if(policy != NULL)
+	{
+		limits.MaxThreadCount = policy->MaxThreadCount != 0 ? policy->MaxThreadCount : processorCoreCount;
+		if(policy->MinByteCountPerThread != 0)
+		{
+			limits.MinByteCountPerThread = policy->MinByteCountPerThread;
+		}
+		if(policy->MinFileCountPerThread != 0)
+		{
+			limits.MinFileCountPerThread = policy->MinFileCountPerThread;
+		}
+	}
+}
+
 udtDemoThreadAllocator::udtDemoThreadAllocator()
 {
+	DynamicScheduling = false;
+	AutoTune = false;
+	PinThreadsToCores = false;
 }
 
-bool udtDemoThreadAllocator::Process(const char** filePaths, u32 fileCount, u32 maxThreadCount)
+bool udtDemoThreadAllocator::Process(const udtMultiParseArg& info)
 {
-	if(maxThreadCount <= 1 || fileCount <= 1)
+	const udtThreadPolicy* const policy = info.ThreadPolicy;
+	const u32 policyFlags = policy != NULL ? policy->Flags : 0;
+	AutoTune = (policyFlags & (u32)udtThreadPolicyFlag::AutoTune) != 0;
+	PinThreadsToCores = (policyFlags & (u32)udtThreadPolicyFlag::PinThreadsToCores) != 0;
+	DynamicScheduling = AutoTune || (info.Flags & (u32)udtMultiParseArgFlag::DynamicScheduling) != 0;
+
+	ThreadLimits limits;
+	GetThreadLimits(limits, info);
+	const u32 processorCoreCount = limits.ProcessorCoreCount;
+	const u64 minByteCountPerThread = limits.MinByteCountPerThread;
+	const u32 minFileCountPerThread = limits.MinFileCountPerThread;
+	u32 maxThreadCount = limits.MaxThreadCount;
+
+	const char** const filePaths = info.FilePaths;
+	const u32 fileCount = info.FileCount;
+
+	if(maxThreadCount <= 1 || fileCount < 2 * minFileCountPerThread)
 	{
 		return false;
 	}
 
-	u32 processorCoreCount = 1;
-	GetProcessorCoreCount(processorCoreCount);
 	if(processorCoreCount == 1)
 	{
 		return false;
@@ -72,16 +124,15 @@ bool udtDemoThreadAllocator::Process(const char** filePaths, u32 fileCount, u32
 		totalByteCount += byteCount;
 	}
 
-	if(totalByteCount < 2 * UDT_MIN_BYTE_SIZE_PER_THREAD)
+	if(totalByteCount < 2 * minByteCountPerThread)
 	{
 		return false;
 	}
 
 	// Prepare the final thread array.
-	maxThreadCount = udt_min(maxThreadCount, (u32)UDT_MAX_THREAD_COUNT);
 	maxThreadCount = udt_min(maxThreadCount, processorCoreCount);
-	maxThreadCount = udt_min(maxThreadCount, fileCount);
-	const u32 finalThreadCount = udt_min(maxThreadCount, (u32)(totalByteCount / UDT_MIN_BYTE_SIZE_PER_THREAD));
+	maxThreadCount = udt_min(maxThreadCount, fileCount / minFileCountPerThread);
+	const u32 finalThreadCount = (u32)udt_min((u64)maxThreadCount, totalByteCount / minByteCountPerThread);
 	Threads.Resize(finalThreadCount);
 	memset(Threads.GetStartAddress(), 0, (size_t)Threads.GetSize() * sizeof(udtParsingThreadData));
 	for(u32 i = 0; i < finalThreadCount; ++i)
@@ -94,6 +145,28 @@ bool udtDemoThreadAllocator::Process(const char** filePaths, u32 fileCount, u32
 	// Sort files by size.
 	qsort(files.GetStartAddress(), (size_t)fileCount, sizeof(FileInfo), &SortByFileSizesDescending);
 
+	if(DynamicScheduling)
+	{
+		// The queue is the sorted file list: the largest demos get started first.
+		// Every thread reports progress relative to the total job size.
+		FilePaths.Resize(fileCount);
+		FileSizes.Resize(fileCount);
+		InputIndices.Resize(fileCount);
+		for(u32 i = 0; i < fileCount; ++i)
+		{
+			FilePaths[i] = files[i].FilePath;
+			FileSizes[i] = files[i].ByteCount;
+			InputIndices[i] = files[i].InputIdx;
+		}
+
+		for(u32 i = 0; i < finalThreadCount; ++i)
+		{
+			Threads[i].TotalByteCount = totalByteCount;
+		}
+
+		return true;
+	}
+
 	// Assign files to threads.
 	for(u32 i = 0; i < fileCount; ++i)
 	{
@@ -148,6 +221,7 @@ struct MultiThreadedProgressContext
 	u64 TotalByteCount;
 	u64 ProcessedByteCount;
 	u64 CurrentJobByteCount;
+	u64* OutputProcessedByteCount;
 	f32* Progress;
 	udtTimer* Timer;
 	u32 MinProgressTimeMs;
@@ -161,6 +235,11 @@ static void MultiThreadedProgressProgressCallback(f32 jobProgress, void* userDat
 		return;
 	}
 
+	// Always kept up to date for auto-tuning.
+	const u64 jobProcessed = (u64)((f64)context->CurrentJobByteCount * (f64)jobProgress);
+	const u64 totalProcessed = context->ProcessedByteCount + jobProcessed;
+	*context->OutputProcessedByteCount = totalProcessed;
+
 	if(context->Timer->GetElapsedMs() < u64(context->MinProgressTimeMs))
 	{
 		return;
@@ -168,8 +247,6 @@ static void MultiThreadedProgressProgressCallback(f32 jobProgress, void* userDat
 
 	context->Timer->Restart();
 
-	const u64 jobProcessed = (u64)((f64)context->CurrentJobByteCount * (f64)jobProgress);
-	const u64 totalProcessed = context->ProcessedByteCount + jobProcessed;
 	const f32 realProgress = udt_clamp((f32)totalProcessed / (f32)context->TotalByteCount, 0.0f, 1.0f);
 
 	*context->Progress = realProgress;
@@ -202,6 +279,18 @@ static void ThreadFunction(void* userData)
 		return;
 	}
 
+	if(shared->JobType == (u32)udtParsingJobType::CutByTime && shared->JobSpecificInfo == NULL)
+	{
+		data->Finished = true;
+		return;
+	}
+
+	if(shared->JobType == (u32)udtParsingJobType::Probe && shared->JobSpecificInfo == NULL)
+	{
+		data->Finished = true;
+		return;
+	}
+
 	const u32 startIdx = data->FirstFileIndex;
 	const u32 endIdx = startIdx + data->FileCount;
 
@@ -212,6 +301,7 @@ static void ThreadFunction(void* userData)
 	progressContext.TotalByteCount = data->TotalByteCount;
 	progressContext.ProcessedByteCount = 0;
 	progressContext.CurrentJobByteCount = 0;
+	progressContext.OutputProcessedByteCount = &data->ProcessedByteCount;
 	progressContext.Timer = &timer;
 	progressContext.Progress = &data->Progress;
 	progressContext.MinProgressTimeMs = shared->ParseInfo->MinProgressTimeMs;
@@ -221,8 +311,11 @@ static void ThreadFunction(void* userData)
 	newParseInfo.ProgressContext = &progressContext;
 
 	s32* const errorCodes = shared->MultiParseInfo->OutputErrorCodes;
+	const bool dynamicScheduling = shared->NextFileIndex != NULL;
+	const u32 demoCount = dynamicScheduling ? 0 : data->FileCount;
+	const udtParsingJobType::Id jobType = (udtParsingJobType::Id)shared->JobType;
 
-	if(!InitContextWithPlugIns(*data->Context, newParseInfo, data->FileCount, (udtParsingJobType::Id)shared->JobType, shared->JobSpecificInfo))
+	if(!InitContextWithPlugIns(*data->Context, newParseInfo, demoCount, jobType, shared->JobSpecificInfo))
 	{
 		data->Result = false;
 		data->Finished = true;
@@ -230,33 +323,57 @@ static void ThreadFunction(void* userData)
 	}
 
 	u64 actualProcessedByteCount = 0;
-	for(u32 i = startIdx; i < endIdx; ++i)
+	const u32 firstCutCount = data->Context->Parser.GetWrittenCutCount();
+	u32 contextDemoIdx = 0;
+	for(u32 i = startIdx; ; ++i)
 	{
 		if(shared->ParseInfo->CancelOperation != NULL && *shared->ParseInfo->CancelOperation != 0)
 		{
 			break;
 		}
 
-		const u32 originalInputIdx = data->Context->InputIndices[i - startIdx];
+		if(dynamicScheduling)
+		{
+			i = AtomicFetchAndAdd(shared->NextFileIndex, 1);
+			if(i >= shared->FileCount)
+			{
+				break;
+			}
+			data->Context->InputIndices.Add(shared->InputIndices[i]);
+		}
+		else if(i >= endIdx)
+		{
+			break;
+		}
+
+		const u32 originalInputIdx = data->Context->InputIndices[contextDemoIdx];
 		const u64 currentJobByteCount = shared->FileSizes[i];
 		progressContext.CurrentJobByteCount = currentJobByteCount;
 
-		const udtParsingJobType::Id jobType = (udtParsingJobType::Id)shared->JobType;
-		const bool success = ProcessSingleDemoFile(jobType, data->Context, i - startIdx, originalInputIdx, &newParseInfo, shared->FilePaths[i], shared->JobSpecificInfo);
+		const bool success = ProcessSingleDemoFile(jobType, data->Context, contextDemoIdx, originalInputIdx, &newParseInfo, shared->FilePaths[i], shared->JobSpecificInfo);
 		errorCodes[originalInputIdx] = GetErrorCode(success, shared->ParseInfo->CancelOperation);
+		++contextDemoIdx;
 
 		progressContext.ProcessedByteCount += currentJobByteCount;
+		data->ProcessedByteCount = progressContext.ProcessedByteCount;
 		if(success)
 		{
 			actualProcessedByteCount += currentJobByteCount;
 		}
 	}
 
+	if(dynamicScheduling)
+	{
+		data->Context->DemoCount = contextDemoIdx;
+	}
+
 	data->Context->UpdatePlugInBufferStructs();
 	
 	if(data->Shared->ParseInfo->PerformanceStats != NULL)
 	{
-		PerfStatsAddCurrentThread(data->Shared->ParseInfo->PerformanceStats, actualProcessedByteCount);
+		const u32 cutCount = data->Context->Parser.GetWrittenCutCount() - firstCutCount;
+		PerfStatsAddCurrentThread(data->Shared->ParseInfo->PerformanceStats, actualProcessedByteCount, (u64)cutCount);
+		PerfStatsAddParserProfile(data->Shared->ParseInfo->PerformanceStats, data->Shared->ParseInfo->PlugInPerformanceStats, *data->Context);
 	}
 
 #if defined(UDT_DEBUG) && defined(UDT_LOG_ALLOCATOR_DEBUG_STATS)
@@ -268,6 +385,22 @@ static void ThreadFunction(void* userData)
 	data->Finished = true;
 }
 
+static bool StartThread(udtThread& thread, udtDemoThreadAllocator& threadInfo, u32 threadIndex)
+{
+	if(!thread.CreateAndStart(&ThreadFunction, &threadInfo.Threads[threadIndex]))
+	{
+		return false;
+	}
+
+	if(threadInfo.PinThreadsToCores)
+	{
+		// Pinning is only a hint, failing to do so is not an error.
+		thread.PinToCore(threadIndex);
+	}
+
+	return true;
+}
+
 bool udtMultiThreadedParsing::Process(udtTimer& jobTimer, 
 									  udtParserContext* contexts,
 									  udtDemoThreadAllocator& threadInfo,
@@ -283,7 +416,7 @@ bool udtMultiThreadedParsing::Process(udtTimer& jobTimer,
 
 	if(parseInfo->PerformanceStats != NULL)
 	{
-		PerfStatsInit(parseInfo->PerformanceStats);
+		PerfStatsInit(parseInfo->PerformanceStats, parseInfo->PlugInPerformanceStats);
 	}
 
 	const u32 threadCount = threadInfo.Threads.GetSize();
@@ -295,7 +428,15 @@ bool udtMultiThreadedParsing::Process(udtTimer& jobTimer,
 	sharedData.ParseInfo = parseInfo;
 	sharedData.FilePaths = threadInfo.FilePaths.GetStartAddress();
 	sharedData.FileSizes = threadInfo.FileSizes.GetStartAddress();
+	sharedData.InputIndices = threadInfo.InputIndices.GetStartAddress();
+	sharedData.FileCount = threadInfo.FilePaths.GetSize();
 	sharedData.JobType = (u32)jobType;
+
+	volatile u32 nextFileIndex = 0;
+	if(threadInfo.DynamicScheduling)
+	{
+		sharedData.NextFileIndex = &nextFileIndex;
+	}
 	
 	for(u32 i = 0, count = multiParseInfo->FileCount; i < count; ++i)
 	{
@@ -309,10 +450,16 @@ bool udtMultiThreadedParsing::Process(udtTimer& jobTimer,
 	bool success = true;
 	udtVMArray<udtThread> threads("MultiThreadedParsing::Process::ThreadsArray");
 	threads.Resize(threadCount);
+	for(u32 i = 0; i < threadCount; ++i)
+	{
+		new (&threads[i]) udtThread;
+	}
+
 	for(u32 i = 0; i < threadCount; ++i)
 	{
 		udtParserContext* const context = contexts + i;
 		udtParsingThreadData& threadData = threadInfo.Threads[i];
+		// With dynamic scheduling, the indices are added as the demos get pulled from the queue.
 		const u32 demoCount = threadData.FileCount;
 		const u32 firstDemoIdx = threadData.FirstFileIndex;
 		context->InputIndices.Resize(demoCount);
@@ -321,11 +468,21 @@ bool udtMultiThreadedParsing::Process(udtTimer& jobTimer,
 			context->InputIndices[j] = threadInfo.InputIndices[firstDemoIdx + j];
 		}
 
-		udtThread& thread = threads[i];
-		new (&thread) udtThread;
 		threadData.Context = contexts + i;
 		threadData.Shared = &sharedData;
-		if(!thread.CreateAndStart(&ThreadFunction, &threadData))
+	}
+
+	// With auto-tuning, we start with a single thread and keep doubling the count 
+	// for as long as the aggregate throughput scales well enough.
+	u32 startedThreadCount = threadInfo.AutoTune ? 1 : threadCount;
+	bool autoTuning = threadInfo.AutoTune;
+	u64 autoTuneByteCount = 0;
+	f64 singleThreadBytesPerUs = 0.0;
+	udtTimer autoTuneTimer;
+	autoTuneTimer.Start();
+	for(u32 i = 0; i < startedThreadCount; ++i)
+	{
+		if(!StartThread(threads[i], threadInfo, i))
 		{
 			success = false;
 			goto thread_clean_up;
@@ -336,7 +493,7 @@ bool udtMultiThreadedParsing::Process(udtTimer& jobTimer,
 	{
 		// Find the first non-finished thread.
 		u32 threadIdx = (u32)-1;
-		for(u32 i = 0; i < threadCount; ++i)
+		for(u32 i = 0; i < startedThreadCount; ++i)
 		{
 			if(!threadInfo.Threads[i].Finished)
 			{
@@ -351,11 +508,57 @@ bool udtMultiThreadedParsing::Process(udtTimer& jobTimer,
 		}
 
 		udtParsingThreadData& data = threadInfo.Threads[threadIdx];
-		if(threads[threadIdx].TimedJoin(minProgressTimeMs))
+		const u32 joinTimeMs = autoTuning ? udt_min(minProgressTimeMs, (u32)UDT_AUTO_TUNE_PERIOD_MS) : minProgressTimeMs;
+		if(threads[threadIdx].TimedJoin(joinTimeMs))
 		{
 			data.Finished = true;
 		}
 
+		if(autoTuning && autoTuneTimer.GetElapsedMs() >= (u64)UDT_AUTO_TUNE_PERIOD_MS)
+		{
+			u64 byteCount = 0;
+			for(u32 i = 0; i < startedThreadCount; ++i)
+			{
+				byteCount += threadInfo.Threads[i].ProcessedByteCount;
+			}
+
+			const f64 bytesPerUs = (f64)(byteCount - autoTuneByteCount) / (f64)udt_max(autoTuneTimer.GetElapsedUs(), (u64)1);
+			if(startedThreadCount == 1)
+			{
+				singleThreadBytesPerUs = bytesPerUs;
+			}
+
+			const f64 efficiency = bytesPerUs / ((f64)startedThreadCount * singleThreadBytesPerUs);
+			if(singleThreadBytesPerUs <= 0.0 || 
+			   efficiency < UDT_AUTO_TUNE_MIN_EFFICIENCY || 
+			   nextFileIndex >= sharedData.FileCount ||
+			   startedThreadCount == threadCount)
+			{
+				autoTuning = false;
+			}
+			else
+			{
+				const u32 newThreadCount = udt_min(2 * startedThreadCount, threadCount);
+				for(u32 i = startedThreadCount; i < newThreadCount; ++i)
+				{
+					if(!StartThread(threads[i], threadInfo, i))
+					{
+						success = false;
+						break;
+					}
+					++startedThreadCount;
+				}
+				autoTuning = success && startedThreadCount < threadCount;
+			}
+
+			autoTuneByteCount = 0;
+			for(u32 i = 0; i < startedThreadCount; ++i)
+			{
+				autoTuneByteCount += threadInfo.Threads[i].ProcessedByteCount;
+			}
+			autoTuneTimer.Restart();
+		}
+
 		if(progressTimer.GetElapsedMs() < u64(minProgressTimeMs))
 		{
 			continue;
@@ -364,20 +567,49 @@ bool udtMultiThreadedParsing::Process(udtTimer& jobTimer,
 		progressTimer.Restart();
 
 		// The actual progress is that of the slowest thread.
+		// With dynamic scheduling, each thread's progress is relative to the total job size.
 		f32 progress = 2.0f;
-		for(u32 i = 0; i < threadCount; ++i)
+		if(threadInfo.DynamicScheduling)
+		{
+			progress = 0.0f;
+			for(u32 i = 0; i < startedThreadCount; ++i)
+			{
+				progress += threadInfo.Threads[i].Progress;
+			}
+			progress = udt_min(progress, 1.0f);
+		}
+		else
 		{
-			progress = udt_min(progress, threadInfo.Threads[i].Progress);
+			for(u32 i = 0; i < startedThreadCount; ++i)
+			{
+				progress = udt_min(progress, threadInfo.Threads[i].Progress);
+			}
 		}
 
-		(*parseInfo->ProgressCb)(progress, parseInfo->ProgressContext);
+		if(parseInfo->ProgressCb != NULL)
+		{
+			(*parseInfo->ProgressCb)(progress, parseInfo->ProgressContext);
+		}
 	}
 	
 	// If the above code is correct and never fails, this is redundant.
-	for(u32 i = 0; i < threadCount; ++i)
+	for(u32 i = 0; i < startedThreadCount; ++i)
 	{
 		threads[i].Join();
 	}
+
+	// The contexts of the threads that were never started still need to be valid for the caller.
+	for(u32 i = startedThreadCount; i < threadCount; ++i)
+	{
+		udtParserContext& context = contexts[i];
+		context.InputIndices.Clear();
+		if(!InitContextWithPlugIns(context, *parseInfo, 0, jobType, jobSpecificInfo))
+		{
+			success = false;
+			continue;
+		}
+		context.UpdatePlugInBufferStructs();
+	}
 	
 thread_clean_up:
 	for(u32 i = 0; i < threadCount; ++i)
@@ -388,7 +620,7 @@ thread_clean_up:
 	if(success && parseInfo->PerformanceStats != NULL)
 	{
 		PerfStatsAddCurrentThread(parseInfo->PerformanceStats, 0);
-		PerfStatsFinalize(parseInfo->PerformanceStats, threadCount, jobTimer.GetElapsedUs());
+		PerfStatsFinalize(parseInfo->PerformanceStats, startedThreadCount, jobTimer.GetElapsedUs());
 	}
 
 #if defined(UDT_DEBUG) && defined(UDT_LOG_ALLOCATOR_DEBUG_STATS)
@@ -398,3 +630,361 @@ thread_clean_up:
 
 	return success;
 }
+
+static bool FindGameStates(udtVMArray<u32>& fileOffsets, u64& fileByteCount, udtParserContext& context, const char* filePath, udtProtocol::Id protocol, u64 minByteCountPerThread, const s32* cancelOperation)
+{
+	UDT_INIT_DEMO_FILE_READER(file, filePath, (&context));
+	fileByteCount = file.Length();
+	if(fileByteCount < 2 * minByteCountPerThread)
+	{
+		return false;
+	}
+
+	// This only reads the message headers and the first commands of each message.
+	return FindGameStateFileOffsets(fileOffsets, context.Context, file, protocol, cancelOperation);
+}
+
+static bool ReadFirstServerInfo(udtString& serverInfo, udtVMLinearAllocator& allocator, udtParserContext& context, const char* filePath, udtProtocol::Id protocol, u32 fileOffset, const s32* cancelOperation)
+{
+	// Only parse the first game state message, with all plug-ins disabled.
+	UDT_INIT_DEMO_FILE_READER_AT(file, filePath, (&context), fileOffset);
+	udtBaseParser& parser = context.Parser;
+	if(!parser.Init(&context.Context, protocol, protocol, 0, false))
+	{
+		return false;
+	}
+
+	parser.SetFilePath(filePath);
+	parser.StopAtGameState = true;
+	udtParserRunner runner;
+	if(!runner.Init(parser, file, cancelOperation))
+	{
+		return false;
+	}
+
+	while(runner.ParseNextMessage())
+	{
+	}
+
+	if(!runner.WasSuccess() || parser._inGameStateIndex != 0)
+	{
+		return false;
+	}
+
+	serverInfo = udtString::NewCloneFromRef(allocator, parser.GetConfigString(CS_SERVERINFO));
+
+	return true;
+}
+
+udtDemoSegmentAllocator::udtDemoSegmentAllocator()
+{
+	FirstServerInfo = udtString::NewNull();
+	FileByteCount = 0;
+	PinThreadsToCores = false;
+}
+
+bool udtDemoSegmentAllocator::Process(udtParserContext& context, const udtParseArg& parseInfo, const udtMultiParseArg& info)
+{
+	Segments.Clear();
+	if(info.FileCount != 1)
+	{
+		return false;
+	}
+
+	ThreadLimits limits;
+	GetThreadLimits(limits, info);
+	const u32 policyFlags = info.ThreadPolicy != NULL ? info.ThreadPolicy->Flags : 0;
+	PinThreadsToCores = (policyFlags & (u32)udtThreadPolicyFlag::PinThreadsToCores) != 0;
+
+	const u32 maxThreadCount = udt_min(limits.MaxThreadCount, limits.ProcessorCoreCount);
+	if(maxThreadCount <= 1)
+	{
+		return false;
+	}
+
+	const char* const filePath = info.FilePaths[0];
+	const udtProtocol::Id protocol = (udtProtocol::Id)udtGetProtocolByFilePath(filePath);
+	if(protocol == udtProtocol::Invalid)
+	{
+		return false;
+	}
+
+	context.ReadAheadInput = (parseInfo.Flags & (u32)udtParseArgFlag::ReadAheadInput) != 0;
+	context.ReadAheadBlockSize = parseInfo.ReadAheadBlockSize;
+	context.ReadAheadBlockCount = parseInfo.ReadAheadBlockCount;
+	udtVMArray<u32> gameStateOffsets("DemoSegmentAllocator::GameStateOffsetsArray");
+	if(!FindGameStates(gameStateOffsets, FileByteCount, context, filePath, protocol, limits.MinByteCountPerThread, parseInfo.CancelOperation))
+	{
+		return false;
+	}
+
+	const u32 gameStateCount = gameStateOffsets.GetSize();
+	if(gameStateCount <= 1)
+	{
+		return false;
+	}
+
+	u32 threadCount = udt_min(maxThreadCount, gameStateCount);
+	threadCount = (u32)udt_min((u64)threadCount, FileByteCount / limits.MinByteCountPerThread);
+	if(threadCount <= 1)
+	{
+		return false;
+	}
+
+	// Each segment boundary is the game state closest to the ideal even split.
+	// Only the first segment can start before the first game state message.
+	udtGameStateSegment segment;
+	segment.StartFileOffset = 0;
+	segment.EndFileOffset = 0;
+	segment.FirstGameStateIndex = 0;
+	Segments.Add(segment);
+	u32 prevGameStateIdx = 0;
+	for(u32 t = 1; t < threadCount; ++t)
+	{
+		const u64 idealOffset = (FileByteCount * (u64)t) / (u64)threadCount;
+		u32 bestIdx = prevGameStateIdx + 1;
+		for(u32 i = bestIdx + 1; i < gameStateCount; ++i)
+		{
+			const u64 bestOffset = (u64)gameStateOffsets[bestIdx];
+			const u64 offset = (u64)gameStateOffsets[i];
+			const u64 bestDistance = bestOffset > idealOffset ? (bestOffset - idealOffset) : (idealOffset - bestOffset);
+			const u64 distance = offset > idealOffset ? (offset - idealOffset) : (idealOffset - offset);
+			if(distance >= bestDistance)
+			{
+				break;
+			}
+			bestIdx = i;
+		}
+
+		// Leave at least one game state for each of the remaining segments.
+		bestIdx = udt_min(bestIdx, gameStateCount - (threadCount - t));
+		if(bestIdx >= gameStateCount || bestIdx <= prevGameStateIdx)
+		{
+			break;
+		}
+
+		Segments[Segments.GetSize() - 1].EndFileOffset = gameStateOffsets[bestIdx];
+		segment.StartFileOffset = gameStateOffsets[bestIdx];
+		segment.EndFileOffset = 0;
+		segment.FirstGameStateIndex = (s32)bestIdx;
+		Segments.Add(segment);
+		prevGameStateIdx = bestIdx;
+	}
+
+	if(Segments.GetSize() <= 1)
+	{
+		return false;
+	}
+
+	StringAllocator.Clear();
+	
+	return ReadFirstServerInfo(FirstServerInfo, StringAllocator, context, filePath, protocol, gameStateOffsets[0], parseInfo.CancelOperation);
+}
+
+struct SegmentThreadData
+{
+	udtParsingThreadData* Data;
+	const udtGameStateSegment* Segment;
+	const udtString* FirstServerInfo;
+	const char* FilePath;
+};
+
+static void SegmentThreadFunction(void* userData)
+{
+	SegmentThreadData* const segmentData = (SegmentThreadData*)userData;
+	if(segmentData == NULL)
+	{
+		return;
+	}
+
+	udtParsingThreadData* const data = segmentData->Data;
+	udtParsingSharedData* const shared = data->Shared;
+
+	udtTimer timer;
+	timer.Start();
+
+	MultiThreadedProgressContext progressContext;
+	progressContext.TotalByteCount = data->TotalByteCount;
+	progressContext.ProcessedByteCount = 0;
+	progressContext.CurrentJobByteCount = data->TotalByteCount;
+	progressContext.OutputProcessedByteCount = &data->ProcessedByteCount;
+	progressContext.Timer = &timer;
+	progressContext.Progress = &data->Progress;
+	progressContext.MinProgressTimeMs = shared->ParseInfo->MinProgressTimeMs;
+
+	udtParseArg newParseInfo = *shared->ParseInfo;
+	newParseInfo.ProgressCb = &MultiThreadedProgressProgressCallback;
+	newParseInfo.ProgressContext = &progressContext;
+
+	if(!InitContextWithPlugIns(*data->Context, newParseInfo, 1, udtParsingJobType::General, NULL))
+	{
+		data->Result = false;
+		data->Finished = true;
+		return;
+	}
+	data->Context->InputIndices.Resize(1);
+	data->Context->InputIndices[0] = 0;
+
+	const udtGameStateSegment& segment = *segmentData->Segment;
+	const bool success = ParseDemoFileSegment(data->Context, &newParseInfo, segmentData->FilePath, segment.StartFileOffset, segment.EndFileOffset, *segmentData->FirstServerInfo);
+	data->Context->UpdatePlugInBufferStructs();
+	data->ProcessedByteCount = data->TotalByteCount;
+
+	if(success && shared->ParseInfo->PerformanceStats != NULL)
+	{
+		PerfStatsAddCurrentThread(shared->ParseInfo->PerformanceStats, data->TotalByteCount);
+		PerfStatsAddParserProfile(shared->ParseInfo->PerformanceStats, shared->ParseInfo->PlugInPerformanceStats, *data->Context);
+	}
+
+	data->Result = success;
+	data->Finished = true;
+}
+
+bool udtMultiThreadedParsing::ProcessSegments(udtTimer& jobTimer,
+											  udtParserContext* outputContext,
+											  udtParserContext* segmentContexts,
+											  udtDemoSegmentAllocator& segmentInfo,
+											  const udtParseArg* parseInfo,
+											  const udtMultiParseArg* multiParseInfo)
+{
+	assert(outputContext != NULL);
+	assert(segmentContexts != NULL);
+	assert(parseInfo != NULL);
+	assert(multiParseInfo != NULL);
+	assert(multiParseInfo->FileCount == 1);
+
+	if(parseInfo->PerformanceStats != NULL)
+	{
+		PerfStatsInit(parseInfo->PerformanceStats, parseInfo->PlugInPerformanceStats);
+	}
+
+	const u32 threadCount = segmentInfo.Segments.GetSize();
+	multiParseInfo->OutputErrorCodes[0] = (s32)udtErrorCode::Unprocessed;
+
+	udtParsingSharedData sharedData;
+	memset(&sharedData, 0, sizeof(sharedData));
+	sharedData.MultiParseInfo = multiParseInfo;
+	sharedData.ParseInfo = parseInfo;
+	sharedData.FilePaths = multiParseInfo->FilePaths;
+	sharedData.FileCount = 1;
+	sharedData.JobType = (u32)udtParsingJobType::General;
+
+	udtVMArray<udtParsingThreadData> threadData("MultiThreadedParsing::ProcessSegments::ThreadDataArray");
+	udtVMArray<SegmentThreadData> segmentData("MultiThreadedParsing::ProcessSegments::SegmentDataArray");
+	udtVMArray<udtThread> threads("MultiThreadedParsing::ProcessSegments::ThreadsArray");
+	threadData.Resize(threadCount);
+	segmentData.Resize(threadCount);
+	threads.Resize(threadCount);
+	for(u32 i = 0; i < threadCount; ++i)
+	{
+		const udtGameStateSegment& segment = segmentInfo.Segments[i];
+		const u32 endOffset = segment.EndFileOffset != 0 ? segment.EndFileOffset : (u32)segmentInfo.FileByteCount;
+
+		udtParsingThreadData& data = threadData[i];
+		memset(&data, 0, sizeof(data));
+		data.TotalByteCount = (u64)(endOffset - segment.StartFileOffset);
+		data.Shared = &sharedData;
+		data.Context = i == 0 ? outputContext : (segmentContexts + i - 1);
+		data.FileCount = 1;
+
+		segmentData[i].Data = &data;
+		segmentData[i].Segment = &segment;
+		segmentData[i].FirstServerInfo = &segmentInfo.FirstServerInfo;
+		segmentData[i].FilePath = multiParseInfo->FilePaths[0];
+
+		new (&threads[i]) udtThread;
+	}
+
+	udtTimer progressTimer;
+	progressTimer.Start();
+
+	const u32 minProgressTimeMs = parseInfo->MinProgressTimeMs;
+	bool success = true;
+	u32 startedThreadCount = 0;
+	for(u32 i = 0; i < threadCount; ++i)
+	{
+		if(!threads[i].CreateAndStart(&SegmentThreadFunction, &segmentData[i]))
+		{
+			success = false;
+			break;
+		}
+
+		if(segmentInfo.PinThreadsToCores)
+		{
+			// Pinning is only a hint, failing to do so is not an error.
+			threads[i].PinToCore(i);
+		}
+		++startedThreadCount;
+	}
+
+	for(;;)
+	{
+		u32 threadIdx = (u32)-1;
+		for(u32 i = 0; i < startedThreadCount; ++i)
+		{
+			if(!threadData[i].Finished)
+			{
+				threadIdx = i;
+			}
+		}
+
+		if(threadIdx == (u32)-1)
+		{
+			break;
+		}
+
+		if(threads[threadIdx].TimedJoin(minProgressTimeMs))
+		{
+			threadData[threadIdx].Finished = true;
+		}
+
+		if(progressTimer.GetElapsedMs() < u64(minProgressTimeMs))
+		{
+			continue;
+		}
+
+		progressTimer.Restart();
+
+		// All segments belong to the same file, so the progress is the total of processed bytes.
+		u64 processedByteCount = 0;
+		for(u32 i = 0; i < startedThreadCount; ++i)
+		{
+			processedByteCount += threadData[i].ProcessedByteCount;
+		}
+		const f32 progress = udt_clamp((f32)processedByteCount / (f32)segmentInfo.FileByteCount, 0.0f, 1.0f);
+
+		if(parseInfo->ProgressCb != NULL)
+		{
+			(*parseInfo->ProgressCb)(progress, parseInfo->ProgressContext);
+		}
+	}
+
+	for(u32 i = 0; i < startedThreadCount; ++i)
+	{
+		threads[i].Join();
+		success = success && threadData[i].Result;
+	}
+
+	for(u32 i = 0; i < threadCount; ++i)
+	{
+		threads[i].Release();
+	}
+
+	if(success)
+	{
+		for(u32 i = 1; i < threadCount; ++i)
+		{
+			outputContext->AppendDemoSegment(segmentContexts[i - 1], segmentInfo.Segments[i].FirstGameStateIndex);
+		}
+		outputContext->UpdatePlugInBufferStructs();
+	}
+
+	multiParseInfo->OutputErrorCodes[0] = GetErrorCode(success, parseInfo->CancelOperation);
+
+	if(success && parseInfo->PerformanceStats != NULL)
+	{
+		PerfStatsFinalize(parseInfo->PerformanceStats, startedThreadCount, jobTimer.GetElapsedUs());
+	}
+
+	return success;
+}
@@ -3,6 +3,7 @@
 
 #include "uberdemotools.h"
 #include "array.hpp"
+#include "string.hpp"
 #include "api_helpers.hpp"
 #include "timer.hpp"
 
@@ -11,6 +12,9 @@ struct udtParsingSharedData
 {
 	const char** FilePaths;
 	u64* FileSizes;
+	const u32* InputIndices;
+	volatile u32* NextFileIndex; // Only used with dynamic scheduling.
+	u32 FileCount;
 	const udtParseArg* ParseInfo;
 	const udtMultiParseArg* MultiParseInfo;
 	const void* JobSpecificInfo;
@@ -20,6 +24,7 @@ struct udtParsingSharedData
 struct udtParsingThreadData
 {
 	u64 TotalByteCount;
+	u64 ProcessedByteCount; // Updated as the thread makes progress.
 	udtParsingSharedData* Shared;
 	udtParserContext* Context;
 	u32 FirstFileIndex;
@@ -35,12 +40,39 @@ struct udtDemoThreadAllocator
 	udtDemoThreadAllocator();
 
 	// Returns true if more than 1 thread should be launched.
-	bool Process(const char** filePaths, u32 fileCount, u32 maxThreadCount);
+	// With dynamic scheduling, the threads don't get a fixed file list.
+	// The files are instead sorted largest first and pulled from a shared queue.
+	bool Process(const udtMultiParseArg& info);
 
 	udtVMArray<const char*> FilePaths { "DemoThreadAllocator::FilePathsArray" };
 	udtVMArray<u64> FileSizes { "DemoThreadAllocator::FileSizesArray" };
 	udtVMArray<u32> InputIndices { "DemoThreadAllocator::InputIndicesArray" };
 	udtVMArray<udtParsingThreadData> Threads { "DemoThreadAllocator::ThreadsArray" };
+	bool DynamicScheduling;
+	bool AutoTune; // Threads is then the maximum thread count.
+	bool PinThreadsToCores;
+};
+
+struct udtGameStateSegment
+{
+	u32 StartFileOffset;
+	u32 EndFileOffset; // 0 means the end of the file.
+	s32 FirstGameStateIndex;
+};
+
+struct udtDemoSegmentAllocator
+{
+	udtDemoSegmentAllocator();
+
+	// Returns true if the single input demo should be split across more than 1 thread.
+	// Segments always start at a game state message, so each one can be parsed independently.
+	bool Process(udtParserContext& context, const udtParseArg& parseInfo, const udtMultiParseArg& info);
+
+	udtVMArray<udtGameStateSegment> Segments { "DemoSegmentAllocator::SegmentsArray" };
+	udtVMLinearAllocator StringAllocator { "DemoSegmentAllocator::Strings" };
+	udtString FirstServerInfo; // Some of the analysis only uses the demo's first game state.
+	u64 FileByteCount;
+	bool PinThreadsToCores;
 };
 
 struct udtMultiThreadedParsing
@@ -52,4 +84,13 @@ struct udtMultiThreadedParsing
 				 const udtMultiParseArg* multiParseInfo,
 				 udtParsingJobType::Id jobType,
 				 const void* jobSpecificInfo);
+
+	// The first segment is parsed into outputContext and the others into segmentContexts.
+	// On success, the plug-in data of all segments is appended to outputContext in file order.
+	bool ProcessSegments(udtTimer& jobTimer,
+						 udtParserContext* outputContext,
+						 udtParserContext* segmentContexts,
+						 udtDemoSegmentAllocator& segmentInfo,
+						 const udtParseArg* parseInfo,
+						 const udtMultiParseArg* multiParseInfo);
 };
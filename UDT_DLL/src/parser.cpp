@@ -13,6 +13,14 @@ udtBaseParser::udtBaseParser()
 
 	UserData = NULL;
 	EnablePlugIns = true;
+	ContinuesDemo = false;
+	FirstServerInfo = udtString::NewNull();
+	StopAtGameState = false;
+	ReadWholeDemo = false;
+	MultiSymbolHuffman = false;
+	SkipUnneededSnapshots = false;
+	StoppedEarly = false;
+	SkippedSnapshots = false;
 
 	_inFileName = udtString::NewEmptyConstant();
 	_inFilePath = udtString::NewEmptyConstant();
@@ -27,12 +35,8 @@ udtBaseParser::udtBaseParser()
 	_inServerTime = UDT_S32_MIN;
 	_inLastSnapshotMessageNumber = UDT_S32_MIN;
 
-	_outFileName = udtString::NewEmptyConstant();
-	_outFilePath = udtString::NewEmptyConstant();
-	_outServerCommandSequence = 0;
-	_outSnapshotsWritten = 0;
-	_outWriteFirstMessage = false;
-	_outWriteMessage = false;
+	_nextCutIndex = 0;
+	_outCutCount = 0;
 }
 
 udtBaseParser::~udtBaseParser()
@@ -48,6 +52,12 @@ bool udtBaseParser::Init(udtContext* context, udtProtocol::Id inProtocol, udtPro
 	}
 
 	EnablePlugIns = enablePlugIns;
+	ContinuesDemo = false;
+	FirstServerInfo = udtString::NewNull();
+	StopAtGameState = false;
+	ReadWholeDemo = false;
+	StoppedEarly = false;
+	SkippedSnapshots = false;
 
 	_context = context;
 	_inProtocol = inProtocol;
@@ -62,10 +72,14 @@ bool udtBaseParser::Init(udtContext* context, udtProtocol::Id inProtocol, udtPro
 
 	_inFileName = udtString::NewEmptyConstant();
 	_inFilePath = udtString::NewEmptyConstant();
-	_outFileName = udtString::NewEmptyConstant();
-	_outFilePath = udtString::NewEmptyConstant();
 
+	for(u32 i = 0, count = _outputs.GetSize(); i < count; ++i)
+	{
+		_outputs[i].File.Close();
+	}
+	_outputs.Clear();
 	_cuts.Clear();
+	_nextCutIndex = 0;
 	_persistentAllocator.Clear();
 	_configStringAllocator.Clear();
 	_tempAllocator.Clear();
@@ -83,9 +97,11 @@ bool udtBaseParser::Init(udtContext* context, udtProtocol::Id inProtocol, udtPro
 
 	if(enablePlugIns)
 	{
+		udtPlugInsProfiler plugInsProfile(Profiler);
 		for(u32 i = 0; i < PlugIns.GetSize(); ++i)
 		{
 			PlugIns[i]->StartProcessingDemo();
+			plugInsProfile.PlugInDone(PlugIns[i]->ProfilerTicks);
 		}
 	}
 
@@ -103,11 +119,6 @@ void udtBaseParser::ResetForGamestateMessage()
 	_inServerTime = UDT_S32_MIN;
 	_inLastSnapshotMessageNumber = UDT_S32_MIN;
 
-	_outServerCommandSequence = 0;
-	_outSnapshotsWritten = 0;
-	_outWriteFirstMessage = false;
-	_outWriteMessage = false;
-
 	memset(_inEntityBaselines, 0, sizeof(_inEntityBaselines));
 	memset(_inSnapshots, 0, sizeof(_inSnapshots));
 	memset(_inConfigStrings, 0, sizeof(_inConfigStrings));
@@ -133,6 +144,9 @@ void udtBaseParser::Destroy()
 
 bool udtBaseParser::ParseNextMessage(const udtMessage& inMsg, s32 inServerMessageSequence, u32 fileOffset)
 {
+	udtScopedProfilerTicks profile(Profiler, udtParserProfilerStage::MessageParse);
+	++Profiler.MessageCount;
+
 	_inMsg = inMsg;
 	_inMsg.SetFileName(_inFileName);
 	_inServerMessageSequence = inServerMessageSequence;
@@ -143,9 +157,11 @@ bool udtBaseParser::ParseNextMessage(const udtMessage& inMsg, s32 inServerMessag
 
 bool udtBaseParser::ParseServerMessage()
 {
-	_outMsg.Init(_outMsgData, sizeof(_outMsgData));
+	_outOps.Clear();
+	_outSnapshots.Clear();
+	_outOpAllocator.Clear();
 
-	_outMsg.SetHuffman(_outProtocol >= udtProtocol::Dm66);
+	_inMsg.SetMultiSymbolHuffman(MultiSymbolHuffman);
 	_inMsg.SetHuffman(_inProtocol >= udtProtocol::Dm66);
 
 	//
@@ -163,18 +179,16 @@ bool udtBaseParser::ParseServerMessage()
 		}
 	}
 	_inReliableSequenceAcknowledge = reliableSequenceAcknowledge;
-	if(ShouldWriteMessage())
-	{
-		_outMsg.WriteLong(_inReliableSequenceAcknowledge);
-	}
 
 	if(EnablePlugIns && !PlugIns.IsEmpty())
 	{
 		udtMessageBundleCallbackArg info;
 		info.ReliableSequenceAcknowledge = reliableSequenceAcknowledge;
+		udtPlugInsProfiler plugInsProfile(Profiler);
 		for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
 		{
 			PlugIns[i]->ProcessMessageBundleStart(info, *this);
+			plugInsProfile.PlugInDone(PlugIns[i]->ProfilerTicks);
 		}
 	}
 
@@ -204,7 +218,7 @@ bool udtBaseParser::ParseServerMessage()
 		case svc_nop:
 			if(ShouldWriteMessage())
 			{
-				_outMsg.WriteByte(svc_nop);
+				AddOutputOp(udtOutputOpType::Nop, udtString::NewNull(), udtString::NewNull(), 0);
 			}
 			break;
 
@@ -214,6 +228,7 @@ bool udtBaseParser::ParseServerMessage()
 
 		case svc_gamestate:
 			if(!ParseGamestate()) return false;
+			if(StopAtGameState) return false;
 			break;
 
 		case svc_snapshot:
@@ -233,113 +248,165 @@ bool udtBaseParser::ParseServerMessage()
 		}
 	}
 
-	if(ShouldWriteMessage())
-	{
-		_outMsg.WriteByte(svc_EOF);
-	}
-
 	if(EnablePlugIns && !PlugIns.IsEmpty())
 	{
 		udtMessageBundleCallbackArg info;
 		info.ReliableSequenceAcknowledge = reliableSequenceAcknowledge;
+		udtPlugInsProfiler plugInsProfile(Profiler);
 		for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
 		{
 			PlugIns[i]->ProcessMessageBundleEnd(info, *this);
+			plugInsProfile.PlugInDone(PlugIns[i]->ProfilerTicks);
 		}
 	}
 
-	if(_cuts.GetSize() > 0)
+	if(!ProcessCuts())
 	{
-		const udtCutInfo cut = _cuts[0];
-		const s32 gameTime = _inServerTime;
+		return false;
+	}
 
-		if(_inGameStateIndex == cut.GameStateIndex && !_outWriteMessage &&
-		   gameTime >= cut.StartTimeMs && gameTime <= cut.EndTimeMs)
-		{
-			const bool wroteMessage = _outWriteMessage;
-			_outWriteMessage = true;
-			_outWriteFirstMessage = _outWriteMessage && !wroteMessage;
-		}
-		else if((_inGameStateIndex == cut.GameStateIndex && _outWriteMessage && gameTime > cut.EndTimeMs) ||
-				(_inGameStateIndex > cut.GameStateIndex && _outWriteMessage))
-		{
-			WriteLastMessage();
-			_outWriteMessage = false;
-			_outWriteFirstMessage = false;
-			_outServerCommandSequence = 0;
-			_outSnapshotsWritten = 0;
-			_outFile.Close();
-			_cuts.Remove(0);
-			if(_cuts.GetSize() == 0)
-			{
-				// It was the last cut, we're done parsing the file now.
-				return false;
-			}
-		}
+	if(ArePlugInsDone())
+	{
+		StoppedEarly = true;
+		return false;
 	}
 
-	if(_outWriteFirstMessage)
+	return true;
+}
+
+bool udtBaseParser::ProcessCuts()
+{
+	if(_cuts.IsEmpty())
 	{
-		udtCutInfo& cut = _cuts[0];
-		udtString filePath;
-		if(cut.FilePath != NULL)
+		return true;
+	}
+
+	const s32 gameTime = _inServerTime;
+
+	// Write the message to all the cuts in progress or close the ones that are done.
+	for(u32 i = 0; i < _outputs.GetSize();)
+	{
+		udtCutOutput& output = _outputs[i];
+		if(_inGameStateIndex > output.GameStateIndex ||
+		   (_inGameStateIndex == output.GameStateIndex && gameTime > output.EndTimeMs))
 		{
-			filePath = udtString::NewConstRef(cut.FilePath);
+			WriteLastMessage(output);
+			++_outCutCount;
+			const u32 lastIndex = _outputs.GetSize() - 1;
+			_outputs[i] = _outputs[lastIndex];
+			_outputs.Resize(lastIndex);
+			continue;
 		}
-		else
+
+		WriteNextMessage(output);
+		++i;
+	}
+
+	// Start the cuts that begin with this message.
+	for(u32 i = _nextCutIndex, count = _cuts.GetSize(); i < count; ++i)
+	{
+		udtCutInfo& cut = _cuts[i];
+		if(cut.GameStateIndex > _inGameStateIndex ||
+		   (cut.GameStateIndex == _inGameStateIndex && gameTime < cut.StartTimeMs))
 		{
-			udtDemoStreamCreatorArg info;
-			memset(&info, 0, sizeof(info));
-			info.StartTimeMs = cut.StartTimeMs;
-			info.EndTimeMs = cut.EndTimeMs;
-			info.Parser = this;
-			info.VeryShortDesc = cut.VeryShortDesc;
-			info.UserData = cut.UserData;
-			info.TempAllocator = &_tempAllocator;
-			info.FilePathAllocator = &_persistentAllocator;
-			filePath = (*cut.StreamCreator)(info);
+			break;
 		}
-		_outFile.Close();
-		if(_outFile.Open(filePath.GetPtr(), udtFileOpenMode::Write))
+
+		if(!cut.Started && cut.GameStateIndex == _inGameStateIndex && gameTime <= cut.EndTimeMs)
 		{
-			_outFilePath = filePath;
-			udtPath::GetFileName(_outFileName, _persistentAllocator, filePath);
-			_outMsg.SetFileName(_outFileName);
-			WriteFirstMessage();
-			_outWriteFirstMessage = false;
+			cut.Started = true;
+			StartCut(cut);
 		}
-		else
+	}
+
+	// The server time isn't always monotonic, so a cut that wasn't started 
+	// can only be skipped once we're past its game state.
+	while(_nextCutIndex < _cuts.GetSize())
+	{
+		const udtCutInfo& cut = _cuts[_nextCutIndex];
+		if(!cut.Started && cut.GameStateIndex >= _inGameStateIndex)
 		{
-			_cuts.Remove(0);
+			break;
 		}
+		++_nextCutIndex;
 	}
-	else if(_outWriteMessage)
+
+	// When the last cut is done, we're done parsing the file.
+	if(_outputs.IsEmpty() && _nextCutIndex >= _cuts.GetSize())
 	{
-		WriteNextMessage();
+		StoppedEarly = true;
+		return false;
 	}
 
 	return true;
 }
 
+void udtBaseParser::StartCut(const udtCutInfo& cut)
+{
+	udtString filePath;
+	if(cut.FilePath != NULL)
+	{
+		filePath = udtString::NewConstRef(cut.FilePath);
+	}
+	else
+	{
+		udtDemoStreamCreatorArg info;
+		memset(&info, 0, sizeof(info));
+		info.StartTimeMs = cut.StartTimeMs;
+		info.EndTimeMs = cut.EndTimeMs;
+		info.Parser = this;
+		info.VeryShortDesc = cut.VeryShortDesc;
+		info.UserData = cut.UserData;
+		info.TempAllocator = &_tempAllocator;
+		info.FilePathAllocator = &_persistentAllocator;
+		filePath = (*cut.StreamCreator)(info);
+	}
+
+	const u32 outputIndex = _outputs.GetSize();
+	_outputs.Resize(outputIndex + 1);
+	udtCutOutput& output = _outputs[outputIndex];
+	new (&output.File) udtFileStream();
+	if(!output.File.Open(filePath.GetPtr(), udtFileOpenMode::Write))
+	{
+		_outputs.Resize(outputIndex);
+		return;
+	}
+
+	udtPath::GetFileName(output.FileName, _persistentAllocator, filePath);
+	output.GameStateIndex = cut.GameStateIndex;
+	output.EndTimeMs = cut.EndTimeMs;
+	output.ServerCommandSequence = 0;
+	output.SnapshotsWritten = 0;
+	WriteFirstMessage(output);
+}
+
 void udtBaseParser::FinishParsing(bool /*success*/)
 {
-	// Close any output file stream that is still open, if any.
-	if(!_cuts.IsEmpty() && _outWriteMessage)
+	// Close the output file streams that are still open, if any.
+	for(u32 i = 0, count = _outputs.GetSize(); i < count; ++i)
 	{
-		WriteLastMessage();
-		_outWriteMessage = false;
-		_outWriteFirstMessage = false;
-		_outServerCommandSequence = 0;
-		_outSnapshotsWritten = 0;
-		_outFile.Close();
-		_cuts.Clear();
+		WriteLastMessage(_outputs[i]);
+		++_outCutCount;
 	}
+	_outputs.Clear();
+	_cuts.Clear();
+	_nextCutIndex = 0;
 
 	if(EnablePlugIns)
 	{
+		// When stopping at a game state, the rest of the demo is processed separately.
+		udtPlugInsProfiler plugInsProfile(Profiler);
 		for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
 		{
-			PlugIns[i]->FinishProcessingDemo();
+			if(StopAtGameState)
+			{
+				PlugIns[i]->FinishProcessingDemoSegment(_inGameStateIndex);
+			}
+			else
+			{
+				PlugIns[i]->FinishProcessingDemo();
+			}
+			plugInsProfile.PlugInDone(PlugIns[i]->ProfilerTicks);
 		}
 	}
 }
@@ -354,7 +421,7 @@ void udtBaseParser::AddCut(s32 gsIndex, s32 startTimeMs, s32 endTimeMs, udtDemoN
 	cut.EndTimeMs = endTimeMs;
 	cut.StreamCreator = streamCreator;
 	cut.UserData = userData;
-	_cuts.Add(cut);
+	InsertCut(cut);
 }
 
 void udtBaseParser::AddCut(s32 gsIndex, s32 startTimeMs, s32 endTimeMs, const char* filePath)
@@ -365,36 +432,104 @@ void udtBaseParser::AddCut(s32 gsIndex, s32 startTimeMs, s32 endTimeMs, const ch
 	cut.StartTimeMs = startTimeMs;
 	cut.EndTimeMs = endTimeMs;
 	cut.FilePath = filePath;
+	InsertCut(cut);
+}
+
+void udtBaseParser::InsertCut(const udtCutInfo& cut)
+{
+	// Keep the cuts sorted so that a single pass over the demo is enough.
 	_cuts.Add(cut);
+	u32 i = _cuts.GetSize() - 1;
+	for(; i > 0; --i)
+	{
+		const udtCutInfo& previous = _cuts[i - 1];
+		if(previous.GameStateIndex < cut.GameStateIndex ||
+		   (previous.GameStateIndex == cut.GameStateIndex && previous.StartTimeMs <= cut.StartTimeMs))
+		{
+			break;
+		}
+		_cuts[i] = previous;
+	}
+	_cuts[i] = cut;
 }
 
 bool udtBaseParser::ShouldWriteMessage() const
 {
-	return _outWriteMessage && _outProtocol >= udtProtocol::Dm66;
+	return !_outputs.IsEmpty() && _outProtocol >= udtProtocol::Dm66;
+}
+
+void udtBaseParser::AddOutputOp(udtOutputOpType::Id type, const udtString& string, const udtString& csIndex, u32 snapshotIndex)
+{
+	udtOutputOp op;
+	op.String = string;
+	op.ConfigStringIndex = csIndex;
+	op.SnapshotIndex = snapshotIndex;
+	op.Type = type;
+	_outOps.Add(op);
 }
 
-void udtBaseParser::WriteFirstMessage()
+void udtBaseParser::WriteFirstMessage(udtCutOutput& output)
 {
-	WriteGameState();
+	WriteGameState(output);
+	_outMsg.ClearUnusedBits();
 	const s32 length = _outMsg.Buffer.cursize;
-	udtStream& stream = _outFile;
+	udtStream& stream = output.File;
 	stream.Write(&_inServerMessageSequence, 4, 1);
 	stream.Write(&length, 4, 1);
 	stream.Write(_outMsg.Buffer.data, length, 1);
 }
 
-void udtBaseParser::WriteNextMessage()
+void udtBaseParser::WriteNextMessage(udtCutOutput& output)
 {
+	udtScopedProfilerTicks profile(Profiler, udtParserProfilerStage::OutputWrite);
+
+	_outMsg.Init(_outMsgData, sizeof(_outMsgData));
+	_outMsg.SetHuffman(_outProtocol >= udtProtocol::Dm66);
+	_outMsg.SetFileName(output.FileName);
+
+	if(_outProtocol >= udtProtocol::Dm66)
+	{
+		_outMsg.WriteLong(_inReliableSequenceAcknowledge);
+		for(u32 i = 0, count = _outOps.GetSize(); i < count; ++i)
+		{
+			const udtOutputOp& op = _outOps[i];
+			switch(op.Type)
+			{
+				case udtOutputOpType::Command:
+					_outMsg.WriteByte(svc_serverCommand);
+					_outMsg.WriteLong(output.ServerCommandSequence);
+					_outMsg.WriteString(op.String.GetPtr(), (s32)op.String.GetLength());
+					++output.ServerCommandSequence;
+					break;
+
+				case udtOutputOpType::BigConfigString:
+					WriteBigConfigStringCommand(output, op.ConfigStringIndex, op.String);
+					break;
+
+				case udtOutputOpType::Snapshot:
+					WriteSnapshot(output, _outSnapshots[op.SnapshotIndex]);
+					break;
+
+				case udtOutputOpType::Nop:
+				default:
+					_outMsg.WriteByte(svc_nop);
+					break;
+			}
+		}
+		_outMsg.WriteByte(svc_EOF);
+	}
+
+	_outMsg.ClearUnusedBits();
 	const s32 length = _outMsg.Buffer.cursize;
-	udtStream& stream = _outFile;
+	udtStream& stream = output.File;
 	stream.Write(&_inServerMessageSequence, 4, 1);
 	stream.Write(&length, 4, 1);
 	stream.Write(_outMsg.Buffer.data, length, 1);
 }
 
-void udtBaseParser::WriteLastMessage()
+void udtBaseParser::WriteLastMessage(udtCutOutput& output)
 {
-	udtStream& stream = _outFile;
+	udtStream& stream = output.File;
 	s32 length = -1;
 	stream.Write(&length, 4, 1);
 	stream.Write(&length, 4, 1);
@@ -408,7 +543,8 @@ bool udtBaseParser::ParseCommandString()
 	const char* const commandStringTemp = _inMsg.ReadString(commandStringLength);
 
 	// Do we have it already?
-	if(_inServerCommandSequence >= commandSequence) 
+	// The commands preceding the first game state of a demo segment were processed with the previous segment.
+	if(_inServerCommandSequence >= commandSequence || (ContinuesDemo && _inGameStateIndex < 0)) 
 	{
 		// Yes, don't bother processing it.
 		return true;
@@ -485,28 +621,31 @@ tokenize:
 		info.IsConfigString = isConfigString;
 		info.IsEmptyConfigString = isConfigString ? udtString::IsNullOrEmpty(tokenizer.GetArg(2)) : false;
 
+		udtPlugInsProfiler plugInsProfile(Profiler);
 		for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
 		{
 			PlugIns[i]->ProcessCommandMessage(info, *this);
+			plugInsProfile.PlugInDone(PlugIns[i]->ProfilerTicks);
 		}
 	}
 
 	if(ShouldWriteMessage())
 	{
+		// The strings need to outlive the temporary allocators until the message gets written.
 		if(csIndex >= 0 && commandStringLength >= MAX_STRING_CHARS)
 		{
-			WriteBigConfigStringCommand(tokenizer.GetArg(1), tokenizer.GetArg(2));
+			const udtString csIndexString = udtString::NewCloneFromRef(_outOpAllocator, tokenizer.GetArg(1));
+			const udtString csDataString = udtString::NewCloneFromRef(_outOpAllocator, tokenizer.GetArg(2));
+			AddOutputOp(udtOutputOpType::BigConfigString, csDataString, csIndexString, 0);
 		}
 		else if(commandStringLength < MAX_STRING_CHARS)
 		{
-			_outMsg.WriteByte(svc_serverCommand);
-			_outMsg.WriteLong(_outServerCommandSequence);
-			_outMsg.WriteString(commandString.GetPtr(), commandStringLength);
-			++_outServerCommandSequence;
+			const udtString command = udtString::NewClone(_outOpAllocator, commandString.GetPtr(), (u32)commandStringLength);
+			AddOutputOp(udtOutputOpType::Command, command, udtString::NewNull(), 0);
 		}
 		else
 		{
-			_outMsg.WriteByte(svc_nop);
+			AddOutputOp(udtOutputOpType::Nop, udtString::NewNull(), udtString::NewNull(), 0);
 		}
 	}
 	
@@ -601,9 +740,11 @@ bool udtBaseParser::ParseGamestate()
 		info.ClientNum = _inClientNum;
 		info.ChecksumFeed = _inChecksumFeed;
 
+		udtPlugInsProfiler plugInsProfile(Profiler);
 		for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
 		{
 			PlugIns[i]->ProcessGamestateMessage(info, *this);
+			plugInsProfile.PlugInDone(PlugIns[i]->ProfilerTicks);
 		}
 	}
 
@@ -615,6 +756,9 @@ bool udtBaseParser::ParseGamestate()
 
 bool udtBaseParser::ParseSnapshot()
 {
+	udtScopedProfilerTicks profile(Profiler, udtParserProfilerStage::SnapshotParse);
+	++Profiler.SnapshotCount;
+
 	//
 	// Read in the new snapshot to a temporary buffer
 	// We will only save it if it is valid.
@@ -629,6 +773,15 @@ bool udtBaseParser::ParseSnapshot()
 
 	_inServerTime = _inMsg.ReadLong();
 
+	if(!ShouldDecodeSnapshots())
+	{
+		// The snapshot is always the message's last command.
+		_inMsg.Buffer.readcount = _inMsg.Buffer.cursize;
+		_inMsg.Buffer.bit = _inMsg.Buffer.cursize << 3;
+		SkippedSnapshots = true;
+		return true;
+	}
+
 	idLargestClientSnapshot newSnap;
 	Com_Memset(&newSnap, 0, sizeof(newSnap));
 	newSnap.serverCommandNum = _inServerCommandSequence;
@@ -718,14 +871,6 @@ bool udtBaseParser::ParseSnapshot()
 		return false;
 	}
 
-	// Did we write enough snapshots already?
-	const bool noDelta = _outSnapshotsWritten < deltaNum;
-	if(noDelta) 
-	{
-		deltaNum = 0;
-		oldSnap = NULL;
-	}
-
 	// If not valid, dump the entire thing now that 
 	// it has been properly read.
 	if(!newSnap.valid)
@@ -804,58 +949,90 @@ bool udtBaseParser::ParseSnapshot()
 		info.CommandNumber = newSnap.serverCommandNum;
 		info.MessageNumber = newSnap.messageNum;
 
+		udtPlugInsProfiler plugInsProfile(Profiler);
 		for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
 		{
 			PlugIns[i]->ProcessSnapshotMessage(info, *this);
+			plugInsProfile.PlugInDone(PlugIns[i]->ProfilerTicks);
 		}
 	}
 
 	//
-	// Write to the output message.
+	// Save what we need to write to the output messages.
 	//
 
 	if(ShouldWriteMessage())
 	{
-		_outMsg.WriteByte(svc_snapshot);
-		_outMsg.WriteLong(newSnap.serverTime);
-		_outMsg.WriteByte(deltaNum);
-		_outMsg.WriteByte(newSnap.snapFlags);
-		_outMsg.WriteByte(areaMaskLength);
-		_outMsg.WriteData(&newSnap.areamask, areaMaskLength);
-		_protocolConverter->StartSnapshot(newSnap.serverTime);
-		if(_outProtocol == _inProtocol)
-		{
-			_outMsg.WriteDeltaPlayer(oldSnap ? GetPlayerState(oldSnap, _outProtocol) : NULL, GetPlayerState(&newSnap, _outProtocol));
-			EmitPacketEntities(deltaNum ? oldSnap : NULL, &newSnap);
-		}
-		else
+		const u32 snapshotIndex = _outSnapshots.GetSize();
+		_outSnapshots.Resize(snapshotIndex + 1);
+		udtOutputSnapshot& snapshot = _outSnapshots[snapshotIndex];
+		Com_Memcpy(&snapshot.NewSnapshot, &newSnap, (size_t)_inProtocolSizeOfClientSnapshot);
+		if(oldSnap)
 		{
-			idLargestClientSnapshot oldSnapOutProto;
-			idLargestClientSnapshot newSnapOutProto;
-			if(oldSnap)
-			{
-				_protocolConverter->ConvertSnapshot(oldSnapOutProto, *oldSnap);
-			}
-			_protocolConverter->ConvertSnapshot(newSnapOutProto, newSnap);
-			_outMsg.WriteDeltaPlayer(oldSnap ? GetPlayerState(&oldSnapOutProto, _outProtocol) : NULL, GetPlayerState(&newSnapOutProto, _outProtocol));
-			EmitPacketEntities(deltaNum ? &oldSnapOutProto : NULL, &newSnapOutProto);
+			Com_Memcpy(&snapshot.OldSnapshot, oldSnap, (size_t)_inProtocolSizeOfClientSnapshot);
 		}
-		++_outSnapshotsWritten;
+		snapshot.HasOldSnapshot = oldSnap != NULL;
+		snapshot.DeltaNum = deltaNum;
+		snapshot.AreaMaskLength = areaMaskLength;
+		AddOutputOp(udtOutputOpType::Snapshot, udtString::NewNull(), udtString::NewNull(), snapshotIndex);
 	}
 
 	return true;
 }
 
-void udtBaseParser::WriteGameState()
+void udtBaseParser::WriteSnapshot(udtCutOutput& output, udtOutputSnapshot& snapshot)
+{
+	idClientSnapshotBase& newSnap = snapshot.NewSnapshot;
+	idClientSnapshotBase* oldSnap = snapshot.HasOldSnapshot ? &snapshot.OldSnapshot : NULL;
+	s32 deltaNum = snapshot.DeltaNum;
+	const s32 areaMaskLength = snapshot.AreaMaskLength;
+
+	// Did we write enough snapshots already?
+	const bool noDelta = output.SnapshotsWritten < deltaNum;
+	if(noDelta)
+	{
+		deltaNum = 0;
+		oldSnap = NULL;
+	}
+
+	_outMsg.WriteByte(svc_snapshot);
+	_outMsg.WriteLong(newSnap.serverTime);
+	_outMsg.WriteByte(deltaNum);
+	_outMsg.WriteByte(newSnap.snapFlags);
+	_outMsg.WriteByte(areaMaskLength);
+	_outMsg.WriteData(&newSnap.areamask, areaMaskLength);
+	_protocolConverter->StartSnapshot(newSnap.serverTime);
+	if(_outProtocol == _inProtocol)
+	{
+		_outMsg.WriteDeltaPlayer(oldSnap ? GetPlayerState(oldSnap, _outProtocol) : NULL, GetPlayerState(&newSnap, _outProtocol));
+		EmitPacketEntities(deltaNum ? oldSnap : NULL, &newSnap);
+	}
+	else
+	{
+		idLargestClientSnapshot oldSnapOutProto;
+		idLargestClientSnapshot newSnapOutProto;
+		if(oldSnap)
+		{
+			_protocolConverter->ConvertSnapshot(oldSnapOutProto, *oldSnap);
+		}
+		_protocolConverter->ConvertSnapshot(newSnapOutProto, newSnap);
+		_outMsg.WriteDeltaPlayer(oldSnap ? GetPlayerState(&oldSnapOutProto, _outProtocol) : NULL, GetPlayerState(&newSnapOutProto, _outProtocol));
+		EmitPacketEntities(deltaNum ? &oldSnapOutProto : NULL, &newSnapOutProto);
+	}
+	++output.SnapshotsWritten;
+}
+
+void udtBaseParser::WriteGameState(udtCutOutput& output)
 {
 	_outMsg.Init(_outMsgData, sizeof(_outMsgData));
+	_outMsg.SetFileName(output.FileName);
 	_outMsg.Bitstream();
 
 	_outMsg.WriteLong(_inReliableSequenceAcknowledge);
 
 	_outMsg.WriteByte(svc_gamestate);
-	_outMsg.WriteLong(_outServerCommandSequence);
-	++_outServerCommandSequence;
+	_outMsg.WriteLong(output.ServerCommandSequence);
+	++output.ServerCommandSequence;
 
 	_protocolConverter->StartGameState();
 	
@@ -912,7 +1089,7 @@ void udtBaseParser::WriteGameState()
 	_outMsg.WriteByte(svc_EOF);
 }
 
-void udtBaseParser::WriteBigConfigStringCommand(const udtString& csIndex, const udtString& csData)
+void udtBaseParser::WriteBigConfigStringCommand(udtCutOutput& output, const udtString& csIndex, const udtString& csData)
 {
 	// Simple example:
 	// cs idx "name0\value0\name1\value1\name2\value2\name3\value3"
@@ -921,6 +1098,8 @@ void udtBaseParser::WriteBigConfigStringCommand(const udtString& csIndex, const
 	// bcs1 idx "name1\value1\"
 	// bcs1 idx "name2\value2\"
 	// bcs2 idx "name3\value3"
+	udtVMScopedStackAllocator allocatorScope(_tempAllocator);
+
 	const u32 maxLengthPerCmd = MAX_STRING_CHARS - 2;
 	const u32 perCmdOverhead = 8 + csIndex.GetLength();
 	const u32 maxDataLength = maxLengthPerCmd - perCmdOverhead;
@@ -959,17 +1138,59 @@ void udtBaseParser::WriteBigConfigStringCommand(const udtString& csIndex, const
 		udtString::AppendMultiple(command, cmdPieces, (u32)UDT_COUNT_OF(cmdPieces));
 
 		_outMsg.WriteByte(svc_serverCommand);
-		_outMsg.WriteLong(_outServerCommandSequence);
+		_outMsg.WriteLong(output.ServerCommandSequence);
 		_outMsg.WriteString(command.GetPtr(), (s32)command.GetLength());
 
-		++_outServerCommandSequence;
+		++output.ServerCommandSequence;
 		dataOffset += maxDataLength;
 	}
 
 }
 
+bool udtBaseParser::ShouldDecodeSnapshots() const
+{
+	if(!SkipUnneededSnapshots || !_cuts.IsEmpty())
+	{
+		return true;
+	}
+
+	if(EnablePlugIns)
+	{
+		for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
+		{
+			if((PlugIns[i]->GetNeeds() & (u32)udtParserPlugInNeed::Snapshots) != 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool udtBaseParser::ArePlugInsDone() const
+{
+	// The cuts decide when to stop.
+	if(ReadWholeDemo || !EnablePlugIns || PlugIns.IsEmpty() || !_cuts.IsEmpty())
+	{
+		return false;
+	}
+
+	for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
+	{
+		if(!PlugIns[i]->IsDone())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 bool udtBaseParser::ParsePacketEntities(udtMessage& msg, idClientSnapshotBase* oldframe, idClientSnapshotBase* newframe)
 {
+	udtScopedProfilerTicks profile(Profiler, udtParserProfilerStage::EntityParse);
+
 	_inChangedEntities.Clear();
 	_inRemovedEntities.Clear();
 
@@ -9,6 +9,7 @@
 #include "parser_plug_in.hpp"
 #include "array.hpp"
 #include "protocol_conversion.hpp"
+#include "parser_profiler.hpp"
 
 // For the placement new operator.
 #include <new>
@@ -35,6 +36,58 @@ struct udtBaseParser
 public:
 	struct udtConfigString;
 
+	struct udtCutInfo
+	{
+		const char* FilePath;
+		udtDemoNameCreator StreamCreator;
+		void* UserData;
+		const char* VeryShortDesc;
+		s32 GameStateIndex;
+		s32 StartTimeMs;
+		s32 EndTimeMs;
+		bool Started; // Or it failed to start.
+	};
+
+	// A cut that is currently being written.
+	struct udtCutOutput
+	{
+		udtFileStream File;
+		udtString FileName;
+		s32 GameStateIndex;
+		s32 EndTimeMs;
+		s32 ServerCommandSequence;
+		s32 SnapshotsWritten;
+	};
+
+	struct udtOutputOpType
+	{
+		enum Id
+		{
+			Nop,
+			Command,
+			BigConfigString,
+			Snapshot
+		};
+	};
+
+	// Something to write in the output message once for every cut being written.
+	struct udtOutputOp
+	{
+		udtString String; // The command or the big config string's data.
+		udtString ConfigStringIndex; // Big config strings only.
+		u32 SnapshotIndex; // Snapshots only. Index into _outSnapshots.
+		udtOutputOpType::Id Type;
+	};
+
+	struct udtOutputSnapshot
+	{
+		idLargestClientSnapshot NewSnapshot;
+		idLargestClientSnapshot OldSnapshot; // Only valid when HasOldSnapshot is true.
+		s32 DeltaNum;
+		s32 AreaMaskLength;
+		bool HasOldSnapshot;
+	};
+
 public:
 	udtBaseParser();
 	~udtBaseParser();
@@ -48,45 +101,41 @@ public:
 
 	void	AddCut(s32 gsIndex, s32 startTimeMs, s32 endTimeMs, udtDemoNameCreator streamCreator, const char* veryShortDesc, void* userData = NULL);
 	void	AddCut(s32 gsIndex, s32 startTimeMs, s32 endTimeMs, const char* filePath);
+	u32     GetWrittenCutCount() const { return _outCutCount; } // Since the parser was created.
 	void    AddPlugIn(udtBaseParserPlugIn* plugIn);
 
 	const udtString       GetConfigString(s32 csIndex) const;
 
 private:
 	bool                  ParseServerMessage(); // Returns true if should continue parsing.
+	bool                  ProcessCuts(); // Returns true if should continue parsing.
+	void                  InsertCut(const udtCutInfo& cut);
+	void                  StartCut(const udtCutInfo& cut);
 	bool                  ShouldWriteMessage() const;
-	void                  WriteFirstMessage();
-	void                  WriteNextMessage();
-	void                  WriteLastMessage();
-	void                  WriteGameState();
-	void                  WriteBigConfigStringCommand(const udtString& csIndex, const udtString& csData);
+	void                  AddOutputOp(udtOutputOpType::Id type, const udtString& string, const udtString& csIndex, u32 snapshotIndex);
+	void                  WriteFirstMessage(udtCutOutput& output);
+	void                  WriteNextMessage(udtCutOutput& output);
+	void                  WriteLastMessage(udtCutOutput& output);
+	void                  WriteGameState(udtCutOutput& output);
+	void                  WriteSnapshot(udtCutOutput& output, udtOutputSnapshot& snapshot);
+	void                  WriteBigConfigStringCommand(udtCutOutput& output, const udtString& csIndex, const udtString& csData);
 	bool                  ParseCommandString();
 	bool                  ParseGamestate();
 	bool                  ParseSnapshot();
+	bool                  ShouldDecodeSnapshots() const;
+	bool                  ArePlugInsDone() const;
 	bool                  ParsePacketEntities(udtMessage& msg, idClientSnapshotBase* oldframe, idClientSnapshotBase* newframe);
 	void                  EmitPacketEntities(idClientSnapshotBase* from, idClientSnapshotBase* to);
 	bool                  DeltaEntity(udtMessage& msg, idClientSnapshotBase *frame, s32 newnum, idEntityStateBase* old, bool unchanged);
-	void                  ResetForGamestateMessage();
 
 public:
+	void                  ResetForGamestateMessage(); // Also used before restoring a demo index keyframe.
 	idEntityStateBase*    GetEntity(s32 idx) const { return (idEntityStateBase*)&_inParseEntities[idx * _inProtocolSizeOfEntityState]; }
 	idEntityStateBase*    GetBaseline(s32 idx) const { return (idEntityStateBase*)&_inEntityBaselines[idx * _inProtocolSizeOfEntityState]; }
 	idClientSnapshotBase* GetClientSnapshot(s32 idx) const { return (idClientSnapshotBase*)&_inSnapshots[idx * _inProtocolSizeOfClientSnapshot]; }
 	const idTokenizer&    GetTokenizer() { return _tokenizer; }
 	const char*           GetFileNamePtr() { return _inFileName.GetPtrSafe("N/A"); }
 	
-public:
-	struct udtCutInfo
-	{
-		const char* FilePath;
-		udtDemoNameCreator StreamCreator;
-		void* UserData;
-		const char* VeryShortDesc;
-		s32 GameStateIndex;
-		s32 StartTimeMs;
-		s32 EndTimeMs;
-	};
-
 public:
 	// General.
 	udtVMLinearAllocator _persistentAllocator { "Parser::Persistent" }; // Memory we need to be able to access to during the entire parsing phase.
@@ -105,6 +154,17 @@ public:
 	udtVMArray<udtBaseParserPlugIn*> PlugIns { "Parser::PlugInsArray" };
 	bool EnablePlugIns;
 
+	// Demo segments. See ParseDemoFileSegment.
+	bool ContinuesDemo; // Parsing starts at a game state that isn't the demo's first.
+	udtString FirstServerInfo; // Only used when ContinuesDemo is true: CS_SERVERINFO of the demo's first game state.
+	bool StopAtGameState; // Stop right after the next game state, which closes the previous one for the plug-ins.
+	bool MultiSymbolHuffman; // See udtParseArgFlag::MultiSymbolHuffman.
+	bool SkipUnneededSnapshots; // Only read the snapshot headers when there are no cuts and no active plug-in needs udtParserPlugInNeed::Snapshots.
+	bool ReadWholeDemo; // Ignore the plug-ins' IsDone. Needed when every message must be seen, e.g. for writing a demo index.
+	bool StoppedEarly; // The rest of the demo wasn't needed: all cuts were written or all plug-ins were done.
+	bool SkippedSnapshots; // At least one snapshot wasn't decoded, so corrupted snapshot data went unnoticed.
+	udtParserProfiler Profiler; // See udtParseArgFlag::ProfileStages.
+
 	// Input.
 	udtString _inFilePath;
 	udtString _inFileName;
@@ -133,16 +193,16 @@ public:
 	udtVMArray<u8> _inEntityFlags { "Parser::EntityFlagsArray" };
 
 	// Output.
-	udtFileStream _outFile;
-	udtString _outFilePath;
-	udtString _outFileName;
-	udtVMArray<udtCutInfo> _cuts { "Parser::CutsArray" };
+	// Messages are decoded once and only re-encoded for each of the overlapping cuts being written.
+	udtVMArray<udtCutInfo> _cuts { "Parser::CutsArray" }; // Sorted by game state index and start time.
+	udtVMArray<udtCutOutput> _outputs { "Parser::OutputsArray" };
+	udtVMArray<udtOutputOp> _outOps { "Parser::OutputOpsArray" }; // For the current message.
+	udtVMArray<udtOutputSnapshot> _outSnapshots { "Parser::OutputSnapshotsArray" }; // For the current message.
+	udtVMLinearAllocator _outOpAllocator { "Parser::OutputOps" }; // Gets cleared for every message.
 	u8 _outMsgData[ID_MAX_MSG_LENGTH];
 	udtMessage _outMsg; // This instance *DOES* have ownership of the raw message data.
-	s32 _outServerCommandSequence;
-	s32 _outSnapshotsWritten;
-	bool _outWriteFirstMessage;
-	bool _outWriteMessage;
+	u32 _nextCutIndex; // The first cut in _cuts that wasn't started or skipped yet.
+	u32 _outCutCount;
 
 private:
 	idTokenizer _tokenizer; // Make sure plug-ins don't get write access to this.
@@ -10,6 +10,7 @@
 #include "plug_in_captures.hpp"
 #include "plug_in_obituaries.hpp"
 #include "plug_in_scores.hpp"
+#include "plug_in_probe.hpp"
 
 // For the placement new operator.
 #include <new>
@@ -49,6 +50,9 @@ static const size_t SizeOfAllPlugIns = UDT_PRIVATE_PLUG_IN_LIST(UDT_PRIVATE_PLUG
 udtParserContext_s::udtParserContext_s()
 {
 	DemoCount = 0;
+	ReadAheadInput = false;
+	ReadAheadBlockSize = 0;
+	ReadAheadBlockCount = 0;
 
 	// @NOTE: This data can never be relocated.
 	PlugInAllocator.Init((uptr)SizeOfAllPlugIns);
@@ -61,13 +65,6 @@ udtParserContext_s::~udtParserContext_s()
 
 bool udtParserContext_s::Init(u32 demoCount, const u32* plugInIds, u32 plugInCount)
 {
-#if defined(UDT_WINDOWS)
-	if(!DemoReader.Init())
-	{
-		return false;
-	}
-#endif
-
 	DemoCount = demoCount;
 
 	for(u32 i = 0; i < plugInCount; ++i)
@@ -129,6 +126,17 @@ void udtParserContext_s::UpdatePlugInBufferStructs()
 	}
 }
 
+void udtParserContext_s::AppendDemoSegment(udtParserContext_s& segment, s32 firstGameStateIndex)
+{
+	assert(PlugIns.GetSize() == segment.PlugIns.GetSize());
+
+	for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
+	{
+		assert(PlugIns[i].Id == segment.PlugIns[i].Id);
+		PlugIns[i].PlugIn->AppendDemoSegment(*segment.PlugIns[i].PlugIn, firstGameStateIndex);
+	}
+}
+
 void udtParserContext_s::GetPlugInById(udtBaseParserPlugIn*& plugIn, u32 plugInId)
 {
 	plugIn = NULL;
@@ -142,6 +150,26 @@ void udtParserContext_s::GetPlugInById(udtBaseParserPlugIn*& plugIn, u32 plugInI
 	}
 }
 
+udtStream* udtParserContext_s::OpenDemoFile(const char* filePath, u32 offset)
+{
+#if defined(UDT_LINUX)
+	if(!ReadAheadInput)
+	{
+		return MappedDemoReader.Open(filePath, offset) ? &MappedDemoReader : NULL;
+	}
+#endif
+
+	// No single read can be larger than a block and the largest read is a message.
+	const u32 blockSize = ReadAheadBlockSize != 0 ? udt_max(ReadAheadBlockSize, (u32)ID_MAX_MSG_LENGTH) : (u32)UDT_READ_AHEAD_DEFAULT_BLOCK_SIZE;
+	const u32 blockCount = ReadAheadBlockCount != 0 ? udt_max(ReadAheadBlockCount, (u32)2) : (u32)UDT_READ_AHEAD_DEFAULT_BLOCK_COUNT;
+	if(!DemoReader.IsInitialized() && !DemoReader.Init(blockSize, blockCount))
+	{
+		return NULL;
+	}
+
+	return DemoReader.Open(filePath, offset) ? &DemoReader : NULL;
+}
+
 void udtParserContext_s::DestroyPlugIns()
 {
 	for(u32 i = 0, count = PlugIns.GetSize(); i < count; ++i)
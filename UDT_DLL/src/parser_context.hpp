@@ -8,12 +8,16 @@
 #include "modifier_context.hpp"
 #include "json_writer_context.hpp"
 #include "read_only_sequ_file_stream.hpp"
+#include "mapped_file_stream.hpp"
+#include "demo_index.hpp"
+#include "pattern_cutter.hpp"
 
 
 #define UDT_PRIVATE_PLUG_IN_LIST(N) \
 	UDT_PLUG_IN_LIST(N) \
 	N(FindPatterns, "", udtPatternSearchPlugIn,    udtCutSection) \
-	N(ConvertToUDT, "", udtParserPlugInQuakeToUDT, udtNothing)
+	N(ConvertToUDT, "", udtParserPlugInQuakeToUDT, udtNothing) \
+	N(Probe,        "", udtParserPlugInProbe,      udtDemoProbeInfo)
 
 #define UDT_PRIVATE_PLUG_IN_ITEM(Enum, Desc, Type, OutputType) Enum,
 struct udtPrivateParserPlugIn
@@ -45,8 +49,10 @@ public:
 	void ResetForNextDemo(bool keepPlugInData); // Called once per demo processed.
 	bool CopyBuffersStruct(u32 plugInId, void* buffersStruct);
 	void UpdatePlugInBufferStructs();
+	void AppendDemoSegment(udtParserContext_s& segment, s32 firstGameStateIndex); // Both contexts must have the same plug-ins.
 	u32  GetDemoCount() const { return DemoCount; }
 	void GetPlugInById(udtBaseParserPlugIn*& plugIn, u32 plugInId);
+	udtStream* OpenDemoFile(const char* filePath, u32 offset); // Returns NULL on failure.
 
 private:
 	void DestroyPlugIns();
@@ -60,15 +66,19 @@ public:
 	udtVMArray<AddOnItem> PlugIns { "ParserContext::PlugInsArray" }; // There is only 1 (shared) plug-in instance for each plug-in ID passed.
 	udtVMArray<u32> InputIndices { "ParserContext::InputIndicesArray" };
 	udtVMLinearAllocator PlugInTempAllocator { "ParserContext::PlugInTemp" };
-#if defined(UDT_WINDOWS)
-	udtReadOnlySequentialFileStream DemoReader;
+	udtReadOnlySequentialFileStream DemoReader; // Lazily initialized.
+	udtDemoIndexWriter DemoIndexWriter; // Only used with udtParseArgFlag::WriteDemoIndex.
+	udtPatternCutter PatternCutter; // Only used with udtPatternSearchArgMask::SinglePass.
+#if defined(UDT_LINUX)
+	udtMappedFileStream MappedDemoReader;
 #endif
 	u32 DemoCount;
+	u32 ReadAheadBlockSize; // See udtParseArg::ReadAheadBlockSize.
+	u32 ReadAheadBlockCount; // See udtParseArg::ReadAheadBlockCount.
+	bool ReadAheadInput; // Only relevant on Linux, see udtParseArgFlag::ReadAheadInput.
 };
 
 
-#if defined(UDT_WINDOWS)
-
 struct udtStreamScopeGuard
 {
 	udtStreamScopeGuard(udtStream& stream)
@@ -87,25 +97,11 @@ private:
 	udtStream& _stream;
 };
 
-#endif
-
 
-#if defined(UDT_WINDOWS)
-#	define UDT_INIT_DEMO_FILE_READER(name, filePath, context) \
-		udtReadOnlySequentialFileStream& name = context->DemoReader; \
-		udtStreamScopeGuard name##ScopeGuard(name); \
-		if(!name.Open(filePath)) return false;
-#	define UDT_INIT_DEMO_FILE_READER_AT(name, filePath, context, offset) \
-		udtReadOnlySequentialFileStream& name = context->DemoReader; \
-		udtStreamScopeGuard name##ScopeGuard(name); \
-		if(!name.Open(filePath, offset)) return false;
-#else
-#	define UDT_INIT_DEMO_FILE_READER(name, filePath, context) \
-		udtFileStream name; \
-		if(!name.Open(filePath, udtFileOpenMode::Read)) return false;
-#	define UDT_INIT_DEMO_FILE_READER_AT(name, filePath, context, offset) \
-		udtFileStream name; \
-		if(!name.Open(filePath, udtFileOpenMode::Read)) return false; \
-		if(fileOffset > 0 && name.Seek((s32)offset, udtSeekOrigin::Start) != 0) return false;
-
-#endif
+#define UDT_INIT_DEMO_FILE_READER_AT(name, filePath, context, offset) \
+	udtStream* const name##Pointer = context->OpenDemoFile(filePath, offset); \
+	if(name##Pointer == NULL) return false; \
+	udtStream& name = *name##Pointer; \
+	udtStreamScopeGuard name##ScopeGuard(name);
+#define UDT_INIT_DEMO_FILE_READER(name, filePath, context) \
+	UDT_INIT_DEMO_FILE_READER_AT(name, filePath, context, 0)
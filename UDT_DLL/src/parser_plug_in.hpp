@@ -59,10 +59,32 @@ struct udtCommandCallbackArg
 };
 
 
+// What a plug-in reads from the parser and its callback arguments.
+// The parser doesn't decode the data no active plug-in needs when udtBaseParser::SkipUnneededSnapshots is true.
+struct udtParserPlugInNeed
+{
+	enum Id
+	{
+		GameStates = UDT_BIT(0),
+		Commands = UDT_BIT(1), // Includes config strings.
+		Snapshots = UDT_BIT(2), // Player states and entities. Snapshot server times are always available.
+		All = GameStates | Commands | Snapshots
+	};
+};
+
+// Large enough for the buffers struct of any analysis plug-in.
+#define UDT_ANALYSIS_DATA_BUFFERS_ITEM(Enum, Desc, Type, BuffersType) BuffersType Enum;
+union udtAnalysisDataBuffers
+{
+	UDT_PLUG_IN_LIST(UDT_ANALYSIS_DATA_BUFFERS_ITEM)
+};
+#undef UDT_ANALYSIS_DATA_BUFFERS_ITEM
+
 struct udtBaseParserPlugIn
 {
 	udtBaseParserPlugIn() 
-		: TempAllocator(NULL)
+		: ProfilerTicks(0)
+		, TempAllocator(NULL)
 		, DemoCount(0)
 		, StartItemCount(0)
 	{
@@ -94,14 +116,42 @@ struct udtBaseParserPlugIn
 	void FinishProcessingDemo()
 	{
 		FinishDemoAnalysis();
+		AddBufferRange();
+	}
 
-		const u32 firstIndex = StartItemCount;
-		const u32 lastIndex = GetItemCount();
-		const u32 count = lastIndex - firstIndex;
-		udtParseDataBufferRange range;
-		range.FirstIndex = firstIndex;
-		range.Count = count;
-		BufferRanges.Add(range);
+	// Call instead of FinishProcessingDemo when the demo's remaining game states are processed separately.
+	// The game state the parser stopped at gets processed again as the first of the next segment.
+	void FinishProcessingDemoSegment(s32 nextGameStateIndex)
+	{
+		DiscardGameStateItems(nextGameStateIndex);
+		AddBufferRange();
+	}
+
+	// Call for each additional game state segment of the last demo, in order.
+	// The segment's plug-in must have processed only that segment.
+	void AppendDemoSegment(udtBaseParserPlugIn& segment, s32 firstGameStateIndex)
+	{
+		assert(!BufferRanges.IsEmpty());
+
+		udtAnalysisDataBuffers buffers;
+		udtAnalysisDataBuffers bases;
+		memset(&bases, 0, sizeof(bases));
+		segment.UpdateBufferStruct();
+		segment.CopyBuffersStruct(&buffers);
+		AppendDemoItems(&buffers, &bases, firstGameStateIndex);
+		FinishAppendingDemoSegment(segment);
+
+		udtParseDataBufferRange& range = BufferRanges[BufferRanges.GetSize() - 1];
+		range.Count = GetItemCount() - range.FirstIndex;
+	}
+
+	// Call instead of StartProcessingDemo and FinishProcessingDemo to add a demo without parsing it.
+	// Same arguments as AppendDemoItems.
+	void AppendDemo(const void* buffersStruct, const void* baseBuffersStruct)
+	{
+		StartItemCount = GetItemCount();
+		AppendDemoItems(buffersStruct, baseBuffersStruct, 0);
+		AddBufferRange();
 	}
 
 	virtual void InitAllocators(u32 demoCount) = 0; // Initialize your private allocators, including FinalAllocator.
@@ -110,17 +160,55 @@ struct udtBaseParserPlugIn
 	virtual void CopyBuffersStruct(void* /*buffersStruct*/) const {}
 	virtual void UpdateBufferStruct() {}
 	virtual u32  GetItemCount() const { return 0; }
+	virtual void DiscardGameStateItems(s32 /*gameStateIndex*/) {} // Remove the items of all game states >= gameStateIndex.
+	virtual u32  GetNeeds() const { return (u32)udtParserPlugInNeed::All; } // Flags from udtParserPlugInNeed.
+	virtual bool IsDone() const { return false; } // True once the rest of the current demo isn't needed. Parsing stops when all plug-ins are done. Only the probe uses it.
+
+	u32 GetBufferRangeCount() const { return BufferRanges.GetSize(); } // Demos that failed early have no range.
 
 	virtual void ProcessMessageBundleStart(const udtMessageBundleCallbackArg& /*arg*/, udtBaseParser& /*parser*/) {}
 	virtual void ProcessMessageBundleEnd(const udtMessageBundleCallbackArg& /*arg*/, udtBaseParser& /*parser*/) {}
 	virtual void ProcessGamestateMessage(const udtGamestateCallbackArg& /*arg*/, udtBaseParser& /*parser*/) {}
 	virtual void ProcessSnapshotMessage(const udtSnapshotCallbackArg& /*arg*/, udtBaseParser& /*parser*/) {}
 	virtual void ProcessCommandMessage(const udtCommandCallbackArg& /*arg*/, udtBaseParser& /*parser*/) {}
+
+	u64 ProfilerTicks; // Time spent in the callbacks. Only measured when udtParserProfiler::Enabled is true.
 	
 protected:
 	virtual void StartDemoAnalysis() {}
 	virtual void FinishDemoAnalysis() {}
 
+	// Copy all items and strings of the buffers struct, fix up the indices and string offsets.
+	// The source's arrays and string buffer started at the sizes of the base buffers struct when its items were created,
+	// so its indices and offsets get shifted by the difference with the destination's sizes.
+	// Only the counts and string buffer size of the base buffers struct are read.
+	virtual void AppendDemoItems(const void* /*buffersStruct*/, const void* /*baseBuffersStruct*/, s32 /*gameStateIndexOffset*/) {}
+	virtual void FinishAppendingDemoSegment(udtBaseParserPlugIn& /*segment*/) {}
+
+	void AddBufferRange()
+	{
+		const u32 firstIndex = StartItemCount;
+		const u32 lastIndex = GetItemCount();
+		const u32 count = lastIndex - firstIndex;
+		udtParseDataBufferRange range;
+		range.FirstIndex = firstIndex;
+		range.Count = count;
+		BufferRanges.Add(range);
+	}
+
+	// Items must be sorted by game state index.
+	template<typename T>
+	static u32 GetItemCountBeforeGameState(const udtVMArray<T>& items, s32 gameStateIndex)
+	{
+		u32 count = items.GetSize();
+		while(count > 0 && (s32)items[count - 1].GameStateIndex >= gameStateIndex)
+		{
+			--count;
+		}
+
+		return count;
+	}
+
 	udtVMLinearAllocator* TempAllocator; // Don't create your own temp allocator, use this one.
 	udtVMArray<udtParseDataBufferRange> BufferRanges { "BaseParserPlugIn::BufferRangesArray" };
 	
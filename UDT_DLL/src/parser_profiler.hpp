@@ -0,0 +1,138 @@
+#pragma once
+
+
+#include "timer.hpp"
+
+#include <string.h>
+
+
+// The stages are nested, so the time of a stage includes the time of the stages it calls.
+struct udtParserProfilerStage
+{
+	enum Id
+	{
+		FileRead,      // udtParserRunner reading the next message from the file.
+		MessageParse,  // udtBaseParser::ParseNextMessage. Includes all the stages below.
+		SnapshotParse, // udtBaseParser::ParseSnapshot. Includes entity parsing and the snapshot plug-in callbacks.
+		EntityParse,   // udtBaseParser::ParsePacketEntities.
+		PlugIns,       // All plug-in callbacks.
+		OutputWrite,   // udtBaseParser::WriteNextMessage for all the cuts being written.
+		Count
+	};
+};
+
+// Owned by the parser, so one per thread.
+// The counts are always updated but the timers only run when Enabled is true.
+struct udtParserProfiler
+{
+	udtParserProfiler()
+	{
+		Clear();
+		Enabled = false;
+	}
+
+	void Clear()
+	{
+		memset(StageTicks, 0, sizeof(StageTicks));
+		MessageCount = 0;
+		SnapshotCount = 0;
+		CachedDemoCount = 0;
+		SkippedByteCount = 0;
+	}
+
+	void Add(const udtParserProfiler& profiler)
+	{
+		for(u32 i = 0; i < (u32)udtParserProfilerStage::Count; ++i)
+		{
+			StageTicks[i] += profiler.StageTicks[i];
+		}
+		MessageCount += profiler.MessageCount;
+		SnapshotCount += profiler.SnapshotCount;
+		CachedDemoCount += profiler.CachedDemoCount;
+		SkippedByteCount += profiler.SkippedByteCount;
+	}
+
+	u64 StageTicks[udtParserProfilerStage::Count];
+	u64 MessageCount;
+	u64 SnapshotCount;
+	u64 CachedDemoCount; // Demos read from the analysis cache instead of being parsed.
+	u64 SkippedByteCount; // Demo bytes left unread because parsing stopped early, see udtBaseParser::StoppedEarly.
+	bool Enabled;
+};
+
+// Adds the ticks elapsed since construction to the counter when stopped or destroyed.
+struct udtScopedProfilerTicks
+{
+	udtScopedProfilerTicks(udtParserProfiler& profiler, udtParserProfilerStage::Id stage)
+		: _ticks(profiler.StageTicks[stage])
+		, _startTicks(0)
+		, _running(profiler.Enabled)
+	{
+		if(_running)
+		{
+			_startTicks = GetProfilerTicks();
+		}
+	}
+
+	~udtScopedProfilerTicks()
+	{
+		Stop();
+	}
+
+	void Stop()
+	{
+		if(_running)
+		{
+			_ticks += GetProfilerTicks() - _startTicks;
+			_running = false;
+		}
+	}
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtScopedProfilerTicks);
+
+	u64& _ticks;
+	u64 _startTicks;
+	bool _running;
+};
+
+// Times a plug-in callback loop with a single timer read per plug-in:
+// each plug-in gets the ticks elapsed since the previous one was done.
+struct udtPlugInsProfiler
+{
+	udtPlugInsProfiler(udtParserProfiler& profiler)
+		: _ticks(profiler.StageTicks[udtParserProfilerStage::PlugIns])
+		, _startTicks(0)
+		, _lastTicks(0)
+		, _enabled(profiler.Enabled)
+	{
+		if(_enabled)
+		{
+			_startTicks = GetProfilerTicks();
+			_lastTicks = _startTicks;
+		}
+	}
+
+	~udtPlugInsProfiler()
+	{
+		_ticks += _lastTicks - _startTicks;
+	}
+
+	void PlugInDone(u64& plugInTicks)
+	{
+		if(_enabled)
+		{
+			const u64 ticks = GetProfilerTicks();
+			plugInTicks += ticks - _lastTicks;
+			_lastTicks = ticks;
+		}
+	}
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtPlugInsProfiler);
+
+	u64& _ticks;
+	u64 _startTicks;
+	u64 _lastTicks;
+	bool _enabled;
+};
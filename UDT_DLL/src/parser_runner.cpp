@@ -1,4 +1,5 @@
 #include "parser_runner.hpp"
+#include "demo_index.hpp"
 #include "utils.hpp"
 
 
@@ -7,13 +8,17 @@ udtParserRunner::udtParserRunner()
 	_fileStartOffset = 0;
 	_fileOffset = 0;
 	_maxByteCount = 0;
+	_endFileOffset = 0;
+	_messageFileOffset = 0;
+	_inServerMessageSequence = 0;
 	_parser = NULL;
 	_file = NULL;
+	_indexWriter = NULL;
 	_cancelOperation = NULL;
 	_success = false;
 }
 
-bool udtParserRunner::Init(udtBaseParser& parser, udtStream& file, const s32* cancelOperation)
+bool udtParserRunner::Init(udtBaseParser& parser, udtStream& file, const s32* cancelOperation, u32 endFileOffset)
 {
 	_parser = &parser;
 	_file = &file;
@@ -22,8 +27,11 @@ bool udtParserRunner::Init(udtBaseParser& parser, udtStream& file, const s32* ca
 	_inMsg.InitContext(parser._context);
 	_inMsg.InitProtocol(parser._inProtocol);
 
+	// The file offsets passed to the parser are absolute, even when not starting at the beginning.
 	_fileStartOffset = (u64)file.Offset();
-	_maxByteCount = file.Length() - _fileStartOffset;
+	_fileOffset = _fileStartOffset;
+	_endFileOffset = (u64)endFileOffset;
+	_maxByteCount = (endFileOffset != 0 ? _endFileOffset : file.Length()) - _fileStartOffset;
 
 	_timer.Start();
 
@@ -39,6 +47,20 @@ bool udtParserRunner::ParseNextMessage()
 	}
 
 	const u64 fileOffset = _fileOffset;
+	if(_endFileOffset != 0 && fileOffset > _endFileOffset)
+	{
+		SetSuccess(true);
+		return false;
+	}
+
+	// The message at the end offset holds the next segment's game state.
+	// We still parse it so that the plug-ins can wrap up the previous game state.
+	if(_endFileOffset != 0 && fileOffset == _endFileOffset)
+	{
+		_parser->StopAtGameState = true;
+	}
+
+	udtScopedProfilerTicks readProfile(_parser->Profiler, udtParserProfilerStage::FileRead);
 
 	s32 inServerMessageSequence = 0;
 	u32 elementsRead = _file->Read(&inServerMessageSequence, 4, 1);
@@ -67,22 +89,52 @@ bool udtParserRunner::ParseNextMessage()
 
 	if((u32)_inMsg.Buffer.cursize > (u32)_inMsg.Buffer.maxsize)
 	{
+		// A corrupted snapshot would have stopped parsing had it been decoded.
+		// What's left is garbage, so we keep what was read so far like we do for truncated demos.
+		if(_parser->SkippedSnapshots)
+		{
+			_parser->_context->LogWarning("Demo file %s has a message length greater than MAX_SIZE, probably following corrupted snapshot data", _parser->GetFileNamePtr());
+			SetSuccess(true);
+			return false;
+		}
+
 		_parser->_context->LogError("Demo file %s has a message length greater than MAX_SIZE", _parser->GetFileNamePtr());
 		SetSuccess(false);
 		return false;
 	}
 
-	elementsRead = _file->Read(_inMsg.Buffer.data, _inMsg.Buffer.cursize, 1);
-	if(elementsRead != 1)
+	// udtMessage can read a few bytes past the end of the message data, see udtMessage::RealReadBits.
+	// The message is never written to, so pointing directly into the stream's data is safe.
+	const u8* const inPlaceData = _file->ReadInPlace((u32)_inMsg.Buffer.cursize, UDT_MESSAGE_READ_PADDING);
+	if(inPlaceData != NULL)
 	{
-		_parser->_context->LogWarning("Demo file %s is truncated", _parser->GetFileNamePtr());
-		SetSuccess(true);
-		return false;
+		_inMsg.Buffer.data = (u8*)inPlaceData;
+	}
+	else
+	{
+		elementsRead = _file->Read(_inMsg.Buffer.data, _inMsg.Buffer.cursize, 1);
+		if(elementsRead != 1)
+		{
+			_parser->_context->LogWarning("Demo file %s is truncated", _parser->GetFileNamePtr());
+			SetSuccess(true);
+			return false;
+		}
 	}
 
+	readProfile.Stop();
+
 	_inMsg.Buffer.readcount = 0;
 	if(!_parser->ParseNextMessage(_inMsg, inServerMessageSequence, (u32)fileOffset))
 	{
+		if(_parser->StoppedEarly)
+		{
+			const u64 nextFileOffset = fileOffset + (u64)_inMsg.Buffer.cursize + 8;
+			const u64 endFileOffset = _fileStartOffset + _maxByteCount;
+			if(endFileOffset > nextFileOffset)
+			{
+				_parser->Profiler.SkippedByteCount += endFileOffset - nextFileOffset;
+			}
+		}
 		SetSuccess(true);
 		return false;
 	}
@@ -90,7 +142,13 @@ bool udtParserRunner::ParseNextMessage()
 	const u64 currentByteCount = fileOffset - _fileStartOffset;
 	const f32 currentProgress = (f32)currentByteCount / (f32)_maxByteCount;
 	_parser->_context->NotifyProgress(currentProgress);
+	_messageFileOffset = (u32)fileOffset;
+	_inServerMessageSequence = inServerMessageSequence;
 	_fileOffset += (u64)_inMsg.Buffer.cursize + 8;
+	if(_indexWriter != NULL)
+	{
+		_indexWriter->ProcessMessage(*_parser, (u32)_fileOffset);
+	}
 
 	SetSuccess(true);
 
@@ -107,7 +165,109 @@ bool udtParserRunner::WasSuccess() const
 	return _success;
 }
 
+void udtParserRunner::SetIndexWriter(udtDemoIndexWriter* indexWriter)
+{
+	_indexWriter = indexWriter;
+	_parser->ReadWholeDemo = indexWriter != NULL;
+}
+
 void udtParserRunner::SetSuccess(bool success)
 {
 	_success = success;
 }
+
+static bool MessageHasGameState(udtMessage& msg, udtProtocol::Id protocol)
+{
+	if(protocol > udtProtocol::Dm3)
+	{
+		msg.ReadLong(); // Reliable sequence acknowledge.
+	}
+
+	// Server commands can be sent before the gamestate in the same message.
+	for(;;)
+	{
+		if(msg.Buffer.readcount >= msg.Buffer.cursize)
+		{
+			return false;
+		}
+
+		const s32 command = msg.ReadByte();
+		if(command == svc_gamestate)
+		{
+			return true;
+		}
+
+		if(command == svc_serverCommand)
+		{
+			s32 commandStringLength = 0;
+			msg.ReadLong(); // Command sequence.
+			msg.ReadString(commandStringLength);
+		}
+		else if(command != svc_nop)
+		{
+			// Snapshots, the end-of-message marker and everything else.
+			return false;
+		}
+
+		if(protocol <= udtProtocol::Dm48)
+		{
+			msg.GoToNextByte();
+		}
+	}
+}
+
+bool FindGameStateFileOffsets(udtVMArray<u32>& fileOffsets, udtContext& context, udtStream& file, udtProtocol::Id protocol, const s32* cancelOperation)
+{
+	udtVMArray<u8> messageData("FindGameStateFileOffsets::MessageDataArray");
+	messageData.Resize(ID_MAX_MSG_LENGTH + UDT_MESSAGE_READ_PADDING);
+
+	udtMessage msg;
+	msg.InitContext(&context);
+	msg.InitProtocol(protocol);
+
+	fileOffsets.Clear();
+	u64 fileOffset = (u64)file.Offset();
+	for(;;)
+	{
+		if(cancelOperation != NULL && *cancelOperation != 0)
+		{
+			return false;
+		}
+
+		s32 header[2]; // Server message sequence and message length.
+		if(file.Read(header, 8, 1) != 1 || header[1] == -1)
+		{
+			break;
+		}
+
+		const s32 messageLength = header[1];
+		if((u32)messageLength > (u32)ID_MAX_MSG_LENGTH)
+		{
+			context.LogError("FindGameStateFileOffsets: Message length greater than MAX_SIZE");
+			return false;
+		}
+
+		msg.Init(messageData.GetStartAddress(), ID_MAX_MSG_LENGTH);
+		const u8* const inPlaceData = file.ReadInPlace((u32)messageLength, UDT_MESSAGE_READ_PADDING);
+		if(inPlaceData != NULL)
+		{
+			msg.Buffer.data = (u8*)inPlaceData;
+		}
+		else if(file.Read(msg.Buffer.data, (u32)messageLength, 1) != 1)
+		{
+			break;
+		}
+		msg.Buffer.cursize = messageLength;
+		msg.Buffer.readcount = 0;
+		msg.SetHuffman(protocol >= udtProtocol::Dm66);
+
+		if(MessageHasGameState(msg, protocol))
+		{
+			fileOffsets.Add((u32)fileOffset);
+		}
+
+		fileOffset += (u64)messageLength + 8;
+	}
+
+	return true;
+}
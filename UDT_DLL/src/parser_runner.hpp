@@ -5,14 +5,24 @@
 #include "timer.hpp"
 
 
+struct udtDemoIndexWriter;
+
+
 struct udtParserRunner
 {
 	udtParserRunner();
 
-	bool Init(udtBaseParser& parser, udtStream& file, const s32* cancelOperation);
+	bool Init(udtBaseParser& parser, udtStream& file, const s32* cancelOperation, u32 endFileOffset = 0); // Parses until the end of the file if endFileOffset is 0.
 	bool ParseNextMessage(); // Returns true as long as there's supposed to be more to read.
 	void FinishParsing();
 	bool WasSuccess() const;
+	void SetIndexWriter(udtDemoIndexWriter* indexWriter); // Optional. Call after Init.
+
+	// The raw data of the last message parsed. Only valid until the next call to ParseNextMessage.
+	const udtMessage& GetMessage() const { return _inMsg; }
+	s32 GetServerMessageSequence() const { return _inServerMessageSequence; }
+	u32 GetMessageFileOffset() const { return _messageFileOffset; }
+	u32 GetNextFileOffset() const { return (u32)_fileOffset; }
 
 private:
 	UDT_NO_COPY_SEMANTICS(udtParserRunner);
@@ -25,8 +35,16 @@ private:
 	u64 _fileStartOffset;
 	u64 _fileOffset;
 	u64 _maxByteCount;
+	u64 _endFileOffset;
+	u32 _messageFileOffset;
+	s32 _inServerMessageSequence;
 	udtBaseParser* _parser;
 	udtStream* _file;
+	udtDemoIndexWriter* _indexWriter;
 	const s32* _cancelOperation;
 	bool _success;
 };
+
+// Only decodes what it needs to find the "gamestate" messages, so it is much faster than a full parse.
+// The file offsets are those of the messages that contain a "gamestate" message.
+extern bool FindGameStateFileOffsets(udtVMArray<u32>& fileOffsets, udtContext& context, udtStream& file, udtProtocol::Id protocol, const s32* cancelOperation);
@@ -0,0 +1,355 @@
+#include "pattern_cutter.hpp"
+#include "plug_in_pattern_search.hpp"
+
+#include <stdlib.h>
+
+
+udtPatternCutter::udtPatternCutter()
+{
+	_cutInfo.OutputFolderPath = NULL;
+	_parser = NULL;
+	_context = NULL;
+	_plugIn = NULL;
+	_demoFilePath = udtString::NewNull();
+	_protocol = udtProtocol::Invalid;
+	_firstMessageIndex = 0;
+	_firstCutCount = 0;
+	_gameStateIndex = -1;
+	_abandonedEndTimeMs = UDT_S32_MIN;
+	_hasGameStateMessage = false;
+}
+
+udtPatternCutter::~udtPatternCutter()
+{
+	if(_parser != NULL)
+	{
+		_parser->~udtBaseParser();
+		free(_parser);
+	}
+}
+
+bool udtPatternCutter::StartDemo(udtBaseParser& parser, udtPatternSearchPlugIn& plugIn, const char* outputFolderPath)
+{
+	if(_parser == NULL)
+	{
+		// @NOTE: We don't use the standard operator new approach to avoid C++ exceptions.
+		_parser = (udtBaseParser*)malloc(sizeof(udtBaseParser));
+		if(_parser == NULL)
+		{
+			return false;
+		}
+
+		new (_parser) udtBaseParser;
+	}
+
+	_parser->MultiSymbolHuffman = parser.MultiSymbolHuffman;
+	_parser->Profiler.Enabled = parser.Profiler.Enabled;
+	_parser->Profiler.Clear();
+	_cutInfo.OutputFolderPath = outputFolderPath;
+	_context = parser._context;
+	_plugIn = &plugIn;
+	_demoFilePath = parser._inFilePath;
+	_protocol = parser._inProtocol;
+	_firstCutCount = _parser->GetWrittenCutCount();
+	_gameStateIndex = -1;
+	_writtenSections.Clear();
+	ClearHistory();
+
+	return true;
+}
+
+void udtPatternCutter::ProcessMessage(const udtBaseParser& parser, const udtMessage& message, s32 serverMessageSequence, u32 fileOffset, u32 nextFileOffset)
+{
+	// When the message has a new game state, the sections found belong to the previous one.
+	AddNewSections();
+
+	if(parser._inGameStateIndex != _gameStateIndex)
+	{
+		WriteFinalCuts(UDT_S32_MAX);
+		ClearHistory();
+		_gameStateIndex = parser._inGameStateIndex;
+		_hasGameStateMessage = _gameStateIndex >= 0 && fileOffset == parser._inGameStateFileOffsets[_gameStateIndex];
+	}
+
+	if(_gameStateIndex < 0)
+	{
+		return;
+	}
+
+	AddMessage(message, serverMessageSequence, fileOffset);
+	_keyframes.ProcessMessage(parser, nextFileOffset);
+
+	const s32 serverTimeMs = parser._inServerTime;
+	if(serverTimeMs == UDT_S32_MIN)
+	{
+		return;
+	}
+
+	const s32 minFutureStartTimeMs = _plugIn->GetMinFutureCutStartMs(serverTimeMs);
+	WriteFinalCuts(minFutureStartTimeMs);
+
+	const s32 maxLookBackTimeMs = serverTimeMs - UDT_PATTERN_CUTTER_MAX_LOOK_BACK_MS;
+	AbandonSections(maxLookBackTimeMs);
+
+	s32 neededTimeMs = minFutureStartTimeMs;
+	if(!_pendingSections.IsEmpty())
+	{
+		neededTimeMs = udt_min(neededTimeMs, _pendingSections[0].Section.StartTimeMs);
+	}
+	DiscardHistory(udt_max(neededTimeMs, maxLookBackTimeMs));
+}
+
+void udtPatternCutter::FinishDemo(udtBaseParser& parser, udtVMArray<udtCutSection>& remainingSections)
+{
+	// We now have the final list, which includes the sections found at the very end.
+	const udtVMArray<udtCutSection>& sections = _plugIn->CutSections;
+	for(u32 i = 0, count = sections.GetSize(); i < count; ++i)
+	{
+		const udtCutSection& section = sections[i];
+		if(IsWritten(section))
+		{
+			continue;
+		}
+
+		if(section.GameStateIndex != _gameStateIndex || !WriteCut(section))
+		{
+			remainingSections.Add(section);
+		}
+	}
+
+	parser._outCutCount += _parser->GetWrittenCutCount() - _firstCutCount;
+	parser.Profiler.Add(_parser->Profiler);
+	_parser->Profiler.Clear();
+	_writtenSections.Clear();
+	ClearHistory();
+}
+
+void udtPatternCutter::AddNewSections()
+{
+	_newSections.Clear();
+	_newSectionAnalyzerIndices.Clear();
+	_plugIn->GetNewCutSections(_newSections, _newSectionAnalyzerIndices);
+	for(u32 i = 0, count = _newSections.GetSize(); i < count; ++i)
+	{
+		// Sections of another game state are left to the second pass.
+		PendingSection pending;
+		pending.Section = _newSections[i];
+		pending.AnalyzerIndex = _newSectionAnalyzerIndices[i];
+		const udtCutSection& section = pending.Section;
+		if(section.GameStateIndex != _gameStateIndex)
+		{
+			continue;
+		}
+
+		// The first section of a merged range names it, so we order ties by analyzer like the final list.
+		// An analyzer's sections arrive in order, so those ties keep their order.
+		_pendingSections.Add(pending);
+		u32 j = _pendingSections.GetSize() - 1;
+		for(; j > 0; --j)
+		{
+			const PendingSection& previous = _pendingSections[j - 1];
+			if(previous.Section.StartTimeMs < section.StartTimeMs ||
+			   (previous.Section.StartTimeMs == section.StartTimeMs && previous.AnalyzerIndex <= pending.AnalyzerIndex))
+			{
+				break;
+			}
+
+			_pendingSections[j] = previous;
+		}
+		_pendingSections[j] = pending;
+	}
+
+	AbandonSections(UDT_S32_MIN);
+}
+
+void udtPatternCutter::AbandonSections(s32 startTimeMs)
+{
+	while(!_pendingSections.IsEmpty() &&
+		  (_pendingSections[0].Section.StartTimeMs < startTimeMs || _pendingSections[0].Section.StartTimeMs <= _abandonedEndTimeMs))
+	{
+		_abandonedEndTimeMs = udt_max(_abandonedEndTimeMs, _pendingSections[0].Section.EndTimeMs);
+		_pendingSections.Remove(0);
+	}
+}
+
+void udtPatternCutter::WriteFinalCuts(s32 minFutureStartTimeMs)
+{
+	// Same merging rules as MergeRanges.
+	while(!_pendingSections.IsEmpty())
+	{
+		udtCutSection cut = _pendingSections[0].Section;
+		u32 sectionCount = 1;
+		for(u32 count = _pendingSections.GetSize(); sectionCount < count; ++sectionCount)
+		{
+			const udtCutSection& section = _pendingSections[sectionCount].Section;
+			if(section.StartTimeMs > cut.EndTimeMs)
+			{
+				break;
+			}
+
+			cut.EndTimeMs = udt_max(cut.EndTimeMs, section.EndTimeMs);
+			cut.PatternTypes |= section.PatternTypes;
+		}
+
+		// A section found later could still be merged with it.
+		if(cut.EndTimeMs >= minFutureStartTimeMs)
+		{
+			break;
+		}
+
+		for(u32 i = 0; i < sectionCount; ++i)
+		{
+			_pendingSections.Remove(0);
+		}
+
+		if(WriteCut(cut))
+		{
+			_writtenSections.Add(cut);
+		}
+	}
+}
+
+bool udtPatternCutter::WriteCut(const udtCutSection& cut)
+{
+	udtBaseParser& parser = *_parser;
+	if(!parser.Init(_context, _protocol, _protocol, cut.GameStateIndex, false))
+	{
+		return false;
+	}
+
+	u32 fileOffset = 0;
+	const s32 keyframeIndex = _keyframes.FindKeyframe(cut.GameStateIndex, cut.StartTimeMs);
+	if(keyframeIndex >= 0)
+	{
+		if(!_keyframes.RestoreKeyframe(parser, (u32)keyframeIndex))
+		{
+			return false;
+		}
+		fileOffset = _keyframes.GetKeyframe((u32)keyframeIndex).FileOffset;
+	}
+	else if(_hasGameStateMessage && _firstMessageIndex < _messages.GetSize())
+	{
+		fileOffset = _messages[_firstMessageIndex].FileOffset;
+	}
+	else
+	{
+		// We don't go back far enough.
+		return false;
+	}
+
+	u32 messageIndex = _firstMessageIndex;
+	const u32 messageCount = _messages.GetSize();
+	while(messageIndex < messageCount && _messages[messageIndex].FileOffset != fileOffset)
+	{
+		++messageIndex;
+	}
+
+	if(messageIndex == messageCount)
+	{
+		return false;
+	}
+
+	parser.SetFilePath(_demoFilePath.GetPtr());
+	parser.AddCut(cut.GameStateIndex, cut.StartTimeMs, cut.EndTimeMs, &CallbackCutDemoFileNameCreation, cut.VeryShortDesc, &_cutInfo);
+
+	const u32 firstCutCount = parser.GetWrittenCutCount();
+	udtMessage message;
+	message.InitContext(_context);
+	message.InitProtocol(_protocol);
+	for(; messageIndex < messageCount; ++messageIndex)
+	{
+		const Message& rawMessage = _messages[messageIndex];
+		message.Init(parser._inMsgData, ID_MAX_MSG_LENGTH);
+		message.Buffer.data = _messageData.GetStartAddress() + rawMessage.DataOffset;
+		message.Buffer.cursize = (s32)rawMessage.ByteCount;
+		if(!parser.ParseNextMessage(message, rawMessage.ServerMessageSequence, rawMessage.FileOffset))
+		{
+			break;
+		}
+	}
+	parser.FinishParsing(true);
+
+	return parser.GetWrittenCutCount() > firstCutCount;
+}
+
+bool udtPatternCutter::IsWritten(const udtCutSection& cut) const
+{
+	for(u32 i = 0, count = _writtenSections.GetSize(); i < count; ++i)
+	{
+		const udtCutSection& section = _writtenSections[i];
+		if(section.GameStateIndex == cut.GameStateIndex &&
+		   section.StartTimeMs == cut.StartTimeMs &&
+		   section.EndTimeMs == cut.EndTimeMs)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void udtPatternCutter::AddMessage(const udtMessage& message, s32 serverMessageSequence, u32 fileOffset)
+{
+	Message rawMessage;
+	rawMessage.DataOffset = _messageData.GetSize();
+	rawMessage.ByteCount = (u32)message.Buffer.cursize;
+	rawMessage.FileOffset = fileOffset;
+	rawMessage.ServerMessageSequence = serverMessageSequence;
+	_messages.Add(rawMessage);
+
+	u8* const data = _messageData.Extend(rawMessage.ByteCount + UDT_MESSAGE_READ_PADDING);
+	memcpy(data, message.Buffer.data, (size_t)rawMessage.ByteCount);
+	memset(data + rawMessage.ByteCount, 0, (size_t)UDT_MESSAGE_READ_PADDING);
+}
+
+void udtPatternCutter::DiscardHistory(s32 startTimeMs)
+{
+	const s32 keyframeIndex = _keyframes.FindKeyframe(_gameStateIndex, startTimeMs);
+	if(keyframeIndex < 0)
+	{
+		return;
+	}
+
+	const u32 fileOffset = _keyframes.GetKeyframe((u32)keyframeIndex).FileOffset;
+	_keyframes.DiscardKeyframes((u32)keyframeIndex);
+
+	const u32 messageCount = _messages.GetSize();
+	while(_firstMessageIndex < messageCount && _messages[_firstMessageIndex].FileOffset < fileOffset)
+	{
+		++_firstMessageIndex;
+		_hasGameStateMessage = false;
+	}
+
+	// Only move the data once enough of it is unused.
+	if(_firstMessageIndex < 1024 || _firstMessageIndex * 2 < messageCount)
+	{
+		return;
+	}
+
+	const u32 keptMessageCount = messageCount - _firstMessageIndex;
+	const u32 firstDataOffset = keptMessageCount > 0 ? _messages[_firstMessageIndex].DataOffset : _messageData.GetSize();
+	const u32 keptByteCount = _messageData.GetSize() - firstDataOffset;
+	u8* const data = _messageData.GetStartAddress();
+	memmove(data, data + firstDataOffset, (size_t)keptByteCount);
+	_messageData.Resize(keptByteCount);
+
+	for(u32 i = 0; i < keptMessageCount; ++i)
+	{
+		Message rawMessage = _messages[_firstMessageIndex + i];
+		rawMessage.DataOffset -= firstDataOffset;
+		_messages[i] = rawMessage;
+	}
+	_messages.Resize(keptMessageCount);
+	_firstMessageIndex = 0;
+}
+
+void udtPatternCutter::ClearHistory()
+{
+	_keyframes.Init(_protocol, UDT_PATTERN_CUTTER_KEYFRAME_INTERVAL_MS);
+	_messages.Clear();
+	_messageData.Clear();
+	_pendingSections.Clear();
+	_firstMessageIndex = 0;
+	_abandonedEndTimeMs = UDT_S32_MIN;
+	_hasGameStateMessage = false;
+}
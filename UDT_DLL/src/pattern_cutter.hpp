@@ -0,0 +1,79 @@
+#pragma once
+
+
+#include "parser.hpp"
+#include "demo_index.hpp"
+#include "cut_section.hpp"
+#include "utils.hpp"
+#include "array.hpp"
+
+
+// Server time between the keyframes kept in memory.
+// Taking a keyframe costs about as much as replaying a few dozen messages.
+#define UDT_PATTERN_CUTTER_KEYFRAME_INTERVAL_MS    15000
+
+// Sections starting further back than this are left to the second pass.
+#define UDT_PATTERN_CUTTER_MAX_LOOK_BACK_MS    (5 * 60 * 1000)
+
+
+struct udtPatternSearchPlugIn;
+
+// Writes the cuts while the demo is being searched, see udtPatternSearchArgMask::SinglePass.
+// A cut is written once no section found later can be merged with it,
+// by replaying the raw messages it needs from the last keyframe before its start.
+// The messages and keyframes are only kept as far back as a cut might still need them.
+struct udtPatternCutter
+{
+public:
+	udtPatternCutter();
+	~udtPatternCutter();
+
+	bool StartDemo(udtBaseParser& parser, udtPatternSearchPlugIn& plugIn, const char* outputFolderPath); // After the parser's Init and SetFilePath.
+	void ProcessMessage(const udtBaseParser& parser, const udtMessage& message, s32 serverMessageSequence, u32 fileOffset, u32 nextFileOffset); // After each message.
+	void FinishDemo(udtBaseParser& parser, udtVMArray<udtCutSection>& remainingSections); // After the parser's FinishParsing. Gets the final sections still to cut.
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtPatternCutter);
+
+	struct Message
+	{
+		u32 DataOffset; // Into _messageData.
+		u32 ByteCount;
+		u32 FileOffset;
+		s32 ServerMessageSequence;
+	};
+
+	struct PendingSection
+	{
+		udtCutSection Section;
+		u32 AnalyzerIndex; // Breaks start time ties the way udtPatternSearchPlugIn::FinishDemoAnalysis does.
+	};
+
+	void AddNewSections();
+	void AbandonSections(s32 startTimeMs); // Leaves the sections starting before that time to the second pass.
+	void WriteFinalCuts(s32 minFutureStartTimeMs);
+	bool WriteCut(const udtCutSection& cut);
+	bool IsWritten(const udtCutSection& cut) const; // Ignores the name: the final list can label a merged range differently.
+	void AddMessage(const udtMessage& message, s32 serverMessageSequence, u32 fileOffset);
+	void DiscardHistory(s32 startTimeMs); // Keeps what the cuts starting at that time or later need.
+	void ClearHistory();
+
+	udtDemoIndexWriter _keyframes;
+	udtVMArray<Message> _messages { "PatternCutter::MessagesArray" };
+	udtVMArray<u8> _messageData { "PatternCutter::MessageDataArray" }; // Each message is followed by UDT_MESSAGE_READ_PADDING zeros.
+	udtVMArray<PendingSection> _pendingSections { "PatternCutter::PendingSectionsArray" }; // Sorted by start time, then analyzer index.
+	udtVMArray<udtCutSection> _writtenSections { "PatternCutter::WrittenSectionsArray" };
+	udtVMArray<udtCutSection> _newSections { "PatternCutter::NewSectionsArray" };
+	udtVMArray<u32> _newSectionAnalyzerIndices { "PatternCutter::NewSectionAnalyzerIndicesArray" };
+	CallbackCutDemoFileStreamCreationInfo _cutInfo;
+	udtBaseParser* _parser; // Writes the cuts. Lazily allocated.
+	udtContext* _context;
+	udtPatternSearchPlugIn* _plugIn;
+	udtString _demoFilePath;
+	udtProtocol::Id _protocol;
+	u32 _firstMessageIndex; // The messages before it were discarded.
+	u32 _firstCutCount;
+	s32 _gameStateIndex;
+	s32 _abandonedEndTimeMs; // Sections starting before that would merge with sections left to the second pass.
+	bool _hasGameStateMessage; // The first message kept is the current game state's.
+};
@@ -1,4 +1,5 @@
 #include "plug_in_captures.hpp"
+#include "utils.hpp"
 
 
 udtParserPlugInCaptures::udtParserPlugInCaptures()
@@ -33,6 +34,27 @@ u32 udtParserPlugInCaptures::GetItemCount() const
 	return _analyzer.Captures.GetSize();
 }
 
+void udtParserPlugInCaptures::AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset)
+{
+	const udtParseDataCaptureBuffers& source = *(const udtParseDataCaptureBuffers*)buffersStruct;
+	const udtParseDataCaptureBuffers& bases = *(const udtParseDataCaptureBuffers*)baseBuffersStruct;
+	const u32 stringOffset = AppendStringBuffer(_analyzer.StringAllocator, source.StringBuffer, source.StringBufferSize) - bases.StringBufferSize;
+	const u32 count = source.CaptureCount;
+	udtParseDataCapture* const captures = _analyzer.Captures.Append(source.Captures, count);
+	for(u32 i = 0; i < count; ++i)
+	{
+		udtParseDataCapture& capture = captures[i];
+		capture.GameStateIndex += gameStateIndexOffset;
+		RebaseApiStringOffset(capture.MapName, stringOffset);
+		RebaseApiStringOffset(capture.PlayerName, stringOffset);
+	}
+}
+
+void udtParserPlugInCaptures::DiscardGameStateItems(s32 gameStateIndex)
+{
+	_analyzer.Captures.Resize(GetItemCountBeforeGameState(_analyzer.Captures, gameStateIndex));
+}
+
 void udtParserPlugInCaptures::StartDemoAnalysis()
 {
 	_analyzer.StartDemoAnalysis();
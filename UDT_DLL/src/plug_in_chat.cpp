@@ -66,6 +66,39 @@ u32 udtParserPlugInChat::GetItemCount() const
 	return ChatEvents.GetSize();
 }
 
+void udtParserPlugInChat::AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset)
+{
+	const udtParseDataChatBuffers& source = *(const udtParseDataChatBuffers*)buffersStruct;
+	const udtParseDataChatBuffers& bases = *(const udtParseDataChatBuffers*)baseBuffersStruct;
+	const u32 stringOffset = AppendStringBuffer(_stringAllocator, source.StringBuffer, source.StringBufferSize) - bases.StringBufferSize;
+	const u32 count = source.ChatMessageCount;
+	udtParseDataChat* const chatEvents = ChatEvents.Append(source.ChatMessages, count);
+	for(u32 i = 0; i < count; ++i)
+	{
+		udtParseDataChat& chatEvent = chatEvents[i];
+		chatEvent.GameStateIndex += gameStateIndexOffset;
+		for(u32 j = 0; j < 2; ++j)
+		{
+			udtChatEventData& strings = chatEvent.Strings[j];
+			RebaseApiStringOffset(strings.OriginalCommand, stringOffset);
+			RebaseApiStringOffset(strings.ClanName, stringOffset);
+			RebaseApiStringOffset(strings.PlayerName, stringOffset);
+			RebaseApiStringOffset(strings.Message, stringOffset);
+			RebaseApiStringOffset(strings.Location, stringOffset);
+		}
+	}
+}
+
+void udtParserPlugInChat::DiscardGameStateItems(s32 gameStateIndex)
+{
+	ChatEvents.Resize(GetItemCountBeforeGameState(ChatEvents, gameStateIndex));
+}
+
+u32 udtParserPlugInChat::GetNeeds() const
+{
+	return (u32)(udtParserPlugInNeed::GameStates | udtParserPlugInNeed::Commands);
+}
+
 void udtParserPlugInChat::StartDemoAnalysis()
 {
 	_gameStateIndex = -1;
@@ -68,6 +68,58 @@ u32 udtParserPlugInGameState::GetItemCount() const
 	return _gameStates.GetSize();
 }
 
+void udtParserPlugInGameState::AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 /*gameStateIndexOffset*/)
+{
+	const udtParseDataGameStateBuffers& source = *(const udtParseDataGameStateBuffers*)buffersStruct;
+	const udtParseDataGameStateBuffers& bases = *(const udtParseDataGameStateBuffers*)baseBuffersStruct;
+	const u32 stringOffset = AppendStringBuffer(_stringAllocator, source.StringBuffer, source.StringBufferSize) - bases.StringBufferSize;
+	const u32 firstMatchIndex = _matches.GetSize() - bases.MatchCount;
+	const u32 firstKeyValuePairIndex = _keyValuePairs.GetSize() - bases.KeyValuePairCount;
+	const u32 firstPlayerIndex = _players.GetSize() - bases.PlayerCount;
+	_matches.Append(source.Matches, source.MatchCount);
+
+	const u32 keyValuePairCount = source.KeyValuePairCount;
+	udtGameStateKeyValuePair* const keyValuePairs = _keyValuePairs.Append(source.KeyValuePairs, keyValuePairCount);
+	for(u32 i = 0; i < keyValuePairCount; ++i)
+	{
+		RebaseApiStringOffset(keyValuePairs[i].Name, stringOffset);
+		RebaseApiStringOffset(keyValuePairs[i].Value, stringOffset);
+	}
+
+	const u32 playerCount = source.PlayerCount;
+	udtGameStatePlayerInfo* const players = _players.Append(source.Players, playerCount);
+	for(u32 i = 0; i < playerCount; ++i)
+	{
+		RebaseApiStringOffset(players[i].FirstName, stringOffset);
+	}
+
+	// The file offsets are already absolute.
+	const u32 gameStateCount = source.GameStateCount;
+	udtParseDataGameState* const gameStates = _gameStates.Append(source.GameStates, gameStateCount);
+	for(u32 i = 0; i < gameStateCount; ++i)
+	{
+		udtParseDataGameState& gameState = gameStates[i];
+		RebaseApiStringOffset(gameState.DemoTakerName, stringOffset);
+		gameState.FirstMatchIndex += firstMatchIndex;
+		gameState.FirstKeyValuePairIndex += firstKeyValuePairIndex;
+		gameState.FirstPlayerIndex += firstPlayerIndex;
+	}
+}
+
+void udtParserPlugInGameState::DiscardGameStateItems(s32 gameStateIndex)
+{
+	// The current game state only gets added to the array when the next one starts.
+	const bool isCurrent = (u32)gameStateIndex >= _gameStates.GetSize();
+	const udtParseDataGameState& firstRemoved = isCurrent ? _currentGameState : _gameStates[gameStateIndex];
+	_matches.Resize(firstRemoved.FirstMatchIndex);
+	_keyValuePairs.Resize(firstRemoved.FirstKeyValuePairIndex);
+	_players.Resize(firstRemoved.FirstPlayerIndex);
+	if(!isCurrent)
+	{
+		_gameStates.Resize((u32)gameStateIndex);
+	}
+}
+
 void udtParserPlugInGameState::StartDemoAnalysis()
 {
 	_protocol = udtProtocol::Invalid;
@@ -190,6 +242,7 @@ void udtParserPlugInGameState::AddCurrentMatchIfValid(bool addIfInProgress)
 	match.MatchStartTimeMs = _analyzer.MatchStartTime();
 	match.MatchEndTimeMs = _analyzer.MatchEndTime();
 	match.WarmUpEndTimeMs = UDT_S32_MIN;
+	match.Reserved1 = 0;
 	
 	if(_currentGameState.MatchCount > 0 &&
 	   _matches[_matches.GetSize() - 1].MatchEndTimeMs >= match.MatchStartTimeMs)
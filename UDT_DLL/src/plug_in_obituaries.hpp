@@ -2,6 +2,7 @@
 
 
 #include "analysis_obituaries.hpp"
+#include "utils.hpp"
 
 
 struct udtParserPlugInObituaries : udtBaseParserPlugIn
@@ -39,6 +40,28 @@ public:
 		return Analyzer.Obituaries.GetSize();
 	}
 
+	void AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset) override
+	{
+		const udtParseDataObituaryBuffers& source = *(const udtParseDataObituaryBuffers*)buffersStruct;
+		const udtParseDataObituaryBuffers& bases = *(const udtParseDataObituaryBuffers*)baseBuffersStruct;
+		const u32 stringOffset = AppendStringBuffer(Analyzer.GetStringAllocator(), source.StringBuffer, source.StringBufferSize) - bases.StringBufferSize;
+		const u32 count = source.ObituaryCount;
+		udtParseDataObituary* const obituaries = Analyzer.Obituaries.Append(source.Obituaries, count);
+		for(u32 i = 0; i < count; ++i)
+		{
+			udtParseDataObituary& obituary = obituaries[i];
+			obituary.GameStateIndex += gameStateIndexOffset;
+			RebaseApiStringOffset(obituary.AttackerName, stringOffset);
+			RebaseApiStringOffset(obituary.TargetName, stringOffset);
+			RebaseApiStringOffset(obituary.MeanOfDeathName, stringOffset);
+		}
+	}
+
+	void DiscardGameStateItems(s32 gameStateIndex) override
+	{
+		Analyzer.Obituaries.Resize(GetItemCountBeforeGameState(Analyzer.Obituaries, gameStateIndex));
+	}
+
 	void StartDemoAnalysis() override
 	{
 		Analyzer.ResetForNextDemo();
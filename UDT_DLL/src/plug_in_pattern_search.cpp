@@ -23,23 +23,24 @@ struct CutSection : public udtCutSection
 	int Order;
 };
 
-static int SortByStartTimeAscending(const void* aPtr, const void* bPtr)
-{
-	const u64 a = ((CutSection*)aPtr)->StartTimeMs;
-	const u64 b = ((CutSection*)bPtr)->StartTimeMs;
-
-	return (int)(a - b);
-}
-
-static int StableSortByGameStateIndexAscending(const void* aPtr, const void* bPtr)
+// Sections with the same start time stay in analyzer order, which decides the merged sections' names.
+// udtPatternCutter::AddNewSections sorts the live sections the same way.
+static int StableSortByGameStateIndexAndStartTimeAscending(const void* aPtr, const void* bPtr)
 {
 	const CutSection& a = *(CutSection*)aPtr;
 	const CutSection& b = *(CutSection*)bPtr;
 
-	const int byGameState = a.GameStateIndex - b.GameStateIndex;
-	const int byPreviousOrder = a.Order - b.Order;
+	if(a.GameStateIndex != b.GameStateIndex)
+	{
+		return a.GameStateIndex < b.GameStateIndex ? -1 : 1;
+	}
+
+	if(a.StartTimeMs != b.StartTimeMs)
+	{
+		return a.StartTimeMs < b.StartTimeMs ? -1 : 1;
+	}
 
-	return byGameState != 0 ? byGameState : byPreviousOrder;
+	return a.Order - b.Order;
 }
 
 static void AppendCutSections(udtVMArray<udtCutSection>& dest, udtVMArray<CutSection>& source)
@@ -151,6 +152,56 @@ udtPatternSearchAnalyzerBase* udtPatternSearchPlugIn::GetAnalyzer(udtPatternType
 	return NULL;
 }
 
+bool udtPatternSearchPlugIn::CanCutInSinglePass() const
+{
+	if(_analyzers.IsEmpty() ||
+	   (GetInfo().Flags & (u32)udtPatternSearchArgMask::SinglePass) == 0 ||
+	   (_analyzers.GetSize() > 1 && (GetInfo().Flags & (u32)udtPatternSearchArgMask::MergeCutSections) == 0))
+	{
+		return false;
+	}
+
+	for(u32 i = 0, count = _analyzers.GetSize(); i < count; ++i)
+	{
+		if(!_analyzers[i]->AddsCutSectionsLive())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+s32 udtPatternSearchPlugIn::GetMinFutureCutStartMs(s32 serverTimeMs) const
+{
+	if(serverTimeMs == UDT_S32_MIN)
+	{
+		return UDT_S32_MIN;
+	}
+
+	s32 matchTimeMs = serverTimeMs;
+	for(u32 i = 0, count = _analyzers.GetSize(); i < count; ++i)
+	{
+		matchTimeMs = udt_min(matchTimeMs, _analyzers[i]->GetPendingMatchTimeMs());
+	}
+
+	return matchTimeMs - (s32)GetInfo().StartOffsetSec * 1000;
+}
+
+void udtPatternSearchPlugIn::GetNewCutSections(udtVMArray<udtCutSection>& sections, udtVMArray<u32>& analyzerIndices)
+{
+	for(u32 i = 0, count = _analyzers.GetSize(); i < count; ++i)
+	{
+		const udtVMArray<udtCutSection>& analyzerSections = _analyzers[i]->CutSections;
+		for(u32 j = _liveCutSectionCounts[i], sectionCount = analyzerSections.GetSize(); j < sectionCount; ++j)
+		{
+			sections.Add(analyzerSections[j]);
+			analyzerIndices.Add(i);
+		}
+		_liveCutSectionCounts[i] = analyzerSections.GetSize();
+	}
+}
+
 void udtPatternSearchPlugIn::ProcessGamestateMessage(const udtGamestateCallbackArg& info, udtBaseParser& parser)
 {
 	const udtPatternSearchArg& pi = GetInfo();
@@ -272,6 +323,8 @@ void udtPatternSearchPlugIn::ProcessCommandMessage(const udtCommandCallbackArg&
 void udtPatternSearchPlugIn::StartDemoAnalysis()
 {
 	CutSections.Clear();
+	_liveCutSectionCounts.Clear();
+	_liveCutSectionCounts.ExtendAndSet(_analyzers.GetSize(), 0);
 
 	for(u32 i = 0, analyzerCount = _analyzers.GetSize(); i < analyzerCount; ++i)
 	{
@@ -311,25 +364,16 @@ void udtPatternSearchPlugIn::FinishDemoAnalysis()
 			const udtCutSection cut = _analyzers[i]->CutSections[j];
 			CutSection newCut;
 			newCut.udtCutSection::operator=(cut);
+			newCut.Order = (int)tempCutSections.GetSize();
 			tempCutSections.Add(newCut);
 		}
 	}
 
 	//
-	// Apply sorting pass #1.
+	// Sort by game state, then by start time.
 	//
 	const u32 cutCount = tempCutSections.GetSize();
-	qsort(tempCutSections.GetStartAddress(), (size_t)cutCount, sizeof(CutSection), &SortByStartTimeAscending);
-
-	//
-	// Apply sorting pass #2, which must be stable with respect to 
-	// the sorting of pass #1.
-	//
-	for(u32 i = 0; i < cutCount; ++i)
-	{
-		tempCutSections[i].Order = (int)i;
-	}
-	qsort(tempCutSections.GetStartAddress(), (size_t)cutCount, sizeof(CutSection), &StableSortByGameStateIndexAscending);
+	qsort(tempCutSections.GetStartAddress(), (size_t)cutCount, sizeof(CutSection), &StableSortByGameStateIndexAndStartTimeAscending);
 
 	//
 	// Create a new list with the sorted data using the final data format
@@ -28,6 +28,11 @@ public:
 
 	void SetPatternInfo(const udtPatternSearchArg& info) { _info = &info; }
 
+	// For single-pass cutting, see udtPatternSearchArgMask::SinglePass.
+	bool CanCutInSinglePass() const; // The flag is set, all analyzers add their sections live and all sections get merged.
+	s32  GetMinFutureCutStartMs(s32 serverTimeMs) const; // No section found from now on will start earlier.
+	void GetNewCutSections(udtVMArray<udtCutSection>& sections, udtVMArray<u32>& analyzerIndices); // Appends the sections found since the last call and who found them.
+
 	s32 GetTrackedPlayerIndex() const;
 	const udtPatternSearchArg& GetInfo() const { return *_info; }
 
@@ -44,6 +49,7 @@ private:
 
 	udtVMArray<udtPatternSearchAnalyzerBase*> _analyzers { "CutByPatternPlugIn::AnalyzersArray" };
 	udtVMArray<udtPatternType::Id> _analyzerTypes { "CutByPatternPlugIn::AnalyzerTypesArray" };
+	udtVMArray<u32> _liveCutSectionCounts { "CutByPatternPlugIn::LiveCutSectionCountsArray" }; // Sections already returned by GetNewCutSections.
 	udtVMLinearAllocator _analyzerAllocator { "CutByPatternPlugIn::AnalyzerData" };
 	udtVMScopedStackAllocator _analyzerAllocatorScope;
 
@@ -0,0 +1,211 @@
+#include "plug_in_probe.hpp"
+#include "utils.hpp"
+#include "scoped_stack_allocator.hpp"
+
+
+udtParserPlugInProbe::udtParserPlugInProbe()
+{
+	_info = NULL;
+	_protocol = udtProtocol::Invalid;
+	_inputIndex = 0;
+	_gameStateRead = false;
+	_done = false;
+	ClearDemoInfo(_demo);
+}
+
+udtParserPlugInProbe::~udtParserPlugInProbe()
+{
+}
+
+void udtParserPlugInProbe::InitAllocators(u32 demoCount)
+{
+	_analyzer.InitAllocators(*TempAllocator, demoCount);
+}
+
+u32 udtParserPlugInProbe::GetItemCount() const
+{
+	return Demos.GetSize();
+}
+
+void udtParserPlugInProbe::StartDemoAnalysis()
+{
+	_analyzer.ResetForNextDemo();
+
+	_protocol = udtProtocol::Invalid;
+	_gameStateRead = false;
+	_done = false;
+
+	ClearDemoInfo(_demo);
+	_demo.FirstPlayerIndex = Players.GetSize();
+}
+
+void udtParserPlugInProbe::ClearDemoInfo(udtDemoProbeInfo& demo)
+{
+	memset(&demo, 0, sizeof(demo));
+	WriteNullStringToApiStruct(demo.MapName);
+	WriteNullStringToApiStruct(demo.ModVersion);
+	WriteNullStringToApiStruct(demo.ServerName);
+	WriteNullStringToApiStruct(demo.DemoTakerName);
+	demo.Protocol = (u32)udtProtocol::Invalid;
+	demo.Mod = (u32)udtMod::None;
+	demo.GameType = (u32)udtGameType::Invalid;
+	demo.DemoTakerPlayerIndex = -1;
+	demo.FirstSnapshotTimeMs = UDT_S32_MIN;
+	demo.LastSnapshotTimeMs = UDT_S32_MIN;
+}
+
+void udtParserPlugInProbe::FinishDemoAnalysis()
+{
+	if(!_gameStateRead)
+	{
+		return;
+	}
+
+	_demo.Mod = (u32)_analyzer.Mod();
+	_demo.GameType = (u32)_analyzer.GameType();
+	_demo.GamePlay = (u32)_analyzer.GamePlay();
+	_demo.StartDateEpoch = _analyzer.GetMatchStartDateEpoch();
+	WriteString(_demo.MapName, _analyzer.MapName());
+	WriteString(_demo.ModVersion, _analyzer.ModVersion());
+
+	Demos.Add(_demo);
+	InputIndices.Add(_inputIndex);
+}
+
+void udtParserPlugInProbe::ProcessGamestateMessage(const udtGamestateCallbackArg& info, udtBaseParser& parser)
+{
+	// We only want the demo's first game state.
+	if(_gameStateRead)
+	{
+		_done = true;
+		return;
+	}
+
+	_analyzer.ProcessGamestateMessage(info, parser);
+
+	_gameStateRead = true;
+	_protocol = parser._inProtocol;
+	_demo.Protocol = (u32)parser._inProtocol;
+
+	ProcessDemoTakerName(info.ClientNum, parser);
+	ProcessServerName(parser);
+	ProcessPlayers(parser);
+
+	_done = _info->MaxSnapshotCount == 0;
+}
+
+void udtParserPlugInProbe::ProcessSnapshotMessage(const udtSnapshotCallbackArg& info, udtBaseParser& parser)
+{
+	if(!_gameStateRead || _done)
+	{
+		return;
+	}
+
+	_analyzer.ProcessSnapshotMessage(info, parser);
+
+	if(_demo.SnapshotCount == 0)
+	{
+		_demo.FirstSnapshotTimeMs = parser._inServerTime;
+	}
+	_demo.LastSnapshotTimeMs = parser._inServerTime;
+	++_demo.SnapshotCount;
+
+	_done = _demo.SnapshotCount >= _info->MaxSnapshotCount;
+}
+
+void udtParserPlugInProbe::ProcessCommandMessage(const udtCommandCallbackArg& info, udtBaseParser& parser)
+{
+	if(!_gameStateRead || _done)
+	{
+		return;
+	}
+
+	_analyzer.ProcessCommandMessage(info, parser);
+}
+
+void udtParserPlugInProbe::ProcessDemoTakerName(s32 playerIndex, udtBaseParser& parser)
+{
+	_demo.DemoTakerPlayerIndex = playerIndex;
+	if(playerIndex < 0 || playerIndex >= ID_MAX_CLIENTS)
+	{
+		return;
+	}
+
+	const s32 firstPlayerCsIndex = GetIdNumber(udtMagicNumberType::ConfigStringIndex, udtConfigStringIndex::FirstPlayer, _protocol);
+	const udtString& cs = parser._inConfigStrings[firstPlayerCsIndex + playerIndex];
+	if(udtString::IsNullOrEmpty(cs))
+	{
+		return;
+	}
+
+	udtVMScopedStackAllocator allocatorScope(*TempAllocator);
+
+	udtString clan, name;
+	bool hasClan;
+	if(GetClanAndPlayerName(clan, name, hasClan, *TempAllocator, _protocol, cs.GetPtr()))
+	{
+		WriteStringToApiStruct(_demo.DemoTakerName, udtString::NewCleanCloneFromRef(StringAllocator, _protocol, name));
+	}
+}
+
+void udtParserPlugInProbe::ProcessServerName(udtBaseParser& parser)
+{
+	const udtString serverInfo = parser.GetConfigString(CS_SERVERINFO);
+	if(udtString::IsNullOrEmpty(serverInfo))
+	{
+		return;
+	}
+
+	udtVMScopedStackAllocator allocatorScope(*TempAllocator);
+
+	udtString serverName;
+	if(ParseConfigStringValueString(serverName, *TempAllocator, "sv_hostname", serverInfo.GetPtr()))
+	{
+		WriteStringToApiStruct(_demo.ServerName, udtString::NewCleanCloneFromRef(StringAllocator, _protocol, serverName));
+	}
+}
+
+void udtParserPlugInProbe::ProcessPlayers(udtBaseParser& parser)
+{
+	const s32 firstPlayerCsIndex = GetIdNumber(udtMagicNumberType::ConfigStringIndex, udtConfigStringIndex::FirstPlayer, _protocol);
+	for(s32 i = 0; i < ID_MAX_CLIENTS; ++i)
+	{
+		const udtString& cs = parser._inConfigStrings[firstPlayerCsIndex + i];
+		if(udtString::IsNullOrEmpty(cs))
+		{
+			continue;
+		}
+
+		udtVMScopedStackAllocator allocatorScope(*TempAllocator);
+
+		udtString clan, name;
+		bool hasClan;
+		const udtString finalName = GetClanAndPlayerName(clan, name, hasClan, *TempAllocator, _protocol, cs.GetPtr()) ?
+			udtString::NewCleanCloneFromRef(StringAllocator, _protocol, name) :
+			udtString::NewClone(StringAllocator, "N/A");
+
+		s32 team = -1;
+		if(!ParseConfigStringValueInt(team, *TempAllocator, "t", cs.GetPtr()))
+		{
+			team = -1;
+		}
+
+		udtDemoProbePlayer player;
+		WriteStringToApiStruct(player.Name, finalName);
+		player.Index = i;
+		player.Team = team;
+		Players.Add(player);
+		++_demo.PlayerCount;
+	}
+}
+
+void udtParserPlugInProbe::WriteString(u32& offset, const udtString& string)
+{
+	if(udtString::IsNull(string))
+	{
+		WriteNullStringToApiStruct(offset);
+		return;
+	}
+
+	WriteStringToApiStruct(offset, udtString::NewCloneFromRef(StringAllocator, string));
+}
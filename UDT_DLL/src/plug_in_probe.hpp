@@ -0,0 +1,57 @@
+#pragma once
+
+
+#include "parser.hpp"
+#include "parser_plug_in.hpp"
+#include "array.hpp"
+#include "string.hpp"
+#include "analysis_general.hpp"
+
+
+// Reads the first game state and, optionally, a few snapshots after it.
+// The parser stops reading the demo as soon as IsDone returns true.
+struct udtParserPlugInProbe : udtBaseParserPlugIn
+{
+public:
+	udtParserPlugInProbe();
+	~udtParserPlugInProbe();
+
+	void InitAllocators(u32 demoCount) override;
+	u32  GetItemCount() const override;
+
+	void StartDemoAnalysis() override;
+	void FinishDemoAnalysis() override;
+	void ProcessGamestateMessage(const udtGamestateCallbackArg& info, udtBaseParser& parser) override;
+	void ProcessSnapshotMessage(const udtSnapshotCallbackArg& info, udtBaseParser& parser) override;
+	void ProcessCommandMessage(const udtCommandCallbackArg& info, udtBaseParser& parser) override;
+
+	void SetProbeInfo(const udtProbeArg& info) { _info = &info; }
+	void SetInputIndex(u32 inputIndex) { _inputIndex = inputIndex; } // Call before parsing each demo.
+	bool IsDone() const override { return _done; }
+
+	static void ClearDemoInfo(udtDemoProbeInfo& demo); // Everything is set to "not available".
+
+private:
+	UDT_NO_COPY_SEMANTICS(udtParserPlugInProbe);
+
+	void ProcessDemoTakerName(s32 playerIndex, udtBaseParser& parser);
+	void ProcessServerName(udtBaseParser& parser);
+	void ProcessPlayers(udtBaseParser& parser);
+	void WriteString(u32& offset, const udtString& string);
+
+public:
+	// The string offsets and player indices are relative to this plug-in's buffers.
+	udtVMArray<udtDemoProbeInfo> Demos { "ParserPlugInProbe::DemosArray" };
+	udtVMArray<u32> InputIndices { "ParserPlugInProbe::InputIndicesArray" }; // One per element of Demos.
+	udtVMArray<udtDemoProbePlayer> Players { "ParserPlugInProbe::PlayersArray" };
+	udtVMLinearAllocator StringAllocator { "ParserPlugInProbe::Strings" };
+
+private:
+	udtGeneralAnalyzer _analyzer;
+	udtDemoProbeInfo _demo;
+	const udtProbeArg* _info;
+	udtProtocol::Id _protocol;
+	u32 _inputIndex;
+	bool _gameStateRead;
+	bool _done;
+};
@@ -33,6 +33,30 @@ u32 udtParserPlugInRawCommands::GetItemCount() const
 	return _commands.GetSize();
 }
 
+void udtParserPlugInRawCommands::AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset)
+{
+	const udtParseDataRawCommandBuffers& source = *(const udtParseDataRawCommandBuffers*)buffersStruct;
+	const udtParseDataRawCommandBuffers& bases = *(const udtParseDataRawCommandBuffers*)baseBuffersStruct;
+	const u32 stringOffset = AppendStringBuffer(_stringAllocator, source.StringBuffer, source.StringBufferSize) - bases.StringBufferSize;
+	const u32 count = source.CommandCount;
+	udtParseDataRawCommand* const commands = _commands.Append(source.Commands, count);
+	for(u32 i = 0; i < count; ++i)
+	{
+		commands[i].GameStateIndex += gameStateIndexOffset;
+		RebaseApiStringOffset(commands[i].RawCommand, stringOffset);
+	}
+}
+
+void udtParserPlugInRawCommands::DiscardGameStateItems(s32 gameStateIndex)
+{
+	_commands.Resize(GetItemCountBeforeGameState(_commands, gameStateIndex));
+}
+
+u32 udtParserPlugInRawCommands::GetNeeds() const
+{
+	return (u32)(udtParserPlugInNeed::GameStates | udtParserPlugInNeed::Commands);
+}
+
 void udtParserPlugInRawCommands::StartDemoAnalysis()
 {
 	_gameStateIndex = -1;
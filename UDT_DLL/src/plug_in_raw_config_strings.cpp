@@ -33,6 +33,30 @@ u32 udtParserPlugInRawConfigStrings::GetItemCount() const
 	return _configStrings.GetSize();
 }
 
+void udtParserPlugInRawConfigStrings::AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset)
+{
+	const udtParseDataRawConfigStringBuffers& source = *(const udtParseDataRawConfigStringBuffers*)buffersStruct;
+	const udtParseDataRawConfigStringBuffers& bases = *(const udtParseDataRawConfigStringBuffers*)baseBuffersStruct;
+	const u32 stringOffset = AppendStringBuffer(_stringAllocator, source.StringBuffer, source.StringBufferSize) - bases.StringBufferSize;
+	const u32 count = source.ConfigStringCount;
+	udtParseDataRawConfigString* const configStrings = _configStrings.Append(source.ConfigStrings, count);
+	for(u32 i = 0; i < count; ++i)
+	{
+		configStrings[i].GameStateIndex += gameStateIndexOffset;
+		RebaseApiStringOffset(configStrings[i].RawConfigString, stringOffset);
+	}
+}
+
+void udtParserPlugInRawConfigStrings::DiscardGameStateItems(s32 gameStateIndex)
+{
+	_configStrings.Resize(GetItemCountBeforeGameState(_configStrings, gameStateIndex));
+}
+
+u32 udtParserPlugInRawConfigStrings::GetNeeds() const
+{
+	return (u32)(udtParserPlugInNeed::GameStates);
+}
+
 void udtParserPlugInRawConfigStrings::StartDemoAnalysis()
 {
 	_gameStateIndex = -1;
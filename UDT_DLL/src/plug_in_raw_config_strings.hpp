@@ -16,6 +16,9 @@ public:
 	void CopyBuffersStruct(void* buffersStruct) const override;
 	void UpdateBufferStruct() override;
 	u32  GetItemCount() const override;
+	void AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset) override;
+	void DiscardGameStateItems(s32 gameStateIndex) override;
+	u32  GetNeeds() const override;
 	void StartDemoAnalysis() override;
 	void FinishDemoAnalysis() override;
 	void ProcessGamestateMessage(const udtGamestateCallbackArg& arg, udtBaseParser& parser) override;
@@ -71,6 +71,38 @@ u32 udtParserPlugInScores::GetItemCount() const
 	return _scores.GetSize();
 }
 
+void udtParserPlugInScores::AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset)
+{
+	const udtParseDataScoreBuffers& source = *(const udtParseDataScoreBuffers*)buffersStruct;
+	const udtParseDataScoreBuffers& bases = *(const udtParseDataScoreBuffers*)baseBuffersStruct;
+	const u32 stringOffset = AppendStringBuffer(_stringAllocator, source.StringBuffer, source.StringBufferSize) - bases.StringBufferSize;
+	const u32 count = source.ScoreCount;
+	udtParseDataScore* const scores = _scores.Append(source.Scores, count);
+	for(u32 i = 0; i < count; ++i)
+	{
+		udtParseDataScore& score = scores[i];
+		score.GameStateIndex += gameStateIndexOffset;
+		RebaseApiStringOffset(score.Name1, stringOffset);
+		RebaseApiStringOffset(score.Name2, stringOffset);
+		RebaseApiStringOffset(score.CleanName1, stringOffset);
+		RebaseApiStringOffset(score.CleanName2, stringOffset);
+	}
+}
+
+void udtParserPlugInScores::FinishAppendingDemoSegment(udtBaseParserPlugIn& segment)
+{
+	udtParserPlugInScores& source = (udtParserPlugInScores&)segment;
+	if(source._firstScoreFixUpPending)
+	{
+		FixUpFirstScore(BufferRanges[BufferRanges.GetSize() - 1].FirstIndex, source._firstSnapshotTimeMs);
+	}
+}
+
+void udtParserPlugInScores::DiscardGameStateItems(s32 gameStateIndex)
+{
+	_scores.Resize(GetItemCountBeforeGameState(_scores, gameStateIndex));
+}
+
 void udtParserPlugInScores::StartDemoAnalysis()
 {
 	memset(_players, 0, sizeof(_players));
@@ -79,14 +111,27 @@ void udtParserPlugInScores::StartDemoAnalysis()
 	_gameType = udtGameType::Count;
 	_protocol = udtProtocol::Invalid;
 	_mod = udtMod::None;
+	_firstScoreFixUpPending = false;
 	_tempAllocator.Clear();
 }
 
 void udtParserPlugInScores::FinishDemoAnalysis()
 {
+	if(_parser != NULL && _parser->ContinuesDemo)
+	{
+		// Done when appending this segment's data, see FinishAppendingDemoSegment.
+		_firstScoreFixUpPending = true;
+		return;
+	}
+
 	// @NOTE: The current range hasn't been added yet.
 	const u32 rangeCount = BufferRanges.GetSize();
 	const u32 firstIdx = rangeCount == 0 ? 0 : BufferRanges[rangeCount - 1].FirstIndex + BufferRanges[rangeCount - 1].Count;
+	FixUpFirstScore(firstIdx, _firstSnapshotTimeMs);
+}
+
+void udtParserPlugInScores::FixUpFirstScore(u32 firstIdx, s32 firstSnapshotTimeMs)
+{
 	if(firstIdx >= _scores.GetSize())
 	{
 		return;
@@ -100,7 +145,7 @@ void udtParserPlugInScores::FinishDemoAnalysis()
 	}
 	else
 	{
-		_scores[firstIdx].ServerTimeMs = _firstSnapshotTimeMs;
+		_scores[firstIdx].ServerTimeMs = firstSnapshotTimeMs;
 	}
 }
 
@@ -352,6 +397,7 @@ void udtParserPlugInScores::AddScore()
 	scores.GameStateIndex = _gameStateIndex;
 	scores.ServerTimeMs = _parser->_inServerTime;
 	scores.Flags = 0;
+	scores.Reserved1 = 0;
 	WriteNullStringToApiStruct(scores.Name1);
 	WriteNullStringToApiStruct(scores.Name2);
 	WriteNullStringToApiStruct(scores.CleanName1);
@@ -17,6 +17,9 @@ public:
 	void CopyBuffersStruct(void* buffersStruct) const override;
 	void UpdateBufferStruct() override;
 	u32  GetItemCount() const override;
+	void AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset) override;
+	void FinishAppendingDemoSegment(udtBaseParserPlugIn& segment) override;
+	void DiscardGameStateItems(s32 gameStateIndex) override;
 	void StartDemoAnalysis() override;
 	void FinishDemoAnalysis() override;
 	void ProcessGamestateMessage(const udtGamestateCallbackArg& arg, udtBaseParser& parser) override;
@@ -41,6 +44,7 @@ private:
 	void DetectGameType();
 	void DetectMod();
 	void AddScore();
+	void FixUpFirstScore(u32 firstIdx, s32 firstSnapshotTimeMs);
 	void GetScoresCPMA(udtParseDataScore& scores);
 	void GetScoresQ3(udtParseDataScore& scores);
 	void GetScoresQL(udtParseDataScore& scores);
@@ -66,4 +70,5 @@ private:
 	udtProtocol::Id _protocol;
 	udtMod::Id _mod;
 	bool _scoreChanged;
+	bool _firstScoreFixUpPending; // When the demo's first score was in a previous segment.
 };
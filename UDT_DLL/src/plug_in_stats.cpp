@@ -95,9 +95,6 @@ udtParserPlugInStats::~udtParserPlugInStats()
 void udtParserPlugInStats::InitAllocators(u32 demoCount)
 {
 	_analyzer.InitAllocators(*TempAllocator, demoCount);
-
-	_redString = udtString::NewClone(_stringAllocator, "RED");
-	_blueString = udtString::NewClone(_stringAllocator, "BLUE");
 }
 
 void udtParserPlugInStats::CopyBuffersStruct(void* buffersStruct) const
@@ -131,6 +128,68 @@ u32 udtParserPlugInStats::GetItemCount() const
 	return _statsArray.GetSize();
 }
 
+void udtParserPlugInStats::AppendDemoItems(const void* buffersStruct, const void* baseBuffersStruct, s32 gameStateIndexOffset)
+{
+	const udtParseDataStatsBuffers& source = *(const udtParseDataStatsBuffers*)buffersStruct;
+	const udtParseDataStatsBuffers& bases = *(const udtParseDataStatsBuffers*)baseBuffersStruct;
+	const u32 stringOffset = AppendStringBuffer(_stringAllocator, source.StringBuffer, source.StringBufferSize) - bases.StringBufferSize;
+	const u32 firstTeamFlagIndex = _teamFlagsArray.GetSize() - bases.TeamFlagCount;
+	const u32 firstPlayerFlagIndex = _playerFlagsArray.GetSize() - bases.PlayerFlagCount;
+	const u32 firstTeamFieldIndex = _teamFieldsArray.GetSize() - bases.TeamFieldCount;
+	const u32 firstPlayerFieldIndex = _playerFieldsArray.GetSize() - bases.PlayerFieldCount;
+	const u32 firstPlayerStatsIndex = _playerStatsArray.GetSize() - bases.PlayerStatsCount;
+	const u32 firstTimeOutRangeIndex = _timeOutTimes.GetSize() / 2 - bases.TimeOutRangeCount;
+	_teamFlagsArray.Append(source.TeamFlags, source.TeamFlagCount);
+	_playerFlagsArray.Append(source.PlayerFlags, source.PlayerFlagCount);
+	_teamFieldsArray.Append(source.TeamFields, source.TeamFieldCount);
+	_playerFieldsArray.Append(source.PlayerFields, source.PlayerFieldCount);
+	_timeOutTimes.Append(source.TimeOutStartAndEndTimes, source.TimeOutRangeCount * 2);
+
+	const u32 playerStatsCount = source.PlayerStatsCount;
+	udtPlayerStats* const playerStats = _playerStatsArray.Append(source.PlayerStats, playerStatsCount);
+	for(u32 i = 0; i < playerStatsCount; ++i)
+	{
+		RebaseApiStringOffset(playerStats[i].Name, stringOffset);
+		RebaseApiStringOffset(playerStats[i].CleanName, stringOffset);
+	}
+
+	const u32 matchCount = source.MatchCount;
+	udtParseDataStats* const matches = _statsArray.Append(source.MatchStats, matchCount);
+	for(u32 i = 0; i < matchCount; ++i)
+	{
+		udtParseDataStats& stats = matches[i];
+		stats.GameStateIndex += (u32)gameStateIndexOffset;
+		stats.FirstTeamFlagIndex += firstTeamFlagIndex;
+		stats.FirstPlayerFlagIndex += firstPlayerFlagIndex;
+		stats.FirstTeamFieldIndex += firstTeamFieldIndex;
+		stats.FirstPlayerFieldIndex += firstPlayerFieldIndex;
+		stats.FirstPlayerStatsIndex += firstPlayerStatsIndex;
+		stats.FirstTimeOutRangeIndex += firstTimeOutRangeIndex;
+		RebaseApiStringOffset(stats.ModVersion, stringOffset);
+		RebaseApiStringOffset(stats.MapName, stringOffset);
+		RebaseApiStringOffset(stats.FirstPlaceName, stringOffset);
+		RebaseApiStringOffset(stats.SecondPlaceName, stringOffset);
+		RebaseApiStringOffset(stats.CustomRedName, stringOffset);
+		RebaseApiStringOffset(stats.CustomBlueName, stringOffset);
+	}
+}
+
+void udtParserPlugInStats::DiscardGameStateItems(s32 gameStateIndex)
+{
+	const u32 keptMatchCount = GetItemCountBeforeGameState(_statsArray, gameStateIndex);
+	if(keptMatchCount < _statsArray.GetSize())
+	{
+		const udtParseDataStats& firstRemoved = _statsArray[keptMatchCount];
+		_teamFlagsArray.Resize(firstRemoved.FirstTeamFlagIndex);
+		_playerFlagsArray.Resize(firstRemoved.FirstPlayerFlagIndex);
+		_teamFieldsArray.Resize(firstRemoved.FirstTeamFieldIndex);
+		_playerFieldsArray.Resize(firstRemoved.FirstPlayerFieldIndex);
+		_playerStatsArray.Resize(firstRemoved.FirstPlayerStatsIndex);
+		_timeOutTimes.Resize(2 * firstRemoved.FirstTimeOutRangeIndex);
+		_statsArray.Resize(keptMatchCount);
+	}
+}
+
 void udtParserPlugInStats::StartDemoAnalysis()
 {
 	_analyzer.ResetForNextDemo();
@@ -142,6 +201,10 @@ void udtParserPlugInStats::StartDemoAnalysis()
 	_disableStatsOverrides = false;
 	_lastMatchEndTime = UDT_S32_MIN;
 	ClearStats();
+
+	// Each demo gets its own copies so that its strings never point into another demo's data.
+	_redString = udtString::NewClone(_stringAllocator, "RED");
+	_blueString = udtString::NewClone(_stringAllocator, "BLUE");
 }
 
 void udtParserPlugInStats::FinishDemoAnalysis()
@@ -2927,9 +2990,6 @@ void udtParserPlugInStats::AddCurrentStats()
 
 	// Clear the stats for the next match.
 	ClearStats();
-
-	// We just cloned its strings into our local _stringAllocator, so it's safe.
-	_analyzer.ClearStringAllocator();
 }
 
 void udtParserPlugInStats::ClearStats(bool newGameState)
@@ -2954,6 +3014,8 @@ void udtParserPlugInStats::ClearStats(bool newGameState)
 		for(s32 i = 0; i < 64; ++i)
 		{
 			_playerTeamIndices[i] = -1;
+			_playerStats[i].Name = UDT_U32_MAX;
+			_playerStats[i].CleanName = UDT_U32_MAX;
 		}
 	}
 }
@@ -0,0 +1,19 @@
+#pragma once
+
+
+#include "array.hpp"
+#include "linear_allocator.hpp"
+
+
+struct udtProbeContext_s
+{
+	udtProbeContext_s(const udtProbeArg* probeInfo)
+	{
+		ProbeInfo = probeInfo;
+	}
+
+	udtVMArray<udtDemoProbeInfo> Demos { "ProbeContext::DemosArray" }; // Indexed by input index.
+	udtVMArray<udtDemoProbePlayer> Players { "ProbeContext::PlayersArray" };
+	udtVMLinearAllocator StringAllocator { "ProbeContext::Strings" };
+	const udtProbeArg* ProbeInfo;
+};
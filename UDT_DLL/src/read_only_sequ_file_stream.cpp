@@ -1,5 +1,9 @@
 #include "read_only_sequ_file_stream.hpp"
 #include "memory.hpp"
+#include "assert_or_fatal.hpp"
+#include "utils.hpp"
+
+#include <string.h>
 
 
 #if defined(UDT_WINDOWS)
@@ -8,16 +12,10 @@
 #include "string.hpp"
 #include "scoped_stack_allocator.hpp"
 #include "thread_local_allocators.hpp"
-#include "assert_or_fatal.hpp"
-#include "utils.hpp"
 
 #include <Windows.h>
 
 
-#define BLOCK_SIZE  (128*1024)
-#define BLOCK_COUNT (2)
-
-
 static bool GetDeviceSectorSize(u32& sectorSize, const WCHAR* deviceName)
 {
 	const HANDLE file = CreateFileW(deviceName, STANDARD_RIGHTS_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
@@ -83,6 +81,7 @@ static u8* AlignTop(u8* address, u32 alignment)
 }
 
 
+
 struct BlockInfo
 {
 	OVERLAPPED Overlapped;
@@ -94,11 +93,12 @@ struct BlockInfo
 
 struct udtReadOnlySequentialFileStreamImpl
 {
-	BlockInfo _blocks[BLOCK_COUNT];
+	BlockInfo* _blocks; // If invalid: NULL.
 	u8* _buffer;     // Aligned buffer used for the reads.
 	void* _realBuffer; // The buffer we need to free.
 	HANDLE _file;    // If invalid: INVALID_HANDLE_VALUE.
 	u32 _blockSize;
+	u32 _blockCount;
 	u32 _fileByteCount;
 	u32 _fileOffset;
 };
@@ -106,48 +106,57 @@ struct udtReadOnlySequentialFileStreamImpl
 udtReadOnlySequentialFileStream::udtReadOnlySequentialFileStream()
 {
 	_data = (udtReadOnlySequentialFileStreamImpl*)udt_malloc(sizeof(udtReadOnlySequentialFileStreamImpl));
+	_data->_blocks = NULL;
 	_data->_buffer = NULL;
+	_data->_realBuffer = NULL;
 	_data->_file = INVALID_HANDLE_VALUE;
 	_data->_blockSize = 0;
+	_data->_blockCount = 0;
 	_data->_fileByteCount = 0;
 	_data->_fileOffset = 0;
-	for(u32 i = 0; i < BLOCK_COUNT; ++i)
-	{
-		_data->_blocks[i].Event = NULL;
-		_data->_blocks[i].BlockIndex = i;
-		_data->_blocks[i].RequestPending = false;
-		_data->_blocks[i].Ready = false;
-	}
 }
 
-udtReadOnlySequentialFileStream::~udtReadOnlySequentialFileStream()
+bool udtReadOnlySequentialFileStream::Init(u32 blockSize, u32 blockCount)
 {
-	Destroy(); 
-}
+	if(_data->_blocks != NULL || blockSize == 0 || blockCount < 2)
+	{
+		return false;
+	}
 
-bool udtReadOnlySequentialFileStream::Init()
-{
-	for(int i = 0; i < BLOCK_COUNT; ++i)
+	BlockInfo* const blocks = (BlockInfo*)udt_malloc(sizeof(BlockInfo) * (size_t)blockCount);
+	for(u32 i = 0; i < blockCount; ++i)
+	{
+		blocks[i].Event = NULL;
+		blocks[i].BlockIndex = i;
+		blocks[i].RequestPending = false;
+		blocks[i].Ready = false;
+	}
+	_data->_blocks = blocks;
+	_data->_blockCount = blockCount;
+
+	for(u32 i = 0; i < blockCount; ++i)
 	{
 		const HANDLE event = CreateEvent(NULL, TRUE, FALSE, NULL);
 		if(event == NULL)
 		{
 			return false;
 		}
-		_data->_blocks[i].Event = event;
+		blocks[i].Event = event;
 	}
 
 	// If the largest sector size found on the system is higher than a page size,
 	// we use that as the alignment. Otherwise, we use the page size.
 	// This is for fast/correct DMA with unbuffered reads.
+	// Unbuffered reads also require the block size to be a multiple of the sector size.
 	u32 alignment = 1; // In number of pages.
-	u32 bytesRequired = BLOCK_SIZE * BLOCK_COUNT;
 	const u32 sectorSize = GetLargestDeviceSectorSize();
 	if(sectorSize > 4096 && IsPowerOfTwo(alignment))
 	{
 		alignment = sectorSize / UDT_MEMORY_PAGE_SIZE;
-		bytesRequired += (alignment - 1) * UDT_MEMORY_PAGE_SIZE;
 	}
+	const u32 alignmentByteCount = alignment * UDT_MEMORY_PAGE_SIZE;
+	blockSize = ((blockSize + alignmentByteCount - 1) / alignmentByteCount) * alignmentByteCount;
+	const u32 bytesRequired = blockSize * blockCount + (alignment - 1) * UDT_MEMORY_PAGE_SIZE;
 
 	void* const buffer = VirtualAlloc(NULL, (SIZE_T)bytesRequired, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 	if(buffer == NULL)
@@ -155,9 +164,9 @@ bool udtReadOnlySequentialFileStream::Init()
 		return false;
 	}
 
-	_data->_buffer = AlignTop((u8*)buffer, alignment * UDT_MEMORY_PAGE_SIZE);
+	_data->_buffer = AlignTop((u8*)buffer, alignmentByteCount);
 	_data->_realBuffer = buffer;
-	_data->_blockSize = BLOCK_SIZE;
+	_data->_blockSize = blockSize;
 
 	return true;
 }
@@ -166,7 +175,7 @@ bool udtReadOnlySequentialFileStream::Open(const char* filePath, u32 offset)
 {
 	Close();
 	_data->_fileOffset = 0;
-	for(u32 i = 0; i < BLOCK_COUNT; ++i)
+	for(u32 i = 0, count = _data->_blockCount; i < count; ++i)
 	{
 		_data->_blocks[i].BlockIndex = i;
 		_data->_blocks[i].RequestPending = false;
@@ -191,8 +200,8 @@ bool udtReadOnlySequentialFileStream::Open(const char* filePath, u32 offset)
 	_data->_fileOffset = offset;
 
 	const u32 blockCount = (_data->_fileByteCount + blockSize - 1) / blockSize;
-	const u32 requestCount = udt_min(blockCount, (u32)BLOCK_COUNT - 1);
-	const u32 firstBlockIndex = offset / BLOCK_SIZE;
+	const u32 requestCount = udt_min(blockCount, _data->_blockCount - 1);
+	const u32 firstBlockIndex = offset / blockSize;
 	for(u32 i = 0; i < requestCount; ++i)
 	{
 		RequestBlock(firstBlockIndex + i);
@@ -204,7 +213,7 @@ bool udtReadOnlySequentialFileStream::Open(const char* filePath, u32 offset)
 void udtReadOnlySequentialFileStream::RequestBlock(u32 blockIndex)
 {
 	const u32 blockSize = _data->_blockSize;
-	const u32 blockId = blockIndex % BLOCK_COUNT;
+	const u32 blockId = blockIndex % _data->_blockCount;
 	BlockInfo& block = _data->_blocks[blockId];
 	if(block.BlockIndex == blockIndex && (block.RequestPending || block.Ready))
 	{
@@ -224,17 +233,541 @@ void udtReadOnlySequentialFileStream::RequestBlock(u32 blockIndex)
 	block.Ready = success;
 }
 
-void udtReadOnlySequentialFileStream::WaitForBlock(u32 blockIndex)
+bool udtReadOnlySequentialFileStream::WaitForBlock(u32 blockIndex)
 {
-	const u32 blockId = blockIndex % BLOCK_COUNT;
+	const u32 blockId = blockIndex % _data->_blockCount;
 	BlockInfo& block = _data->_blocks[blockId];
 	if(block.BlockIndex == blockIndex && block.RequestPending)
 	{
 		DWORD bytesRead = 0;
-		GetOverlappedResult(_data->_file, &block.Overlapped, &bytesRead, TRUE);
+		const bool success = GetOverlappedResult(_data->_file, &block.Overlapped, &bytesRead, TRUE) != FALSE;
 		block.RequestPending = false;
-		block.Ready = true;
+		block.Ready = success;
+	}
+
+	return block.BlockIndex == blockIndex && block.Ready;
+}
+
+s32 udtReadOnlySequentialFileStream::Close()
+{
+	if(_data->_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(_data->_file);
+		_data->_file = INVALID_HANDLE_VALUE;
+	}
+
+	return 0;
+}
+
+void udtReadOnlySequentialFileStream::Destroy()
+{
+	Close();
+
+	if(_data->_blocks != NULL)
+	{
+		for(u32 i = 0, count = _data->_blockCount; i < count; ++i)
+		{
+			const HANDLE event = _data->_blocks[i].Event;
+			if(event != NULL)
+			{
+				CloseHandle(event);
+			}
+		}
+		free(_data->_blocks);
+	}
+
+	if(_data->_realBuffer != NULL)
+	{
+		VirtualFree(_data->_realBuffer, 0, MEM_RELEASE);
+	}
+	
+	free(_data);
+}
+
+
+#else
+
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <errno.h>
+
+
+struct BlockInfo
+{
+	struct iovec Vector; // Must stay valid while the io_uring request is in flight.
+	u32 BlockIndex;
+	bool RequestPending;
+	bool Ready;
+};
+
+struct IoRing
+{
+	void* SubmissionRing;
+	void* CompletionRing;
+	io_uring_sqe* SubmissionEntries;
+	u32* SubmissionTail;
+	u32* SubmissionMask;
+	u32* SubmissionArray;
+	u32* CompletionHead;
+	u32* CompletionTail;
+	u32* CompletionMask;
+	io_uring_cqe* CompletionEntries;
+	size_t SubmissionRingByteCount;
+	size_t CompletionRingByteCount;
+	size_t SubmissionEntriesByteCount;
+	int File; // If invalid: -1.
+};
+
+struct udtReadOnlySequentialFileStreamImpl
+{
+	BlockInfo* _blocks; // If invalid: NULL.
+	u8* _buffer;
+	u32 _blockSize;
+	u32 _blockCount;
+	u32 _fileByteCount;
+	u32 _fileOffset;
+	int _file; // If invalid: -1.
+
+	// Used when io_uring is available.
+	IoRing _ring;
+
+	// Used otherwise: a single thread services the read requests in block index order.
+	pthread_t _thread;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _requestCondition;
+	pthread_cond_t _completionCondition;
+	bool _threadStarted;
+	bool _threadBusy;
+	bool _threadQuit;
+};
+
+static bool ReadFully(int file, u8* buffer, u32 byteCount, u64 offset)
+{
+	while(byteCount > 0)
+	{
+		const ssize_t result = pread(file, buffer, (size_t)byteCount, (off_t)offset);
+		if(result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if(result <= 0)
+		{
+			// Reading past the end isn't an error, the bytes past the end are never used.
+			return result == 0;
+		}
+
+		buffer += result;
+		byteCount -= (u32)result;
+		offset += (u64)result;
+	}
+
+	return true;
+}
+
+static bool CreateIoRing(IoRing& ring, u32 entryCount)
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	const int file = (int)syscall(__NR_io_uring_setup, entryCount, &params);
+	if(file < 0)
+	{
+		return false;
+	}
+
+	ring.File = file;
+	ring.SubmissionRingByteCount = params.sq_off.array + params.sq_entries * sizeof(u32);
+	ring.CompletionRingByteCount = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	ring.SubmissionEntriesByteCount = params.sq_entries * sizeof(io_uring_sqe);
+
+	const int prot = PROT_READ | PROT_WRITE;
+	const int flags = MAP_SHARED | MAP_POPULATE;
+	ring.SubmissionRing = mmap(NULL, ring.SubmissionRingByteCount, prot, flags, file, IORING_OFF_SQ_RING);
+	ring.CompletionRing = mmap(NULL, ring.CompletionRingByteCount, prot, flags, file, IORING_OFF_CQ_RING);
+	ring.SubmissionEntries = (io_uring_sqe*)mmap(NULL, ring.SubmissionEntriesByteCount, prot, flags, file, IORING_OFF_SQES);
+	if(ring.SubmissionRing == MAP_FAILED ||
+	   ring.CompletionRing == MAP_FAILED ||
+	   ring.SubmissionEntries == MAP_FAILED)
+	{
+		return false;
+	}
+
+	u8* const sq = (u8*)ring.SubmissionRing;
+	u8* const cq = (u8*)ring.CompletionRing;
+	ring.SubmissionTail = (u32*)(sq + params.sq_off.tail);
+	ring.SubmissionMask = (u32*)(sq + params.sq_off.ring_mask);
+	ring.SubmissionArray = (u32*)(sq + params.sq_off.array);
+	ring.CompletionHead = (u32*)(cq + params.cq_off.head);
+	ring.CompletionTail = (u32*)(cq + params.cq_off.tail);
+	ring.CompletionMask = (u32*)(cq + params.cq_off.ring_mask);
+	ring.CompletionEntries = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+	return true;
+}
+
+static void DestroyIoRing(IoRing& ring)
+{
+	if(ring.SubmissionEntries != NULL && ring.SubmissionEntries != MAP_FAILED)
+	{
+		munmap(ring.SubmissionEntries, ring.SubmissionEntriesByteCount);
+	}
+
+	if(ring.CompletionRing != NULL && ring.CompletionRing != MAP_FAILED)
+	{
+		munmap(ring.CompletionRing, ring.CompletionRingByteCount);
+	}
+
+	if(ring.SubmissionRing != NULL && ring.SubmissionRing != MAP_FAILED)
+	{
+		munmap(ring.SubmissionRing, ring.SubmissionRingByteCount);
+	}
+
+	if(ring.File != -1)
+	{
+		close(ring.File);
+	}
+
+	memset(&ring, 0, sizeof(ring));
+	ring.File = -1;
+}
+
+static void ReadThreadFunction(void* userData)
+{
+	udtReadOnlySequentialFileStreamImpl& data = *(udtReadOnlySequentialFileStreamImpl*)userData;
+
+	pthread_mutex_lock(&data._mutex);
+	for(;;)
+	{
+		// Pick the pending request with the lowest block index.
+		BlockInfo* block = NULL;
+		for(u32 i = 0; i < data._blockCount; ++i)
+		{
+			BlockInfo& current = data._blocks[i];
+			if(current.RequestPending && (block == NULL || current.BlockIndex < block->BlockIndex))
+			{
+				block = &current;
+			}
+		}
+
+		if(block == NULL)
+		{
+			if(data._threadQuit)
+			{
+				break;
+			}
+
+			pthread_cond_wait(&data._requestCondition, &data._mutex);
+			continue;
+		}
+
+		const u32 blockSize = data._blockSize;
+		const u32 blockIndex = block->BlockIndex;
+		u8* const buffer = data._buffer + (blockIndex % data._blockCount) * blockSize;
+		const int file = data._file;
+		data._threadBusy = true;
+		pthread_mutex_unlock(&data._mutex);
+
+		const bool success = ReadFully(file, buffer, blockSize, (u64)blockIndex * (u64)blockSize);
+
+		pthread_mutex_lock(&data._mutex);
+		data._threadBusy = false;
+		block->RequestPending = false;
+		block->Ready = success;
+		pthread_cond_broadcast(&data._completionCondition);
+	}
+	pthread_mutex_unlock(&data._mutex);
+}
+
+static void* ReadThreadEntryPoint(void* userData)
+{
+	ReadThreadFunction(userData);
+
+	return NULL;
+}
+
+udtReadOnlySequentialFileStream::udtReadOnlySequentialFileStream()
+{
+	_data = (udtReadOnlySequentialFileStreamImpl*)udt_malloc(sizeof(udtReadOnlySequentialFileStreamImpl));
+	memset(_data, 0, sizeof(udtReadOnlySequentialFileStreamImpl));
+	_data->_file = -1;
+	_data->_ring.File = -1;
+	pthread_mutex_init(&_data->_mutex, NULL);
+	pthread_cond_init(&_data->_requestCondition, NULL);
+	pthread_cond_init(&_data->_completionCondition, NULL);
+}
+
+bool udtReadOnlySequentialFileStream::Init(u32 blockSize, u32 blockCount)
+{
+	if(_data->_blocks != NULL || blockSize == 0 || blockCount < 2)
+	{
+		return false;
+	}
+
+	BlockInfo* const blocks = (BlockInfo*)udt_malloc(sizeof(BlockInfo) * (size_t)blockCount);
+	for(u32 i = 0; i < blockCount; ++i)
+	{
+		blocks[i].BlockIndex = i;
+		blocks[i].RequestPending = false;
+		blocks[i].Ready = false;
+	}
+	_data->_blocks = blocks;
+	_data->_blockCount = blockCount;
+	_data->_blockSize = blockSize;
+	_data->_buffer = (u8*)udt_malloc((size_t)blockSize * (size_t)blockCount);
+
+	if(CreateIoRing(_data->_ring, blockCount))
+	{
+		return true;
+	}
+
+	DestroyIoRing(_data->_ring);
+	_data->_threadStarted = pthread_create(&_data->_thread, NULL, &ReadThreadEntryPoint, _data) == 0;
+
+	return _data->_threadStarted;
+}
+
+bool udtReadOnlySequentialFileStream::Open(const char* filePath, u32 offset)
+{
+	Close();
+	for(u32 i = 0, count = _data->_blockCount; i < count; ++i)
+	{
+		_data->_blocks[i].BlockIndex = i;
+		_data->_blocks[i].RequestPending = false;
+		_data->_blocks[i].Ready = false;
+	}
+
+	const int file = open(filePath, O_RDONLY);
+	if(file == -1)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if(fstat(file, &info) != 0)
+	{
+		close(file);
+		return false;
+	}
+
+	posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	const u32 blockSize = _data->_blockSize;
+	_data->_file = file;
+	_data->_fileByteCount = (u32)info.st_size;
+	_data->_fileOffset = offset;
+
+	const u32 blockCount = (_data->_fileByteCount + blockSize - 1) / blockSize;
+	const u32 requestCount = udt_min(blockCount, _data->_blockCount - 1);
+	const u32 firstBlockIndex = offset / blockSize;
+	for(u32 i = 0; i < requestCount; ++i)
+	{
+		RequestBlock(firstBlockIndex + i);
+	}
+
+	return true;
+}
+
+void udtReadOnlySequentialFileStream::RequestBlock(u32 blockIndex)
+{
+	const u32 blockSize = _data->_blockSize;
+	const u32 blockId = blockIndex % _data->_blockCount;
+	BlockInfo& block = _data->_blocks[blockId];
+	if(block.BlockIndex == blockIndex && (block.RequestPending || block.Ready))
+	{
+		return;
+	}
+
+	IoRing& ring = _data->_ring;
+	if(ring.File == -1)
+	{
+		pthread_mutex_lock(&_data->_mutex);
+		block.BlockIndex = blockIndex;
+		block.RequestPending = true;
+		block.Ready = false;
+		pthread_cond_signal(&_data->_requestCondition);
+		pthread_mutex_unlock(&_data->_mutex);
+		return;
+	}
+
+	block.BlockIndex = blockIndex;
+	block.Vector.iov_base = _data->_buffer + blockId * blockSize;
+	block.Vector.iov_len = (size_t)blockSize;
+
+	const u32 tail = *ring.SubmissionTail;
+	const u32 index = tail & *ring.SubmissionMask;
+	io_uring_sqe& entry = ring.SubmissionEntries[index];
+	memset(&entry, 0, sizeof(entry));
+	entry.opcode = IORING_OP_READV;
+	entry.fd = _data->_file;
+	entry.addr = (u64)(uptr)&block.Vector;
+	entry.len = 1;
+	entry.off = (u64)blockIndex * (u64)blockSize;
+	entry.user_data = (u64)blockId;
+	ring.SubmissionArray[index] = index;
+	__atomic_store_n(ring.SubmissionTail, tail + 1, __ATOMIC_RELEASE);
+
+	long result = 0;
+	do
+	{
+		result = syscall(__NR_io_uring_enter, ring.File, 1, 0, 0, NULL, 0);
+	}
+	while(result < 0 && errno == EINTR);
+
+	if(result == 1)
+	{
+		block.RequestPending = true;
+		block.Ready = false;
+		return;
+	}
+
+	// The kernel didn't take the entry (EAGAIN, EBUSY, etc).
+	// We take it back so that the next submission doesn't send a stale read
+	// and read the block right away instead.
+	__atomic_store_n(ring.SubmissionTail, tail, __ATOMIC_RELEASE);
+	block.RequestPending = false;
+	block.Ready = ReadFully(_data->_file, (u8*)block.Vector.iov_base, blockSize, (u64)blockIndex * (u64)blockSize);
+}
+
+bool udtReadOnlySequentialFileStream::WaitForBlock(u32 blockIndex)
+{
+	const u32 blockId = blockIndex % _data->_blockCount;
+	BlockInfo& block = _data->_blocks[blockId];
+	if(block.BlockIndex != blockIndex)
+	{
+		return false;
+	}
+
+	IoRing& ring = _data->_ring;
+	if(ring.File == -1)
+	{
+		pthread_mutex_lock(&_data->_mutex);
+		while(block.RequestPending)
+		{
+			pthread_cond_wait(&_data->_completionCondition, &_data->_mutex);
+		}
+		const bool ready = block.Ready;
+		pthread_mutex_unlock(&_data->_mutex);
+
+		return ready;
+	}
+
+	const u32 blockSize = _data->_blockSize;
+	while(block.RequestPending)
+	{
+		const u32 head = *ring.CompletionHead;
+		if(head == __atomic_load_n(ring.CompletionTail, __ATOMIC_ACQUIRE))
+		{
+			const long result = syscall(__NR_io_uring_enter, ring.File, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+			if(result < 0 && errno != EINTR)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const io_uring_cqe& entry = ring.CompletionEntries[head & *ring.CompletionMask];
+		BlockInfo& completed = _data->_blocks[(u32)entry.user_data];
+		const s32 byteCount = (s32)entry.res;
+		completed.RequestPending = false;
+		completed.Ready = byteCount >= 0;
+		if(byteCount >= 0 && (u32)byteCount < blockSize)
+		{
+			// Short read: finish the block synchronously.
+			const u64 offset = (u64)completed.BlockIndex * (u64)blockSize + (u64)byteCount;
+			u8* const buffer = (u8*)completed.Vector.iov_base + byteCount;
+			completed.Ready = ReadFully(_data->_file, buffer, blockSize - (u32)byteCount, offset);
+		}
+		__atomic_store_n(ring.CompletionHead, head + 1, __ATOMIC_RELEASE);
+	}
+
+	return block.Ready;
+}
+
+s32 udtReadOnlySequentialFileStream::Close()
+{
+	if(_data->_file == -1)
+	{
+		return 0;
 	}
+
+	// The buffers and file descriptor must not be released while reads are in flight.
+	if(_data->_ring.File != -1)
+	{
+		for(u32 i = 0, count = _data->_blockCount; i < count; ++i)
+		{
+			WaitForBlock(_data->_blocks[i].BlockIndex);
+		}
+	}
+	else
+	{
+		pthread_mutex_lock(&_data->_mutex);
+		for(u32 i = 0, count = _data->_blockCount; i < count; ++i)
+		{
+			_data->_blocks[i].RequestPending = false;
+		}
+		while(_data->_threadBusy)
+		{
+			pthread_cond_wait(&_data->_completionCondition, &_data->_mutex);
+		}
+		pthread_mutex_unlock(&_data->_mutex);
+	}
+
+	close(_data->_file);
+	_data->_file = -1;
+
+	return 0;
+}
+
+void udtReadOnlySequentialFileStream::Destroy()
+{
+	Close();
+
+	if(_data->_threadStarted)
+	{
+		pthread_mutex_lock(&_data->_mutex);
+		_data->_threadQuit = true;
+		pthread_cond_signal(&_data->_requestCondition);
+		pthread_mutex_unlock(&_data->_mutex);
+		pthread_join(_data->_thread, NULL);
+	}
+
+	DestroyIoRing(_data->_ring);
+	pthread_cond_destroy(&_data->_completionCondition);
+	pthread_cond_destroy(&_data->_requestCondition);
+	pthread_mutex_destroy(&_data->_mutex);
+
+	if(_data->_blocks != NULL)
+	{
+		free(_data->_blocks);
+	}
+
+	if(_data->_buffer != NULL)
+	{
+		free(_data->_buffer);
+	}
+
+	free(_data);
+}
+
+
+#endif
+
+
+udtReadOnlySequentialFileStream::~udtReadOnlySequentialFileStream()
+{
+	Destroy(); 
+}
+
+bool udtReadOnlySequentialFileStream::IsInitialized() const
+{
+	return _data->_blocks != NULL;
 }
 
 u32 udtReadOnlySequentialFileStream::Read(void* dstBuff, u32 elementSize, u32 count)
@@ -245,7 +778,7 @@ u32 udtReadOnlySequentialFileStream::Read(void* dstBuff, u32 elementSize, u32 co
 
 	const u32 fileSize = _data->_fileByteCount;
 	const u32 fileOffset = _data->_fileOffset;
-	if(byteCount == 0 || fileOffset == fileSize)
+	if(byteCount == 0 || fileOffset >= fileSize)
 	{
 		return 0;
 	}
@@ -256,24 +789,29 @@ u32 udtReadOnlySequentialFileStream::Read(void* dstBuff, u32 elementSize, u32 co
 	}
 
 	const u32 blockIndex = fileOffset / blockSize;
-	WaitForBlock(blockIndex);
+	if(!WaitForBlock(blockIndex))
+	{
+		return 0;
+	}
 
-	const u32 nextBlockIndex = blockIndex + BLOCK_COUNT - 1;
+	const u32 ringBlockCount = _data->_blockCount;
+	const u32 nextBlockIndex = blockIndex + ringBlockCount - 1;
 	const u32 blockCount = (fileSize + blockSize - 1) / blockSize;
 	if(nextBlockIndex < blockCount)
 	{
 		RequestBlock(nextBlockIndex);
 	}
 
-	if((fileOffset % blockSize) + byteCount > blockSize)
+	if((fileOffset % blockSize) + byteCount > blockSize && 
+	   !WaitForBlock(blockIndex + 1))
 	{
-		WaitForBlock(blockIndex + 1);
+		return 0;
 	}
 
-	const u32 blockId = blockIndex % BLOCK_COUNT;
+	const u32 blockId = blockIndex % ringBlockCount;
 	const u8* const buffer = _data->_buffer;
 	const u8* const readData = buffer + (blockId * blockSize) + (fileOffset % blockSize);
-	const u8* const bufferEnd = buffer + (u32)BLOCK_COUNT * blockSize;
+	const u8* const bufferEnd = buffer + ringBlockCount * blockSize;
 	if(readData + byteCount > bufferEnd)
 	{
 		u8* const writeData = (u8*)dstBuff;
@@ -312,39 +850,3 @@ u64 udtReadOnlySequentialFileStream::Length()
 {
 	return (u64)_data->_fileByteCount;
 }
-
-s32 udtReadOnlySequentialFileStream::Close()
-{
-	if(_data->_file != INVALID_HANDLE_VALUE)
-	{
-		CloseHandle(_data->_file);
-		_data->_file = INVALID_HANDLE_VALUE;
-	}
-
-	return 0;
-}
-
-void udtReadOnlySequentialFileStream::Destroy()
-{
-	Close();
-
-	for(int i = 0; i < BLOCK_COUNT; ++i)
-	{
-		const HANDLE event = _data->_blocks[i].Event;
-		if(event != NULL)
-		{
-			CloseHandle(event);
-		}
-	}
-
-	if(_data->_realBuffer != NULL)
-	{
-		VirtualFree(_data->_realBuffer, 0, MEM_RELEASE);
-	}
-	
-	free(_data);
-}
-
-
-#endif
-
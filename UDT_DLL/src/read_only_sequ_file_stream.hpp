@@ -4,17 +4,26 @@
 #include "stream.hpp"
 
 
+#define UDT_READ_AHEAD_DEFAULT_BLOCK_SIZE  (128*1024)
+#define UDT_READ_AHEAD_DEFAULT_BLOCK_COUNT (2)
+
+
 struct udtReadOnlySequentialFileStreamImpl;
 
 // This is intended to be created once and then used for multiple files.
 // The initialization cost would be too high if not amortized over many files.
+// While the parser works on a block, the next (blockCount - 1) blocks are being read in the background.
+// Windows: overlapped unbuffered reads.
+// Linux:   io_uring when the kernel supports it, a pread thread otherwise.
 struct udtReadOnlySequentialFileStream : udtStream
 {
 public:
 	udtReadOnlySequentialFileStream();
 	~udtReadOnlySequentialFileStream();
 
-	bool Init();
+	// The block count must be at least 2 and no single read can be larger than a block.
+	bool Init(u32 blockSize = UDT_READ_AHEAD_DEFAULT_BLOCK_SIZE, u32 blockCount = UDT_READ_AHEAD_DEFAULT_BLOCK_COUNT);
+	bool IsInitialized() const;
 	bool Open(const char* filePath, u32 offset = 0);
 
 	u32  Read(void* dstBuff, u32 elementSize, u32 count) override;
@@ -25,8 +34,10 @@ public:
 	s32  Close() override;
 
 private:
+	UDT_NO_COPY_SEMANTICS(udtReadOnlySequentialFileStream);
+
 	void RequestBlock(u32 blockIndex);
-	void WaitForBlock(u32 blockIndex);
+	bool WaitForBlock(u32 blockIndex);
 	void Destroy();
 
 	udtReadOnlySequentialFileStreamImpl* _data;
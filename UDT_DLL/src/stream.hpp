@@ -27,6 +27,11 @@ struct udtStream
 	virtual u64 Length() = 0; // -1 for failure.
 	virtual s32 Close() = 0; // 0 for success. Must be safe to call more than once.
 
+	// Zero-copy read: returns the address of the next byteCount bytes and advances the offset.
+	// At least paddingByteCount more readable bytes must follow the returned data.
+	// Returns NULL when not supported or when the request can't be honored, nothing is consumed then.
+	virtual const u8* ReadInPlace(u32 /*byteCount*/, u32 /*paddingByteCount*/) { return NULL; }
+
 	uptr      ReadAll(udtVMLinearAllocator& allocator);
 	udtString ReadAllAsString(udtVMLinearAllocator& allocator); // Will allocate and set the trailing NULL terminator.
 };
@@ -154,6 +154,42 @@ void udtThread::Release()
 	}
 }
 
+bool udtThread::PinToCore(u32 coreIndex)
+{
+	if(_threadhandle == NULL)
+	{
+		return false;
+	}
+
+#if defined(UDT_WINDOWS)
+
+	if(coreIndex >= (u32)(sizeof(DWORD_PTR) * 8))
+	{
+		return false;
+	}
+
+	return SetThreadAffinityMask((HANDLE)_threadhandle, (DWORD_PTR)1 << coreIndex) != 0;
+
+#elif defined(_GNU_SOURCE)
+
+	if(coreIndex >= (u32)CPU_SETSIZE)
+	{
+		return false;
+	}
+
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET((int)coreIndex, &cpuSet);
+
+	return pthread_setaffinity_np(*(pthread_t*)_threadhandle, sizeof(cpuSet), &cpuSet) == 0;
+
+#else
+
+	return false;
+
+#endif
+}
+
 void udtThread::InvokeUserFunction()
 {
 	if(_entryPoint != NULL)
@@ -161,3 +197,30 @@ void udtThread::InvokeUserFunction()
 		(*_entryPoint)(_userData);
 	}
 }
+
+u32 AtomicFetchAndAdd(volatile u32* target, u32 value)
+{
+#if defined(UDT_WINDOWS)
+	return (u32)InterlockedExchangeAdd((volatile LONG*)target, (LONG)value);
+#else
+	return __sync_fetch_and_add(target, value);
+#endif
+}
+
+u32 AtomicLoad(const volatile u32* source)
+{
+#if defined(UDT_WINDOWS)
+	return (u32)InterlockedCompareExchange((volatile LONG*)source, 0, 0);
+#else
+	return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void AtomicStore(volatile u32* target, u32 value)
+{
+#if defined(UDT_WINDOWS)
+	InterlockedExchange((volatile LONG*)target, (LONG)value);
+#else
+	__atomic_store_n(target, value, __ATOMIC_RELEASE);
+#endif
+}
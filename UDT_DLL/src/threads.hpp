@@ -15,6 +15,7 @@ struct udtThread
 	bool Join();
 	bool TimedJoin(u32 timeoutMs);
 	void Release();
+	bool PinToCore(u32 coreIndex); // Call after CreateAndStart.
 
 	// Do not use directly.
 	void InvokeUserFunction();
@@ -24,3 +25,10 @@ private:
 	void* _userData;
 	ThreadEntryPoint _entryPoint;
 };
+
+// Returns the value before the addition.
+extern u32 AtomicFetchAndAdd(volatile u32* target, u32 value);
+
+// The writes made before the store are visible to the thread that loads the stored value.
+extern u32 AtomicLoad(const volatile u32* source);
+extern void AtomicStore(volatile u32* target, u32 value);
@@ -153,6 +153,28 @@ void udtTimer::SetElapsedUs(u64 uElapsedUs)
 	_data->ElapsedTime = (u64)(((f32)uElapsedUs / 1000000.0f) * (f32)_data->Frequency);
 }
 
+u64 GetProfilerTicks()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	return (u64)counter.QuadPart;
+}
+
+u64 ProfilerTicksToUs(u64 ticks)
+{
+	static u64 frequency = 0;
+	if(frequency == 0)
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceFrequency(&counter);
+		frequency = (u64)counter.QuadPart;
+	}
+
+	// Split to avoid overflowing.
+	return (ticks / frequency) * 1000000ull + ((ticks % frequency) * 1000000ull) / frequency;
+}
+
 
 #else
 
@@ -289,5 +311,18 @@ void udtTimer::SetElapsedUs(u64 uElapsedUs)
 	_data->ElapsedNs = uElapsedUs * (u64)1000;
 }
 
+u64 GetProfilerTicks()
+{
+	timespec timeSpec;
+	clock_gettime(CLOCK_MONOTONIC, &timeSpec);
+
+	return ((u64)timeSpec.tv_sec * (u64)1000000000) + (u64)timeSpec.tv_nsec;
+}
+
+u64 ProfilerTicksToUs(u64 ticks)
+{
+	return ticks / (u64)1000;
+}
+
 
 #endif
@@ -32,3 +32,8 @@ private:
 
 	udtTimerImpl* _data;
 };
+
+// Much cheaper than udtTimer for timing short sections of code a very large number of times.
+// Only differences between 2 tick values are meaningful.
+extern u64 GetProfilerTicks();
+extern u64 ProfilerTicksToUs(u64 ticks);
@@ -5,12 +5,16 @@
 #include "parser_context.hpp"
 #include "path.hpp"
 #include "parser_runner.hpp"
+#include "file_stream.hpp"
 
 #include <cstdlib>
 #include <cstdio>
 #include <cctype>
 
 
+#define UDT_HASH_FILE_CHUNK_SIZE    UDT_KB(256)
+
+
 #define ITEM(Enum, Desc, Bit) Desc,
 static const char* MeansOfDeathNames[udtMeanOfDeath::Count + 1]
 {
@@ -308,7 +312,7 @@ s32 GetErrorCode(bool success, const s32* cancel)
 	return (s32)((cancel != NULL && *cancel != 0) ? udtErrorCode::OperationCanceled : udtErrorCode::OperationFailed);
 }
 
-bool RunParser(udtBaseParser& parser, udtStream& file, const s32* cancelOperation)
+bool RunParser(udtBaseParser& parser, udtStream& file, const s32* cancelOperation, udtDemoIndexWriter* indexWriter)
 {
 	udtParserRunner runner;
 	if(!runner.Init(parser, file, cancelOperation))
@@ -316,6 +320,8 @@ bool RunParser(udtBaseParser& parser, udtStream& file, const s32* cancelOperatio
 		return false;
 	}
 
+	runner.SetIndexWriter(indexWriter);
+
 	while(runner.ParseNextMessage())
 	{
 	}
@@ -565,12 +571,16 @@ bool IsRoundBasedMode(udtGameType::Id gameType)
 	return (gameTypeFlags[gameType] & (u8)udtGameTypeMask::RoundBased) != 0;
 }
 
-void PerfStatsInit(u64* perfStats)
+void PerfStatsInit(u64* perfStats, u64* plugInPerfStats)
 {
 	memset(perfStats, 0, sizeof(u64) * (size_t)udtPerfStatsField::Count);
+	if(plugInPerfStats != NULL)
+	{
+		memset(plugInPerfStats, 0, sizeof(u64) * (size_t)udtParserPlugIn::Count);
+	}
 }
 
-void PerfStatsAddCurrentThread(u64* perfStats, u64 totalDemoByteCount)
+void PerfStatsAddCurrentThread(u64* perfStats, u64 totalDemoByteCount, u64 cutCount)
 {
 	udtVMLinearAllocator::Stats allocStats;
 	udtVMLinearAllocator::GetThreadStats(allocStats);
@@ -580,6 +590,47 @@ void PerfStatsAddCurrentThread(u64* perfStats, u64 totalDemoByteCount)
 	perfStats[udtPerfStatsField::AllocatorCount] += allocStats.AllocatorCount;
 	perfStats[udtPerfStatsField::DataProcessed] += totalDemoByteCount;
 	perfStats[udtPerfStatsField::ResizeCount] += (u64)allocStats.ResizeCount;
+	perfStats[udtPerfStatsField::CutCount] += cutCount;
+}
+
+void PerfStatsAddParserProfile(u64* perfStats, u64* plugInPerfStats, udtParserContext& context)
+{
+	udtBaseParser& parser = context.Parser;
+	udtParserProfiler& profiler = parser.Profiler;
+	perfStats[udtPerfStatsField::MessageCount] += profiler.MessageCount;
+	perfStats[udtPerfStatsField::SnapshotCount] += profiler.SnapshotCount;
+	perfStats[udtPerfStatsField::CachedDemoCount] += profiler.CachedDemoCount;
+	perfStats[udtPerfStatsField::SkippedByteCount] += profiler.SkippedByteCount;
+
+	if(profiler.Enabled)
+	{
+		const u64* const ticks = profiler.StageTicks;
+		perfStats[udtPerfStatsField::FileReadDuration] += ProfilerTicksToUs(ticks[udtParserProfilerStage::FileRead]);
+		perfStats[udtPerfStatsField::MessageParseDuration] += ProfilerTicksToUs(ticks[udtParserProfilerStage::MessageParse]);
+		perfStats[udtPerfStatsField::SnapshotParseDuration] += ProfilerTicksToUs(ticks[udtParserProfilerStage::SnapshotParse]);
+		perfStats[udtPerfStatsField::EntityParseDuration] += ProfilerTicksToUs(ticks[udtParserProfilerStage::EntityParse]);
+		perfStats[udtPerfStatsField::PlugInDuration] += ProfilerTicksToUs(ticks[udtParserProfilerStage::PlugIns]);
+		perfStats[udtPerfStatsField::OutputWriteDuration] += ProfilerTicksToUs(ticks[udtParserProfilerStage::OutputWrite]);
+
+		// The parser can also hold private plug-ins that aren't part of the breakdown.
+		if(plugInPerfStats != NULL)
+		{
+			for(u32 i = 0, count = context.PlugIns.GetSize(); i < count; ++i)
+			{
+				const u32 plugInId = (u32)context.PlugIns[i].Id;
+				if(plugInId < (u32)udtParserPlugIn::Count)
+				{
+					plugInPerfStats[plugInId] += ProfilerTicksToUs(context.PlugIns[i].PlugIn->ProfilerTicks);
+				}
+			}
+		}
+	}
+
+	profiler.Clear();
+	for(u32 i = 0, count = parser.PlugIns.GetSize(); i < count; ++i)
+	{
+		parser.PlugIns[i]->ProfilerTicks = 0;
+	}
 }
 
 void PerfStatsFinalize(u64* perfStats, u32 threadCount, u64 durationUs)
@@ -595,6 +646,8 @@ void PerfStatsFinalize(u64* perfStats, u32 threadCount, u64 durationUs)
 		((1000000 * perfStats[udtPerfStatsField::DataProcessed]) / durationUs) : 0;
 	perfStats[udtPerfStatsField::MemoryEfficiency] = (perfStats[udtPerfStatsField::MemoryCommitted] > 0) ?
 		((1000 * perfStats[udtPerfStatsField::MemoryUsed]) / perfStats[udtPerfStatsField::MemoryCommitted]) : 0;
+	perfStats[udtPerfStatsField::CutThroughput] = (durationUs > 0) ?
+		((10000000 * perfStats[udtPerfStatsField::CutCount]) / durationUs) : 0;
 }
 
 void WriteStringToApiStruct(u32& offset, const udtString& string)
@@ -611,6 +664,100 @@ void WriteNullStringToApiStruct(u32& offset)
 	offsetAndLength[1] = 0;
 }
 
+u32 AppendStringBuffer(udtVMLinearAllocator& dest, const u8* source, u32 byteCount)
+{
+	if(byteCount == 0)
+	{
+		return (u32)dest.GetCurrentByteCount();
+	}
+
+	const uptr offset = dest.Allocate((uptr)byteCount);
+	memcpy(dest.GetAddressAt(offset), source, (size_t)byteCount);
+
+	return (u32)offset;
+}
+
+void RebaseApiStringOffset(u32& offset, u32 baseOffset)
+{
+	if(offset != UDT_U32_MAX)
+	{
+		offset += baseOffset;
+	}
+}
+
+// MurmurHash64A.
+u64 HashBytes(const void* data, uptr byteCount, u64 seed)
+{
+	const u64 m = 0xC6A4A7935BD1E995ULL;
+	const u32 r = 47;
+
+	u64 h = seed ^ ((u64)byteCount * m);
+
+	const u8* bytes = (const u8*)data;
+	const u8* const wordsEnd = bytes + (byteCount & ~(uptr)7);
+	while(bytes != wordsEnd)
+	{
+		u64 k;
+		memcpy(&k, bytes, 8);
+		bytes += 8;
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+
+	const u32 remaining = (u32)(byteCount & 7);
+	for(u32 i = remaining; i > 0; --i)
+	{
+		h ^= (u64)bytes[i - 1] << (8 * (i - 1));
+	}
+	if(remaining > 0)
+	{
+		h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+
+	return h;
+}
+
+bool HashFile(u64& hash, u64& byteCount, const char* filePath, udtVMLinearAllocator& tempAllocator)
+{
+	udtFileStream file;
+	if(!file.Open(filePath, udtFileOpenMode::Read))
+	{
+		return false;
+	}
+
+	udtVMScopedStackAllocator allocatorScope(tempAllocator);
+	u8* const chunk = tempAllocator.AllocateAndGetAddress((uptr)UDT_HASH_FILE_CHUNK_SIZE);
+
+	const u64 fileSize = file.Length();
+	u64 result = 0;
+	u64 remaining = fileSize;
+	while(remaining > 0)
+	{
+		const u32 chunkSize = (u32)udt_min(remaining, (u64)UDT_HASH_FILE_CHUNK_SIZE);
+		if(file.Read(chunk, chunkSize, 1) != 1)
+		{
+			return false;
+		}
+
+		result = HashBytes(chunk, (uptr)chunkSize, result);
+		remaining -= (u64)chunkSize;
+	}
+
+	hash = result;
+	byteCount = fileSize;
+
+	return true;
+}
+
 void PlayerStateToEntityState(idEntityStateBase& es, s32& lastEventSequence, const idPlayerStateBase& ps, bool extrapolate, s32 serverTimeMs, udtProtocol::Id protocol)
 {
 	s32 healthStatIdx = GetIdNumber(udtMagicNumberType::LifeStatsIndex, udtLifeStatsIndex::Health, protocol, udtMod::None);
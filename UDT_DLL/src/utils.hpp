@@ -9,6 +9,9 @@
 #include "look_up_tables.hpp"
 
 
+struct udtDemoIndexWriter;
+
+
 // On Windows, MAX_PATH is 260.
 #define UDT_MAX_PATH_LENGTH    320
 
@@ -74,7 +77,7 @@ extern udtString   FormatBytes(udtVMLinearAllocator& allocator, u64 byteCount);
 extern bool        StringParseSeconds(s32& duration, const char* buffer); // Format is minutes:seconds or seconds.
 extern bool        CopyFileRange(udtStream& input, udtStream& output, udtVMLinearAllocator& allocator, u32 startOffset, u32 endOffset);
 extern s32         GetErrorCode(bool success, const s32* cancel);
-extern bool        RunParser(udtBaseParser& parser, udtStream& file, const s32* cancelOperation);
+extern bool        RunParser(udtBaseParser& parser, udtStream& file, const s32* cancelOperation, udtDemoIndexWriter* indexWriter = NULL);
 extern void        LogLinearAllocatorDebugStats(udtContext& context, udtVMLinearAllocator& allocator);
 extern bool        StringMatchesCutByChatRule(const udtString& string, const udtChatPatternRule& rule, udtVMLinearAllocator& allocator, udtProtocol::Id procotol);
 extern bool        IsObituaryEvent(udtObituaryEvent& info, const idEntityStateBase& entity, udtProtocol::Id protocol);
@@ -82,11 +85,16 @@ extern const char* GetUDTModName(s32 mod); // Where mod is of type udtMeanOfDeat
 extern bool        GetClanAndPlayerName(udtString& clan, udtString& player, bool& hasClan, udtVMLinearAllocator& allocator, udtProtocol::Id protocol, const char* configString);
 extern bool        IsTeamMode(udtGameType::Id gameType);
 extern bool        IsRoundBasedMode(udtGameType::Id gameType);
-extern void        PerfStatsInit(u64* perfStats);
-extern void        PerfStatsAddCurrentThread(u64* perfStats, u64 totalDemoByteCount);
+extern void        PerfStatsInit(u64* perfStats, u64* plugInPerfStats); // plugInPerfStats can be NULL.
+extern void        PerfStatsAddCurrentThread(u64* perfStats, u64 totalDemoByteCount, u64 cutCount = 0);
+extern void        PerfStatsAddParserProfile(u64* perfStats, u64* plugInPerfStats, udtParserContext& context); // Also clears the context's profiling data.
 extern void        PerfStatsFinalize(u64* perfStats, u32 threadCount, u64 durationMs);
 extern void        WriteStringToApiStruct(u32& offset, const udtString& string);
 extern void        WriteNullStringToApiStruct(u32& offset);
+extern u32         AppendStringBuffer(udtVMLinearAllocator& dest, const u8* source, u32 byteCount); // Returns the value to add to the source's string offsets.
+extern void        RebaseApiStringOffset(u32& offset, u32 baseOffset); // Leaves null strings untouched.
+extern u64         HashBytes(const void* data, uptr byteCount, u64 seed); // Not cryptographic. Pass the previous result as the seed to hash in chunks.
+extern bool        HashFile(u64& hash, u64& byteCount, const char* filePath, udtVMLinearAllocator& tempAllocator); // HashBytes over the whole file.
 extern void        PlayerStateToEntityState(idEntityStateBase& es, s32& lastEventSequence, const idPlayerStateBase& ps, bool extrapolate, s32 serverTimeMs, udtProtocol::Id protocol);
 
 // Gets the integer value of a config string variable.
@@ -8,6 +8,8 @@
 #include "scoped_stack_allocator.hpp"
 #include "path.hpp"
 #include "thread_local_allocators.hpp"
+#include "threads.hpp"
+#include "system.hpp"
 
 #include <stdlib.h>
 #include <math.h>
@@ -20,6 +22,26 @@
 // True constants.
 #define  LG_BEAM_LENGTH  768
 
+// How far ahead of a snapshot the fix-ups look: the longest item spawn time.
+// A parsed snapshot doesn't change anymore once the parser is that far ahead of the one before it.
+#define  MAX_FIX_LOOK_AHEAD_MS  (30 * 1000)
+
+// The snapshots are only made available during the load when we can reserve enough address space
+// for their data to never get relocated, see Demo::Init.
+#if defined(UDT_X64)
+#	define  PUBLISH_SNAPSHOTS_WHILE_LOADING  1
+#else
+#	define  PUBLISH_SNAPSHOTS_WHILE_LOADING  0
+#endif
+
+// Reading a final snapshot decodes everything since the last keyframe.
+#define  SNAPSHOT_KEYFRAME_INTERVAL  32
+
+// Quantization of the final snapshots, in steps per unit.
+// An 8th of a unit and a 65536th of a turn are well below what can be seen on the map.
+#define  POSITION_QUANTIZATION_SCALE  8.0f
+#define  ANGLE_QUANTIZATION_SCALE     (65536.0f / (2.0f * UDT_PI))
+
 
 /*
 Static items can only spawn at a fixed location and can't be dropped by a player.
@@ -286,11 +308,406 @@ static f32 ComputePlayerAngle(const idEntityStateBase& es, s32 serverTimeMs)
 	return (angles[1] / 180.0f) * UDT_PI;
 }
 
+/*
+Final snapshot encoding:
+- u8 SnapshotField bits
+- the static item bits if they changed: varint byte count, bytes
+- the core fields that changed
+- varint player count, then for each player:
+  u8 client number, u8 PlayerField bits, the fields that changed, position, angle,
+  LG end point relative to the position if firing the LG
+- varint dynamic item count, then for each item:
+  u8 DynamicItemField bits, u8 id and varint entity number if not the same entity as the previous item at that index,
+  position, angle and u8 sprite offset if they changed
+- varint rail beam count, then for each beam:
+  u8 non-zero if the same as the previous beam at that index, positions and u8 team if not, u8 alpha
+Positions and angles are quantized and written as varint zigzag deltas.
+They're relative to the previous snapshot, where players are matched by client number.
+Keyframes are relative to empty data instead.
+*/
+
+struct SnapshotField
+{
+	enum Id
+	{
+		StaticItems,
+		FollowedName,
+		FollowedHealth,
+		FollowedArmor,
+		FollowedAmmo,
+		FollowedTeam,
+		FollowedWeapon,
+		Count
+	};
+};
+
+struct PlayerField
+{
+	enum Id
+	{
+		Name,
+		Team,
+		WeaponId,
+		Flags,
+		Count
+	};
+};
+
+struct DynamicItemField
+{
+	enum Id
+	{
+		SameEntity,
+		Angle,
+		SpriteOffset,
+		Count
+	};
+};
+
+// Upper bounds, with 5 bytes per varint.
+static const u32 MaxEncodedPlayerByteCount = 2 + 5 + 3 + 3 * 5 + 5 + 3 * 5;
+static const u32 MaxEncodedDynamicItemByteCount = 2 + 5 + 3 * 5 + 5 + 1;
+static const u32 MaxEncodedRailBeamByteCount = 1 + 3 * 5 + 3 * 5 + 1 + 1;
+static const u32 MaxEncodedSnapshotByteCount =
+	1 + 5 + MAX_STATIC_ITEMS / 8 + 5 + 3 * 5 + 2 +
+	5 + 64 * MaxEncodedPlayerByteCount +
+	5 + MAX_DYN_ITEMS * MaxEncodedDynamicItemByteCount +
+	5 + MAX_RAIL_BEAMS * MaxEncodedRailBeamByteCount;
+
+static s32 Quantize(f32 value, f32 scale)
+{
+	// Small enough for the dequantized values to quantize back to the same numbers.
+	const f32 maxValue = (f32)(1 << 20);
+
+	return (s32)floorf(udt_clamp(value * scale, -maxValue, maxValue) + 0.5f);
+}
+
+static f32 Dequantize(s32 value, f32 scale)
+{
+	return (f32)value / scale;
+}
+
+static u8* WriteVarInt(u8* data, u32 value)
+{
+	while(value >= 0x80)
+	{
+		*data++ = (u8)(value | 0x80);
+		value >>= 7;
+	}
+	*data++ = (u8)value;
+
+	return data;
+}
+
+static u32 ReadVarInt(const u8*& data)
+{
+	u32 value = 0;
+	for(u32 shift = 0;; shift += 7)
+	{
+		const u8 byte = *data++;
+		value |= (u32)(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0)
+		{
+			break;
+		}
+	}
+
+	return value;
+}
+
+static u8* WriteDelta(u8* data, s32 value, s32 reference)
+{
+	const u32 delta = (u32)value - (u32)reference;
+
+	return WriteVarInt(data, (delta << 1) ^ (0 - (delta >> 31)));
+}
+
+static s32 ReadDelta(const u8*& data, s32 reference)
+{
+	const u32 zigZag = ReadVarInt(data);
+
+	return (s32)((u32)reference + ((zigZag >> 1) ^ (0 - (zigZag & 1))));
+}
+
+static u8* WritePosition(u8* data, const f32* position, const f32* reference)
+{
+	for(u32 i = 0; i < 3; ++i)
+	{
+		data = WriteDelta(data, Quantize(position[i], POSITION_QUANTIZATION_SCALE), Quantize(reference[i], POSITION_QUANTIZATION_SCALE));
+	}
+
+	return data;
+}
+
+static void ReadPosition(f32* position, const u8*& data, const f32* reference)
+{
+	for(u32 i = 0; i < 3; ++i)
+	{
+		position[i] = Dequantize(ReadDelta(data, Quantize(reference[i], POSITION_QUANTIZATION_SCALE)), POSITION_QUANTIZATION_SCALE);
+	}
+}
+
+static u8* WriteAngle(u8* data, f32 angle, f32 reference)
+{
+	return WriteDelta(data, Quantize(angle, ANGLE_QUANTIZATION_SCALE), Quantize(reference, ANGLE_QUANTIZATION_SCALE));
+}
+
+static f32 ReadAngle(const u8*& data, f32 reference)
+{
+	return Dequantize(ReadDelta(data, Quantize(reference, ANGLE_QUANTIZATION_SCALE)), ANGLE_QUANTIZATION_SCALE);
+}
+
+static bool IsSamePosition(const f32* a, const f32* b)
+{
+	return
+		Quantize(a[0], POSITION_QUANTIZATION_SCALE) == Quantize(b[0], POSITION_QUANTIZATION_SCALE) &&
+		Quantize(a[1], POSITION_QUANTIZATION_SCALE) == Quantize(b[1], POSITION_QUANTIZATION_SCALE) &&
+		Quantize(a[2], POSITION_QUANTIZATION_SCALE) == Quantize(b[2], POSITION_QUANTIZATION_SCALE);
+}
+
+static bool HasLGEndPoint(const Player& player)
+{
+	return player.WeaponId == (u8)udtWeapon::LightningGun && IsBitSet(&player.Flags, PlayerFlags::Firing);
+}
+
+static void GetPlayerIndices(u8* playerIndices, const Snapshot* snapshot)
+{
+	// The first player with a given client number is the one matched.
+	memset(playerIndices, 0xFF, 64);
+	if(snapshot == nullptr)
+	{
+		return;
+	}
+
+	for(u32 p = snapshot->PlayerCount; p > 0; --p)
+	{
+		playerIndices[snapshot->Players[p - 1].IdClientNumber] = (u8)(p - 1);
+	}
+}
+
 static void MessageCallback(s32 logLevel, const char* message)
 {
 	Log::LogMessage((Log::Level::Id)logLevel, message);
 }
 
+struct HeatMapSample
+{
+	u16 X;
+	u16 Y;
+	u32 ItemIndex; // Only used before the samples get sorted by player.
+};
+
+struct HeatMapJobData
+{
+	const HeatMapSample* Samples;
+	const u32* FirstSampleIndices; // One more than there are items.
+	u8* Images;
+	const u8 (*ColorRamp)[3];
+	u32 Width;
+	u32 Height;
+	u32 Radius;
+	u32 ItemCount;
+	volatile u32 NextItemIndex;
+	volatile u32 FinishedItemCount;
+	bool SquaredRamp;
+};
+
+#define  HEAT_MAP_RAMP_COLOR_COUNT  256
+
+static const u32 HeatMapBlurKernel[7] = { 1, 6, 15, 20, 15, 6, 1 };
+
+static void BlurRGBAPixelHorizontally(u16* output, const u8* input, u32 x, u32 width)
+{
+	for(u32 c = 0; c < 4; ++c)
+	{
+		u32 sum = 0;
+		for(s32 k = 0; k < 7; ++k)
+		{
+			const u32 sx = (u32)udt_clamp<s32>((s32)x + k - 3, 0, (s32)width - 1);
+			sum += HeatMapBlurKernel[k] * (u32)input[4 * sx + c];
+		}
+		output[4 * x + c] = (u16)sum;
+	}
+}
+
+// A 7-tap binomial kernel, equivalent to 3 passes of the 3x3 Gaussian kernel, applied in 2 separable passes.
+// The inner loops are branch-free so that the compiler can vectorize them.
+static void BlurRGBAImage(u8* output, const u8* input, u16* temp, u32 width, u32 height)
+{
+	const u32 stride = 4 * width;
+	const u32 border = udt_min<u32>(3, width);
+	for(u32 y = 0; y < height; ++y)
+	{
+		const u8* const in = input + y * stride;
+		u16* const out = temp + y * stride;
+		for(u32 x = 0; x < border; ++x)
+		{
+			BlurRGBAPixelHorizontally(out, in, x, width);
+		}
+
+		if(width > 6)
+		{
+			for(u32 i = 12, iEnd = stride - 12; i < iEnd; ++i)
+			{
+				out[i] = (u16)(
+					(u32)in[i - 12] + 6 * (u32)in[i - 8] + 15 * (u32)in[i - 4] + 20 * (u32)in[i] +
+					15 * (u32)in[i + 4] + 6 * (u32)in[i + 8] + (u32)in[i + 12]);
+			}
+		}
+
+		for(u32 x = udt_max(border, width - 3); x < width; ++x)
+		{
+			BlurRGBAPixelHorizontally(out, in, x, width);
+		}
+	}
+
+	for(u32 y = 0; y < height; ++y)
+	{
+		const u16* rows[7];
+		for(s32 k = 0; k < 7; ++k)
+		{
+			rows[k] = temp + (u32)udt_clamp<s32>((s32)y + k - 3, 0, (s32)height - 1) * stride;
+		}
+
+		u8* const out = output + y * stride;
+		for(u32 i = 0; i < stride; ++i)
+		{
+			const u32 sum =
+				(u32)rows[0][i] + 6 * (u32)rows[1][i] + 15 * (u32)rows[2][i] + 20 * (u32)rows[3][i] +
+				15 * (u32)rows[4][i] + 6 * (u32)rows[5][i] + (u32)rows[6][i];
+			out[i] = (u8)((sum + 2048) >> 12);
+		}
+	}
+
+	// The opacity isn't smoothed.
+	const u32 pixelCount = width * height;
+	for(u32 i = 0; i < pixelCount; ++i)
+	{
+		output[4 * i + 3] = input[4 * i + 3];
+	}
+}
+
+static void GenerateHeatMapImage(u8* image, u32* histogram, u8* rampImage, u16* blurTemp, const HeatMapJobData& job, u32 itemIndex)
+{
+	const u32 width = job.Width;
+	const u32 height = job.Height;
+	const u32 pixelCount = width * height;
+	const u32 r = job.Radius;
+	const u32 maxSqDist = 2 * r * r;
+	memset(histogram, 0, pixelCount * sizeof(u32));
+	for(u32 s = job.FirstSampleIndices[itemIndex], sEnd = job.FirstSampleIndices[itemIndex + 1]; s < sEnd; ++s)
+	{
+		const u32 xc = (u32)job.Samples[s].X;
+		const u32 yc = (u32)job.Samples[s].Y;
+		const u32 ymin = (u32)udt_max((s32)(yc - r), 0);
+		const u32 ymax = udt_min(yc + r, height);
+		const u32 xmin = (u32)udt_max((s32)(xc - r), 0);
+		const u32 xmax = udt_min(xc + r, width);
+		for(u32 y = ymin; y < ymax; ++y)
+		{
+			const u32 yd = yc - y;
+			for(u32 x = xmin; x < xmax; ++x)
+			{
+				const u32 xd = xc - x;
+				const u32 dist = xd*xd + yd*yd;
+				histogram[y*width + (width - 1 - x)] += maxSqDist - dist;
+			}
+		}
+	}
+
+	u32 maxValue = 0;
+	for(u32 i = 0; i < pixelCount; ++i)
+	{
+		maxValue = udt_max(maxValue, histogram[i]);
+	}
+
+	const u32 rampColorCount = HEAT_MAP_RAMP_COLOR_COUNT;
+	const u32 divider = (maxValue + rampColorCount - 1) / rampColorCount;
+	if(divider == 0)
+	{
+		memset(image, 0, (size_t)pixelCount * 4);
+		return;
+	}
+
+	const u8 (*colorRamp)[3] = job.ColorRamp;
+	if(job.SquaredRamp)
+	{
+		for(u32 i = 0; i < pixelCount; ++i)
+		{
+			const u32 col2 = rampColorCount - 1 - (histogram[i] / divider);
+			const u32 col = rampColorCount - 1 - ((col2 * col2) / rampColorCount);
+			const u8 op = (u8)((col * 256) / rampColorCount);
+			rampImage[4 * i + 0] = colorRamp[col][0];
+			rampImage[4 * i + 1] = colorRamp[col][1];
+			rampImage[4 * i + 2] = colorRamp[col][2];
+			rampImage[4 * i + 3] = op;
+		}
+	}
+	else
+	{
+		for(u32 i = 0; i < pixelCount; ++i)
+		{
+			const u32 col = histogram[i] / divider;
+			const u8 op = (u8)((col * 256) / rampColorCount);
+			rampImage[4 * i + 0] = colorRamp[col][0];
+			rampImage[4 * i + 1] = colorRamp[col][1];
+			rampImage[4 * i + 2] = colorRamp[col][2];
+			rampImage[4 * i + 3] = op;
+		}
+	}
+
+	// We smooth the heat map to make it look less blocky.
+	BlurRGBAImage(image, rampImage, blurTemp, width, height);
+}
+
+// Returns false if the temporary buffers couldn't be allocated.
+static bool ProcessHeatMapJobItems(HeatMapJobData& job, Demo::ProgressCallback progressCallback, void* userData)
+{
+	const u32 pixelCount = job.Width * job.Height;
+	const size_t byteCount = (size_t)pixelCount * (sizeof(u32) + 4 + 4 * sizeof(u16));
+	u8* const temp = (u8*)malloc(byteCount);
+	if(temp == nullptr)
+	{
+		return false;
+	}
+
+	u32* const histogram = (u32*)temp;
+	u16* const blurTemp = (u16*)(histogram + pixelCount);
+	u8* const rampImage = (u8*)(blurTemp + 4 * pixelCount);
+	for(;;)
+	{
+		const u32 itemIndex = AtomicFetchAndAdd(&job.NextItemIndex, 1);
+		if(itemIndex >= job.ItemCount)
+		{
+			break;
+		}
+
+		u8* const image = job.Images + (size_t)itemIndex * (size_t)pixelCount * 4;
+		GenerateHeatMapImage(image, histogram, rampImage, blurTemp, job, itemIndex);
+		const u32 finishedCount = AtomicFetchAndAdd(&job.FinishedItemCount, 1) + 1;
+		if(progressCallback != nullptr)
+		{
+			(*progressCallback)((f32)finishedCount / (f32)job.ItemCount, userData);
+		}
+	}
+
+	free(temp);
+
+	return true;
+}
+
+struct HeatMapThreadData
+{
+	HeatMapJobData* Job;
+	bool Success;
+};
+
+static void HeatMapThreadEntryPoint(void* userData)
+{
+	HeatMapThreadData& data = *(HeatMapThreadData*)userData;
+	data.Success = ProcessHeatMapJobItems(*data.Job, nullptr, nullptr);
+}
+
 idProtocolNumbers::idProtocolNumbers()
 {
 	memset(this, 0, sizeof(idProtocolNumbers));
@@ -335,25 +752,22 @@ void idProtocolNumbers::GetNumbers(u32 protocol, u32 mod)
 	}
 }
 
-static const u32 LoadStepCount = 4;
+static const u32 LoadStepCount = 1;
 static const f32 LoadSteps[LoadStepCount + 2] =
 {
 	0.0f,
-	0.03f,
-	0.07f,
-	0.42f,
-	0.52f,
+	0.2f,
 	1.0f
 };
 
 Demo::Demo()
 {
-	_snapshots[0].SetName("Demo::SnapshotOffsetArray0");
-	_snapshots[1].SetName("Demo::SnapshotOffsetArray1");
-	_snapshotAllocators[0].SetAlignment(1);
-	_snapshotAllocators[1].SetAlignment(1);
-	_snapshotAllocators[0].SetName("Demo::Persist0");
-	_snapshotAllocators[1].SetName("Demo::Persist1");
+	_snapshots[SnapshotBuffer::Parsed].SetName("Demo::ParsedSnapshotOffsetArray");
+	_snapshots[SnapshotBuffer::Final].SetName("Demo::FinalSnapshotOffsetArray");
+	_snapshotAllocators[SnapshotBuffer::Parsed].SetAlignment(1);
+	_snapshotAllocators[SnapshotBuffer::Final].SetAlignment(1);
+	_snapshotAllocators[SnapshotBuffer::Parsed].SetName("Demo::ParsedPersist");
+	_snapshotAllocators[SnapshotBuffer::Final].SetName("Demo::FinalPersist");
 }
 
 Demo::~Demo()
@@ -361,9 +775,10 @@ Demo::~Demo()
 	udtCuDestroyContext(_context);
 	free(_messageData);
 	free(_snapshot);
+	free(_fixSnapshots);
 }
 
-bool Demo::Init(ProgressCallback progressCallback, void* userData)
+bool Demo::Init(ProgressCallback progressCallback, PlaybackReadyCallback playbackReadyCallback, void* userData)
 {
 	assert(progressCallback != nullptr);
 	assert(userData != nullptr);
@@ -392,7 +807,30 @@ bool Demo::Init(ProgressCallback progressCallback, void* userData)
 	}
 	_snapshot = snapshot;
 
+	Snapshot* const fixSnapshots = (Snapshot*)malloc(sizeof(Snapshot) * 4);
+	if(fixSnapshots == nullptr)
+	{
+		Platform_PrintError("Failed to allocate %d bytes for snapshot data", (int)sizeof(Snapshot) * 4);
+		return false;
+	}
+	_fixSnapshots = fixSnapshots;
+
+#if PUBLISH_SNAPSHOTS_WHILE_LOADING
+	if(playbackReadyCallback != nullptr)
+	{
+		// Another thread reads the final snapshots and strings while more get written, so they can't be relocated.
+		// Their offsets are 32-bit, so reserving 4 GB covers anything that can be addressed.
+		const uptr maxByteCount = UDT_GB((uptr)4);
+		const uptr minSnapshotByteCount = 4; // The fields and the 3 counts.
+		_snapshotAllocators[SnapshotBuffer::Final].Init(maxByteCount);
+		_snapshots[SnapshotBuffer::Final].Init((maxByteCount / minSnapshotByteCount) * (uptr)sizeof(SnapshotDesc));
+		_stringAllocator.Init(maxByteCount);
+		_staticItems.Init((uptr)sizeof(StaticItem) * (uptr)MAX_STATIC_ITEMS);
+	}
+#endif
+
 	_progressCallback = progressCallback;
+	_playbackReadyCallback = playbackReadyCallback;
 	_userData = userData;
 
 	udtCuSetMessageCallback(context, &MessageCallback);
@@ -408,16 +846,21 @@ void Demo::Load(const char* filePath, bool keepOnlyFirstMatch, bool removeTimeOu
 	_removeTimeOuts = removeTimeOuts;
 	strcpy(_filePath, filePath);
 
-	_readIndex = 0;
-	_writeIndex = 0;
-	for(u32 i = 0; i < 2; ++i)
+	AtomicStore(&_publishedSnapshotCount, 0);
+	_playbackReady = false;
+	for(u32 i = 0; i < (u32)SnapshotBuffer::Count; ++i)
 	{
 		_snapshots[i].Clear();
 		_snapshotAllocators[i].Clear();
 	}
 	_stringAllocator.Clear();
+	for(u32 i = 0; i < MAX_STATIC_ITEMS; ++i)
+	{
+		_staticItemLastSnapUp[i] = UDT_U32_MAX;
+	}
+	_fixedSnapshotCount = 0;
+	_firstParsedSnapshotIndex = 0;
 
-	const u32 previousProtocol = _protocol;
 	const u32 protocol = udtGetProtocolByFilePath(filePath);
 	_protocol = protocol;
 
@@ -427,50 +870,24 @@ void Demo::Load(const char* filePath, bool keepOnlyFirstMatch, bool removeTimeOu
 		_max[i] = -99999.0f;
 	}
 
-	const u32 previousMod = _mod;
-	if(!AnalyzeDemo(filePath, keepOnlyFirstMatch) && 
-	   protocol <= udtProtocol::Dm68)
-	{
-		ParseDemo(filePath, &Demo::ProcessMessage_Mod);
-	}
+	// The match range and time-outs must be known before the snapshots get filtered and timed.
+	// Everything else is read in a single pass: the mod and static items get resolved as they show up
+	// and the snapshots get fixed up as soon as the parser is far enough ahead of them.
+	_readModFromGameName = !AnalyzeDemo(filePath, keepOnlyFirstMatch) && protocol <= udtProtocol::Dm68;
 	_ospEncryptedPlayers = false;
-	if(_mod == (u32)udtMod::OSP)
-	{
-		ParseDemo(filePath, &Demo::ProcessMessage_OSPEncryption);
-	}
-	NextStep();
-	
-	const u32 mod = _mod;
-	if(protocol != previousProtocol || mod != previousMod)
-	{
-		_protocolNumbers.GetNumbers(protocol, mod);
-	}
-
-	ParseDemo(filePath, &Demo::ProcessMessage_StaticItems);
 	NextStep();
 
 	_timeOutIndex = 0;
-	ParseDemo(filePath, &Demo::ProcessMessage_FinalPass);
-	NextStep();
+	ParseDemo(filePath);
+	FixSnapshots(true);
 
-	if(_snapshots[_readIndex].GetSize() == 0)
+	const u32 snapshotCount = _snapshots[SnapshotBuffer::Final].GetSize();
+	if(snapshotCount == 0)
 	{
 		return;
 	}
 
-	FixStaticItems();
-	NextStep();
-
-	FixDynamicItemsAndPlayers();
-
-	// Doesn't count as a step (too fast).
-	FixLGEndPoints();
-
-	const auto& snapshots = _snapshots[_readIndex];
-	const u32 lastIndex = snapshots.GetSize() - 1;
-	_firstSnapshotTimeMs = snapshots[0].DisplayTimeMs;
-	_lastSnapshotTimeMs = snapshots[lastIndex].DisplayTimeMs;
-
+	AtomicStore(&_publishedSnapshotCount, snapshotCount);
 	(*_progressCallback)(1.0f, _userData);
 
 	udtVMLinearAllocator& tempAlloc = udtThreadLocalAllocators::GetTempAllocator();
@@ -481,52 +898,136 @@ void Demo::Load(const char* filePath, bool keepOnlyFirstMatch, bool removeTimeOu
 	Log::LogInfo("Demo %s loaded in %s", fileName.GetPtr(), loadTime.GetPtr());
 }
 
-void Demo::GenerateHeatMap(u32* histogram, u32 width, u32 height, const f32* min, const f32* max, u32 clientNumber)
+void Demo::GenerateHeatMaps(u8* images, u32 width, u32 height, const f32* min, const f32* max, bool squaredRamp, u32 maxThreadCount)
 {
-	memset(histogram, 0, width * height * sizeof(u32));
+	// Images are stored in client number order.
+	u32 itemIndices[64];
+	u32 itemCount = 0;
+	for(u32 p = 0; p < 64; ++p)
+	{
+		itemIndices[p] = _heatMapPlayers[p].Present ? itemCount++ : UDT_U32_MAX;
+	}
 
-	const f32 playerRadius = 32.0f; // Quake units
-	const f32 scale = max[0] - min[0];
-	const u32 r = (u32)((playerRadius / scale) * (f32)width);
-	const u32 maxSqDist = 2 * r * r;
+	if(itemCount == 0)
+	{
+		return;
+	}
 
-	const auto& snapshots = _snapshots[_readIndex];
-	const u32 snapshotCount = snapshots.GetSize();
+	// A single pass over the snapshots gathers the positions of all players.
+	// Each snapshot is decoded relative to the previous one, the fix-up snapshots aren't needed anymore.
+	udtVMArray<HeatMapSample> samples("Demo::HeatMapSamplesArray");
+	u32 firstSampleIndices[65];
+	memset(firstSampleIndices, 0, sizeof(firstSampleIndices));
+	Snapshot* const snaps[2] = { _snapshot, _fixSnapshots };
+	u8 staticItemBits[2][ItemMaskByteCount];
+	const u32 snapshotCount = GetSnapshotCount();
 	for(u32 s = 0; s < snapshotCount; ++s)
 	{
-		Snapshot& snap = *_snapshot;
-		if(!GetSnapshotData(snap, s))
-		{
-			continue;
-		}
+		const u32 snapIdx = s & 1;
+		const bool keyframe = (s % SNAPSHOT_KEYFRAME_INTERVAL) == 0;
+		Snapshot& snap = *snaps[snapIdx];
+		DecodeSnapshot(snap, staticItemBits[snapIdx], keyframe ? nullptr : snaps[snapIdx ^ 1], staticItemBits[snapIdx ^ 1], s);
 
 		for(u32 p = 0; p < snap.PlayerCount; ++p)
 		{
 			const Player& player = snap.Players[p];
-			if((u32)player.IdClientNumber == clientNumber &&
-			   !IsBitSet(&player.Flags, PlayerFlags::Dead))
+			const u32 itemIndex = player.IdClientNumber < 64 ? itemIndices[player.IdClientNumber] : UDT_U32_MAX;
+			if(itemIndex == UDT_U32_MAX ||
+			   IsBitSet(&player.Flags, PlayerFlags::Dead))
 			{
-				const f32 xcf = ((max[0] - player.Position[0]) / (max[0] - min[0])) * (f32)width;
-				const f32 ycf = ((max[1] - player.Position[1]) / (max[1] - min[1])) * (f32)height;
-				const u32 xc = udt_clamp<u32>((u32)xcf, 0, width - 1);
-				const u32 yc = udt_clamp<u32>((u32)ycf, 0, height - 1);
-				const u32 ymin = (u32)udt_max((s32)(yc - r), 0);
-				const u32 ymax = udt_min(yc + r, height);
-				for(u32 y = ymin; y < ymax; ++y)
-				{
-					const u32 xmin = (u32)udt_max((s32)(xc - r), 0);
-					const u32 xmax = udt_min(xc + r, width);
-					const u32 yd = yc - y;
-					for(u32 x = xmin; x < xmax; ++x)
-					{
-						const u32 xd = xc - x;
-						const u32 dist = xd*xd + yd*yd;
-						histogram[y*width + (width - 1 - x)] += maxSqDist - dist;
-					}
-				}
-				break;
+				continue;
 			}
+
+			const f32 xcf = ((max[0] - player.Position[0]) / (max[0] - min[0])) * (f32)width;
+			const f32 ycf = ((max[1] - player.Position[1]) / (max[1] - min[1])) * (f32)height;
+			HeatMapSample sample;
+			sample.X = (u16)udt_clamp<u32>((u32)xcf, 0, width - 1);
+			sample.Y = (u16)udt_clamp<u32>((u32)ycf, 0, height - 1);
+			sample.ItemIndex = itemIndex;
+			samples.Add(sample);
+			++firstSampleIndices[itemIndex + 1];
+		}
+	}
+
+	// Counting sort by player so that each image only reads its own samples.
+	for(u32 i = 0; i < itemCount; ++i)
+	{
+		firstSampleIndices[i + 1] += firstSampleIndices[i];
+	}
+
+	udtVMArray<HeatMapSample> sortedSamples("Demo::HeatMapSortedSamplesArray");
+	sortedSamples.Resize(samples.GetSize());
+	u32 nextSampleIndices[64];
+	memcpy(nextSampleIndices, firstSampleIndices, sizeof(nextSampleIndices));
+	for(u32 i = 0, count = samples.GetSize(); i < count; ++i)
+	{
+		sortedSamples[nextSampleIndices[samples[i].ItemIndex]++] = samples[i];
+	}
+
+	const u32 rampColorCount = HEAT_MAP_RAMP_COLOR_COUNT;
+	const u32 baseColorCount = 5;
+	const u8 colors[baseColorCount][3] = { { 0, 0, 0 }, { 0, 255, 255 }, { 0, 255, 0 }, { 255, 255, 0 }, { 255, 0, 0 } };
+	u8 colorRamp[rampColorCount][3];
+	const u32 div = rampColorCount / (baseColorCount - 1);
+	for(u32 i = 0; i < rampColorCount; ++i)
+	{
+		const u32 c0 = i / div;
+		const u32 c1 = c0 + 1;
+		const f32 t = (f32)(i % div) / (f32)div;
+		for(u32 c = 0; c < 3; ++c)
+		{
+			colorRamp[i][c] = (u8)((f32)colors[c0][c] * (1.0f - t) + (f32)colors[c1][c] * t);
+		}
+	}
+
+	const f32 playerRadius = 32.0f; // Quake units
+	const f32 scale = max[0] - min[0];
+
+	HeatMapJobData job;
+	job.Samples = sortedSamples.GetStartAddress();
+	job.FirstSampleIndices = firstSampleIndices;
+	job.Images = images;
+	job.ColorRamp = colorRamp;
+	job.Width = width;
+	job.Height = height;
+	job.Radius = (u32)((playerRadius / scale) * (f32)width);
+	job.ItemCount = itemCount;
+	job.NextItemIndex = 0;
+	job.FinishedItemCount = 0;
+	job.SquaredRamp = squaredRamp;
+
+	// This thread processes images too.
+	u32 coreCount = 1;
+	GetProcessorCoreCount(coreCount);
+	if(maxThreadCount == 0)
+	{
+		maxThreadCount = coreCount;
+	}
+	const u32 extraThreadCount = udt_min(udt_min(maxThreadCount, coreCount), itemCount) - 1;
+	udtThread threads[MaxHeatMapThreadCount];
+	HeatMapThreadData threadData[MaxHeatMapThreadCount];
+	u32 startedThreadCount = 0;
+	for(u32 i = 0; i < udt_min<u32>(extraThreadCount, MaxHeatMapThreadCount); ++i)
+	{
+		threadData[i].Job = &job;
+		threadData[i].Success = false;
+		if(!threads[i].CreateAndStart(&HeatMapThreadEntryPoint, &threadData[i]))
+		{
+			break;
 		}
+		++startedThreadCount;
+	}
+
+	bool success = ProcessHeatMapJobItems(job, _progressCallback, _userData);
+	for(u32 i = 0; i < startedThreadCount; ++i)
+	{
+		threads[i].Join();
+		success = success && threadData[i].Success;
+	}
+
+	if(!success)
+	{
+		Platform_FatalError("Failed to allocate the temporary buffers for heat map generation");
 	}
 }
 
@@ -551,22 +1052,52 @@ const char* Demo::GetStringSafe(u32 offset, const char* replacement) const
 	return s;
 }
 
+s32 Demo::GetFirstSnapshotTimeMs() const
+{
+	if(GetSnapshotCount() == 0)
+	{
+		return 0;
+	}
+
+	return _snapshots[SnapshotBuffer::Final][0].DisplayTimeMs;
+}
+
+u32 Demo::GetDurationMs() const
+{
+	const u32 snapshotCount = GetSnapshotCount();
+	if(snapshotCount == 0)
+	{
+		return 0;
+	}
+
+	const auto& snapshots = _snapshots[SnapshotBuffer::Final];
+
+	return (u32)(snapshots[snapshotCount - 1].DisplayTimeMs - snapshots[0].DisplayTimeMs);
+}
+
+u32 Demo::GetSnapshotCount() const
+{
+	return AtomicLoad(&_publishedSnapshotCount);
+}
+
 u32 Demo::GetSnapshotIndexFromDisplayTime(s32 displayTimeMs) const
 {
-	if(displayTimeMs < _firstSnapshotTimeMs)
+	const u32 snapshotCount = GetSnapshotCount();
+	const auto& snapshots = _snapshots[SnapshotBuffer::Final];
+	if(snapshotCount == 0 ||
+	   displayTimeMs < snapshots[0].DisplayTimeMs)
 	{
 		return 0;
 	}
 
-	const u32 lastIndex = _snapshots[_readIndex].GetSize() - 1;
-	if(displayTimeMs >= _lastSnapshotTimeMs)
+	const u32 lastIndex = snapshotCount - 1;
+	if(displayTimeMs >= snapshots[lastIndex].DisplayTimeMs)
 	{
 		return lastIndex;
 	}
 
 	u32 min = 0;
 	u32 max = lastIndex - 1;
-	const auto& snapshots = _snapshots[_readIndex];
 	for(;;)
 	{
 		const u32 i = (min + max) / 2;
@@ -588,43 +1119,86 @@ u32 Demo::GetSnapshotIndexFromDisplayTime(s32 displayTimeMs) const
 
 s32 Demo::GetSnapshotDisplayTimeMs(u32 index) const
 {
-	const auto& snapshots = _snapshots[_readIndex];
-	if(index >= snapshots.GetSize())
+	if(index >= GetSnapshotCount())
 	{
 		return 0;
 	}
 
-	return snapshots[index].DisplayTimeMs;
+	return _snapshots[SnapshotBuffer::Final][index].DisplayTimeMs;
 }
 
 s32 Demo::GetSnapshotServerTimeMs(u32 index)
 {
-	const auto& snapshots = _snapshots[_readIndex];
-	if(index >= snapshots.GetSize())
+	if(index >= GetSnapshotCount())
 	{
 		return 0;
 	}
 
-	return snapshots[index].ServerTimeMs;
+	return _snapshots[SnapshotBuffer::Final][index].ServerTimeMs;
 }
 
 bool Demo::GetSnapshotData(Snapshot& snapshot, u32 index) const
 {
-	const auto& snapshots = _snapshots[_readIndex];
-	if(index >= snapshots.GetSize())
+	if(index >= GetSnapshotCount())
 	{
 		return false;
 	}
 
+	// Decoding starts from the last keyframe and alternates between the 2 snapshots so that it ends with the requested one.
+	Snapshot temp;
+	Snapshot* const snaps[2] = { &snapshot, &temp };
+	u8 staticItemBits[2][ItemMaskByteCount];
+	const Snapshot* prevSnap = nullptr;
+	const u8* prevStaticItemBits = nullptr;
+	for(u32 s = index - (index % SNAPSHOT_KEYFRAME_INTERVAL); s <= index; ++s)
+	{
+		const u32 snapIdx = (index - s) & 1;
+		DecodeSnapshot(*snaps[snapIdx], staticItemBits[snapIdx], prevSnap, prevStaticItemBits, s);
+		prevSnap = snaps[snapIdx];
+		prevStaticItemBits = staticItemBits[snapIdx];
+	}
+
+	ReadStaticItems(snapshot, staticItemBits[0]);
+	ReadScore(snapshot);
+
+	return true;
+}
+
+bool Demo::ReadSnapshot(Snapshot& snapshot, u32 buffer, u32 index) const
+{
+	const auto& snapshots = _snapshots[buffer];
 	uptr offset = snapshots[index].Offset;
 
-	Read(offset, snapshot.DisplayTimeMs);
+	Read(buffer, offset, snapshot.DisplayTimeMs);
 	snapshot.ServerTimeMs = snapshots[index].ServerTimeMs;
 
-	u8 staticItemBits[MaxItemMaskByteCount];
+	u8 staticItemBits[ItemMaskByteCount];
+	Read(buffer, offset, staticItemBits, (u32)ItemMaskByteCount);
+	ReadStaticItems(snapshot, staticItemBits);
+
+	Read(buffer, offset, snapshot.PlayerCount);
+	assert(snapshot.PlayerCount <= 64);
+	Read(buffer, offset, snapshot.Players, snapshot.PlayerCount * (u32)sizeof(Player));
+
+	Read(buffer, offset, snapshot.DynamicItemCount);
+	assert(snapshot.DynamicItemCount <= MAX_DYN_ITEMS);
+	Read(buffer, offset, snapshot.DynamicItems, snapshot.DynamicItemCount * (u32)sizeof(DynamicItem));
+
+	Read(buffer, offset, snapshot.RailBeamCount);
+	assert(snapshot.RailBeamCount <= MAX_RAIL_BEAMS);
+	Read(buffer, offset, snapshot.RailBeams, snapshot.RailBeamCount * (u32)sizeof(RailBeam));
+
+	Read(buffer, offset, snapshot.Core);
+
+	ReadScore(snapshot);
+
+	return true;
+}
+
+void Demo::ReadStaticItems(Snapshot& snapshot, const u8* staticItemBits) const
+{
+	// The items registered after the snapshot was written aren't in its mask.
 	const u32 staticItemCount = _staticItems.GetSize();
-	const u32 staticItemByteCount = (staticItemCount + 7) / 8;
-	Read(offset, staticItemBits, staticItemByteCount);
 	snapshot.StaticItemCount = 0;
 	for(u32 i = 0; i < staticItemCount; ++i)
 	{
@@ -637,21 +1211,10 @@ bool Demo::GetSnapshotData(Snapshot& snapshot, u32 index) const
 		++snapshot.StaticItemCount;
 	}
 	assert(snapshot.StaticItemCount <= MAX_STATIC_ITEMS);
+}
 
-	Read(offset, snapshot.PlayerCount);
-	assert(snapshot.PlayerCount <= 64);
-	Read(offset, snapshot.Players, snapshot.PlayerCount * (u32)sizeof(Player));
-
-	Read(offset, snapshot.DynamicItemCount);
-	assert(snapshot.DynamicItemCount <= MAX_DYN_ITEMS);
-	Read(offset, snapshot.DynamicItems, snapshot.DynamicItemCount * (u32)sizeof(DynamicItem));
-
-	Read(offset, snapshot.RailBeamCount);
-	assert(snapshot.RailBeamCount <= MAX_RAIL_BEAMS);
-	Read(offset, snapshot.RailBeams, snapshot.RailBeamCount * (u32)sizeof(RailBeam));
-
-	Read(offset, snapshot.Core);
-
+void Demo::ReadScore(Snapshot& snapshot) const
+{
 	// @TODO: binary search
 	const Score* score = nullptr;
 	for(u32 i = 0; i < _scores.GetSize(); ++i)
@@ -676,53 +1239,353 @@ bool Demo::GetSnapshotData(Snapshot& snapshot, u32 index) const
 	{
 		snapshot.Score = score->Base;
 	}
+}
+
+void Demo::DecodeSnapshot(Snapshot& snapshot, u8* staticItemBits, const Snapshot* prevSnap, const u8* prevStaticItemBits, u32 index) const
+{
+	// Everything is relative to empty data for keyframes, see EncodeSnapshot.
+	Player noPlayer;
+	DynamicItem noItem;
+	SnapshotCore noCore;
+	memset(&noPlayer, 0, sizeof(noPlayer));
+	memset(&noItem, 0, sizeof(noItem));
+	memset(&noCore, 0, sizeof(noCore));
+
+	const auto& snapshots = _snapshots[SnapshotBuffer::Final];
+	const u8* data = _snapshotAllocators[SnapshotBuffer::Final].GetAddressAt(snapshots[index].Offset);
+	snapshot.DisplayTimeMs = snapshots[index].DisplayTimeMs;
+	snapshot.ServerTimeMs = snapshots[index].ServerTimeMs;
+
+	const u8 fields = *data++;
+	if(IsBitSet(&fields, SnapshotField::StaticItems))
+	{
+		const u32 byteCount = ReadVarInt(data);
+		assert(byteCount <= (u32)ItemMaskByteCount);
+		memcpy(staticItemBits, data, (size_t)byteCount);
+		memset(staticItemBits + byteCount, 0, (size_t)(ItemMaskByteCount - byteCount));
+		data += byteCount;
+	}
+	else if(prevSnap != nullptr)
+	{
+		memcpy(staticItemBits, prevStaticItemBits, (size_t)ItemMaskByteCount);
+	}
+	else
+	{
+		memset(staticItemBits, 0, (size_t)ItemMaskByteCount);
+	}
+
+	const SnapshotCore& prevCore = prevSnap != nullptr ? prevSnap->Core : noCore;
+	SnapshotCore& core = snapshot.Core;
+	core.FollowedName = IsBitSet(&fields, SnapshotField::FollowedName) ? ReadVarInt(data) : prevCore.FollowedName;
+	core.FollowedHealth = IsBitSet(&fields, SnapshotField::FollowedHealth) ? (s16)ReadDelta(data, prevCore.FollowedHealth) : prevCore.FollowedHealth;
+	core.FollowedArmor = IsBitSet(&fields, SnapshotField::FollowedArmor) ? (s16)ReadDelta(data, prevCore.FollowedArmor) : prevCore.FollowedArmor;
+	core.FollowedAmmo = IsBitSet(&fields, SnapshotField::FollowedAmmo) ? (s16)ReadDelta(data, prevCore.FollowedAmmo) : prevCore.FollowedAmmo;
+	core.FollowedTeam = IsBitSet(&fields, SnapshotField::FollowedTeam) ? *data++ : prevCore.FollowedTeam;
+	core.FollowedWeapon = IsBitSet(&fields, SnapshotField::FollowedWeapon) ? *data++ : prevCore.FollowedWeapon;
+
+	u8 prevPlayerIndices[64];
+	GetPlayerIndices(prevPlayerIndices, prevSnap);
+	snapshot.PlayerCount = ReadVarInt(data);
+	assert(snapshot.PlayerCount <= 64);
+	for(u32 p = 0; p < snapshot.PlayerCount; ++p)
+	{
+		Player& player = snapshot.Players[p];
+		player.IdClientNumber = *data++;
+		assert(player.IdClientNumber < 64);
+		const u8 prevPlayerIndex = prevPlayerIndices[player.IdClientNumber];
+		const Player& prevPlayer = prevPlayerIndex != 0xFF ? prevSnap->Players[prevPlayerIndex] : noPlayer;
+		const u8 playerFields = *data++;
+		player.Name = IsBitSet(&playerFields, PlayerField::Name) ? ReadVarInt(data) : prevPlayer.Name;
+		player.Team = IsBitSet(&playerFields, PlayerField::Team) ? *data++ : prevPlayer.Team;
+		player.WeaponId = IsBitSet(&playerFields, PlayerField::WeaponId) ? *data++ : prevPlayer.WeaponId;
+		player.Flags = IsBitSet(&playerFields, PlayerField::Flags) ? *data++ : prevPlayer.Flags;
+		ReadPosition(player.Position, data, prevPlayer.Position);
+		player.Angle = ReadAngle(data, prevPlayer.Angle);
+		if(HasLGEndPoint(player))
+		{
+			ReadPosition(player.LGEndPoint, data, player.Position);
+		}
+		else
+		{
+			Float3::Copy(player.LGEndPoint, player.Position);
+		}
+	}
+
+	snapshot.DynamicItemCount = ReadVarInt(data);
+	assert(snapshot.DynamicItemCount <= MAX_DYN_ITEMS);
+	for(u32 i = 0; i < snapshot.DynamicItemCount; ++i)
+	{
+		DynamicItem& item = snapshot.DynamicItems[i];
+		const u8 itemFields = *data++;
+		const bool sameEntity = IsBitSet(&itemFields, DynamicItemField::SameEntity);
+		const DynamicItem& prevItem = sameEntity ? prevSnap->DynamicItems[i] : noItem;
+		if(sameEntity)
+		{
+			item.Id = prevItem.Id;
+			item.IdEntityNumber = prevItem.IdEntityNumber;
+		}
+		else
+		{
+			item.Id = *data++;
+			item.IdEntityNumber = (u16)ReadVarInt(data);
+		}
+		ReadPosition(item.Position, data, prevItem.Position);
+		item.Angle = IsBitSet(&itemFields, DynamicItemField::Angle) ? ReadAngle(data, prevItem.Angle) : prevItem.Angle;
+		item.SpriteOffset = IsBitSet(&itemFields, DynamicItemField::SpriteOffset) ? *data++ : prevItem.SpriteOffset;
+	}
+
+	snapshot.RailBeamCount = ReadVarInt(data);
+	assert(snapshot.RailBeamCount <= MAX_RAIL_BEAMS);
+	for(u32 i = 0; i < snapshot.RailBeamCount; ++i)
+	{
+		RailBeam& beam = snapshot.RailBeams[i];
+		if(*data++ != 0)
+		{
+			const RailBeam& prevBeam = prevSnap->RailBeams[i];
+			Float3::Copy(beam.StartPosition, prevBeam.StartPosition);
+			Float3::Copy(beam.EndPosition, prevBeam.EndPosition);
+			beam.Team = prevBeam.Team;
+		}
+		else
+		{
+			ReadPosition(beam.StartPosition, data, noPlayer.Position);
+			ReadPosition(beam.EndPosition, data, beam.StartPosition);
+			beam.Team = *data++;
+		}
+		beam.Alpha = (f32)*data++ / 255.0f;
+	}
+}
+
+bool Demo::GetDynamicItemsOnly(Snapshot& snapshot, u32 buffer, u32 index) const
+{
+	const auto& snapshots = _snapshots[buffer];
+	if(index >= snapshots.GetSize())
+	{
+		return false;
+	}
+
+	uptr offset = snapshots[index].Offset;
+
+	Read(buffer, offset, snapshot.DisplayTimeMs);
+	snapshot.ServerTimeMs = snapshots[index].ServerTimeMs;
+
+	offset += (uptr)ItemMaskByteCount;
+
+	u32 playerCount = 0;
+	Read(buffer, offset, playerCount);
+	assert(playerCount <= 64);
+	offset += playerCount * (u32)sizeof(Player);
+
+	Read(buffer, offset, snapshot.DynamicItemCount);
+	assert(snapshot.DynamicItemCount <= MAX_DYN_ITEMS);
+	Read(buffer, offset, snapshot.DynamicItems, snapshot.DynamicItemCount * (u32)sizeof(DynamicItem));
+
+	return true;
+}
+
+bool Demo::GetPlayersOnly(Snapshot& snapshot, u32 buffer, u32 index) const
+{
+	const auto& snapshots = _snapshots[buffer];
+	if(index >= snapshots.GetSize())
+	{
+		return false;
+	}
+
+	uptr offset = snapshots[index].Offset;
+
+	Read(buffer, offset, snapshot.DisplayTimeMs);
+	snapshot.ServerTimeMs = snapshots[index].ServerTimeMs;
+
+	offset += (uptr)ItemMaskByteCount;
+
+	Read(buffer, offset, snapshot.PlayerCount);
+	assert(snapshot.PlayerCount <= 64);
+	Read(buffer, offset, snapshot.Players, snapshot.PlayerCount * (u32)sizeof(Player));
+
+	return true;
+}
+
+void Demo::WriteSnapshot(u32 buffer, const Snapshot& snapshot)
+{
+	SnapshotDesc snapDesc;
+	snapDesc.DisplayTimeMs = snapshot.DisplayTimeMs;
+	snapDesc.ServerTimeMs = snapshot.ServerTimeMs;
+	snapDesc.Offset = (u32)_snapshotAllocators[buffer].GetCurrentByteCount();
+	_snapshots[buffer].Add(snapDesc);
+
+	Write(buffer, snapshot.DisplayTimeMs);
+
+	u8 staticItemBits[ItemMaskByteCount];
+	GetStaticItemBits(staticItemBits, snapshot);
+	Write(buffer, staticItemBits, (u32)ItemMaskByteCount);
+
+	assert(snapshot.PlayerCount <= 64);
+	Write(buffer, snapshot.PlayerCount);
+	Write(buffer, snapshot.Players, snapshot.PlayerCount * (u32)sizeof(Player));
+
+	assert(snapshot.DynamicItemCount <= MAX_DYN_ITEMS);
+	Write(buffer, snapshot.DynamicItemCount);
+	Write(buffer, snapshot.DynamicItems, snapshot.DynamicItemCount * (u32)sizeof(DynamicItem));
+
+	assert(snapshot.RailBeamCount <= MAX_RAIL_BEAMS);
+	Write(buffer, snapshot.RailBeamCount);
+	Write(buffer, snapshot.RailBeams, snapshot.RailBeamCount * (u32)sizeof(RailBeam));
 
-	return true;
+	Write(buffer, snapshot.Core);
 }
 
-bool Demo::GetDynamicItemsOnly(Snapshot& snapshot, u32 index) const
+void Demo::EncodeSnapshot(const Snapshot& snapshot)
 {
-	const auto& snapshots = _snapshots[_readIndex];
-	if(index >= snapshots.GetSize())
+	// The snapshot is encoded relative to the last one encoded, which is kept as is.
+	// See the description of the encoding above.
+	Player noPlayer;
+	DynamicItem noItem;
+	SnapshotCore noCore;
+	memset(&noPlayer, 0, sizeof(noPlayer));
+	memset(&noItem, 0, sizeof(noItem));
+	memset(&noCore, 0, sizeof(noCore));
+
+	auto& snapshots = _snapshots[SnapshotBuffer::Final];
+	auto& allocator = _snapshotAllocators[SnapshotBuffer::Final];
+	Snapshot& lastSnap = _fixSnapshots[3];
+	const Snapshot* const prevSnap = (snapshots.GetSize() % SNAPSHOT_KEYFRAME_INTERVAL) != 0 ? &lastSnap : nullptr;
+	if(prevSnap == nullptr)
 	{
-		return false;
+		memset(_encodedStaticItemBits, 0, sizeof(_encodedStaticItemBits));
 	}
 
-	uptr offset = snapshots[index].Offset;
-
-	Read(offset, snapshot.DisplayTimeMs);
-	snapshot.ServerTimeMs = snapshots[index].ServerTimeMs;
+	SnapshotDesc snapDesc;
+	snapDesc.DisplayTimeMs = snapshot.DisplayTimeMs;
+	snapDesc.ServerTimeMs = snapshot.ServerTimeMs;
+	snapDesc.Offset = (u32)allocator.GetCurrentByteCount();
+	snapshots.Add(snapDesc);
+
+	u8* const start = allocator.AllocateAndGetAddress(MaxEncodedSnapshotByteCount);
+	u8* data = start;
+
+	u8 staticItemBits[ItemMaskByteCount];
+	GetStaticItemBits(staticItemBits, snapshot);
+	const SnapshotCore& prevCore = prevSnap != nullptr ? prevSnap->Core : noCore;
+	const SnapshotCore& core = snapshot.Core;
+	u8 fields = 0;
+	if(memcmp(staticItemBits, _encodedStaticItemBits, sizeof(staticItemBits)) != 0) SetBit(&fields, SnapshotField::StaticItems);
+	if(core.FollowedName != prevCore.FollowedName) SetBit(&fields, SnapshotField::FollowedName);
+	if(core.FollowedHealth != prevCore.FollowedHealth) SetBit(&fields, SnapshotField::FollowedHealth);
+	if(core.FollowedArmor != prevCore.FollowedArmor) SetBit(&fields, SnapshotField::FollowedArmor);
+	if(core.FollowedAmmo != prevCore.FollowedAmmo) SetBit(&fields, SnapshotField::FollowedAmmo);
+	if(core.FollowedTeam != prevCore.FollowedTeam) SetBit(&fields, SnapshotField::FollowedTeam);
+	if(core.FollowedWeapon != prevCore.FollowedWeapon) SetBit(&fields, SnapshotField::FollowedWeapon);
+	*data++ = fields;
+
+	if(IsBitSet(&fields, SnapshotField::StaticItems))
+	{
+		u32 byteCount = (u32)ItemMaskByteCount;
+		while(byteCount > 0 && staticItemBits[byteCount - 1] == 0)
+		{
+			--byteCount;
+		}
+		data = WriteVarInt(data, byteCount);
+		memcpy(data, staticItemBits, (size_t)byteCount);
+		data += byteCount;
+	}
 
-	const u32 staticItemCount = _staticItems.GetSize();
-	const u32 staticItemByteCount = (staticItemCount + 7) / 8;
-	offset += staticItemByteCount;
+	if(IsBitSet(&fields, SnapshotField::FollowedName)) data = WriteVarInt(data, core.FollowedName);
+	if(IsBitSet(&fields, SnapshotField::FollowedHealth)) data = WriteDelta(data, core.FollowedHealth, prevCore.FollowedHealth);
+	if(IsBitSet(&fields, SnapshotField::FollowedArmor)) data = WriteDelta(data, core.FollowedArmor, prevCore.FollowedArmor);
+	if(IsBitSet(&fields, SnapshotField::FollowedAmmo)) data = WriteDelta(data, core.FollowedAmmo, prevCore.FollowedAmmo);
+	if(IsBitSet(&fields, SnapshotField::FollowedTeam)) *data++ = core.FollowedTeam;
+	if(IsBitSet(&fields, SnapshotField::FollowedWeapon)) *data++ = core.FollowedWeapon;
 
-	u32 playerCount = 0;
-	Read(offset, playerCount);
-	assert(playerCount <= 64);
-	offset += playerCount * (u32)sizeof(Player);
+	u8 prevPlayerIndices[64];
+	GetPlayerIndices(prevPlayerIndices, prevSnap);
+	assert(snapshot.PlayerCount <= 64);
+	data = WriteVarInt(data, snapshot.PlayerCount);
+	for(u32 p = 0; p < snapshot.PlayerCount; ++p)
+	{
+		const Player& player = snapshot.Players[p];
+		const u8 prevPlayerIndex = prevPlayerIndices[player.IdClientNumber];
+		const Player& prevPlayer = prevPlayerIndex != 0xFF ? prevSnap->Players[prevPlayerIndex] : noPlayer;
+		u8 playerFields = 0;
+		if(player.Name != prevPlayer.Name) SetBit(&playerFields, PlayerField::Name);
+		if(player.Team != prevPlayer.Team) SetBit(&playerFields, PlayerField::Team);
+		if(player.WeaponId != prevPlayer.WeaponId) SetBit(&playerFields, PlayerField::WeaponId);
+		if(player.Flags != prevPlayer.Flags) SetBit(&playerFields, PlayerField::Flags);
+		*data++ = player.IdClientNumber;
+		*data++ = playerFields;
+		if(IsBitSet(&playerFields, PlayerField::Name)) data = WriteVarInt(data, player.Name);
+		if(IsBitSet(&playerFields, PlayerField::Team)) *data++ = player.Team;
+		if(IsBitSet(&playerFields, PlayerField::WeaponId)) *data++ = player.WeaponId;
+		if(IsBitSet(&playerFields, PlayerField::Flags)) *data++ = player.Flags;
+		data = WritePosition(data, player.Position, prevPlayer.Position);
+		data = WriteAngle(data, player.Angle, prevPlayer.Angle);
+		if(HasLGEndPoint(player))
+		{
+			data = WritePosition(data, player.LGEndPoint, player.Position);
+		}
+	}
 
-	Read(offset, snapshot.DynamicItemCount);
 	assert(snapshot.DynamicItemCount <= MAX_DYN_ITEMS);
-	Read(offset, snapshot.DynamicItems, snapshot.DynamicItemCount * (u32)sizeof(DynamicItem));
+	data = WriteVarInt(data, snapshot.DynamicItemCount);
+	for(u32 i = 0; i < snapshot.DynamicItemCount; ++i)
+	{
+		const DynamicItem& item = snapshot.DynamicItems[i];
+		const bool sameEntity =
+			prevSnap != nullptr &&
+			i < prevSnap->DynamicItemCount &&
+			prevSnap->DynamicItems[i].Id == item.Id &&
+			prevSnap->DynamicItems[i].IdEntityNumber == item.IdEntityNumber;
+		const DynamicItem& prevItem = sameEntity ? prevSnap->DynamicItems[i] : noItem;
+		u8 itemFields = 0;
+		if(sameEntity) SetBit(&itemFields, DynamicItemField::SameEntity);
+		if(Quantize(item.Angle, ANGLE_QUANTIZATION_SCALE) != Quantize(prevItem.Angle, ANGLE_QUANTIZATION_SCALE)) SetBit(&itemFields, DynamicItemField::Angle);
+		if(item.SpriteOffset != prevItem.SpriteOffset) SetBit(&itemFields, DynamicItemField::SpriteOffset);
+		*data++ = itemFields;
+		if(!sameEntity)
+		{
+			*data++ = item.Id;
+			data = WriteVarInt(data, item.IdEntityNumber);
+		}
+		data = WritePosition(data, item.Position, prevItem.Position);
+		if(IsBitSet(&itemFields, DynamicItemField::Angle)) data = WriteAngle(data, item.Angle, prevItem.Angle);
+		if(IsBitSet(&itemFields, DynamicItemField::SpriteOffset)) *data++ = item.SpriteOffset;
+	}
 
-	return true;
-}
+	assert(snapshot.RailBeamCount <= MAX_RAIL_BEAMS);
+	data = WriteVarInt(data, snapshot.RailBeamCount);
+	for(u32 i = 0; i < snapshot.RailBeamCount; ++i)
+	{
+		const RailBeam& beam = snapshot.RailBeams[i];
+		const bool sameBeam =
+			prevSnap != nullptr &&
+			i < prevSnap->RailBeamCount &&
+			prevSnap->RailBeams[i].Team == beam.Team &&
+			IsSamePosition(prevSnap->RailBeams[i].StartPosition, beam.StartPosition) &&
+			IsSamePosition(prevSnap->RailBeams[i].EndPosition, beam.EndPosition);
+		*data++ = sameBeam ? 1 : 0;
+		if(!sameBeam)
+		{
+			data = WritePosition(data, beam.StartPosition, noPlayer.Position);
+			data = WritePosition(data, beam.EndPosition, beam.StartPosition);
+			*data++ = beam.Team;
+		}
+		*data++ = (u8)floorf(udt_clamp(beam.Alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
 
-void Demo::WriteSnapshot(const Snapshot& snapshot)
-{
-	SnapshotDesc snapDesc;
-	snapDesc.DisplayTimeMs = snapshot.DisplayTimeMs;
-	snapDesc.ServerTimeMs = snapshot.ServerTimeMs;
-	snapDesc.Offset = (u32)_snapshotAllocators[_writeIndex].GetCurrentByteCount();
-	_snapshots[_writeIndex].Add(snapDesc);
+	const uptr byteCount = (uptr)(data - start);
+	assert(byteCount <= (uptr)MaxEncodedSnapshotByteCount);
+	allocator.Pop((uptr)MaxEncodedSnapshotByteCount - byteCount);
 
-	Write(snapshot.DisplayTimeMs);
+	if(&snapshot != &lastSnap)
+	{
+		lastSnap = snapshot;
+	}
+	memcpy(_encodedStaticItemBits, staticItemBits, sizeof(staticItemBits));
+}
 
-	u8 staticItemBits[MaxItemMaskByteCount];
-	memset(staticItemBits, 0, sizeof(staticItemBits));
+void Demo::GetStaticItemBits(u8* staticItemBits, const Snapshot& snapshot) const
+{
+	memset(staticItemBits, 0, (size_t)ItemMaskByteCount);
 	const u32 staticItemCount = _staticItems.GetSize();
-	const u32 staticItemByteCount = (staticItemCount + 7) / 8;
 	for(u32 i = 0; i < snapshot.StaticItemCount; ++i)
 	{
 		const auto& snapItem = snapshot.StaticItems[i];
@@ -740,36 +1603,21 @@ void Demo::WriteSnapshot(const Snapshot& snapshot)
 		}
 	}
 	assert(staticItemCount <= MAX_STATIC_ITEMS);
-	Write(staticItemBits, staticItemByteCount);
-
-	assert(snapshot.PlayerCount <= 64);
-	Write(snapshot.PlayerCount);
-	Write(snapshot.Players, snapshot.PlayerCount * (u32)sizeof(Player));
-
-	assert(snapshot.DynamicItemCount <= MAX_DYN_ITEMS);
-	Write(snapshot.DynamicItemCount);
-	Write(snapshot.DynamicItems, snapshot.DynamicItemCount * (u32)sizeof(DynamicItem));
-
-	assert(snapshot.RailBeamCount <= MAX_RAIL_BEAMS);
-	Write(snapshot.RailBeamCount);
-	Write(snapshot.RailBeams, snapshot.RailBeamCount * (u32)sizeof(RailBeam));
-
-	Write(snapshot.Core);
 }
 
-void Demo::Read(uptr& offset, void* data, u32 byteCount) const
+void Demo::Read(u32 buffer, uptr& offset, void* data, u32 byteCount) const
 {
-	memcpy(data, _snapshotAllocators[_readIndex].GetAddressAt(offset), (size_t)byteCount);
+	memcpy(data, _snapshotAllocators[buffer].GetAddressAt(offset), (size_t)byteCount);
 	offset += (uptr)byteCount;
 }
 
-void Demo::Write(const void* data, u32 byteCount)
+void Demo::Write(u32 buffer, const void* data, u32 byteCount)
 {
-	u8* const dest = _snapshotAllocators[_writeIndex].AllocateAndGetAddress(byteCount);
+	u8* const dest = _snapshotAllocators[buffer].AllocateAndGetAddress(byteCount);
 	memcpy(dest, data, (size_t)byteCount);
 }
 
-void Demo::ParseDemo(const char* filePath, MessageHandler messageHandler)
+void Demo::ParseDemo(const char* filePath)
 {
 	udtFileStream file;
 	if(!file.Open(filePath, udtFileOpenMode::Read))
@@ -854,26 +1702,23 @@ void Demo::ParseDemo(const char* filePath, MessageHandler messageHandler)
 			}
 		}
 
-		if(!(this->*messageHandler)(output))
-		{
-			break;
-		}
+		ProcessMessage(output);
 	}
 }
 
-bool Demo::ProcessMessage_Mod(const udtCuMessageOutput&)
+void Demo::ReadModFromGameName()
 {
 	udtCuConfigString cs;
 	if(udtCuGetConfigString(_context, &cs, 0) != udtErrorCode::None)
 	{
-		return false;
+		return;
 	}
 
 	char gameName[64];
 	char temp[64];
 	if(udtParseConfigStringValueAsString(gameName, sizeof(gameName), temp, sizeof(temp), "gamename", cs.ConfigString) != udtErrorCode::None)
 	{
-		return false;
+		return;
 	}
 
 	const udtString gameNameString = udtString::NewConstRef(gameName);
@@ -885,17 +1730,15 @@ bool Demo::ProcessMessage_Mod(const udtCuMessageOutput&)
 	{
 		_mod = udtMod::CPMA;
 	}
-	
-	return false;
 }
 
-bool Demo::ProcessMessage_OSPEncryption(const udtCuMessageOutput&)
+void Demo::ReadOSPEncryption()
 {
 	udtCuConfigString cs;
 	if(udtCuGetConfigString(_context, &cs, 872) != udtErrorCode::None ||
 	   cs.ConfigString == nullptr)
 	{
-		return false;
+		return;
 	}
 
 	s32 value = 0;
@@ -904,69 +1747,60 @@ bool Demo::ProcessMessage_OSPEncryption(const udtCuMessageOutput&)
 	{
 		_ospEncryptedPlayers = true;
 	}
-
-	return false;
 }
 
-bool Demo::ProcessMessage_StaticItems(const udtCuMessageOutput& message)
+void Demo::ProcessGameState()
 {
-	if(message.IsGameState)
+	if(_readModFromGameName)
 	{
-		_staticItems.Clear();
-		return true;
+		ReadModFromGameName();
 	}
 
-	if(message.GameStateOrSnapshot.Snapshot == nullptr)
+	if(_mod == (u32)udtMod::OSP)
 	{
-		return true;
+		ReadOSPEncryption();
 	}
 
-	const udtCuSnapshotMessage& snapshot = *message.GameStateOrSnapshot.Snapshot;
-	for(u32 i = 0; i < snapshot.EntityCount; ++i)
+	const u32 protocol = _protocol;
+	const u32 mod = _mod;
+	if(protocol != _protocolNumbersProtocol || mod != _protocolNumbersMod)
 	{
-		const idEntityStateBase& es = *snapshot.Entities[i];
-		if(es.eType != _protocolNumbers.EntityTypeItem)
-		{
-			continue;
-		}
-
-		s32 udtItemId;
-		udtGetUDTMagicNumber(&udtItemId, udtMagicNumberType::Item, es.modelindex, _protocol, _mod);
-		if(GetItemClassFromId(udtItemId) == ItemClass::Static)
-		{
-			RegisterStaticItem(es, udtItemId);
-		}
+		_protocolNumbers.GetNumbers(protocol, mod);
+		_protocolNumbersProtocol = protocol;
+		_protocolNumbersMod = mod;
 	}
 
-	return true;
+	_staticItems.Clear();
+
+	udtCuConfigString cs;
+	udtCuGetConfigString(_context, &cs, 0);
+	char mapName[256];
+	char tempBuffer[256];
+	udtParseConfigStringValueAsString(mapName, sizeof(mapName), tempBuffer, sizeof(tempBuffer), "mapname", cs.ConfigString);
+	_mapName = udtString::NewClone(_stringAllocator, mapName);
+
+	for(s32 p = 0; p < 64; ++p)
+	{
+		_players[p].Name = UDT_U32_MAX;
+		_players[p].Team = udtTeam::Spectators;
+		_heatMapPlayers[p].Present = 0;
+		_heatMapPlayers[p].Name = UDT_U32_MAX;
+		_heatMapPlayers[p].Team = udtTeam::Spectators;
+		ProcessPlayerConfigString(_protocolNumbers.CSIndexFirstPlayer + p, p);
+	}
 }
 
-bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
+void Demo::ProcessMessage(const udtCuMessageOutput& message)
 {
 	if(message.IsGameState)
 	{
-		udtCuConfigString cs;
-		udtCuGetConfigString(_context, &cs, 0);
-		char mapName[256];
-		char tempBuffer[256];
-		udtParseConfigStringValueAsString(mapName, sizeof(mapName), tempBuffer, sizeof(tempBuffer), "mapname", cs.ConfigString);
-		_mapName = udtString::NewClone(_stringAllocator, mapName);
-
-		for(s32 p = 0; p < 64; ++p)
-		{
-			_players[p].Name = UDT_U32_MAX;
-			_players[p].Team = udtTeam::Spectators;
-			_heatMapPlayers[p].Present = 0;
-			_heatMapPlayers[p].Name = UDT_U32_MAX;
-			_heatMapPlayers[p].Team = udtTeam::Spectators;
-			ProcessPlayerConfigString(_protocolNumbers.CSIndexFirstPlayer + p, p);
-		}
+		ProcessGameState();
+		return;
 	}
 
-	if(message.IsGameState ||
-	   message.GameStateOrSnapshot.Snapshot == nullptr)
+	if(message.GameStateOrSnapshot.Snapshot == nullptr)
 	{
-		return true;
+		return;
 	}
 
 	_tempPlayers.Clear();
@@ -975,11 +1809,36 @@ bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
 	_tempShaftImpacts.Clear();
 
 	const udtCuSnapshotMessage& snapshot = *message.GameStateOrSnapshot.Snapshot;
+	Snapshot& newSnap = *_snapshot;
+
+	//
+	// Static items.
+	// They're registered the first time they show up, time-outs included.
+	//
+
+	newSnap.StaticItemCount = 0;
+	for(u32 i = 0; i < snapshot.EntityCount; ++i)
+	{
+		const idEntityStateBase& es = *snapshot.Entities[i];
+		if(es.eType != _protocolNumbers.EntityTypeItem)
+		{
+			continue;
+		}
+
+		s32 udtItemId;
+		udtGetUDTMagicNumber(&udtItemId, udtMagicNumberType::Item, es.modelindex, _protocol, _mod);
+		u32 itemIndex;
+		if(GetItemClassFromId(udtItemId) == ItemClass::Static &&
+		   RegisterStaticItem(es, udtItemId, itemIndex))
+		{
+			newSnap.StaticItems[newSnap.StaticItemCount++] = _staticItems[itemIndex];
+		}
+	}
 
 	s32 timeOffsetMs = 0;
 	if(ProcessTimeOut(timeOffsetMs, snapshot.ServerTimeMs))
 	{
-		return true;
+		return;
 	}
 
 	for(u32 i = 0; i < snapshot.ChangedEntityCount; ++i)
@@ -1004,35 +1863,9 @@ bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
 		}
 	}
 
-	Snapshot& newSnap = *_snapshot;
 	newSnap.ServerTimeMs = snapshot.ServerTimeMs;
 	newSnap.DisplayTimeMs = snapshot.ServerTimeMs - timeOffsetMs;
 
-	//
-	// Static items.
-	//
-
-	newSnap.StaticItemCount = 0;
-	for(u32 i = 0; i < snapshot.EntityCount; ++i)
-	{
-		const idEntityStateBase& es = *snapshot.Entities[i];
-		if(es.eType != _protocolNumbers.EntityTypeItem)
-		{
-			continue;
-		}
-
-		for(u32 j = 0, count = _staticItems.GetSize(); j < count; ++j)
-		{
-			s32 udtItemId;
-			udtGetUDTMagicNumber(&udtItemId, udtMagicNumberType::Item, es.modelindex, _protocol, _mod);
-			if(IsSame(es, _staticItems[j], udtItemId))
-			{
-				newSnap.StaticItems[newSnap.StaticItemCount++] = _staticItems[j];
-				break;
-			}
-		}
-	}
-
 	//
 	// Players.
 	//
@@ -1082,7 +1915,8 @@ bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
 	// Dynamic items.
 	//
 
-	udtVMArray<SnapshotDesc>& snapshots = _snapshots[_writeIndex];
+	udtVMArray<SnapshotDesc>& snapshots = _snapshots[SnapshotBuffer::Parsed];
+	const u32 snapshotIndex = _firstParsedSnapshotIndex + snapshots.GetSize();
 	DynamicItem dynItem;
 	for(u32 i = 0; i < snapshot.EntityCount; ++i)
 	{
@@ -1141,7 +1975,7 @@ bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
 				{
 					Impact explosion;
 					Float3::Copy(explosion.Position, es.pos.trBase);
-					explosion.SnapshotIndex = snapshots.GetSize();
+					explosion.SnapshotIndex = snapshotIndex;
 					_explosions.Add(explosion);
 				}
 				else if(es.weapon == _protocolNumbers.WeaponPlasma)
@@ -1162,7 +1996,7 @@ bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
 			{
 				Impact impact;
 				Float3::Copy(impact.Position, es.pos.trBase);
-				impact.SnapshotIndex = snapshots.GetSize();
+				impact.SnapshotIndex = snapshotIndex;
 				_bulletImpacts.Add(impact);
 			}
 			else if(es.event == _protocolNumbers.EntityEventMissileHit ||
@@ -1181,7 +2015,7 @@ bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
 	}
 	for(s32 i = (s32)_bulletImpacts.GetSize() - 1; i >= 0; --i)
 	{
-		const u32 offset = (snapshots.GetSize() - _bulletImpacts[i].SnapshotIndex) / 4;
+		const u32 offset = (snapshotIndex - _bulletImpacts[i].SnapshotIndex) / 4;
 		if(offset >= (u32)Sprite::BulletImpactFrames)
 		{
 			_bulletImpacts.RemoveUnordered(i);
@@ -1198,7 +2032,7 @@ bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
 	}
 	for(s32 i = (s32)_explosions.GetSize() - 1; i >= 0; --i)
 	{
-		const u32 offset = snapshots.GetSize() - _explosions[i].SnapshotIndex;
+		const u32 offset = snapshotIndex - _explosions[i].SnapshotIndex;
 		if(offset >= (u32)Sprite::ExplosionFrames)
 		{
 			_explosions.RemoveUnordered(i);
@@ -1274,9 +2108,9 @@ bool Demo::ProcessMessage_FinalPass(const udtCuMessageOutput& message)
 		newSnap.Core.FollowedName = _players[followedPlayerIndex].Name;
 	}
 
-	WriteSnapshot(newSnap);
-
-	return true;
+	WriteSnapshot(SnapshotBuffer::Parsed, newSnap);
+	FixStaticItems(snapshotIndex);
+	FixSnapshots(false);
 }
 
 bool Demo::ProcessPlayer(const idEntityStateBase& player, s32 serverTimeMs, bool followed)
@@ -1384,22 +2218,32 @@ void Demo::ProcessPlayerConfigString(u32 csIndex, u32 playerIndex)
 	}
 }
 
-void Demo::RegisterStaticItem(const idEntityStateBase& item, s32 udtItemId)
+bool Demo::RegisterStaticItem(const idEntityStateBase& item, s32 udtItemId, u32& itemIndex)
 {
-	for(u32 i = 0, count = _staticItems.GetSize(); i < count; ++i)
+	const u32 itemCount = _staticItems.GetSize();
+	for(u32 i = 0; i < itemCount; ++i)
 	{
 		if(IsSame(item, _staticItems[i], udtItemId))
 		{
-			return;
+			itemIndex = i;
+			return true;
 		}
 	}
 
+	if(itemCount >= MAX_STATIC_ITEMS)
+	{
+		return false;
+	}
+
 	StaticItem newItem;
 	newItem.Id = udtItemId;
 	newItem.Position[0] = item.pos.trBase[0];
 	newItem.Position[1] = item.pos.trBase[1];
 	newItem.Position[2] = item.pos.trBase[2];
 	_staticItems.Add(newItem);
+	itemIndex = itemCount;
+
+	return true;
 }
 
 bool Demo::IsSame(const idEntityStateBase& es, const StaticItem& item, s32 udtItemId)
@@ -1411,153 +2255,175 @@ bool Demo::IsSame(const idEntityStateBase& es, const StaticItem& item, s32 udtIt
 		item.Position[2] == es.pos.trBase[2];
 }
 
-void Demo::FixStaticItems()
+void Demo::FixSnapshots(bool lastSnapshotParsed)
 {
-	const auto& snapshots = _snapshots[_readIndex];
-	auto& snapDataAllocator = _snapshotAllocators[_readIndex];
-	const u32 itemCount = _staticItems.GetSize();
-	const u32 snapshotCount = snapshots.GetSize();
-	for(u32 i = 0; i < itemCount; ++i)
+	const auto& parsedSnapshots = _snapshots[SnapshotBuffer::Parsed];
+	const u32 parsedCount = parsedSnapshots.GetSize();
+	if(parsedCount == 0)
 	{
-		ReportProgress((f32)i / (f32)itemCount);
+		return;
+	}
 
-		const s32 itemId = _staticItems[i].Id;
-		const u32 spawnTimeMs = GetItemSpawnTimeMs(itemId);
-		if(spawnTimeMs == 0)
+	if(_fixedSnapshotCount == 0)
+	{
+		// The first snapshot can't be fixed up.
+		ReadSnapshot(_fixSnapshots[0], SnapshotBuffer::Parsed, 0);
+		_fixSnapshotIndex = 1;
+		_fixedSnapshotCount = 1;
+	}
+
+	// The snapshot indices count the discarded parsed snapshots, the final ones are never discarded.
+	// The last snapshot parsed is only used to fix up the others.
+	// The last snapshot fixed up is only encoded once the LG fix-up, which needs the next one, is done.
+	const u32 firstIndex = _firstParsedSnapshotIndex;
+	const s32 lastParsedTimeMs = parsedSnapshots[parsedCount - 1].DisplayTimeMs;
+	for(u32 s = _fixedSnapshotCount; s < firstIndex + parsedCount - 1; ++s)
+	{
+		if(!lastSnapshotParsed &&
+		   lastParsedTimeMs - parsedSnapshots[s - 1 - firstIndex].DisplayTimeMs < MAX_FIX_LOOK_AHEAD_MS)
 		{
-			continue;
+			break;
 		}
 
-		u32 lastSnapUp = 0;
-		s32 lastTimeUp = UDT_S32_MIN;
-		for(u32 s = 0; s < snapshotCount; ++s)
+		FixDynamicItemsAndPlayers(s - firstIndex, parsedCount);
+		Snapshot& prevSnap = _fixSnapshots[_fixSnapshotIndex];
+		const Snapshot& currSnap = _fixSnapshots[_fixSnapshotIndex ^ 1];
+		if(s >= 2)
 		{
-			const u8* const snapData = snapDataAllocator.GetAddressAt(snapshots[s].Offset);
-			if(IsBitSet(snapData + 4, i))
-			{
-				lastSnapUp = s;
-				lastTimeUp = *(s32*)snapData;
-				continue;
-			}
+			FixLGEndPoints(prevSnap, _fixSnapshots[3], currSnap);
+		}
+		EncodeSnapshot(prevSnap);
+		_fixedSnapshotCount = s + 1;
+#if PUBLISH_SNAPSHOTS_WHILE_LOADING
+		if(!lastSnapshotParsed &&
+		   _playbackReadyCallback != nullptr)
+		{
+			PublishSnapshots(s);
+		}
+#endif
+	}
 
-			if(lastTimeUp == UDT_S32_MIN)
-			{
-				continue;
-			}
+	if(lastSnapshotParsed)
+	{
+		EncodeSnapshot(_fixSnapshots[_fixSnapshotIndex ^ 1]);
+	}
+	else
+	{
+		DiscardParsedSnapshots();
+	}
+}
 
-			bool fix = false;
-			u32 onePastLastSnapToFix = 0;
-			for(u32 s2 = s + 1; s2 < snapshotCount; ++s2)
-			{
-				const u8* const snapData2 = snapDataAllocator.GetAddressAt(snapshots[s2].Offset);
-				const s32 time = *(s32*)snapData2;
-				if(time - lastTimeUp >= (s32)spawnTimeMs)
-				{
-					break;
-				}
+void Demo::FixStaticItems(u32 snapshotIndex)
+{
+	// Items not showing up in a few snapshots are added back to them if they show up again before they could have respawned.
+	// The parsed snapshots discarded are further back than any spawn time.
+	const u32 firstIndex = _firstParsedSnapshotIndex;
+	const auto& snapshots = _snapshots[SnapshotBuffer::Parsed];
+	auto& snapDataAllocator = _snapshotAllocators[SnapshotBuffer::Parsed];
+	const u8* const snapData = snapDataAllocator.GetAddressAt(snapshots[snapshotIndex - firstIndex].Offset);
+	const s32 timeMs = *(const s32*)snapData;
+	const u32 itemCount = _staticItems.GetSize();
+	for(u32 i = 0; i < itemCount; ++i)
+	{
+		if(!IsBitSet(snapData + 4, i))
+		{
+			continue;
+		}
 
-				if(IsBitSet(snapData2 + 4, i))
-				{
-					fix = true;
-					onePastLastSnapToFix = s2;
-					break;
-				}
-			}
+		const u32 lastSnapUp = _staticItemLastSnapUp[i];
+		_staticItemLastSnapUp[i] = snapshotIndex;
+		if(lastSnapUp == UDT_U32_MAX ||
+		   lastSnapUp < firstIndex ||
+		   lastSnapUp + 1 == snapshotIndex)
+		{
+			continue;
+		}
 
-			if(!fix)
-			{
-				continue;
-			}
+		const u32 spawnTimeMs = GetItemSpawnTimeMs(_staticItems[i].Id);
+		if(spawnTimeMs == 0 ||
+		   timeMs - snapshots[lastSnapUp - firstIndex].DisplayTimeMs >= (s32)spawnTimeMs)
+		{
+			continue;
+		}
 
-			for(u32 s2 = lastSnapUp + 1; s2 < onePastLastSnapToFix; ++s2)
-			{
-				SetBit(snapDataAllocator.GetAddressAt(snapshots[s2].Offset + 4), i);
-			}
+		for(u32 s = lastSnapUp + 1; s < snapshotIndex; ++s)
+		{
+			SetBit(snapDataAllocator.GetAddressAt(snapshots[s - firstIndex].Offset + 4), i);
 		}
 	}
 }
 
-void Demo::FixDynamicItemsAndPlayers()
+void Demo::FixDynamicItemsAndPlayers(u32 s, u32 snapshotCount)
 {
-	_readIndex = 0;
-	_writeIndex = 1;
-
-	Snapshot* const snapshots = (Snapshot*)malloc(sizeof(Snapshot) * 3);
-	if(snapshots == nullptr)
-	{
-		Platform_FatalError("Failed to allocate %d bytes for snapshot data", (int)sizeof(Snapshot) * 3);
-	}
-	Snapshot* snaps[2] = { snapshots, snapshots + 1 };
-	Snapshot& snap2 = snapshots[2];
-	u32 snapIdx = 1;
-	GetSnapshotData(*snaps[0], 0);
-	WriteSnapshot(*snaps[0]);
-
-	const u32 snapshotCount = _snapshots[_readIndex].GetSize();
-	for(u32 s = 1; s < snapshotCount - 1; ++s)
-	{
-		ReportProgress((f32)s / (f32)(snapshotCount - 1));
-
-		GetSnapshotData(*snaps[snapIdx], s);
-		auto& currSnap = *snaps[snapIdx];
-		const auto& prevSnap = *snaps[snapIdx ^ 1];
-		snapIdx ^= 1;
-		assert(currSnap.DynamicItemCount <= MAX_DYN_ITEMS);
-		assert(currSnap.StaticItemCount <= MAX_STATIC_ITEMS);
-		assert(currSnap.RailBeamCount <= MAX_RAIL_BEAMS);
-		assert(currSnap.PlayerCount <= 64);
-
-		for(u32 i = 0; i < prevSnap.DynamicItemCount; ++i)
+	// The previous snapshot is the one written to the final buffer last, so it includes what was added to it.
+	Snapshot* const snaps[2] = { _fixSnapshots, _fixSnapshots + 1 };
+	Snapshot& snap2 = _fixSnapshots[2];
+	const u32 snapIdx = _fixSnapshotIndex;
+	_fixSnapshotIndex ^= 1;
+
+	ReadSnapshot(*snaps[snapIdx], SnapshotBuffer::Parsed, s);
+	auto& currSnap = *snaps[snapIdx];
+	const auto& prevSnap = *snaps[snapIdx ^ 1];
+	assert(currSnap.DynamicItemCount <= MAX_DYN_ITEMS);
+	assert(currSnap.StaticItemCount <= MAX_STATIC_ITEMS);
+	assert(currSnap.RailBeamCount <= MAX_RAIL_BEAMS);
+	assert(currSnap.PlayerCount <= 64);
+
+	// The look-ahead starts with the current snapshot as it was read, i.e. without the items and players added to it.
+	const u32 currItemCount = currSnap.DynamicItemCount;
+	const u32 currPlayerCount = currSnap.PlayerCount;
+
+	for(u32 i = 0; i < prevSnap.DynamicItemCount; ++i)
+	{
+		const DynamicItem& item = prevSnap.DynamicItems[i];
+		const u32 spawnTimeMs = GetDynamicItemSpawnTimeMs(item.Id);
+		if(spawnTimeMs == 0)
+		{
+			continue;
+		}
+		
+		bool fixed = false;
+		for(u32 s2 = s; s2 < snapshotCount && !fixed; ++s2)
 		{
-			const DynamicItem& item = prevSnap.DynamicItems[i];
-			const u32 spawnTimeMs = GetDynamicItemSpawnTimeMs(item.Id);
-			if(spawnTimeMs == 0)
+			const Snapshot* nextSnap = &currSnap;
+			u32 nextItemCount = currItemCount;
+			if(s2 > s)
 			{
-				continue;
+				GetDynamicItemsOnly(snap2, SnapshotBuffer::Parsed, s2);
+				nextSnap = &snap2;
+				nextItemCount = snap2.DynamicItemCount;
 			}
-			
-			bool fixed = false;
-			for(u32 s2 = s; s2 < snapshotCount && !fixed; ++s2)
+
+			if(nextSnap->DisplayTimeMs - prevSnap.DisplayTimeMs >= (s32)spawnTimeMs)
 			{
-				GetDynamicItemsOnly(snap2, s2);
-				if(snap2.DisplayTimeMs - prevSnap.DisplayTimeMs >= (s32)spawnTimeMs)
-				{
-					break;
-				}
+				break;
+			}
 
-				for(u32 i2 = 0; i2 < snap2.DynamicItemCount; ++i2)
+			for(u32 i2 = 0; i2 < nextItemCount; ++i2)
+			{
+				const DynamicItem& item2 = nextSnap->DynamicItems[i2];
+				if(item2.Id == item.Id &&
+				   item2.IdEntityNumber == item.IdEntityNumber)
 				{
-					const DynamicItem& item2 = snap2.DynamicItems[i2];
-					if(item2.Id == item.Id &&
-					   item2.IdEntityNumber == item.IdEntityNumber)
+					if(s2 > s)
 					{
-						if(s2 > s)
-						{
-							DynamicItem newItem = item2;
-							const f32 t = (f32)(currSnap.DisplayTimeMs - prevSnap.DisplayTimeMs) / (f32)(snap2.DisplayTimeMs - prevSnap.DisplayTimeMs);
-							Float3::Lerp(newItem.Position, item.Position, item2.Position, t);
-							currSnap.DynamicItems[currSnap.DynamicItemCount++] = newItem;
-						}
-						fixed = true;
-						break;
+						DynamicItem newItem = item2;
+						const f32 t = (f32)(currSnap.DisplayTimeMs - prevSnap.DisplayTimeMs) / (f32)(snap2.DisplayTimeMs - prevSnap.DisplayTimeMs);
+						Float3::Lerp(newItem.Position, item.Position, item2.Position, t);
+						currSnap.DynamicItems[currSnap.DynamicItemCount++] = newItem;
 					}
+					fixed = true;
+					break;
 				}
 			}
 		}
-
-		FixPlayers(prevSnap, currSnap, snap2, s, snapshotCount, true);
-		FixPlayers(prevSnap, currSnap, snap2, s, snapshotCount, false);
-
-		WriteSnapshot(currSnap);
 	}
 
-	free(snapshots);
-
-	_readIndex = 1;
-	_writeIndex = 0;
+	FixPlayers(prevSnap, currSnap, currPlayerCount, snap2, s, snapshotCount, true);
+	FixPlayers(prevSnap, currSnap, currPlayerCount, snap2, s, snapshotCount, false);
 }
 
-void Demo::FixPlayers(const Snapshot& prevSnap, Snapshot& currSnap, Snapshot& snap2, u32 s, u32 snapshotCount, bool alive)
+void Demo::FixPlayers(const Snapshot& prevSnap, Snapshot& currSnap, u32 currPlayerCount, Snapshot& snap2, u32 s, u32 snapshotCount, bool alive)
 {
 	for(u32 p = 0; p < prevSnap.PlayerCount; ++p)
 	{
@@ -1572,15 +2438,23 @@ void Demo::FixPlayers(const Snapshot& prevSnap, Snapshot& currSnap, Snapshot& sn
 		bool fixed = false;
 		for(u32 s2 = s; s2 < snapshotCount && !fixed; ++s2)
 		{
-			GetSnapshotData(snap2, s2);
-			if(snap2.DisplayTimeMs - prevSnap.DisplayTimeMs >= MAX_FIXABLE_PLAYER_BLINK_TIME_MS)
+			const Snapshot* nextSnap = &currSnap;
+			u32 nextPlayerCount = currPlayerCount;
+			if(s2 > s)
+			{
+				GetPlayersOnly(snap2, SnapshotBuffer::Parsed, s2);
+				nextSnap = &snap2;
+				nextPlayerCount = snap2.PlayerCount;
+			}
+
+			if(nextSnap->DisplayTimeMs - prevSnap.DisplayTimeMs >= MAX_FIXABLE_PLAYER_BLINK_TIME_MS)
 			{
 				break;
 			}
 
-			for(u32 p2 = 0; p2 < snap2.PlayerCount; ++p2)
+			for(u32 p2 = 0; p2 < nextPlayerCount; ++p2)
 			{
-				const Player& player2 = snap2.Players[p2];
+				const Player& player2 = nextSnap->Players[p2];
 				if(player2.IdClientNumber == player.IdClientNumber)
 				{
 					if(s2 > s && 
@@ -1602,56 +2476,40 @@ void Demo::FixPlayers(const Snapshot& prevSnap, Snapshot& currSnap, Snapshot& sn
 	}
 }
 
-void Demo::FixLGEndPoints()
+void Demo::FixLGEndPoints(Snapshot& snapshot, const Snapshot& prevSnap, const Snapshot& nextSnap)
 {
-	const u32 staticItemCount = _staticItems.GetSize();
-	const u32 staticItemByteCount = (staticItemCount + 7) / 8;
-	const auto& snapshots = _snapshots[_readIndex];
-	const u32 snapshotCount = snapshots.GetSize();
-	for(u32 s = 1; s < snapshotCount - 1; ++s)
-	{
-		uptr offset = snapshots[s].Offset + staticItemByteCount + 4;
-		u32 playerCount;
-		Read(offset, playerCount);
-		Player* const players = (Player*)_snapshotAllocators[_readIndex].GetAddressAt(offset);
-		for(u32 p = 0; p < playerCount; ++p)
-		{
-			Player& player = players[p];
-			const Player* prevPlayer = nullptr;
-			const Player* nextPlayer = nullptr;
-			if(IsBitSet(&player.Flags, PlayerFlags::ShortLGBeam))
-			{
-				continue;
-			}
+	for(u32 p = 0; p < snapshot.PlayerCount; ++p)
+	{
+		Player& player = snapshot.Players[p];
+		const Player* prevPlayer = nullptr;
+		const Player* nextPlayer = nullptr;
+		if(IsBitSet(&player.Flags, PlayerFlags::ShortLGBeam))
+		{
+			continue;
+		}
 
-			const bool foundPrev = FindPlayer(prevPlayer, s - 1, player.IdClientNumber);
-			const bool foundNext = FindPlayer(nextPlayer, s + 1, player.IdClientNumber);
-			const bool shortPrev = foundPrev ? IsBitSet(&prevPlayer->Flags, PlayerFlags::ShortLGBeam) : false;
-			const bool shortNext = foundNext ? IsBitSet(&nextPlayer->Flags, PlayerFlags::ShortLGBeam) : false;
-			const bool shaftNext = foundNext ? (nextPlayer->WeaponId == (u8)udtWeapon::LightningGun && IsBitSet(&nextPlayer->Flags, PlayerFlags::Firing)) : false;
-			if(shortPrev && (shortNext || !shaftNext))
-			{
-				// We keep the current view direction but use the beam length of the previous snapshot.
-				f32 normDir[3];
-				const f32 length = Float3::Dist(prevPlayer->Position, prevPlayer->LGEndPoint);
-				Float3::Direction(normDir, player.Position, player.LGEndPoint);
-				Float3::Mad(player.LGEndPoint, player.Position, normDir, length);
-				SetBit(&player.Flags, PlayerFlags::ShortLGBeam);
-			}
+		const bool foundPrev = FindPlayer(prevPlayer, prevSnap, player.IdClientNumber);
+		const bool foundNext = FindPlayer(nextPlayer, nextSnap, player.IdClientNumber);
+		const bool shortPrev = foundPrev ? IsBitSet(&prevPlayer->Flags, PlayerFlags::ShortLGBeam) : false;
+		const bool shortNext = foundNext ? IsBitSet(&nextPlayer->Flags, PlayerFlags::ShortLGBeam) : false;
+		const bool shaftNext = foundNext ? (nextPlayer->WeaponId == (u8)udtWeapon::LightningGun && IsBitSet(&nextPlayer->Flags, PlayerFlags::Firing)) : false;
+		if(shortPrev && (shortNext || !shaftNext))
+		{
+			// We keep the current view direction but use the beam length of the previous snapshot.
+			f32 normDir[3];
+			const f32 length = Float3::Dist(prevPlayer->Position, prevPlayer->LGEndPoint);
+			Float3::Direction(normDir, player.Position, player.LGEndPoint);
+			Float3::Mad(player.LGEndPoint, player.Position, normDir, length);
+			SetBit(&player.Flags, PlayerFlags::ShortLGBeam);
 		}
 	}
 }
 
-bool Demo::FindPlayer(const Player*& playerOut, u32 snapshotIndex, u8 idClientNumber)
+bool Demo::FindPlayer(const Player*& playerOut, const Snapshot& snapshot, u8 idClientNumber)
 {
-	const u32 staticItemByteCount = (_staticItems.GetSize() + 7) / 8;
-	uptr offset = _snapshots[_readIndex][snapshotIndex].Offset + staticItemByteCount + 4;
-	u32 playerCount;
-	Read(offset, playerCount);
-	const Player* const players = (const Player*)_snapshotAllocators[_readIndex].GetAddressAt(offset);
-	for(u32 p = 0; p < playerCount; ++p)
+	for(u32 p = 0; p < snapshot.PlayerCount; ++p)
 	{
-		const Player& player = players[p];
+		const Player& player = snapshot.Players[p];
 		if(idClientNumber == player.IdClientNumber)
 		{
 			playerOut = &player;
@@ -1662,6 +2520,48 @@ bool Demo::FindPlayer(const Player*& playerOut, u32 snapshotIndex, u8 idClientNu
 	return false;
 }
 
+void Demo::PublishSnapshots(u32 snapshotCount)
+{
+	AtomicStore(&_publishedSnapshotCount, snapshotCount);
+	if(!_playbackReady && snapshotCount >= 2)
+	{
+		// We need a duration.
+		_playbackReady = true;
+		(*_playbackReadyCallback)(_userData);
+	}
+}
+
+void Demo::DiscardParsedSnapshots()
+{
+	// The next snapshot to fix up needs the display time of the one before it.
+	auto& snapshots = _snapshots[SnapshotBuffer::Parsed];
+	auto& snapDataAllocator = _snapshotAllocators[SnapshotBuffer::Parsed];
+	const u32 snapshotCount = snapshots.GetSize();
+	const u32 discardedCount = _fixedSnapshotCount - 1 - _firstParsedSnapshotIndex;
+
+	// Only move the data once enough of it is unused.
+	if(discardedCount < 1024 || discardedCount * 2 < snapshotCount)
+	{
+		return;
+	}
+
+	const u32 keptCount = snapshotCount - discardedCount;
+	const u32 firstDataOffset = snapshots[discardedCount].Offset;
+	const uptr keptByteCount = snapDataAllocator.GetCurrentByteCount() - (uptr)firstDataOffset;
+	u8* const data = snapDataAllocator.GetStartAddress();
+	memmove(data, data + firstDataOffset, (size_t)keptByteCount);
+	snapDataAllocator.SetCurrentByteCount(keptByteCount);
+
+	for(u32 i = 0; i < keptCount; ++i)
+	{
+		SnapshotDesc snapDesc = snapshots[discardedCount + i];
+		snapDesc.Offset -= firstDataOffset;
+		snapshots[i] = snapDesc;
+	}
+	snapshots.Resize(keptCount);
+	_firstParsedSnapshotIndex += discardedCount;
+}
+
 void Demo::ComputeLGEndPoint(Player& player, const f32* start, const f32* angles)
 {
 	f32 viewVector[3];
@@ -199,22 +199,27 @@ struct idProtocolNumbers
 struct Demo
 {
 	typedef void (*ProgressCallback)(f32 progress, void* userData);
+	typedef void (*PlaybackReadyCallback)(void* userData);
 
 	Demo();
 	~Demo();
 
-	bool        Init(ProgressCallback progressCallback, void* userData);
+	bool        Init(ProgressCallback progressCallback, PlaybackReadyCallback playbackReadyCallback, void* userData);
 	void        Load(const char* filePath, bool keepOnlyFirstMatch, bool removeTimeOuts);
-	void		GenerateHeatMap(u32* histogram, u32 width, u32 height, const f32* min, const f32* max, u32 clientNumber);
+	void        GenerateHeatMaps(u8* images, u32 width, u32 height, const f32* min, const f32* max, bool squaredRamp, u32 maxThreadCount = 0); // One RGBA image per present player. 0 threads means all cores.
 
+	// The playback ready callback is optional. It's invoked from Load, which keeps running.
+	// From then on, the snapshot functions can be called from another thread while Load runs.
+	// They only see the snapshots loaded so far: the count, duration and snapshot data only ever grow.
+	// The chat messages and map name are available too but the map bounds and heat map players are not.
 	const char* GetFilePath() const;
-	s32         GetFirstSnapshotTimeMs() const { return _firstSnapshotTimeMs; }
-	u32         GetDurationMs() const { return (u32)(_lastSnapshotTimeMs - _firstSnapshotTimeMs); }
-	bool        IsValid() const { return _snapshots[_readIndex].GetSize() > 0; }
+	s32         GetFirstSnapshotTimeMs() const;
+	u32         GetDurationMs() const;
+	bool        IsValid() const { return GetSnapshotCount() > 0; }
 	udtString   GetMapName() const { return _mapName; }
 	const f32*  GetMapMin() const { return _min; }
 	const f32*  GetMapMax() const { return _max; }
-	u32         GetSnapshotCount() const { return _snapshots[_readIndex].GetSize(); }
+	u32         GetSnapshotCount() const;
 	const char* GetString(u32 offset) const { return _stringAllocator.GetStringAt(offset); }
 	const char* GetStringSafe(u32 offset, const char* replacement) const;
 
@@ -236,39 +241,47 @@ struct Demo
 private:
 	UDT_NO_COPY_SEMANTICS(Demo);
 
-	typedef bool (Demo::*MessageHandler)(const udtCuMessageOutput& message); // Return false to stop parsing.
-
 	template<typename T>
-	void Read(uptr& offset, T& data) const
+	void Read(u32 buffer, uptr& offset, T& data) const
 	{
-		Read(offset, &data, (u32)sizeof(T));
+		Read(buffer, offset, &data, (u32)sizeof(T));
 	}
 
 	template<typename T>
-	void Write(const T& data)
+	void Write(u32 buffer, const T& data)
 	{
-		Write(&data, (u32)sizeof(T));
+		Write(buffer, &data, (u32)sizeof(T));
 	}
 
-	bool GetDynamicItemsOnly(Snapshot& snapshot, u32 index) const;
-	void Read(uptr& offset, void* data, u32 byteCount) const;
-	void Write(const void* data, u32 byteCount);
-	void ParseDemo(const char* filePath, MessageHandler messageHandler);
-	bool ProcessMessage_Mod(const udtCuMessageOutput& message);
-	bool ProcessMessage_OSPEncryption(const udtCuMessageOutput& message);
-	bool ProcessMessage_StaticItems(const udtCuMessageOutput& message);
-	bool ProcessMessage_FinalPass(const udtCuMessageOutput& message);
+	bool ReadSnapshot(Snapshot& snapshot, u32 buffer, u32 index) const;
+	void ReadStaticItems(Snapshot& snapshot, const u8* staticItemBits) const;
+	void ReadScore(Snapshot& snapshot) const;
+	void DecodeSnapshot(Snapshot& snapshot, u8* staticItemBits, const Snapshot* prevSnap, const u8* prevStaticItemBits, u32 index) const; // Final snapshots only.
+	bool GetDynamicItemsOnly(Snapshot& snapshot, u32 buffer, u32 index) const;
+	bool GetPlayersOnly(Snapshot& snapshot, u32 buffer, u32 index) const;
+	void Read(u32 buffer, uptr& offset, void* data, u32 byteCount) const;
+	void Write(u32 buffer, const void* data, u32 byteCount);
+	void ParseDemo(const char* filePath);
+	void ProcessGameState();
+	void ProcessMessage(const udtCuMessageOutput& message);
+	void ReadModFromGameName();
+	void ReadOSPEncryption();
 	bool ProcessPlayer(const idEntityStateBase& player, s32 serverTimeMs, bool followed);
 	void ProcessPlayerConfigString(u32 csIndex, u32 playerIndex);
-	void RegisterStaticItem(const idEntityStateBase& item, s32 itemId);
+	bool RegisterStaticItem(const idEntityStateBase& item, s32 itemId, u32& itemIndex);
 	bool IsSame(const idEntityStateBase& a, const StaticItem& b, s32 udtItemId);
-	void FixStaticItems();
-	void FixDynamicItemsAndPlayers();
-	void FixPlayers(const Snapshot& prevSnap, Snapshot& currSnap, Snapshot& snap2, u32 s, u32 snapshotCount, bool alive);
-	void FixLGEndPoints();
-	void WriteSnapshot(const Snapshot& snapshot);
+	void FixSnapshots(bool lastSnapshotParsed);
+	void FixStaticItems(u32 snapshotIndex);
+	void FixDynamicItemsAndPlayers(u32 s, u32 snapshotCount);
+	void FixPlayers(const Snapshot& prevSnap, Snapshot& currSnap, u32 currPlayerCount, Snapshot& snap2, u32 s, u32 snapshotCount, bool alive);
+	void FixLGEndPoints(Snapshot& snapshot, const Snapshot& prevSnap, const Snapshot& nextSnap);
+	void PublishSnapshots(u32 snapshotCount);
+	void DiscardParsedSnapshots();
+	void WriteSnapshot(u32 buffer, const Snapshot& snapshot);
+	void EncodeSnapshot(const Snapshot& snapshot); // Final snapshots only.
+	void GetStaticItemBits(u8* staticItemBits, const Snapshot& snapshot) const;
 	void ComputeLGEndPoint(Player& player, const f32* start, const f32* angles);
-	bool FindPlayer(const Player*& player, u32 snapshotIndex, u8 idClientNumber);
+	bool FindPlayer(const Player*& player, const Snapshot& snapshot, u8 idClientNumber);
 	bool AnalyzeDemo(const char* filePath, bool keepOnlyFirstMatch);
 	u32  CloneString(const void* buffer, u32 offset);
 	void ReportProgress(f32 subProgress);
@@ -277,7 +290,18 @@ private:
 
 	enum Constants
 	{
-		MaxItemMaskByteCount = 64
+		ItemMaskByteCount = MAX_STATIC_ITEMS / 8,
+		MaxHeatMapThreadCount = 16
+	};
+
+	struct SnapshotBuffer
+	{
+		enum Id
+		{
+			Parsed, // Written while parsing, fixed up in place until the final snapshots are written. Only the recent ones are kept.
+			Final, // What gets played back. Encoded relative to the previous snapshot, see EncodeSnapshot.
+			Count
+		};
 	};
 
 	struct SnapshotDesc
@@ -321,13 +345,12 @@ private:
 	HeatMapPlayer _heatMapPlayers[64];
 	char _filePath[512];
 	idProtocolNumbers _protocolNumbers;
-	u8 _staticItemBits[MaxItemMaskByteCount];
+	u32 _staticItemLastSnapUp[MAX_STATIC_ITEMS]; // Parsed snapshot index, counting the discarded ones.
+	u8 _encodedStaticItemBits[ItemMaskByteCount]; // Of the last final snapshot encoded.
 	f32 _min[3];
 	f32 _max[3];
-	u32 _readIndex = 0;
-	u32 _writeIndex = 0;
-	udtVMArray<SnapshotDesc> _snapshots[2];
-	udtVMLinearAllocator _snapshotAllocators[2];
+	udtVMArray<SnapshotDesc> _snapshots[SnapshotBuffer::Count]; // Indexed with SnapshotBuffer::Id.
+	udtVMLinearAllocator _snapshotAllocators[SnapshotBuffer::Count];
 	udtVMLinearAllocator _stringAllocator { "Demo::Strings" };
 	udtVMArray<StaticItem> _staticItems { "Demo::StaticItemsArray" };
 	udtVMArray<Player> _tempPlayers { "Demo::TempPlayersArray" };
@@ -345,17 +368,25 @@ private:
 	udtCuContext* _context = nullptr;
 	u8* _messageData = nullptr;
 	Snapshot* _snapshot = nullptr;
+	Snapshot* _fixSnapshots = nullptr; // The previous and current snapshots of FixDynamicItemsAndPlayers, one to look ahead and the last one encoded.
 	ProgressCallback _progressCallback = nullptr;
+	PlaybackReadyCallback _playbackReadyCallback = nullptr;
 	void* _userData = nullptr;
 	s32 _firstMatchStartTimeMs = UDT_S32_MAX;
 	s32 _firstMatchEndTimeMs = UDT_S32_MIN;
-	s32 _firstSnapshotTimeMs = UDT_S32_MAX;
-	s32 _lastSnapshotTimeMs = UDT_S32_MIN;
 	u32 _mod = udtMod::None;
+	u32 _protocolNumbersProtocol = udtProtocol::Invalid;
+	u32 _protocolNumbersMod = udtMod::None;
 	u32 _gameType = udtGameType::Count;
 	u32 _protocol = udtProtocol::Invalid;
 	u32 _loadStep = 0;
+	u32 _fixSnapshotIndex = 0; // Of the current snapshot in _fixSnapshots.
+	u32 _fixedSnapshotCount = 0; // Including the last one, which isn't encoded yet.
+	u32 _firstParsedSnapshotIndex = 0; // The parsed snapshots before it were discarded.
+	volatile u32 _publishedSnapshotCount = 0; // The final snapshots that won't change anymore.
 	s32 _timeOutIndex = 0;
 	bool _ospEncryptedPlayers = false;
+	bool _readModFromGameName = false; // The analysis failed.
+	bool _playbackReady = false;
 	bool _removeTimeOuts = false;
 };
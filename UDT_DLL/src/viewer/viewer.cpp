@@ -207,87 +207,6 @@ static void DrawTexturedRect(NVGcontext* ctx, f32 x, f32 y, f32 w, f32 h, int te
 	nvgClosePath(ctx);
 }
 
-// The sum of all kernel coefficients should be 256.
-static void ConvolveRGBAImage(u8* output, const u8* input, u32 width, u32 height, const u8* kernelCoeffs, u32 kernelSize)
-{
-	const u32 ks2 = kernelSize / 2;
-	const u32 x1 = width - ks2;
-	const u32 y1 = height - ks2;
-
-	for(u32 y = 0; y < ks2; ++y)
-	{
-		for(u32 x = 0; x < width; ++x)
-		{
-			const u32 idx = y * width + x;
-			output[idx * 4 + 0] = input[idx * 4 + 0];
-			output[idx * 4 + 1] = input[idx * 4 + 1];
-			output[idx * 4 + 2] = input[idx * 4 + 2];
-			output[idx * 4 + 3] = input[idx * 4 + 3];
-		}
-	}
-
-	for(u32 y = ks2; y < y1; ++y)
-	{
-		for(u32 x = 0; x < ks2; ++x)
-		{
-			const u32 idx = y * width + x;
-			output[idx * 4 + 0] = input[idx * 4 + 0];
-			output[idx * 4 + 1] = input[idx * 4 + 1];
-			output[idx * 4 + 2] = input[idx * 4 + 2];
-			output[idx * 4 + 3] = input[idx * 4 + 3];
-		}
-
-		for(u32 x = ks2; x < x1; ++x)
-		{
-			u16 sumR = 0;
-			u16 sumG = 0;
-			u16 sumB = 0;
-			for(u32 ky = 0; ky < kernelSize; ++ky)
-			{
-				for(u32 kx = 0; kx < kernelSize; ++kx)
-				{
-					const u32 inIdx = (y + ky - ks2) * width + (x + kx - ks2);
-					const u32 kernIdx = ky * kernelSize + kx;
-					const u8 r = input[inIdx * 4 + 0];
-					const u8 g = input[inIdx * 4 + 1];
-					const u8 b = input[inIdx * 4 + 2];
-					const u8 k = kernelCoeffs[kernIdx];
-					sumR += (u16)r * (u16)k;
-					sumG += (u16)g * (u16)k;
-					sumB += (u16)b * (u16)k;
-				}
-			}
-
-			const u32 idx = y * width + x;
-			output[idx * 4 + 0] = sumR >> 8;
-			output[idx * 4 + 1] = sumG >> 8;
-			output[idx * 4 + 2] = sumB >> 8;
-			output[idx * 4 + 3] = input[idx * 4 + 3];
-		}
-
-		for(u32 x = x1; x < width; ++x)
-		{
-			const u32 idx = y * width + x;
-			output[idx * 4 + 0] = input[idx * 4 + 0];
-			output[idx * 4 + 1] = input[idx * 4 + 1];
-			output[idx * 4 + 2] = input[idx * 4 + 2];
-			output[idx * 4 + 3] = input[idx * 4 + 3];
-		}
-	}
-
-	for(u32 y = y1; y < height; ++y)
-	{
-		for(u32 x = 0; x < width; ++x)
-		{
-			const u32 idx = y * width + x;
-			output[idx * 4 + 0] = input[idx * 4 + 0];
-			output[idx * 4 + 1] = input[idx * 4 + 1];
-			output[idx * 4 + 2] = input[idx * 4 + 2];
-			output[idx * 4 + 3] = input[idx * 4 + 3];
-		}
-	}
-}
-
 static void SliderFormatZScale(char* buffer, f32 value, f32, f32)
 {
 	sprintf(buffer, "%.2f", 1.0f + value);
@@ -325,6 +244,21 @@ void Viewer::DemoProgressCallback(f32 progress, void* userData)
 	viewer->_threadedJobProgress = progress;
 }
 
+void Viewer::DemoPlaybackReadyCallback(void* userData)
+{
+	Viewer* const viewer = (Viewer*)userData;
+	viewer->LoadDemoMap();
+	if(!viewer->_mapCoordsLoaded)
+	{
+		// The map bounds will come from the demo, so we wait for all of it.
+		return;
+	}
+
+	viewer->RestartPlayback();
+	CriticalSectionLock lock(viewer->_appStateLock);
+	viewer->_appState = AppState::FinishMapLoading;
+}
+
 void Viewer::DemoLoadThreadEntryPoint(void* userData)
 {
 	const DemoLoadThreadData& data = *(const DemoLoadThreadData*)userData;
@@ -372,7 +306,7 @@ bool Viewer::Init(int argc, char** argv)
 	}
 	_snapshot = snapshot;
 	
-	if(!_demo.Init(&DemoProgressCallback, this) ||
+	if(!_demo.Init(&DemoProgressCallback, &DemoPlaybackReadyCallback, this) ||
 	   !LoadMapAliases() ||
 	   !LoadSprites())
 	{
@@ -662,20 +596,16 @@ bool Viewer::CreateTextureRGBA(int& textureId, u32 width, u32 height, const u8*
 
 void Viewer::LoadDemo(const char* filePath)
 {
+	_demoMapLoaded = false;
 	_demo.Load(filePath, _config.OnlyKeepFirstMatchSnapshots, _config.RemoveTimeOutSnapshots);
-	
-	const udtString originalMapName = _demo.GetMapName();
-	udtString mapName = originalMapName;
-	for(u32 i = 0, count = _mapAliases.GetSize(); i < count; ++i)
+
+	// See DemoPlaybackReadyCallback.
+	const bool playbackStarted = _demoMapLoaded && _mapCoordsLoaded;
+	if(!_demoMapLoaded)
 	{
-		if(udtString::EqualsNoCase(_mapAliases[i].NameFound, originalMapName))
-		{
-			mapName = _mapAliases[i].NameToUse;
-			break;
-		}
+		LoadDemoMap();
 	}
 
-	LoadMap(mapName);
 	if(!_mapCoordsLoaded)
 	{
 		for(u32 i = 0; i < 3; ++i)
@@ -690,6 +620,31 @@ void Viewer::LoadDemo(const char* filePath)
 		}
 	}
 
+	if(!playbackStarted)
+	{
+		RestartPlayback();
+	}
+}
+
+void Viewer::LoadDemoMap()
+{
+	const udtString originalMapName = _demo.GetMapName();
+	udtString mapName = originalMapName;
+	for(u32 i = 0, count = _mapAliases.GetSize(); i < count; ++i)
+	{
+		if(udtString::EqualsNoCase(_mapAliases[i].NameFound, originalMapName))
+		{
+			mapName = _mapAliases[i].NameToUse;
+			break;
+		}
+	}
+
+	LoadMap(mapName);
+	_demoMapLoaded = true;
+}
+
+void Viewer::RestartPlayback()
+{
 	_reversePlayback = false;
 	_demoPlaybackTimer.Stop();
 	_demoPlaybackTimer.Reset();
@@ -757,29 +712,10 @@ void Viewer::GenerateHeatMaps()
 		}
 	}
 
-	const u32 rampColorCount = 256;
-	const u32 baseColorCount = 5;
-	const u8 colors[baseColorCount][3] = { { 0, 0, 0 }, { 0, 255, 255 }, { 0, 255, 0 }, { 255, 255, 0 }, { 255, 0, 0 } };
-	u8 colorRamp[rampColorCount][3];
-	const u32 div = rampColorCount / (baseColorCount - 1);
-	for(u32 i = 0; i < rampColorCount; ++i)
-	{
-		const u32 c0 = i / div;
-		const u32 c1 = c0 + 1;
-		const f32 t = (f32)(i % div) / (f32)div;
-		for(u32 c = 0; c < 3; ++c)
-		{
-			colorRamp[i][c] = (u8)((f32)colors[c0][c] * (1.0f - t) + (f32)colors[c1][c] * t);
-		}
-	}
-
 	const u32 w = _mapWidth > 0 ? _mapWidth : 1024;
 	const u32 h = _mapHeight > 0 ? _mapHeight : 1024;
-	const u32 pixelCount = w * h;
-	const u32 byteCountHistogram = (u32)sizeof(u32) * pixelCount;
-	const u32 byteCountHeatMap = 4 * pixelCount;
+	const u32 byteCountHeatMap = 4 * w * h;
 	const u32 byteCountPersistent = playerCount * byteCountHeatMap;
-	const u32 byteCountTemp = byteCountHistogram + byteCountHeatMap;
 
 	u8* const heatMaps = (u8*)malloc((size_t)byteCountPersistent);
 	if(heatMaps == nullptr)
@@ -788,14 +724,7 @@ void Viewer::GenerateHeatMaps()
 	}
 	_heatMapImages = heatMaps;
 
-	u8* const temp = (u8*)malloc((size_t)byteCountTemp);
-	if(temp == nullptr)
-	{
-		Platform_FatalError("Failed to allocate %d bytes for heat map generation", (int)byteCountTemp);
-	}
-
-	u32* const histogramTemp = (u32*)temp;
-	u8* const heatMapTemp = temp + byteCountHistogram;
+	_demo.GenerateHeatMaps(heatMaps, w, h, _mapMin, _mapMax, _config.HeatMapSquaredRamp);
 
 	u32 playerIndex = 0;
 	for(u32 p = 0; p < 64; ++p)
@@ -809,66 +738,13 @@ void Viewer::GenerateHeatMaps()
 			continue;
 		}
 
-		_demo.GenerateHeatMap(histogramTemp, w, h, _mapMin, _mapMax, p);
-
-		u32 maxValue = 0;
-		for(u32 i = 0; i < pixelCount; ++i)
-		{
-			maxValue = udt_max(maxValue, histogramTemp[i]);
-		}
-
-		u8* const heatMapFinal = heatMaps + playerIndex * byteCountHeatMap;
-		const u8 gaussian3x3[9] = { 16, 32, 16, 32, 64, 32, 16, 32, 16 };
-		const u32 divider = (maxValue + rampColorCount - 1) / rampColorCount;
-		if(divider == 0)
-		{
-			memset(heatMapFinal, 0, (size_t)pixelCount * 4);
-			goto finalize_image;
-		}
-
-		if(_config.HeatMapSquaredRamp)
-		{
-			for(u32 i = 0; i < pixelCount; ++i)
-			{
-				const u32 col2 = rampColorCount - 1 - (histogramTemp[i] / divider);
-				const u32 col = rampColorCount - 1 - ((col2 * col2) / rampColorCount);
-				const u8 op = (u8)((col * 256) / rampColorCount);
-				heatMapTemp[4 * i + 0] = colorRamp[col][0];
-				heatMapTemp[4 * i + 1] = colorRamp[col][1];
-				heatMapTemp[4 * i + 2] = colorRamp[col][2];
-				heatMapTemp[4 * i + 3] = op;
-			}
-		}
-		else
-		{
-			for(u32 i = 0; i < pixelCount; ++i)
-			{
-				const u32 col = histogramTemp[i] / divider;
-				const u8 op = (u8)((col * 256) / rampColorCount);
-				heatMapTemp[4 * i + 0] = colorRamp[col][0];
-				heatMapTemp[4 * i + 1] = colorRamp[col][1];
-				heatMapTemp[4 * i + 2] = colorRamp[col][2];
-				heatMapTemp[4 * i + 3] = op;
-			}
-		}
-
-		// We smooth the heat map to make it look less blocky.
-		ConvolveRGBAImage(heatMapFinal, heatMapTemp, w, h, gaussian3x3, 3);
-		ConvolveRGBAImage(heatMapTemp, heatMapFinal, w, h, gaussian3x3, 3);
-		ConvolveRGBAImage(heatMapFinal, heatMapTemp, w, h, gaussian3x3, 3);
-
-	finalize_image:
 		_heatMaps[p].Width = w;
 		_heatMaps[p].Height = h;
-		_heatMaps[p].Image = heatMapFinal;
+		_heatMaps[p].Image = heatMaps + playerIndex * byteCountHeatMap;
 		_heatMaps[p].TextureId = InvalidTextureId;
-
 		++playerIndex;
-		_threadedJobProgress = (f32)playerIndex / (f32)playerCount;
 	}
 
-	free(temp);
-
 	_threadedJobProgress = 1.0f;
 
 	udtVMLinearAllocator& tempAlloc = udtThreadLocalAllocators::GetTempAllocator();
@@ -1012,15 +888,22 @@ void Viewer::ProcessEvent(const Event& event)
 	}
 	else if(_genHeatMapsButton.WasClicked())
 	{
+		// The demo might still be loading.
 		CriticalSectionLock lock(_appStateLock);
-		_appState = AppState::GeneratingHeatMaps;
-		StartGeneratingHeatMaps();
+		if(_appState == AppState::Normal)
+		{
+			_appState = AppState::GeneratingHeatMaps;
+			StartGeneratingHeatMaps();
+		}
 	}
 	else if(_reloadDemoButton.WasClicked())
 	{
 		CriticalSectionLock lock(_appStateLock);
-		_appState = AppState::LoadingDemo;
-		StartLoadingDemo(_demo.GetFilePath());
+		if(_appState == AppState::Normal)
+		{
+			_appState = AppState::LoadingDemo;
+			StartLoadingDemo(_demo.GetFilePath());
+		}
 	}
 
 	if(_tabButtonGroup.HasSelectionChanged())
@@ -1713,9 +1596,23 @@ void Viewer::Render(const RenderParams& renderParams)
 
 	switch(_appState)
 	{
+		case AppState::FinishMapLoading:
+			FinishLoadingMap();
+			_demoMapFinished = true;
+			_appState = AppState::StreamingDemo;
+			RenderNormal(renderParams);
+			break;
+
 		case AppState::FinishDemoLoading:
+		{
+			const bool streamed = _demoMapFinished;
+			_demoMapFinished = false;
 			if(_demo.IsValid())
 			{
+				if(!streamed)
+				{
+					FinishLoadingMap();
+				}
 				FinishLoadingDemo();
 			}
 			if(_demo.IsValid() && _profileMode)
@@ -1726,9 +1623,17 @@ void Viewer::Render(const RenderParams& renderParams)
 			else
 			{
 				_appState = AppState::Normal;
-				RenderThreadedJobProgress(renderParams);
+				if(streamed)
+				{
+					RenderNormal(renderParams);
+				}
+				else
+				{
+					RenderThreadedJobProgress(renderParams);
+				}
 			}
 			break;
+		}
 
 		case AppState::FinishHeatMapGeneration:
 			if(_profileMode)
@@ -1748,6 +1653,7 @@ void Viewer::Render(const RenderParams& renderParams)
 			RenderThreadedJobProgress(renderParams);
 			break;
 
+		case AppState::StreamingDemo:
 		case AppState::Normal:
 			RenderNormal(renderParams);
 			break;
@@ -2279,7 +2185,10 @@ void Viewer::FinishLoadingDemo()
 		_heatMapPlayers[i].SetText(_demo.GetStringSafe(players[i].Name, "?"));
 		_heatMapGroup.AddRadioButton(&_heatMapPlayers[i]);
 	}
+}
 
+void Viewer::FinishLoadingMap()
+{
 	if(_map != InvalidTextureId)
 	{
 		nvgDeleteImage(_sharedReadOnly->NVGContext, _map);
@@ -43,6 +43,7 @@ struct Tab
 struct Viewer
 {
 	static void DemoProgressCallback(f32 progress, void* userData);
+	static void DemoPlaybackReadyCallback(void* userData);
 	static void DemoLoadThreadEntryPoint(void* userData);
 	static void HeatMapsGenThreadEntryPoint(void* userData);
 
@@ -71,6 +72,8 @@ private:
 		{
 			Normal,
 			LoadingDemo,
+			FinishMapLoading, // The demo can be played back while it keeps loading.
+			StreamingDemo,
 			FinishDemoLoading,
 			GeneratingHeatMaps,
 			FinishHeatMapGeneration,
@@ -84,6 +87,8 @@ private:
 	bool CreateTextureRGBA(int& textureId, u32 width, u32 height, const u8* pixels);
 	void StartLoadingDemo(const char* filePath);
 	void LoadDemo(const char* filePath);
+	void LoadDemoMap();
+	void RestartPlayback();
 	void StartGeneratingHeatMaps();
 	void GenerateHeatMaps();
 	void RenderNormal(const RenderParams& renderParams);
@@ -113,6 +118,7 @@ private:
 	void OffsetSnapshot(s32 snapshotCount);
 	void OffsetTimeMs(s32 durationMs);
 	void ComputeMapPosition(f32* result, const f32* input, f32 mapScale, f32 zScale);
+	void FinishLoadingMap();
 	void FinishLoadingDemo();
 	void FinishGeneratingHeatMaps();
 
@@ -206,6 +212,8 @@ private:
 	bool _wasPlayingBeforeProgressDrag = false;
 	bool _reversePlayback = false;
 	bool _mapCoordsLoaded = false;
+	bool _demoMapLoaded = false; // By the demo loading thread.
+	bool _demoMapFinished = false; // The map texture was created while streaming the demo.
 	bool _appLoaded = false;
 	bool _displayHelp = false;
 	bool _profileMode = false;
@@ -0,0 +1,480 @@
+#include "../apps/shared.hpp"
+#include "demo.hpp"
+#include "log.hpp"
+#include "file_stream.hpp"
+#include "file_system.hpp"
+#include "path.hpp"
+#include "threads.hpp"
+#include "system.hpp"
+#include "thread_local_allocators.hpp"
+#include "scoped_stack_allocator.hpp"
+#include "utils.hpp"
+#include "stb_image.h"
+#include "stb_image_write.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+
+#define    UDT_HEAT_MAPS_DEFAULT_IMAGE_SIZE    1024
+#define    UDT_HEAT_MAPS_MAX_THREAD_COUNT      16
+#define    UDT_HEAT_MAPS_MAP_BORDER            256.0f // Quake units added around the area the players moved in.
+
+
+void PrintHelp()
+{
+	printf("For each input demo, writes one heat map image per player and optionally the position track of every player.\n");
+	printf("\n");
+	printf("viewer_heat_maps [-r] [-q] [-p] [-t=maxthreads] [-s=size] [-m=mapfolder] [-o=outputfolder] inputfile|inputfolder\n");
+	printf("\n");
+	printf("-q    quiet mode: no logging to stdout          (default: off)\n");
+	printf("-r    enable recursive demo file search         (default: off)\n");
+	printf("-p    write the position tracks to a CSV file   (default: off)\n");
+	printf("-t=N  set the maximum number of threads to N    (default: the processor core count)\n");
+	printf("-s=N  set the image width and height to N       (default: %d)\n", UDT_HEAT_MAPS_DEFAULT_IMAGE_SIZE);
+	printf("-m=p  read map bounds and image sizes from p    (default: off)\n");
+	printf("-o=p  set the output folder path to p           (default: the input's folder)\n");
+	printf("\n");
+	printf("The map folder holds the viewer's .mapinfo and .png files.\n");
+	printf("When a demo's map is found there, the heat maps match the map image's size and area.\n");
+}
+
+struct Config
+{
+	const char* OutputFolderPath;
+	const char* MapFolderPath;
+	u32 ImageSize;
+	bool WriteTracks;
+};
+
+struct WorkerSharedData
+{
+	const Config* Settings;
+	const udtFileInfo* Files;
+	u32 FileCount;
+	volatile u32 NextFileIndex;
+	volatile u32 FailedFileCount;
+};
+
+struct WorkerThreadData
+{
+	WorkerSharedData* Shared;
+};
+
+static void DemoProgressCallback(f32, void*)
+{
+}
+
+static bool KeepOnlyDemoFiles(const char* name, u64 /*size*/, void* /*userData*/)
+{
+	return udtPath::HasValidDemoFileExtension(name);
+}
+
+static bool LoadMapInfo(f32* min, f32* max, u32& width, u32& height, udtVMLinearAllocator& allocator, const char* mapFolderPath, const udtString& mapName)
+{
+	const udtString folderPath = udtString::NewConstRef(mapFolderPath);
+	const udtString infoFileName = udtString::NewFromConcatenating(allocator, mapName, udtString::NewConstRef(".mapinfo"));
+	const udtString imageFileName = udtString::NewFromConcatenating(allocator, mapName, udtString::NewConstRef(".png"));
+	udtString infoFilePath;
+	udtString imageFilePath;
+	udtPath::Combine(infoFilePath, allocator, folderPath, infoFileName);
+	udtPath::Combine(imageFilePath, allocator, folderPath, imageFileName);
+
+	int w, h, c;
+	if(!stbi_info(imageFilePath.GetPtr(), &w, &h, &c) || w <= 0 || h <= 0)
+	{
+		return false;
+	}
+
+	udtFileStream file;
+	if(!file.Open(infoFilePath.GetPtr(), udtFileOpenMode::Read))
+	{
+		return false;
+	}
+
+	u32 version = 0;
+	if(file.Read(&version, 4, 1) != 1 ||
+	   file.Read(min, 12, 1) != 1 ||
+	   file.Read(max, 12, 1) != 1)
+	{
+		return false;
+	}
+
+	width = (u32)w;
+	height = (u32)h;
+
+	return true;
+}
+
+static udtString GetOutputFilePathNoExt(udtVMLinearAllocator& allocator, const Config& config, const udtString& demoFilePath)
+{
+	udtString folderPath = config.OutputFolderPath != NULL ? udtString::NewConstRef(config.OutputFolderPath) : udtString::NewNull();
+	if(udtString::IsNull(folderPath))
+	{
+		udtPath::GetFolderPath(folderPath, allocator, demoFilePath);
+	}
+
+	udtString fileNameNoExt;
+	udtPath::GetFileNameWithoutExtension(fileNameNoExt, allocator, demoFilePath);
+
+	udtString filePathNoExt;
+	udtPath::Combine(filePathNoExt, allocator, folderPath, fileNameNoExt);
+
+	return filePathNoExt;
+}
+
+// Only keeps the characters that are safe in file names on all platforms.
+static udtString GetPlayerFileName(udtVMLinearAllocator& allocator, const Demo& demo, u32 nameOffset)
+{
+	const char* const name = demo.GetStringSafe(nameOffset, "");
+	udtString fileName = udtString::NewCleanClone(allocator, demo.GetProtocol(), name);
+	char* const chars = fileName.GetWritePtr();
+	u32 length = 0;
+	for(u32 i = 0, count = fileName.GetLength(); i < count; ++i)
+	{
+		const char c = chars[i];
+		if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_')
+		{
+			chars[length++] = c;
+		}
+	}
+	chars[length] = '\0';
+	fileName.SetLength(length);
+
+	return fileName;
+}
+
+static bool WriteHeatMaps(Demo& demo, const Config& config, const udtString& filePathNoExt, udtVMLinearAllocator& allocator)
+{
+	const HeatMapPlayer* players;
+	demo.GetHeatMapPlayers(players);
+	u32 playerCount = 0;
+	for(u32 p = 0; p < 64; ++p)
+	{
+		if(players[p].Present)
+		{
+			++playerCount;
+		}
+	}
+
+	if(playerCount == 0)
+	{
+		return true;
+	}
+
+	f32 min[3];
+	f32 max[3];
+	u32 width = config.ImageSize;
+	u32 height = config.ImageSize;
+	if(config.MapFolderPath == NULL ||
+	   !LoadMapInfo(min, max, width, height, allocator, config.MapFolderPath, demo.GetMapName()))
+	{
+		width = config.ImageSize;
+		height = config.ImageSize;
+		for(u32 i = 0; i < 3; ++i)
+		{
+			min[i] = demo.GetMapMin()[i];
+			max[i] = demo.GetMapMax()[i];
+		}
+		for(u32 i = 0; i < 2; ++i)
+		{
+			min[i] -= UDT_HEAT_MAPS_MAP_BORDER;
+			max[i] += UDT_HEAT_MAPS_MAP_BORDER;
+		}
+	}
+
+	const size_t byteCountHeatMap = (size_t)width * (size_t)height * 4;
+	u8* const heatMaps = (u8*)malloc(byteCountHeatMap * (size_t)playerCount);
+	if(heatMaps == NULL)
+	{
+		fprintf(stderr, "Failed to allocate %d bytes for heat map generation\n", (int)(byteCountHeatMap * (size_t)playerCount));
+		return false;
+	}
+
+	// The demos are already processed in parallel.
+	demo.GenerateHeatMaps(heatMaps, width, height, min, max, false, 1);
+
+	bool success = true;
+	u32 playerIndex = 0;
+	for(u32 p = 0; p < 64; ++p)
+	{
+		if(players[p].Present == 0)
+		{
+			continue;
+		}
+
+		udtVMScopedStackAllocator allocScope(allocator);
+		char suffix[32];
+		sprintf(suffix, "_heat_map_%02u_", p);
+		const udtString suffixString = udtString::NewConstRef(suffix);
+		const udtString playerName = GetPlayerFileName(allocator, demo, players[p].Name);
+		const udtString extension = udtString::NewConstRef(".png");
+		const udtString* pathParts[4] = { &filePathNoExt, &suffixString, &playerName, &extension };
+		const udtString filePath = udtString::NewFromConcatenatingMultiple(allocator, pathParts, 4);
+		const u8* const image = heatMaps + (size_t)playerIndex * byteCountHeatMap;
+		if(!stbi_write_png(filePath.GetPtr(), (int)width, (int)height, 4, image, (int)width * 4))
+		{
+			fprintf(stderr, "Failed to write heat map %s\n", filePath.GetPtr());
+			success = false;
+		}
+		++playerIndex;
+	}
+
+	free(heatMaps);
+
+	return success;
+}
+
+static bool WriteTracks(Demo& demo, const udtString& filePathNoExt, udtVMLinearAllocator& allocator, Snapshot& snapshot)
+{
+	udtVMScopedStackAllocator allocScope(allocator);
+	const udtString filePath = udtString::NewFromConcatenating(allocator, filePathNoExt, udtString::NewConstRef("_tracks.csv"));
+	udtFileStream file;
+	if(!file.Open(filePath.GetPtr(), udtFileOpenMode::Write))
+	{
+		fprintf(stderr, "Failed to open track file %s for writing\n", filePath.GetPtr());
+		return false;
+	}
+
+	char line[256];
+	const int headerLength = sprintf(line, "server_time_ms,display_time_ms,client_number,team,x,y,z,angle,dead\n");
+	file.Write(line, (u32)headerLength, 1);
+	for(u32 s = 0, count = demo.GetSnapshotCount(); s < count; ++s)
+	{
+		if(!demo.GetSnapshotData(snapshot, s))
+		{
+			continue;
+		}
+
+		for(u32 p = 0; p < snapshot.PlayerCount; ++p)
+		{
+			const Player& player = snapshot.Players[p];
+			const int length = sprintf(line, "%d,%d,%u,%u,%.1f,%.1f,%.1f,%.1f,%d\n",
+				(int)snapshot.ServerTimeMs, (int)snapshot.DisplayTimeMs,
+				(u32)player.IdClientNumber, (u32)player.Team,
+				player.Position[0], player.Position[1], player.Position[2], player.Angle,
+				IsBitSet(&player.Flags, PlayerFlags::Dead) ? 1 : 0);
+			file.Write(line, (u32)length, 1);
+		}
+	}
+
+	return true;
+}
+
+static void WorkerThreadEntryPoint(void* userData)
+{
+	WorkerSharedData& shared = *((WorkerThreadData*)userData)->Shared;
+	const Config& config = *shared.Settings;
+
+	Demo* const demo = (Demo*)malloc(sizeof(Demo));
+	Snapshot* const snapshot = (Snapshot*)malloc(sizeof(Snapshot));
+	if(demo == NULL || snapshot == NULL)
+	{
+		fprintf(stderr, "Failed to allocate the demo data\n");
+		free(demo);
+		free(snapshot);
+		return;
+	}
+	new (demo) Demo;
+
+	int dummy = 0;
+	if(!demo->Init(&DemoProgressCallback, nullptr, &dummy))
+	{
+		demo->~Demo();
+		free(demo);
+		free(snapshot);
+		return;
+	}
+
+	udtVMLinearAllocator& allocator = udtThreadLocalAllocators::GetTempAllocator();
+	for(;;)
+	{
+		const u32 fileIndex = AtomicFetchAndAdd(&shared.NextFileIndex, 1);
+		if(fileIndex >= shared.FileCount)
+		{
+			break;
+		}
+
+		udtVMScopedStackAllocator allocScope(allocator);
+		const udtString& demoFilePath = shared.Files[fileIndex].Path;
+		demo->Load(demoFilePath.GetPtr(), false, false);
+		if(!demo->IsValid())
+		{
+			fprintf(stderr, "Failed to load demo file %s\n", demoFilePath.GetPtr());
+			AtomicFetchAndAdd(&shared.FailedFileCount, 1);
+			continue;
+		}
+
+		const udtString filePathNoExt = GetOutputFilePathNoExt(allocator, config, demoFilePath);
+		bool success = WriteHeatMaps(*demo, config, filePathNoExt, allocator);
+		if(config.WriteTracks)
+		{
+			success = WriteTracks(*demo, filePathNoExt, allocator, *snapshot) && success;
+		}
+
+		if(!success)
+		{
+			AtomicFetchAndAdd(&shared.FailedFileCount, 1);
+		}
+		CallbackConsoleMessage(0, udtString::NewFromConcatenating(allocator, udtString::NewConstRef("Processed "), demoFilePath).GetPtr());
+	}
+
+	demo->~Demo();
+	free(demo);
+	free(snapshot);
+}
+
+static bool ProcessDemos(const Config& config, const udtFileInfo* files, u32 fileCount, u32 maxThreadCount)
+{
+	u32 coreCount = 1;
+	GetProcessorCoreCount(coreCount);
+	const u32 threadCount = udt_min(udt_min(maxThreadCount != 0 ? maxThreadCount : coreCount, fileCount), (u32)UDT_HEAT_MAPS_MAX_THREAD_COUNT);
+
+	WorkerSharedData shared;
+	shared.Settings = &config;
+	shared.Files = files;
+	shared.FileCount = fileCount;
+	shared.NextFileIndex = 0;
+	shared.FailedFileCount = 0;
+
+	WorkerThreadData threadData;
+	threadData.Shared = &shared;
+
+	// This thread processes demos too.
+	udtThread threads[UDT_HEAT_MAPS_MAX_THREAD_COUNT];
+	u32 startedThreadCount = 0;
+	for(u32 i = 1; i < threadCount; ++i)
+	{
+		if(!threads[startedThreadCount].CreateAndStart(&WorkerThreadEntryPoint, &threadData))
+		{
+			break;
+		}
+		++startedThreadCount;
+	}
+
+	WorkerThreadEntryPoint(&threadData);
+	for(u32 i = 0; i < startedThreadCount; ++i)
+	{
+		threads[i].Join();
+	}
+
+	return shared.FailedFileCount == 0;
+}
+
+static void PrintLogMessages()
+{
+	Log::Lock();
+	for(u32 i = 0, count = Log::GetMessageCount(); i < count; ++i)
+	{
+		const u32 level = Log::GetMessageLevel(i);
+		if(level == (u32)Log::Level::Warning || level == (u32)Log::Level::Error)
+		{
+			CallbackConsoleMessage((s32)level, Log::GetMessageString(i)); // Same values as the library's log levels.
+		}
+	}
+	Log::Unlock();
+}
+
+int udt_main(int argc, char** argv)
+{
+	if(argc < 2)
+	{
+		PrintHelp();
+		return 0;
+	}
+
+	bool fileMode = false;
+	const char* const inputPath = argv[argc - 1];
+	if(udtFileStream::Exists(inputPath) && udtPath::HasValidDemoFileExtension(inputPath))
+	{
+		fileMode = true;
+	}
+	else if(!IsValidDirectory(inputPath))
+	{
+		fprintf(stderr, "Invalid file/folder path.\n");
+		return 1;
+	}
+
+	Config config;
+	config.OutputFolderPath = NULL;
+	config.MapFolderPath = NULL;
+	config.ImageSize = UDT_HEAT_MAPS_DEFAULT_IMAGE_SIZE;
+	config.WriteTracks = false;
+	bool recursive = false;
+	u32 maxThreadCount = 0;
+	for(int i = 1; i < argc - 1; ++i)
+	{
+		s32 localValue = 0;
+
+		const udtString arg = udtString::NewConstRef(argv[i]);
+		if(udtString::Equals(arg, "-r"))
+		{
+			recursive = true;
+		}
+		else if(udtString::Equals(arg, "-p"))
+		{
+			config.WriteTracks = true;
+		}
+		else if(udtString::StartsWith(arg, "-o=") &&
+				arg.GetLength() >= 4 &&
+				IsValidDirectory(argv[i] + 3))
+		{
+			config.OutputFolderPath = argv[i] + 3;
+		}
+		else if(udtString::StartsWith(arg, "-m=") &&
+				arg.GetLength() >= 4 &&
+				IsValidDirectory(argv[i] + 3))
+		{
+			config.MapFolderPath = argv[i] + 3;
+		}
+		else if(udtString::StartsWith(arg, "-t=") &&
+				arg.GetLength() >= 4 &&
+				StringParseInt(localValue, arg.GetPtr() + 3) &&
+				localValue >= 1 &&
+				localValue <= UDT_HEAT_MAPS_MAX_THREAD_COUNT)
+		{
+			maxThreadCount = (u32)localValue;
+		}
+		else if(udtString::StartsWith(arg, "-s=") &&
+				arg.GetLength() >= 4 &&
+				StringParseInt(localValue, arg.GetPtr() + 3) &&
+				localValue >= 16 &&
+				localValue <= 8192)
+		{
+			config.ImageSize = (u32)localValue;
+		}
+	}
+
+	Log::Init();
+
+	bool success = false;
+	if(fileMode)
+	{
+		udtFileInfo fileInfo;
+		fileInfo.Name = udtString::NewNull();
+		fileInfo.Path = udtString::NewConstRef(inputPath);
+		fileInfo.Size = 0;
+		success = ProcessDemos(config, &fileInfo, 1, maxThreadCount);
+	}
+	else
+	{
+		udtFileListQuery query;
+		query.FileFilter = &KeepOnlyDemoFiles;
+		query.FolderPath = udtString::NewConstRef(inputPath);
+		query.Recursive = recursive;
+		GetDirectoryFileList(query);
+		if(query.Files.IsEmpty())
+		{
+			fprintf(stderr, "No demo file found.\n");
+			Log::Destroy();
+			return 1;
+		}
+		success = ProcessDemos(config, query.Files.GetStartAddress(), query.Files.GetSize(), maxThreadCount);
+	}
+
+	PrintLogMessages();
+	Log::Destroy();
+
+	return success ? 0 : 1;
+}
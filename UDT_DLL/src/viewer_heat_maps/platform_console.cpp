@@ -0,0 +1,20 @@
+// The subset of the viewer's platform layer needed by the Demo class and the log.
+#include "uberdemotools.h"
+#include "platform.hpp"
+#include "thread_local_allocators.hpp"
+#include "scoped_stack_allocator.hpp"
+#include "path.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#if defined(UDT_WINDOWS)
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#	include "windows.hpp"
+#else
+#	include <pthread.h>
+#	include <execinfo.h>
+#	include "linux.hpp"
+#endif
@@ -34,6 +34,7 @@ bool VirtualMemoryDecommitAndRelease(void* address, uptr /*byteCount*/)
 
 #include <sys/mman.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 
 void* VirtualMemoryReserve(uptr byteCount)
@@ -43,7 +44,14 @@ void* VirtualMemoryReserve(uptr byteCount)
 	// @NOTE: Unfortunately, the code above didn't work on the Linux I tried it on...
 
 	const int fd = open("/dev/zero", O_RDWR);
+	if(fd == -1)
+	{
+		return NULL;
+	}
+
+	// The mapping doesn't need the descriptor to stay open.
 	void* const address = mmap(NULL, (size_t)byteCount, PROT_NONE, MAP_PRIVATE | MAP_FILE, fd, 0);
+	close(fd);
 	if(address == MAP_FAILED)
 	{
 		return NULL;
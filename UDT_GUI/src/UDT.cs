@@ -895,6 +895,7 @@ namespace Uber.DemoTools
             Throughput,
             Duration,
             Percentage,
+            Rate,
             Count
         }
 
@@ -913,13 +914,26 @@ namespace Uber.DemoTools
             public IntPtr ProgressContext; // void*
             public IntPtr CancelOperation; // s32*
             public IntPtr PerformanceStats; // u64*
-            public IntPtr Reserved1;
+            public IntPtr PlugInPerformanceStats; // u64*
             public UInt32 PlugInCount;
             public Int32 GameStateIndex;
             public UInt32 FileOffset;
             public UInt32 Flags;
             public UInt32 MinProgressTimeMs;
-            public Int32 Reserved2;
+            public UInt32 DemoIndexIntervalMs;
+            public IntPtr CacheFolderPath; // const char*
+            public UInt32 ReadAheadBlockSize;
+            public UInt32 ReadAheadBlockCount;
+        }
+
+        [StructLayout(LayoutKind.Sequential, Pack = 1)]
+        public struct udtThreadPolicy
+        {
+            public UInt64 MinByteCountPerThread;
+            public UInt32 MaxThreadCount;
+            public UInt32 MinFileCountPerThread;
+            public UInt32 Flags;
+            public Int32 Reserved1;
         }
 
         [StructLayout(LayoutKind.Sequential, Pack = 1)]
@@ -929,6 +943,9 @@ namespace Uber.DemoTools
             public IntPtr OutputErrorCodes; // s32*
 		    public UInt32 FileCount;
 		    public UInt32 MaxThreadCount;
+            public IntPtr ThreadPolicy; // const udtThreadPolicy*
+            public UInt32 Flags;
+            public Int32 Reserved1;
 	    }
 
         [StructLayout(LayoutKind.Sequential, Pack = 1)]
@@ -960,7 +977,8 @@ namespace Uber.DemoTools
         [Flags]
         public enum udtCutByPatternArgFlags : uint
         {
-            MergeCutSections = 1 << 0
+            MergeCutSections = 1 << 0,
+            SinglePass = 1 << 1
         }
 
         public enum udtStringComparisonMode : uint
@@ -1466,7 +1484,9 @@ namespace Uber.DemoTools
         struct udtJSONArg
         {
             public UInt32 ConsoleOutput;
-            public Int32 Reserved1;
+            public UInt32 Flags;
+            public IntPtr OutputFilePath; // const char*
+            public IntPtr Reserved1;
         }
 
         [DllImport(_dllPath, CharSet = CharSet.Ansi, CallingConvention = CallingConvention.Cdecl)]
@@ -3677,6 +3697,9 @@ namespace Uber.DemoTools
                 case udtPerfStatsDataType.Percentage:
                     return ((float)value / 10.0f).ToString() + @"%";
 
+                case udtPerfStatsDataType.Rate:
+                    return ((float)value / 10.0f).ToString() + @"/s";
+
                 case udtPerfStatsDataType.Generic:
                 default:
                     return value.ToString();